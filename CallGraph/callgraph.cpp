@@ -90,6 +90,7 @@ CallGraph::CallGraph(IManager *manager)
     m_mgr->GetTheApp()->Connect( XRCID("cg_about"), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( CallGraph::OnAbout ), NULL, this );
 
     m_mgr->GetTheApp()->Connect( XRCID("cg_show_callgraph"), wxEVT_COMMAND_TOOL_CLICKED, wxCommandEventHandler( CallGraph::OnShowCallGraph ), NULL, this );
+    m_mgr->GetTheApp()->Connect( XRCID("cg_load_profile"), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( CallGraph::OnLoadProfile ), NULL, this );
 
     // initialize paths for standard and stored paths for this plugin
     // GetDotPath();
@@ -104,6 +105,7 @@ CallGraph::~CallGraph()
     m_mgr->GetTheApp()->Disconnect( XRCID("cg_about"), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( CallGraph::OnAbout ), NULL, this );
 
     m_mgr->GetTheApp()->Disconnect( XRCID("cg_show_callgraph"), wxEVT_COMMAND_TOOL_CLICKED, wxCommandEventHandler( CallGraph::OnShowCallGraph ), NULL, this );
+    m_mgr->GetTheApp()->Disconnect( XRCID("cg_load_profile"), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( CallGraph::OnLoadProfile ), NULL, this );
 
     wxDELETE(m_LogFile);
 }
@@ -183,6 +185,8 @@ void CallGraph::CreatePluginMenu(wxMenu *pluginsMenu)
     wxMenuItem *item(NULL);
     item = new wxMenuItem(menu, XRCID("cg_show_callgraph"), _("Show call graph"), _("Show call graph for selected/active project"), wxITEM_NORMAL);
     menu->Append(item);
+    item = new wxMenuItem(menu, XRCID("cg_load_profile"), _("Load profile..."), _("Show call graph for a 'perf script' or callgrind profile"), wxITEM_NORMAL);
+    menu->Append(item);
     menu->AppendSeparator();
     item = new wxMenuItem(menu, XRCID("cg_settings"), _("Settings..."), wxEmptyString, wxITEM_NORMAL);
     menu->Append(item);
@@ -464,6 +468,59 @@ void CallGraph::OnShowCallGraph(wxCommandEvent& event)
 
     delete proc;
 
+    DoShowCallGraph(pgp, base_path);
+}
+
+//---- Load profile event -----------------------------------------------------
+
+void CallGraph::OnLoadProfile(wxCommandEvent& event)
+{
+    if (!wxFileExists(GetDotPath()))
+        return MessageBox(_T("Failed to locate required tool (dot). Please check the plugin settings."), wxICON_ERROR);
+
+    wxString	base_path = ::wxGetCwd();
+    Workspace   *ws = m_mgr->GetWorkspace();
+    if (ws && m_mgr->IsWorkspaceOpen())
+        base_path = ws->GetWorkspaceFileName().GetPath();
+
+    wxString	profile_fn = wxFileSelector(_("Please select the profile to analyze ('perf script' output or callgrind.out file)"), base_path);
+    if (profile_fn.IsEmpty())	return;
+
+    wxFFileInputStream  input(profile_fn);
+    if (!input.IsOk())	return MessageBox(_("Failed to open the selected profile."), wxICON_ERROR);
+
+    wxBusyCursor busy;
+
+    if (CallgrindParser::IsCallgrindFile(profile_fn)) {
+        CallgrindParser parser;
+        parser.CallgrindParserStream(&input);
+        DoShowImportedCallGraph(parser, base_path);
+
+    } else {
+        PerfScriptParser parser;
+        parser.PerfScriptParserStream(&input);
+        if (parser.GetSamplesCount() == 0)
+            return MessageBox(_("No samples were found. Please select the text output of 'perf script' (recorded with 'perf record -g')."), wxICON_ERROR);
+        DoShowImportedCallGraph(parser, base_path);
+    }
+}
+
+void CallGraph::DoShowImportedCallGraph(ProfileParser& parser, const wxString& base_path)
+{
+    if (parser.lines.IsEmpty())
+        return MessageBox(_("The selected profile does not contain any data."), wxICON_ERROR);
+
+    // large profiles contain a long tail of functions with a negligible cost, drop them before creating the graph
+    parser.PruneLines(PROFILE_PRUNE_THRESHOLD);
+    DoShowCallGraph(parser, base_path);
+}
+
+//---- Show CallGraph ---------------------------------------------------------
+
+void CallGraph::DoShowCallGraph(ProfileParser& parser, const wxString& base_path)
+{
+    IConfigTool *config_tool = m_mgr->GetConfigTool();
+
     ConfCallGraph conf;
 
     config_tool->ReadObject(wxT("CallGraph"), &conf);
@@ -471,9 +528,9 @@ void CallGraph::OnShowCallGraph(wxCommandEvent& event)
     DotWriter dotWriter;
 
     // DotWriter
-    dotWriter.SetLineParser(&(pgp.lines));
+    dotWriter.SetLineParser(&(parser.lines));
 
-    int suggestedThreshold = pgp.GetSuggestedNodeThreshold();
+    int suggestedThreshold = parser.GetSuggestedNodeThreshold();
 
     if (suggestedThreshold <= conf.GetTresholdNode()) {
         suggestedThreshold = conf.GetTresholdNode();
@@ -497,7 +554,7 @@ void CallGraph::OnShowCallGraph(wxCommandEvent& event)
     dotWriter.WriteToDotLanguage();
 
     // build output dir
-    cfn.Assign(base_path, "");
+    wxFileName  cfn(base_path, "");
     cfn.AppendDir(CALLGRAPH_DIR);
     cfn.Normalize();
 
@@ -528,7 +585,7 @@ void CallGraph::OnShowCallGraph(wxCommandEvent& event)
         return MessageBox(_("Failed to open file CallGraph.png. Please check the project settings, rebuild the project and try again."), wxICON_INFORMATION);
 
     // show image and create table in the editor tab page
-    uicallgraphpanel	*panel = new uicallgraphpanel(m_mgr->GetEditorPaneNotebook(), m_mgr, output_png_fn, base_path, suggestedThreshold, &(pgp.lines));
+    uicallgraphpanel	*panel = new uicallgraphpanel(m_mgr->GetEditorPaneNotebook(), m_mgr, output_png_fn, base_path, suggestedThreshold, &(parser.lines));
 
     wxString	tstamp = wxDateTime::Now().Format(wxT(" %Y-%m-%d %H:%M:%S"));
 
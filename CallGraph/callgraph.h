@@ -19,6 +19,8 @@
 #include <wx/stream.h>
 #include "confcallgraph.h"
 #include "gprofparser.h"
+#include "perfparser.h"
+#include "callgrindparser.h"
 #include "dotwriter.h"
 #include "static.h"
 
@@ -100,6 +102,23 @@ protected:
 	 * @param event Reference to event class
 	 */
 	void OnShowCallGraph(wxCommandEvent &event);
+	/**
+	 * @brief Function import a profile created by 'perf script' or callgrind and show its call graph.
+	 * @param event Reference to event class
+	 */
+	void OnLoadProfile(wxCommandEvent &event);
+	/**
+	 * @brief Function write the parsed profile to dot, run dot and show the result in a new tab page.
+	 * @param parser Parser holding the profile lines
+	 * @param base_path Folder where the CallGraph output folder is created
+	 */
+	void DoShowCallGraph(ProfileParser& parser, const wxString& base_path);
+	/**
+	 * @brief Prune the imported profile and show its call graph.
+	 * @param parser Parser holding the profile lines
+	 * @param base_path Folder where the CallGraph output folder is created
+	 */
+	void DoShowImportedCallGraph(ProfileParser& parser, const wxString& base_path);
 	/**
 	 * @brief Handle function to open dialog with settings for Call graph plugin. 
 	 * @param event Reference to event class
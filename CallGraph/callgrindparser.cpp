@@ -0,0 +1,123 @@
+#include "callgrindparser.h"
+#include <wx/txtstrm.h>
+#include <wx/wfstream.h>
+#include <wx/tokenzr.h>
+#include <wx/filename.h>
+
+CallgrindParser::CallgrindParser()
+	: m_positions(1)
+{
+}
+
+CallgrindParser::~CallgrindParser()
+{
+}
+
+bool CallgrindParser::IsCallgrindFile(const wxString& filename)
+{
+	if(wxFileName(filename).GetFullName().StartsWith(wxT("callgrind.out")))
+		return true;
+	
+	wxFFileInputStream input(filename);
+	if(!input.IsOk())
+		return false;
+	
+	wxTextInputStream text(input);
+	for(int i = 0; i < 20 && !input.Eof(); ++i) {
+		wxString readlinetext = text.ReadLine();
+		if(readlinetext.StartsWith(wxT("# callgrind format")) || readlinetext.StartsWith(wxT("events:")))
+			return true;
+	}
+	return false;
+}
+
+void CallgrindParser::CallgrindParserStream(wxInputStream *input)
+{
+	Clear();
+	m_compressedNames.clear();
+	m_positions = 1;
+	
+	wxTextInputStream text(*input);
+	int currentFn = wxNOT_FOUND;
+	int calledFn = wxNOT_FOUND;
+	long callCount = 0;
+	bool pendingCall = false;
+	
+	while(!input->Eof()) {
+		wxString readlinetext = text.ReadLine();
+		if(readlinetext.IsEmpty() || readlinetext[0] == wxT('#'))
+			continue;
+		
+		wxChar ch = readlinetext[0];
+		if(wxIsdigit(ch) || ch == wxT('+') || ch == wxT('-') || ch == wxT('*')) {
+			// cost line
+			double cost;
+			if(currentFn == wxNOT_FOUND || !DoParseCost(readlinetext, cost))
+				continue;
+			
+			if(pendingCall) {
+				if(calledFn != wxNOT_FOUND)
+					AddCall(currentFn, calledFn, callCount, cost);
+				pendingCall = false;
+			} else {
+				AddSelfCost(currentFn, cost);
+			}
+			
+		} else if(readlinetext.StartsWith(wxT("fn="))) {
+			currentFn = GetFunctionId(DoGetName(readlinetext.Mid(3)));
+			
+		} else if(readlinetext.StartsWith(wxT("cfn=")) || readlinetext.StartsWith(wxT("cfni="))) {
+			calledFn = GetFunctionId(DoGetName(readlinetext.AfterFirst(wxT('='))));
+			
+		} else if(readlinetext.StartsWith(wxT("calls="))) {
+			readlinetext.Mid(6).BeforeFirst(wxT(' ')).ToLong(&callCount);
+			pendingCall = true;
+			
+		} else if(readlinetext.StartsWith(wxT("positions:"))) {
+			wxArrayString positions = wxStringTokenize(readlinetext.Mid(10), wxT(" \t"), wxTOKEN_STRTOK);
+			m_positions = positions.IsEmpty() ? 1 : positions.GetCount();
+		}
+		// all other specifications (fl=, ob=, events:, summary: ...) are ignored
+	}
+	
+	// callgrind only reports the self cost and the inclusive cost of the calls
+	for(size_t i = 0; i < m_functions.size(); ++i)
+		m_functions[i].inclusive = m_functions[i].self;
+	
+	for(EdgeMap::const_iterator it = m_edges.begin(); it != m_edges.end(); ++it) {
+		if(it->first.first != it->first.second)
+			m_functions[it->first.first].inclusive += it->second.cost;
+	}
+	
+	CreateLines(0);
+}
+
+wxString CallgrindParser::DoGetName(const wxString& value)
+{
+	// name compression: "(id) name" defines the id, "(id)" refers to it
+	if(!value.StartsWith(wxT("(")))
+		return value;
+	
+	wxString id = value.BeforeFirst(wxT(')')) + wxT(")");
+	wxString name = value.AfterFirst(wxT(')'));
+	name.Trim(false);
+	
+	if(name.IsEmpty()) {
+		CallgrindNameMap::iterator it = m_compressedNames.find(id);
+		return it == m_compressedNames.end() ? id : it->second;
+	}
+	
+	m_compressedNames[id] = name;
+	return name;
+}
+
+bool CallgrindParser::DoParseCost(const wxString& line, double& cost) const
+{
+	wxArrayString tokens = wxStringTokenize(line, wxT(" \t"), wxTOKEN_STRTOK);
+	if(tokens.GetCount() <= m_positions) {
+		// no cost means 0
+		cost = 0;
+		return true;
+	}
+	return tokens.Item(m_positions).ToCDouble(&cost);
+}
@@ -0,0 +1,44 @@
+/***************************************************************
+ * Name:      callgrindparser.h
+ * Purpose:   Header to create stream parser for callgrind output.
+ * Notes:
+ **************************************************************/
+
+#ifndef __CALLGRINDPARSER_H__
+#define __CALLGRINDPARSER_H__
+
+#include <wx/stream.h>
+#include <wx/hashmap.h>
+#include "profileparser.h"
+
+WX_DECLARE_STRING_HASH_MAP(wxString, CallgrindNameMap);
+
+/**
+ * @class CallgrindParser
+ * @brief Read a callgrind output file (valgrind --tool=callgrind) and aggregate the cost
+ * of the first event into the LineParserList model.
+ */
+class CallgrindParser : public AggregatingProfileParser
+{
+	CallgrindNameMap m_compressedNames;
+	size_t m_positions;
+
+protected:
+	wxString DoGetName(const wxString& value);
+	bool DoParseCost(const wxString& line, double& cost) const;
+
+public:
+	CallgrindParser();
+	virtual ~CallgrindParser();
+	/**
+	 * @brief Read the input stream line by line and aggregate the costs.
+	 * @param input stream with the callgrind output
+	 */
+	void CallgrindParserStream(wxInputStream *input);
+	/**
+	 * @brief Return true if the stream looks like a callgrind output.
+	 */
+	static bool IsCallgrindFile(const wxString& filename);
+};
+
+#endif // __CALLGRINDPARSER_H__
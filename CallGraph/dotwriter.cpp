@@ -4,7 +4,13 @@
 #include <wx/msgdlg.h>
 #include <wx/math.h>
 #include <wx/regex.h>
+#include <wx/hashset.h>
 #include <math.h>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+WX_DECLARE_HASH_SET(int, wxIntegerHash, wxIntegerEqual, DotNodesSet);
 
 
 DotWriter::DotWriter()
@@ -27,6 +33,7 @@ DotWriter::DotWriter()
 	dwce = 0;
 	dwtn = 0;
 	dwte = 0;
+	dwmaxnodes = DOT_MAX_NODES;
 	dwhideparams = false;
 	dwhidenamespaces = false;
 	dwstripparams = false;
@@ -65,16 +72,35 @@ void DotWriter::SetDotWriterFromDetails(int colnode, int coledge, int thrnode, i
 	dwhidenamespaces = hidenamespaces;
 }
 
+void DotWriter::SetMaxNodes(int maxnodes)
+{
+	dwmaxnodes = maxnodes;
+}
+
 void DotWriter::WriteToDotLanguage()
 {
 	int pl_index = 0;
 	float pl_time = 0;
 	bool is_node = false;
-	wxArrayInt index_pl_nodes;
+	DotNodesSet index_pl_nodes;
 
 	if (mlines == NULL)
 		return;
 
+	// prune the graph: if there are too many nodes above the threshold keep only the most expensive ones
+	float min_time = -1;
+	if (dwmaxnodes > 0) {
+		std::vector<float> times;
+		for(LineParserList::compatibility_iterator it = mlines->GetFirst(); it; it = it->GetNext()) {
+			LineParser *line = it->GetData();
+			if(line->pline && wxRound(line->time) >= dwtn) times.push_back(line->time);
+		}
+		if (times.size() > (size_t)dwmaxnodes) {
+			std::nth_element(times.begin(), times.begin() + (dwmaxnodes - 1), times.end(), std::greater<float>());
+			min_time = times.at(dwmaxnodes - 1);
+		}
+	}
+
 	graph = wxT("graph [ranksep=\"0.25\", fontname=") + fontname + wxT(", nodesep=\"0.125\"];");
 
 	hnode = wxT("node [label=\"\\N\", fontsize=\"9.00\", fontname=") + fontname + wxT(", style=\"") + style + wxT("\", height=0, width=0, shape=") + shape + wxT(", fontcolor=") + cwhite + wxT("];");
@@ -90,9 +116,9 @@ void DotWriter::WriteToDotLanguage()
 	while(it) {
 		LineParser *line = it->GetData();
 
-		if(line->pline && wxRound(line->time) >= dwtn) {
+		if(line->pline && wxRound(line->time) >= dwtn && line->time >= min_time) {
 			is_node = true;
-			index_pl_nodes.Add(line->index);
+			index_pl_nodes.insert(line->index);
 			dlabel = wxString::Format(wxT("%i"),line->index);
 			dlabel += wxT(" [label=\"");
 			dlabel += OptionsShortNameAndParameters(line->name);
@@ -139,7 +165,7 @@ void DotWriter::WriteToDotLanguage()
 			pl_time = line->time; // time for primary node
 		}
 
-		if (line->child && IsInArray(line->nameid,index_pl_nodes) && IsInArray(pl_index,index_pl_nodes) && (wxRound(pl_time) >= dwte)) {
+		if (line->child && index_pl_nodes.count(line->nameid) && index_pl_nodes.count(pl_index) && (wxRound(pl_time) >= dwte)) {
 			dedge = wxString::Format(wxT("%i"), pl_index);
 			dedge += wxT(" -> ");
 			dedge += wxString::Format(wxT("%i"),line->nameid);
@@ -39,6 +39,7 @@ private:
 	int dwce;
 	int dwtn;
 	int dwte;
+	int dwmaxnodes;
 	
 protected:
 	/**
@@ -86,6 +87,12 @@ public:
 	 * @param hidenamespaces
 	 */
 	void SetDotWriterFromDetails(int colnode, int coledge, int thrnode, int thredge, bool hideparams, bool stripparams, bool hidenamespaces);
+	/**
+	 * @brief Set the maximum number of nodes written to the graph. When more primary lines pass
+	 * the node threshold, only the most expensive ones are kept (so dot does not choke on huge graphs).
+	 * @param maxnodes maximum number of nodes, 0 means no limit
+	 */
+	void SetMaxNodes(int maxnodes);
 	//
 	/**
 	 * @brief Function create data in the DOT language and prepare it to write.
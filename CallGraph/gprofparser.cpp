@@ -3,8 +3,6 @@
 #include <wx/regex.h>
 #include <wx/strconv.h>
 
-int cmpint(int* a, int* b) { return *b - *a; }
-
 GprofParser::GprofParser()
 {
 	lineheader = false;
@@ -16,14 +14,10 @@ GprofParser::GprofParser()
 	islom = false;
 	isplus = false;
 	isspontaneous = false;
-	lines.DeleteContents(true);
-	lines.Clear();
 };
 
 GprofParser::~GprofParser()
 {
-	lines.DeleteContents(true);
-	lines.Clear();
 };
 
 void	GprofParser::GprofParserStream(wxInputStream *gprof_output)
@@ -247,28 +241,3 @@ void	GprofParser::GprofParserStream(wxInputStream *gprof_output)
 
 	delete [] nameandid;
 }
-
-int GprofParser::GetSuggestedNodeThreshold()
-{
-	sortedCalls.Clear();
-	
-	for( OccurenceMap::iterator it = calls.begin(); it != calls.end(); ++it )
-		sortedCalls.Add( it->first );
-		
-	sortedCalls.Sort(cmpint);
-	int totalCount = 0;
-	int minCallTime = INT_MAX;
-	
-	for( size_t i = 0; i < sortedCalls.GetCount() && totalCount < 100; ++i )
-	{
-		totalCount += calls[ sortedCalls[i] ];
-		if( totalCount < 100 && sortedCalls[i] < minCallTime  ) minCallTime = sortedCalls[i];
-	}
-	
-	if( minCallTime < 0 ) minCallTime = 0;
-	else if( minCallTime > 100 ) minCallTime = 100;
-	
-	if( sortedCalls.GetCount() > 1 && totalCount >= 100 ) return minCallTime;
-	else
-		return -1;
-}
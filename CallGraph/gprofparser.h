@@ -8,21 +8,22 @@
  * Notes:
  **************************************************************/
 
+#ifndef __GPROFPARSER_H__
+#define __GPROFPARSER_H__
+
 #include <wx/wx.h>
 #include <wx/string.h> 
 #include <wx/stream.h>
 #include <wx/txtstrm.h>
 #include <wx/hashmap.h>
 
-#include "lineparser.h"
-
-WX_DECLARE_HASH_MAP(int, int, wxIntegerHash, wxIntegerEqual, OccurenceMap);
+#include "profileparser.h"
 
 /**
  * @class GprofParser
  * @brief Class define structure for parser to read stream of data from gprof tool.
  */
-class GprofParser
+class GprofParser : public ProfileParser
 {
 private:
 	wxString readlinetext;
@@ -37,9 +38,6 @@ private:
 	bool isplus;	
 	bool isspontaneous;	
 	
-	OccurenceMap calls;
-	wxArrayInt sortedCalls;
-	
 public:
 	/**
 	 * @brief Defautl constructor.
@@ -49,17 +47,11 @@ public:
 	 * @brief Defautl destructor.
 	 */
 	~GprofParser();
-	/**
-	 * @brief  List lines type LineParserList.
-	 */
-	LineParserList lines;
 	/**
 	 * @brief Function is reading the input stream from gprof application and scan the rows to save to collection of objects lines. 
 	 * @param m_pInputStream pointer of type wxInputStream. 
 	 */
 	void GprofParserStream(wxInputStream *m_pInputStream);
-	/**
-	 * @brief Suggest call diagram's node threshold so no more than 100 items should be displayed at once.
-	 */
-	int GetSuggestedNodeThreshold();
 };
+
+#endif // __GPROFPARSER_H__
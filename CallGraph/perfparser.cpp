@@ -0,0 +1,127 @@
+#include "perfparser.h"
+#include <wx/txtstrm.h>
+#include <algorithm>
+
+PerfScriptParser::PerfScriptParser()
+	: m_firstTimestamp(-1)
+	, m_lastTimestamp(-1)
+	, m_samples(0)
+{
+}
+
+PerfScriptParser::~PerfScriptParser()
+{
+}
+
+void PerfScriptParser::PerfScriptParserStream(wxInputStream *input)
+{
+	Clear();
+	m_stack.clear();
+	m_firstTimestamp = -1;
+	m_lastTimestamp = -1;
+	m_samples = 0;
+	
+	wxTextInputStream text(*input);
+	bool inSample = false;
+	
+	while(!input->Eof()) {
+		wxString readlinetext = text.ReadLine();
+		
+		if(readlinetext.IsEmpty()) {
+			// a blank line terminates the sample
+			if(inSample) DoCommitSample();
+			inSample = false;
+			continue;
+		}
+		
+		if(readlinetext.StartsWith(wxT("#")))
+			continue;
+		
+		if(readlinetext[0] != wxT(' ') && readlinetext[0] != wxT('\t')) {
+			// sample header: "comm pid [cpu] timestamp: period event:"
+			if(inSample) DoCommitSample();
+			inSample = true;
+			
+			double timestamp;
+			if(DoParseTimestamp(readlinetext, timestamp)) {
+				if(m_firstTimestamp < 0) m_firstTimestamp = timestamp;
+				m_lastTimestamp = timestamp;
+			}
+			continue;
+		}
+		
+		// stack frame (the leaf comes first)
+		if(inSample && m_stack.size() < PERF_MAX_STACK_DEPTH) {
+			wxString name = DoGetSymbolName(readlinetext);
+			if(!name.IsEmpty())
+				m_stack.push_back(GetFunctionId(name));
+		}
+	}
+	
+	if(inSample) DoCommitSample();
+	
+	double secondsPerSample = 0;
+	if(m_samples > 1 && m_lastTimestamp > m_firstTimestamp)
+		secondsPerSample = (m_lastTimestamp - m_firstTimestamp) / (double)m_samples;
+	
+	CreateLines(secondsPerSample);
+}
+
+void PerfScriptParser::DoCommitSample()
+{
+	if(m_stack.empty())
+		return;
+	
+	++m_samples;
+	AddSelfCost(m_stack.at(0), 1);
+	
+	// a function appearing several times in the same stack (recursion) is only counted once
+	std::vector<int> seen;
+	for(size_t i = 0; i < m_stack.size(); ++i) {
+		if(std::find(seen.begin(), seen.end(), m_stack.at(i)) == seen.end()) {
+			seen.push_back(m_stack.at(i));
+			AddInclusiveCost(m_stack.at(i), 1);
+		}
+		if(i + 1 < m_stack.size())
+			AddCall(m_stack.at(i + 1), m_stack.at(i), 1, 1);
+	}
+	m_stack.clear();
+}
+
+wxString PerfScriptParser::DoGetSymbolName(const wxString& frame) const
+{
+	// "	    7f3a2b1c0d5e symbol+0x1e (/usr/lib/libfoo.so)"
+	wxString line = frame;
+	line.Trim(false).Trim();
+	
+	// skip the address
+	wxString symbol = line.AfterFirst(wxT(' '));
+	symbol.Trim(false);
+	
+	// remove the DSO
+	if(symbol.EndsWith(wxT(")")) && symbol.Contains(wxT(" (")))
+		symbol = symbol.BeforeLast(wxT('(')).Trim();
+	
+	// remove the offset
+	int where = symbol.Find(wxT("+0x"), true);
+	if(where != wxNOT_FOUND)
+		symbol = symbol.Left(where);
+	
+	return symbol;
+}
+
+bool PerfScriptParser::DoParseTimestamp(const wxString& header, double& timestamp) const
+{
+	// the timestamp is the first token of the form "12345.678901:"
+	wxString rest = header;
+	while(!rest.IsEmpty()) {
+		wxString token = rest.BeforeFirst(wxT(' '));
+		rest = rest.AfterFirst(wxT(' '));
+		if(token.EndsWith(wxT(":")) && token.Contains(wxT("."))) {
+			token.RemoveLast();
+			if(token.ToCDouble(&timestamp))
+				return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,51 @@
+/***************************************************************
+ * Name:      perfparser.h
+ * Purpose:   Header to create stream parser for 'perf script' output.
+ * Notes:
+ **************************************************************/
+
+#ifndef __PERFPARSER_H__
+#define __PERFPARSER_H__
+
+#include <wx/stream.h>
+#include "profileparser.h"
+
+/**
+ * @brief Maximum number of frames taken from a single stack sample.
+ */
+#define PERF_MAX_STACK_DEPTH 256
+
+/**
+ * @class PerfScriptParser
+ * @brief Read the output of 'perf script' (recorded with 'perf record -g') and aggregate
+ * the stack samples into the LineParserList model.
+ */
+class PerfScriptParser : public AggregatingProfileParser
+{
+	std::vector<int> m_stack;
+	double m_firstTimestamp;
+	double m_lastTimestamp;
+	long m_samples;
+
+protected:
+	void DoCommitSample();
+	wxString DoGetSymbolName(const wxString& frame) const;
+	bool DoParseTimestamp(const wxString& header, double& timestamp) const;
+
+public:
+	PerfScriptParser();
+	virtual ~PerfScriptParser();
+	/**
+	 * @brief Read the input stream line by line and aggregate the samples.
+	 * @param input stream with the 'perf script' output
+	 */
+	void PerfScriptParserStream(wxInputStream *input);
+	/**
+	 * @brief Return the number of samples read.
+	 */
+	long GetSamplesCount() const {
+		return m_samples;
+	}
+};
+
+#endif // __PERFPARSER_H__
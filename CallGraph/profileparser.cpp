@@ -0,0 +1,223 @@
+#include "profileparser.h"
+#include <wx/math.h>
+#include <wx/hashset.h>
+#include <algorithm>
+#include <limits.h>
+
+WX_DECLARE_HASH_SET(int, wxIntegerHash, wxIntegerEqual, ProfileIdSet);
+
+int cmpint(int* a, int* b) { return *b - *a; }
+
+//---- ProfileParser ----------------------------------------------------------
+
+ProfileParser::ProfileParser()
+{
+	lines.DeleteContents(true);
+	lines.Clear();
+}
+
+ProfileParser::~ProfileParser()
+{
+	lines.DeleteContents(true);
+	lines.Clear();
+}
+
+int ProfileParser::GetSuggestedNodeThreshold()
+{
+	sortedCalls.Clear();
+	
+	for( OccurenceMap::iterator it = calls.begin(); it != calls.end(); ++it )
+		sortedCalls.Add( it->first );
+		
+	sortedCalls.Sort(cmpint);
+	int totalCount = 0;
+	int minCallTime = INT_MAX;
+	
+	for( size_t i = 0; i < sortedCalls.GetCount() && totalCount < 100; ++i )
+	{
+		totalCount += calls[ sortedCalls[i] ];
+		if( totalCount < 100 && sortedCalls[i] < minCallTime  ) minCallTime = sortedCalls[i];
+	}
+	
+	if( minCallTime < 0 ) minCallTime = 0;
+	else if( minCallTime > 100 ) minCallTime = 100;
+	
+	if( sortedCalls.GetCount() > 1 && totalCount >= 100 ) return minCallTime;
+	else
+		return -1;
+}
+
+size_t ProfileParser::PruneLines(float minTime)
+{
+	// collect the functions we keep
+	ProfileIdSet kept;
+	size_t removed = 0;
+	for(LineParserList::compatibility_iterator it = lines.GetFirst(); it; it = it->GetNext()) {
+		LineParser *line = it->GetData();
+		if(line->pline && line->time >= minTime)
+			kept.insert(line->nameid);
+	}
+	
+	bool keepBlock = true;
+	LineParserList::compatibility_iterator it = lines.GetFirst();
+	while(it) {
+		LineParserList::compatibility_iterator next = it->GetNext();
+		LineParser *line = it->GetData();
+		
+		bool remove = false;
+		if(line->pline) {
+			keepBlock = kept.count(line->nameid) != 0;
+			remove = !keepBlock;
+			if(remove) {
+				calls[ wxRound(line->time) ] = calls[ wxRound(line->time) ] - 1;
+				++removed;
+			}
+		} else if(line->child) {
+			remove = !keepBlock || kept.count(line->nameid) == 0;
+		} else {
+			// parent lines precede their primary line
+			remove = kept.count(line->nameid) == 0;
+		}
+		
+		if(remove)
+			lines.DeleteNode(it);
+		it = next;
+	}
+	return removed;
+}
+
+//---- AggregatingProfileParser -----------------------------------------------
+
+AggregatingProfileParser::AggregatingProfileParser()
+	: m_otherId(wxNOT_FOUND)
+{
+}
+
+AggregatingProfileParser::~AggregatingProfileParser()
+{
+}
+
+void AggregatingProfileParser::Clear()
+{
+	m_functions.clear();
+	m_functionIds.clear();
+	m_edges.clear();
+	m_otherId = wxNOT_FOUND;
+	calls.clear();
+	lines.Clear();
+}
+
+int AggregatingProfileParser::GetFunctionId(const wxString& name)
+{
+	ProfileFunctionIdMap::iterator it = m_functionIds.find(name);
+	if(it != m_functionIds.end())
+		return it->second;
+	
+	if(m_functions.size() >= PROFILE_MAX_FUNCTIONS) {
+		// keep the memory bounded: account everything else to a single node
+		if(m_otherId == wxNOT_FOUND) {
+			m_otherId = (int)m_functions.size();
+			m_functions.push_back(FunctionStats());
+			m_functions.back().name = wxT("<other>");
+		}
+		return m_otherId;
+	}
+	
+	int id = (int)m_functions.size();
+	m_functions.push_back(FunctionStats());
+	m_functions.back().name = name;
+	m_functionIds[name] = id;
+	return id;
+}
+
+void AggregatingProfileParser::AddSelfCost(int id, double cost)
+{
+	m_functions.at(id).self += cost;
+}
+
+void AggregatingProfileParser::AddInclusiveCost(int id, double cost)
+{
+	m_functions.at(id).inclusive += cost;
+}
+
+void AggregatingProfileParser::AddCall(int caller, int callee, long count, double cost)
+{
+	EdgeStats &edge = m_edges[std::make_pair(caller, callee)];
+	edge.count += count;
+	edge.cost += cost;
+	if(caller != callee)
+		m_functions.at(callee).called += count;
+}
+
+void AggregatingProfileParser::CreateLines(double secondsPerUnit)
+{
+	lines.Clear();
+	calls.clear();
+	
+	double total = 0;
+	for(size_t i = 0; i < m_functions.size(); ++i)
+		total += m_functions[i].self;
+	
+	if(total <= 0)
+		return;
+	
+	double scale = secondsPerUnit > 0 ? secondsPerUnit : (100.0 / total);
+	
+	// group the edges by the caller
+	std::vector< std::vector<EdgeMap::const_iterator> > callees(m_functions.size());
+	for(EdgeMap::const_iterator it = m_edges.begin(); it != m_edges.end(); ++it)
+		callees[it->first.first].push_back(it);
+	
+	// sort the functions by their inclusive cost, like gprof does
+	std::vector< std::pair<double, int> > order;
+	order.reserve(m_functions.size());
+	for(size_t i = 0; i < m_functions.size(); ++i)
+		order.push_back(std::make_pair(-m_functions[i].inclusive, (int)i));
+	std::sort(order.begin(), order.end());
+	
+	for(size_t n = 0; n < order.size(); ++n) {
+		int id = order[n].second;
+		const FunctionStats &fs = m_functions[id];
+		if(fs.inclusive <= 0)
+			continue;
+		
+		LineParser *line = new LineParser();
+		line->index = id + 1;
+		line->nameid = id + 1;
+		line->name = fs.name;
+		line->time = (float)(fs.inclusive * 100.0 / total);
+		line->self = (float)(fs.self * scale);
+		line->children = (float)((fs.inclusive - fs.self) * scale);
+		line->called0 = fs.called ? (int)fs.called : -1;
+		line->called1 = -1;
+		line->parents = false;
+		line->pline = true;
+		line->child = false;
+		line->cycle = false;
+		line->recursive = m_edges.count(std::make_pair(id, id)) != 0;
+		line->cycleid = -1;
+		lines.Append(line);
+		calls[ wxRound(line->time) ] = calls[ wxRound(line->time) ] + 1;
+		
+		const std::vector<EdgeMap::const_iterator> &edges = callees[id];
+		for(size_t e = 0; e < edges.size(); ++e) {
+			int callee = edges[e]->first.second;
+			LineParser *child = new LineParser();
+			child->index = -1;
+			child->nameid = callee + 1;
+			child->name = m_functions[callee].name;
+			child->time = -1;
+			child->self = (float)(edges[e]->second.cost * scale);
+			child->children = 0;
+			child->called0 = (int)edges[e]->second.count;
+			child->called1 = -1;
+			child->parents = false;
+			child->pline = false;
+			child->child = true;
+			child->cycle = false;
+			child->recursive = callee == id;
+			child->cycleid = -1;
+			lines.Append(child);
+		}
+	}
+}
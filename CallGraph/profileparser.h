@@ -0,0 +1,119 @@
+/***************************************************************
+ * Name:      profileparser.h
+ * Purpose:   Header to define the common base for profile parsers.
+ * Notes:
+ **************************************************************/
+
+#ifndef __PROFILEPARSER_H__
+#define __PROFILEPARSER_H__
+
+#include <wx/string.h>
+#include <wx/hashmap.h>
+#include <wx/dynarray.h>
+#include <vector>
+#include <map>
+
+#include "lineparser.h"
+
+WX_DECLARE_HASH_MAP(int, int, wxIntegerHash, wxIntegerEqual, OccurenceMap);
+WX_DECLARE_STRING_HASH_MAP(int, ProfileFunctionIdMap);
+
+/**
+ * @brief Maximum number of distinct functions kept by the streaming importers.
+ * Samples of any function beyond this limit are accounted to a single "<other>" node,
+ * so the memory used while importing a profile stays bounded.
+ */
+#define PROFILE_MAX_FUNCTIONS 200000
+
+/**
+ * @brief Default pruning threshold (in % of the total time) applied after importing a profile.
+ */
+#define PROFILE_PRUNE_THRESHOLD 0.1
+
+/**
+ * @class ProfileParser
+ * @brief Base class for all parsers which fill the LineParserList model.
+ */
+class ProfileParser
+{
+protected:
+	OccurenceMap calls;
+	wxArrayInt sortedCalls;
+
+public:
+	/**
+	 * @brief Defautl constructor.
+	 */
+	ProfileParser();
+	/**
+	 * @brief Defautl destructor.
+	 */
+	virtual ~ProfileParser();
+	/**
+	 * @brief  List lines type LineParserList.
+	 */
+	LineParserList lines;
+	/**
+	 * @brief Suggest call diagram's node threshold so no more than 100 items should be displayed at once.
+	 */
+	int GetSuggestedNodeThreshold();
+	/**
+	 * @brief Remove all primary lines (and their parent/child lines) whose time is below minTime,
+	 * as well as all parent/child lines which refer to a removed function.
+	 * @param minTime threshold in % of the total time
+	 * @return number of primary lines removed
+	 */
+	size_t PruneLines(float minTime);
+};
+
+/**
+ * @class AggregatingProfileParser
+ * @brief Base class for the streaming importers (perf, callgrind). Samples are aggregated
+ * per function and per call edge while reading the input, the raw samples are never stored.
+ */
+class AggregatingProfileParser : public ProfileParser
+{
+protected:
+	struct FunctionStats {
+		wxString name;
+		double   self;
+		double   inclusive;
+		long     called;
+		FunctionStats() : self(0), inclusive(0), called(0) {}
+	};
+
+	struct EdgeStats {
+		long   count;
+		double cost;
+		EdgeStats() : count(0), cost(0) {}
+	};
+
+	typedef std::map<std::pair<int, int>, EdgeStats> EdgeMap;
+
+	std::vector<FunctionStats> m_functions;
+	ProfileFunctionIdMap       m_functionIds;
+	EdgeMap                    m_edges;
+	int                        m_otherId;
+
+protected:
+	/**
+	 * @brief Return the id of the function, allocate a new one if needed.
+	 */
+	int  GetFunctionId(const wxString& name);
+	void AddSelfCost(int id, double cost);
+	void AddInclusiveCost(int id, double cost);
+	void AddCall(int caller, int callee, long count, double cost);
+	/**
+	 * @brief Convert the aggregated data into the gprof like LineParserList model.
+	 * @param secondsPerUnit used to convert the cost into seconds. If 0, the self/children
+	 * columns are expressed in % of the total cost
+	 */
+	void CreateLines(double secondsPerUnit);
+	void Clear();
+
+public:
+	AggregatingProfileParser();
+	virtual ~AggregatingProfileParser();
+};
+
+#endif // __PROFILEPARSER_H__
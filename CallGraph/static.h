@@ -18,6 +18,9 @@ const wxString	DOT_FILENAME_PNG = "dot.png";
 const wxString	DOT_FILENAME_TXT = "dot.txt";
 const wxString	CALLGRAPH_DIR = "CallGraph";
 
+// maximum number of nodes passed to dot
+const int	DOT_MAX_NODES = 500;
+
 	#ifdef __WXMSW__
 		const wxString	GPROF_FILENAME_EXE = "gprof.exe";
 		const wxString	DOT_FILENAME_EXE = "dot.exe";
@@ -13,10 +13,13 @@
 #include <cppwordscanner.h>
 #include <stringsearcher.h>
 #include <parse_thread.h>
+#include <crawler_include.h>
 #include <wx/tokenzr.h>
 
 // CodeLite includes
 #include <ctags_manager.h>
+#include <tags_storage_sqlite3.h>
+#include <map>
 
 wxString LoadFile(const wxString &filename)
 {
@@ -344,6 +347,101 @@ TEST_FUNC(testAutoSimple)
     return true;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Include crawler test cases
+/////////////////////////////////////////////////////////////////////////////
+
+TEST_FUNC(testCrawlerScan)
+{
+    // The expected values are the results of the former flex scanner (crawler.l)
+    // on the same files: includes in comments and strings are ignored, the
+    // included file is scanned (once) and "using namespace" / aliases are collected
+    fcFileOpener context;
+    context.AddSearchPath("../tests");
+    context.setMaxDepth(20);
+    crawlerScan("../tests/test_crawler.h", &context);
+
+    const fcFileOpener::Set_t& files = context.GetResults();
+    CHECK_SIZE(files.size(), 2);
+    CHECK_SIZE(files.count("../tests/test_crawler.h"), 1);
+    CHECK_SIZE(files.count("../tests/test_crawler_inc.h"), 1);
+
+    std::vector<std::string> statements(context.GetIncludeStatements().begin(), context.GetIncludeStatements().end());
+    CHECK_SIZE(statements.size(), 5);
+    CHECK_STRING(statements.at(0).c_str(), "<vector>");
+    CHECK_STRING(statements.at(1).c_str(), "\"test_crawler_inc.h\"");
+    CHECK_STRING(statements.at(2).c_str(), "\"test_crawler.h\"");
+    CHECK_STRING(statements.at(3).c_str(), "\"after_char_literal.h\"");
+    CHECK_STRING(statements.at(4).c_str(), "<map>");
+
+    const fcFileOpener::Set_t& namespaces = context.GetNamespaces();
+    CHECK_SIZE(namespaces.size(), 3);
+    CHECK_SIZE(namespaces.count("std"), 1);
+    CHECK_SIZE(namespaces.count("wx::detail"), 1);
+    CHECK_SIZE(namespaces.count("inner"), 1);
+
+    CHECK_SIZE(context.GetNamespaceAliases().size(), 1);
+    CHECK_SIZE(context.GetNamespaceAliases().count("namespace fs = boost::filesystem;"), 1);
+    return true;
+}
+
+TEST_FUNC(testIncludeGraph)
+{
+    // main.cpp -> app.h -> base.h and util.cpp -> base.h, stored the way the
+    // parser thread does it
+    wxFileName dbfile(wxT("include_graph_test.tags"));
+    if(dbfile.FileExists())
+        wxRemoveFile(dbfile.GetFullPath());
+
+    TagsStorageSQLite db;
+    db.OpenDatabase(dbfile);
+
+    wxString mainCpp = TagsStorageSQLite::NormalizeIncludeGraphPath(wxT("graph/main.cpp"));
+    wxString utilCpp = TagsStorageSQLite::NormalizeIncludeGraphPath(wxT("graph/util.cpp"));
+    wxString appH    = TagsStorageSQLite::NormalizeIncludeGraphPath(wxT("graph/app.h"));
+    wxString baseH   = TagsStorageSQLite::NormalizeIncludeGraphPath(wxT("graph/base.h"));
+
+    std::map<wxString, wxArrayString> graph;
+    graph[mainCpp].Add(appH);
+    graph[appH].Add(baseH);
+    graph[utilCpp].Add(baseH);
+    db.StoreIncludeGraph(graph);
+
+    wxArrayString files;
+    db.GetIncludedFiles(wxT("graph/main.cpp"), false, files);
+    CHECK_SIZE(files.GetCount(), 1);
+
+    files.Clear();
+    db.GetIncludedFiles(wxT("graph/main.cpp"), true, files);
+    CHECK_SIZE(files.GetCount(), 2);
+    CHECK_SIZE(files.Index(baseH), 1);
+
+    // the queried path is normalized the same way as the stored one
+    files.Clear();
+    db.GetDependentFiles(wxT("graph/./sub/../base.h"), false, files);
+    CHECK_SIZE(files.GetCount(), 2);
+
+    files.Clear();
+    db.GetDependentFiles(wxT("graph/base.h"), true, files);
+    CHECK_SIZE(files.GetCount(), 3);
+    CHECK_SIZE(files.Index(mainCpp) != wxNOT_FOUND, 1);
+
+#ifdef __WXMSW__
+    files.Clear();
+    db.GetDependentFiles(wxT("GRAPH/Base.h"), true, files);
+    CHECK_SIZE(files.GetCount(), 3);
+#endif
+
+    wxArrayString deleted;
+    deleted.Add(wxT("graph/app.h"));
+    db.DeleteIncludeGraph(deleted);
+
+    files.Clear();
+    db.GetDependentFiles(wxT("graph/base.h"), true, files);
+    CHECK_SIZE(files.GetCount(), 1);
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
@@ -0,0 +1,12 @@
+// #include "in_cpp_comment.h"
+/* #include "in_c_comment.h"
+   #include "in_c_comment2.h" */
+#include <vector>
+#include "test_crawler_inc.h"
+const char* s = "#include \"in_string.h\"";
+char c = '"';
+#include "after_char_literal.h"
+using namespace std;
+using  namespace wx::detail;
+namespace fs = boost::filesystem;
+#  include   <map>
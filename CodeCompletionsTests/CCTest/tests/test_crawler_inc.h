@@ -0,0 +1,2 @@
+#include "test_crawler.h"
+using namespace inner;
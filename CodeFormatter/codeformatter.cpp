@@ -35,6 +35,7 @@
 #include "codeformatterdlg.h"
 #include "wx/menu.h"
 #include "file_logger.h"
+#include <wx/stc/stc.h>
 
 
 const wxEventType wxEVT_CF_FORMAT_STRING = XRCID("wxEVT_CF_FORMAT_STRING");
@@ -209,6 +210,13 @@ void CodeFormatter::DoFormatFile(IEditor *editor)
         selStart  = editor->PosFromLine(lineNumber);
         selEnd = editor->LineEnd( editor->LineFromPos(selEnd) );
 
+        // Try to format only the selected range, using the preceding lines
+        // as context so AStyle knows the indentation level
+        if ( DoFormatRange(editor, selStart, selEnd, options) ) {
+            NotifyIndentCompleted(editor);
+            return;
+        }
+
         editor->SelectText(selStart, selEnd - selStart);
         inputString = editor->GetSelection();
 
@@ -238,17 +246,243 @@ void CodeFormatter::DoFormatFile(IEditor *editor)
             editor->ReplaceSelection(output);
 
         } else {
-            editor->SetEditorText(output);
-            editor->SetCaretAt(curpos);
+            // Only replace the lines that were actually changed by the formatter.
+            // This keeps the undo history small and avoids re-styling the whole buffer
+            DoReplaceChangedLines(editor, 0, editor->GetLength(), inputString, output);
+            editor->SetCaretAt(wxMin(curpos, (long)editor->GetLength()));
         }
     }
 
+    NotifyIndentCompleted(editor);
+}
+
+void CodeFormatter::NotifyIndentCompleted(IEditor* editor)
+{
     // Notify that a file was indented
     wxCommandEvent evt(wxEVT_CODEFORMATTER_INDENT_COMPLETED);
     evt.SetString( editor->GetFileName().GetFullPath() );
     EventNotifier::Get()->AddPendingEvent( evt );
 }
 
+// Count the braces of a single line, ignoring the ones found in string and
+// character literals and in comments. 'depth' is the change of the brace depth
+// over the line, 'minDepth' the lowest depth reached within the line (<= 0)
+static void CodeFormatterCountBraces(const wxString& text, int& depth, int& minDepth)
+{
+    depth    = 0;
+    minDepth = 0;
+
+    wxChar quote = 0;
+    bool inComment = false;
+    for(size_t i = 0; i < text.Length(); ++i) {
+        wxChar ch   = text.GetChar(i);
+        wxChar next = (i + 1 < text.Length()) ? text.GetChar(i + 1) : wxChar(0);
+
+        if ( inComment ) {
+            if ( ch == wxT('*') && next == wxT('/') ) {
+                inComment = false;
+                ++i;
+            }
+
+        } else if ( quote ) {
+            if ( ch == wxT('\\') ) {
+                ++i;
+            } else if ( ch == quote ) {
+                quote = 0;
+            }
+
+        } else if ( ch == wxT('/') && next == wxT('/') ) {
+            break;
+
+        } else if ( ch == wxT('/') && next == wxT('*') ) {
+            inComment = true;
+            ++i;
+
+        } else if ( ch == wxT('"') || ch == wxT('\'') ) {
+            quote = ch;
+
+        } else if ( ch == wxT('{') ) {
+            ++depth;
+
+        } else if ( ch == wxT('}') ) {
+            --depth;
+            minDepth = wxMin(minDepth, depth);
+        }
+    }
+}
+
+int CodeFormatter::DoFindContextStartLine(IEditor* editor, int line) const
+{
+    // Walk backward until we find a line that starts at column 0 with a token
+    // that is not a preprocessor directive, a comment, a brace or a label.
+    // Such a line is (by convention) a top level declaration which AStyle
+    // can use to establish its indentation state.
+    // The line must also be at the same brace depth as the range or outside
+    // of it: a block that is closed between the line and the range means that
+    // the line belongs to a previous scope (e.g. unindented code in a function)
+    int minLine = wxMax(0, line - CODEFORMATTER_MAX_CONTEXT_LINES);
+
+    // The lowest brace depth reached between the end of the current line and
+    // the range, relative to the end of the current line
+    int minDepthBelow = 0;
+    for(int i = line - 1; i >= minLine; --i) {
+        int lineStart = editor->PosFromLine(i);
+        int lineEnd   = editor->LineEnd(i);
+        if ( lineStart >= lineEnd )
+            continue;
+
+        wxString text = editor->GetTextRange(lineStart, lineEnd);
+        wxString trimmed = text;
+        trimmed.Trim().Trim(false);
+        if ( trimmed.IsEmpty() )
+            continue;
+
+        // A line following a line that ends with a backslash continues a
+        // preprocessor directive (or a string)
+        bool isContinuation = false;
+        if ( i > 0 ) {
+            wxString prevLine = editor->GetTextRange(editor->PosFromLine(i - 1), editor->LineEnd(i - 1));
+            isContinuation = prevLine.Trim().EndsWith(wxT("\\"));
+        }
+
+        bool isPreprocessor = isContinuation || trimmed.StartsWith(wxT("#"));
+        bool isComment      = trimmed.StartsWith(wxT("//")) || trimmed.StartsWith(wxT("/*")) || trimmed.StartsWith(wxT("*"));
+        if ( isPreprocessor || isComment )
+            continue;
+
+        int depth, minDepth;
+        CodeFormatterCountBraces(text, depth, minDepth);
+        minDepthBelow = wxMin(minDepth, depth + minDepthBelow);
+
+        wxChar ch = text.GetChar(0);
+        if ( ch == wxT(' ') || ch == wxT('\t') || ch == wxT('}') || ch == wxT('{') )
+            continue;
+
+        // Labels, access specifiers and case labels
+        if ( trimmed.EndsWith(wxT(":")) && !trimmed.EndsWith(wxT("::")) )
+            continue;
+
+        if ( minDepthBelow < 0 )
+            continue;
+
+        return i;
+    }
+    return wxNOT_FOUND;
+}
+
+bool CodeFormatter::DoFormatRange(IEditor* editor, int startPos, int endPos, const wxString& options)
+{
+    int startLine    = editor->LineFromPos(startPos);
+    int contextLine  = DoFindContextStartLine(editor, startLine);
+    if ( contextLine == wxNOT_FOUND )
+        return false;
+
+    // Place a marker comment between the context and the range so we can
+    // locate the formatted range in the AStyle output
+    static const wxString RANGE_MARKER = wxT("//__CODEFORMATTER_RANGE_BEGIN__");
+
+    wxString eol;
+    if ( editor->GetEOL() == 0 ) {// CRLF
+        eol = wxT("\r\n");
+    } else if ( editor->GetEOL() == 1 ) { // CR
+        eol = wxT("\r");
+    } else {
+        eol = wxT("\n");
+    }
+
+    wxString context = editor->GetTextRange(editor->PosFromLine(contextLine), startPos);
+    wxString range   = editor->GetTextRange(startPos, endPos);
+    if ( range.Contains(RANGE_MARKER) || context.Contains(RANGE_MARKER) )
+        return false;
+
+    wxString input;
+    input << context << RANGE_MARKER << eol << range;
+
+    wxString output;
+    AstyleFormat(input, options, output);
+    if ( output.IsEmpty() )
+        return false;
+
+    int where = output.Find(RANGE_MARKER);
+    if ( where == wxNOT_FOUND )
+        return false;
+
+    // Skip the marker line
+    output = output.Mid(where + RANGE_MARKER.length());
+    if ( output.StartsWith(wxT("\r\n")) ) {
+        output.Remove(0, 2);
+    } else if ( output.StartsWith(wxT("\n")) || output.StartsWith(wxT("\r")) ) {
+        output.Remove(0, 1);
+    }
+
+    // AStyle trims the trailing whitespace; keep the original range terminator
+    wxString trimmedRange = range;
+    trimmedRange.Trim();
+    output.Trim();
+    output << range.Mid(trimmedRange.Length());
+
+    DoReplaceChangedLines(editor, startPos, endPos, range, output);
+    return true;
+}
+
+void CodeFormatter::DoReplaceChangedLines(IEditor* editor, int startPos, int endPos, const wxString& oldText, const wxString& newText)
+{
+    wxStyledTextCtrl* stc = editor->GetSTC();
+    if ( !stc )
+        return;
+
+    if ( oldText == newText )
+        return;
+
+    // Split both buffers into lines (keeping the EOL) and skip the common
+    // leading and trailing lines. Only the lines in between are replaced
+    wxArrayString oldLines = DoSplitLines(oldText);
+    wxArrayString newLines = DoSplitLines(newText);
+
+    size_t prefix = 0;
+    while ( prefix < oldLines.GetCount() && prefix < newLines.GetCount() && oldLines.Item(prefix) == newLines.Item(prefix) ) {
+        ++prefix;
+    }
+
+    size_t suffix = 0;
+    while ( suffix < (oldLines.GetCount() - prefix) && suffix < (newLines.GetCount() - prefix) &&
+            oldLines.Item(oldLines.GetCount() - suffix - 1) == newLines.Item(newLines.GetCount() - suffix - 1) ) {
+        ++suffix;
+    }
+
+    int startLine    = editor->LineFromPos(startPos);
+    int replaceStart = editor->PosFromLine(startLine + prefix);
+    int replaceEnd   = suffix ? editor->PosFromLine(startLine + oldLines.GetCount() - suffix) : endPos;
+
+    wxString replacement;
+    for(size_t i = prefix; i < newLines.GetCount() - suffix; ++i) {
+        replacement << newLines.Item(i);
+    }
+
+    stc->BeginUndoAction();
+    stc->SetTargetStart(replaceStart);
+    stc->SetTargetEnd(replaceEnd);
+    stc->ReplaceTarget(replacement);
+    stc->EndUndoAction();
+}
+
+wxArrayString CodeFormatter::DoSplitLines(const wxString& text) const
+{
+    wxArrayString lines;
+    size_t lineStart = 0;
+    for(size_t i = 0; i < text.Length(); ++i) {
+        if ( text.GetChar(i) == wxT('\n') ) {
+            lines.Add(text.Mid(lineStart, i - lineStart + 1));
+            lineStart = i + 1;
+        }
+    }
+
+    if ( lineStart < text.Length() ) {
+        lines.Add(text.Mid(lineStart));
+    }
+    return lines;
+}
+
 void CodeFormatter::AstyleFormat(const wxString &input, const wxString &options, wxString &output)
 {
     char *textOut = AStyleMain(_C(input), _C(options), ASErrorHandler, ASMemoryAlloc);
@@ -27,6 +27,10 @@
 
 #include "plugin.h"
 
+// Maximum number of lines to scan backward when looking for the
+// context required to format a range of lines
+#define CODEFORMATTER_MAX_CONTEXT_LINES 2000
+
 class CodeFormatter : public IPlugin
 {
 protected:
@@ -34,6 +38,13 @@ protected:
     int DoGetGlobalEOL() const;
     wxString DoGetGlobalEOLString() const;
 
+    // Range formatting
+    bool DoFormatRange(IEditor *editor, int startPos, int endPos, const wxString &options);
+    int  DoFindContextStartLine(IEditor *editor, int line) const;
+    void DoReplaceChangedLines(IEditor *editor, int startPos, int endPos, const wxString &oldText, const wxString &newText);
+    wxArrayString DoSplitLines(const wxString &text) const;
+    void NotifyIndentCompleted(IEditor *editor);
+
 public:
     CodeFormatter(IManager *manager);
     virtual ~CodeFormatter();
@@ -0,0 +1,121 @@
+#include <map>
+#include <string>
+#include <vector>
+#include "cl_parser_state.h"
+#include "code_completion_api.h"
+#include <stddef.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace
+{
+
+// A thread local slot, holding a clParserState pointer. When 'owner' is set,
+// the slot owns the state and deletes it when the thread exits (on Windows
+// there is no such notification and the state of an exiting thread is leaked,
+// the threads that parse live as long as the application does)
+class clParserStateSlot
+{
+#ifdef _WIN32
+	DWORD m_index;
+public:
+	clParserStateSlot(bool /*owner*/) { m_index = TlsAlloc(); }
+	clParserState* Get() const      { return (clParserState*)TlsGetValue(m_index); }
+	void Set(clParserState* state)  { TlsSetValue(m_index, state); }
+#else
+	pthread_key_t m_key;
+
+	static void DeleteState(void* state) {
+		delete (clParserState*)state;
+	}
+
+public:
+	clParserStateSlot(bool owner)   { pthread_key_create(&m_key, owner ? &DeleteState : NULL); }
+	clParserState* Get() const      { return (clParserState*)pthread_getspecific(m_key); }
+	void Set(clParserState* state)  { pthread_setspecific(m_key, state); }
+#endif
+};
+
+// The state installed by clParserStateScope
+clParserStateSlot s_currentState(false);
+
+// The thread's own state
+clParserStateSlot s_threadState(true);
+
+}
+
+clParserState::clParserState()
+{
+	for (int i=0; i<kModuleCount; i++) {
+		m_modules[i] = NULL;
+	}
+}
+
+clParserState::~clParserState()
+{
+	for (int i=0; i<kModuleCount; i++) {
+		delete m_modules[i];
+	}
+}
+
+clParserState* clParserState::Current()
+{
+	clParserState* state = s_currentState.Get();
+	if ( state ) {
+		return state;
+	}
+
+	state = s_threadState.Get();
+	if ( !state ) {
+		state = new clParserState();
+		s_threadState.Set(state);
+	}
+	return state;
+}
+
+clParserState* clParserState::SetCurrent(clParserState* state)
+{
+	clParserState* previous = s_currentState.Get();
+	s_currentState.Set(state);
+	return previous;
+}
+
+std::string get_scope_name(clParserState& state, const std::string& in, std::vector<std::string>& additionlNS, const std::map<std::string, std::string>& ignoreTokens)
+{
+	clParserStateScope scope(state);
+	return get_scope_name(in, additionlNS, ignoreTokens);
+}
+
+void get_variables(clParserState& state, const std::string& in, VariableList& li, const std::map<std::string, std::string>& ignoreMap, bool isUsedWithinFunc)
+{
+	clParserStateScope scope(state);
+	get_variables(in, li, ignoreMap, isUsedWithinFunc);
+}
+
+bool is_primitive_type(clParserState& state, const std::string& in)
+{
+	clParserStateScope scope(state);
+	return is_primitive_type(in);
+}
+
+void get_functions(clParserState& state, const std::string& in, FunctionList& li, const std::map<std::string, std::string>& ignoreTokens)
+{
+	clParserStateScope scope(state);
+	get_functions(in, li, ignoreTokens);
+}
+
+void get_typedefs(clParserState& state, const std::string& in, clTypedefList& li)
+{
+	clParserStateScope scope(state);
+	get_typedefs(in, li);
+}
+
+ExpressionResult& parse_expression(clParserState& state, const std::string& in)
+{
+	clParserStateScope scope(state);
+	return parse_expression(in);
+}
@@ -0,0 +1,104 @@
+#ifndef CL_PARSER_STATE_H
+#define CL_PARSER_STATE_H
+
+#ifndef WXDLLIMPEXP_CL
+
+#ifdef WXMAKINGDLL_CL
+#    define WXDLLIMPEXP_CL __declspec(dllexport)
+#elif defined(WXUSINGDLL_CL)
+#    define WXDLLIMPEXP_CL __declspec(dllimport)
+#else // not making nor using DLL
+#    define WXDLLIMPEXP_CL
+#endif
+
+#endif
+
+/**
+ * @class clParserStateModule
+ * @brief base class for the state of a single generated lexer or parser
+ */
+class WXDLLIMPEXP_CL clParserStateModule
+{
+public:
+    clParserStateModule() {}
+    virtual ~clParserStateModule() {}
+};
+
+/**
+ * @class clParserState
+ * @brief the state of the generated lexers and parsers: the scope lexer and the
+ * scope, variable, function and typedef parsers, plus the expression lexer and parser.
+ *
+ * The generated code no longer keeps its state in global variables, it uses the
+ * state object that is current for the calling thread instead. Unless a caller
+ * installs its own state (see clParserStateScope), every thread gets a state
+ * of its own, so the parsers can run on several threads at the same time
+ */
+class WXDLLIMPEXP_CL clParserState
+{
+public:
+    enum eModule {
+        kScopeLexer = 0,
+        kExprLexer,
+        kScopeParser,
+        kVarParser,
+        kFuncParser,
+        kTypedefParser,
+        kExprParser,
+        kModuleCount
+    };
+
+protected:
+    clParserStateModule* m_modules[kModuleCount];
+
+private:
+    clParserState(const clParserState&);
+    clParserState& operator=(const clParserState&);
+
+public:
+    clParserState();
+    virtual ~clParserState();
+
+    /**
+     * @brief return the state used by the calling thread
+     */
+    static clParserState* Current();
+
+    /**
+     * @brief make 'state' the state of the calling thread. Passing NULL restores the
+     * thread's own state
+     * @return the previously installed state (NULL if the thread's own state was used)
+     */
+    static clParserState* SetCurrent(clParserState* state);
+
+    /**
+     * @brief return the state of a single lexer/parser, allocate it on first use
+     */
+    template <typename T>
+    T* GetModule(eModule module) {
+        if ( !m_modules[module] ) {
+            m_modules[module] = new T();
+        }
+        return static_cast<T*>(m_modules[module]);
+    }
+};
+
+/**
+ * @class clParserStateScope
+ * @brief install a parser state for the lifetime of this object
+ */
+class WXDLLIMPEXP_CL clParserStateScope
+{
+    clParserState* m_previous;
+
+public:
+    clParserStateScope(clParserState& state)
+        : m_previous( clParserState::SetCurrent(&state) )
+    {}
+
+    ~clParserStateScope() {
+        clParserState::SetCurrent(m_previous);
+    }
+};
+
+#endif // CL_PARSER_STATE_H
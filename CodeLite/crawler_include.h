@@ -4,6 +4,16 @@
 #include <vector>
 #include "fc_fileopener.h"
 
+/**
+ * @brief scan 'filePath' using the global context (fcFileOpener::Instance())
+ */
 extern WXDLLIMPEXP_CL int crawlerScan        ( const char* filePath );
 
+/**
+ * @brief a reentrant version of crawlerScan(): the search paths, the results and the
+ * scan state are kept in 'context' (and on the stack), so different files can be scanned
+ * concurrently, each with its own context
+ */
+extern WXDLLIMPEXP_CL int crawlerScan        ( const char* filePath, fcFileOpener* context );
+
 #endif
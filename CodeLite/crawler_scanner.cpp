@@ -0,0 +1,347 @@
+// A reentrant implementation of the include crawler.
+// It replaces the flex generated scanner (crawler.l) and follows the same rules,
+// but keeps all of its state on the stack and in the fcFileOpener passed by the
+// caller, so several files can be scanned at the same time from different threads
+
+#include "crawler_include.h"
+#include <string>
+#include <vector>
+#include <string.h>
+
+namespace
+{
+
+enum fcScanState {
+    kStateInitial,
+    kStateInclude,
+    kStateCComment,
+    kStateCppComment,
+    kStateUsingNamespace
+};
+
+struct fcBuffer {
+    std::string content;
+    std::string fileName; // only set when the include graph is collected
+    size_t      pos;
+
+    fcBuffer() : pos(0) {}
+};
+
+void fcReadFile(FILE* fp, std::string& content)
+{
+    char buf[8192];
+    size_t bytes = 0;
+    while ( (bytes = fread(buf, 1, sizeof(buf), fp)) > 0 ) {
+        content.append(buf, bytes);
+    }
+    fclose(fp);
+}
+
+inline bool fcIsAlpha(char ch)
+{
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+}
+
+inline bool fcIsNsChar(char ch)
+{
+    return fcIsAlpha(ch) || ch == ':' || ch == '_';
+}
+
+inline bool fcIsHex(char ch)
+{
+    return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+}
+
+inline bool fcMatchLiteral(const std::string& s, size_t pos, const char* literal)
+{
+    size_t len = strlen(literal);
+    return s.compare(pos, len, literal) == 0;
+}
+
+// ns_name: [a-zA-Z][a-zA-Z:_]*
+// Return the position after the name, or std::string::npos
+size_t fcMatchNsName(const std::string& s, size_t pos)
+{
+    if ( pos >= s.length() || !fcIsAlpha(s[pos]) )
+        return std::string::npos;
+
+    ++pos;
+    while ( pos < s.length() && fcIsNsChar(s[pos]) )
+        ++pos;
+    return pos;
+}
+
+size_t fcSkipSpaces(const std::string& s, size_t pos)
+{
+    while ( pos < s.length() && s[pos] == ' ' )
+        ++pos;
+    return pos;
+}
+
+// escape_sequence: [\\]({simple_escape}|{octal_escape}|{hex_escape})
+size_t fcMatchEscape(const std::string& s, size_t pos)
+{
+    if ( pos + 1 >= s.length() )
+        return std::string::npos;
+
+    char ch = s[pos + 1];
+    if ( strchr("abfnrtv'\"?\\", ch) ) {
+        return pos + 2;
+
+    } else if ( ch >= '0' && ch <= '7' ) {
+        size_t end = pos + 1;
+        while ( end < s.length() && end < pos + 4 && s[end] >= '0' && s[end] <= '7' )
+            ++end;
+        return end;
+
+    } else if ( ch == 'x' && pos + 2 < s.length() && fcIsHex(s[pos + 2]) ) {
+        size_t end = pos + 2;
+        while ( end < s.length() && fcIsHex(s[end]) )
+            ++end;
+        return end;
+    }
+    return std::string::npos;
+}
+
+// "L"?[']{c_char}+[']  and  "L"?["]{s_char}*["]
+size_t fcMatchQuoted(const std::string& s, size_t pos)
+{
+    if ( s[pos] == 'L' )
+        ++pos;
+
+    if ( pos >= s.length() || (s[pos] != '\'' && s[pos] != '"') )
+        return std::string::npos;
+
+    char quote = s[pos];
+    size_t count = 0;
+    size_t cur = pos + 1;
+    while ( cur < s.length() ) {
+        char ch = s[cur];
+        if ( ch == quote ) {
+            if ( quote == '\'' && count == 0 )
+                return std::string::npos;
+            return cur + 1;
+
+        } else if ( ch == '\n' ) {
+            return std::string::npos;
+
+        } else if ( ch == '\\' ) {
+            cur = fcMatchEscape(s, cur);
+            if ( cur == std::string::npos )
+                return std::string::npos;
+
+        } else {
+            ++cur;
+        }
+        ++count;
+    }
+    return std::string::npos;
+}
+
+// "using "[ ]*"namespace"
+size_t fcMatchUsingNamespace(const std::string& s, size_t pos)
+{
+    if ( !fcMatchLiteral(s, pos, "using ") )
+        return std::string::npos;
+
+    pos = fcSkipSpaces(s, pos + 6);
+    if ( !fcMatchLiteral(s, pos, "namespace") )
+        return std::string::npos;
+    return pos + 9;
+}
+
+// "namespace "{ns_name}[ ]*"="[ ]*{ns_name}[ ]*";"
+size_t fcMatchNamespaceAlias(const std::string& s, size_t pos)
+{
+    if ( !fcMatchLiteral(s, pos, "namespace ") )
+        return std::string::npos;
+
+    pos = fcMatchNsName(s, pos + 10);
+    if ( pos == std::string::npos )
+        return std::string::npos;
+
+    pos = fcSkipSpaces(s, pos);
+    if ( pos >= s.length() || s[pos] != '=' )
+        return std::string::npos;
+
+    pos = fcMatchNsName(s, fcSkipSpaces(s, pos + 1));
+    if ( pos == std::string::npos )
+        return std::string::npos;
+
+    pos = fcSkipSpaces(s, pos);
+    if ( pos >= s.length() || s[pos] != ';' )
+        return std::string::npos;
+    return pos + 1;
+}
+
+// ["<][^ \t\n]+[">] - the longest match wins
+size_t fcMatchIncludeName(const std::string& s, size_t pos)
+{
+    if ( s[pos] != '"' && s[pos] != '<' )
+        return std::string::npos;
+
+    size_t end = std::string::npos;
+    for ( size_t cur = pos + 1; cur < s.length(); ++cur ) {
+        char ch = s[cur];
+        if ( ch == ' ' || ch == '\t' || ch == '\n' )
+            break;
+
+        if ( (ch == '"' || ch == '>') && cur > pos + 1 )
+            end = cur + 1;
+    }
+    return end;
+}
+
+} // namespace
+
+int crawlerScan( const char* filePath, fcFileOpener* context )
+{
+    FILE* fp = fopen(filePath, "r");
+    if ( fp == NULL ) {
+        // failed to open input file...
+        return -1;
+    }
+
+    std::vector<fcBuffer*> includeStack;
+    includeStack.push_back( new fcBuffer() );
+    fcReadFile(fp, includeStack.back()->content);
+    if ( context->IsCollectIncludeGraph() ) {
+        includeStack.back()->fileName = filePath;
+        context->AddIncludeEdge(filePath, "");
+    }
+
+    fcScanState state = kStateInitial;
+    while ( !includeStack.empty() ) {
+
+        fcBuffer* buffer = includeStack.back();
+        const std::string& s = buffer->content;
+        size_t& pos = buffer->pos;
+
+        if ( pos >= s.length() ) {
+            // <<EOF>>
+            delete buffer;
+            includeStack.pop_back();
+            if ( !includeStack.empty() ) {
+                // reduce the current depth
+                context->decDepth();
+            }
+            continue;
+        }
+
+        char ch = s[pos];
+        size_t end = std::string::npos;
+        switch ( state ) {
+        case kStateCppComment:
+            if ( ch == '\n' )
+                state = kStateInitial;
+            ++pos;
+            break;
+
+        case kStateCComment:
+            if ( fcMatchLiteral(s, pos, "*/") ) {
+                state = kStateInitial;
+                pos += 2;
+
+            } else {
+                ++pos;
+            }
+            break;
+
+        case kStateUsingNamespace:
+            end = fcMatchNsName(s, pos);
+            if ( end != std::string::npos ) {
+                // got the namespace
+                context->AddNamespace( s.substr(pos, end - pos).c_str() );
+                state = kStateInitial;
+                pos = end;
+
+            } else {
+                if ( ch == ';' )
+                    state = kStateInitial;
+                ++pos;
+            }
+            break;
+
+        case kStateInclude:
+            end = fcMatchIncludeName(s, pos);
+            if ( end != std::string::npos ) {
+                // got the include file name
+                std::string includeName = s.substr(pos, end - pos);
+                pos   = end;
+                state = kStateInitial;
+
+                // keep the include statement
+                context->AddIncludeStatement( includeName );
+
+                // record the edge even if the included file was already scanned
+                std::string fullpath;
+                if ( context->IsCollectIncludeGraph() ) {
+                    fullpath = context->ResolveInclude( includeName );
+                    if ( !fullpath.empty() ) {
+                        context->AddIncludeEdge(buffer->fileName, fullpath);
+                    }
+                }
+
+                FILE* newFile = NULL;
+                if ( context->getDepth() < context->getMaxDepth() ) {
+                    newFile = context->OpenFile( includeName );
+                }
+
+                if ( newFile ) {
+                    // since we are moving into another file, increase the current depth by 1
+                    fcBuffer* newBuffer = new fcBuffer();
+                    fcReadFile(newFile, newBuffer->content);
+                    if ( context->IsCollectIncludeGraph() ) {
+                        newBuffer->fileName = fullpath;
+                        context->AddIncludeEdge(fullpath, "");
+                    }
+                    includeStack.push_back( newBuffer );
+                    context->incDepth();
+                }
+
+            } else {
+                if ( ch == '\n' )
+                    state = kStateInitial;
+                ++pos;
+            }
+            break;
+
+        case kStateInitial:
+        default:
+            if ( fcMatchLiteral(s, pos, "//") ) {
+                state = kStateCppComment;
+                pos += 2;
+
+            } else if ( fcMatchLiteral(s, pos, "/*") ) {
+                state = kStateCComment;
+                pos += 2;
+
+            } else if ( (ch == '\'' || ch == '"' || ch == 'L') && (end = fcMatchQuoted(s, pos)) != std::string::npos ) {
+                // eat a string
+                pos = end;
+
+            } else if ( ch == 'u' && (end = fcMatchUsingNamespace(s, pos)) != std::string::npos ) {
+                state = kStateUsingNamespace;
+                pos = end;
+
+            } else if ( ch == 'n' && (end = fcMatchNamespaceAlias(s, pos)) != std::string::npos ) {
+                context->AddNamespaceAlias( s.substr(pos, end - pos).c_str() );
+                pos = end;
+
+            } else if ( ch == 'i' && fcMatchLiteral(s, pos, "include") ) {
+                state = kStateInclude;
+                pos += 7;
+
+            } else {
+                ++pos;
+            }
+            break;
+        }
+    }
+    return 0;
+}
+
+int crawlerScan( const char* filePath )
+{
+    return crawlerScan( filePath, fcFileOpener::Instance() );
+}
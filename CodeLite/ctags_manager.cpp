@@ -1842,6 +1842,20 @@ void TagsManager::GetFiles(const wxString &partialName, std::vector<wxFileName>
     }
 }
 
+void TagsManager::GetIncludedFiles(const wxFileName &fileName, bool transitive, wxArrayString &files)
+{
+    if (GetDatabase()) {
+        GetDatabase()->GetIncludedFiles(fileName.GetFullPath(), transitive, files);
+    }
+}
+
+void TagsManager::GetDependentFiles(const wxFileName &fileName, bool transitive, wxArrayString &files)
+{
+    if (GetDatabase()) {
+        GetDatabase()->GetDependentFiles(fileName.GetFullPath(), transitive, files);
+    }
+}
+
 TagEntryPtr TagsManager::FunctionFromFileLine(const wxFileName &fileName, int lineno, bool nextFunction /*false*/)
 {
     if (!GetDatabase()) {
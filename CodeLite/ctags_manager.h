@@ -139,9 +139,6 @@ public:
         Retag_Quick_No_Scan
     };
 
-public:
-    wxCriticalSection      m_crawlerLocker;
-
 private:
     wxFileName                    m_codeliteIndexerPath;
     IProcess*                     m_codeliteIndexerProcess;
@@ -514,6 +511,22 @@ public:
     void GetFiles(const wxString &partialName, std::vector<FileEntryPtr> &files);
     void GetFiles(const wxString &partialName, std::vector<wxFileName> &files);
 
+    /**
+     * return the files included by 'fileName', as recorded by the include crawler
+     * @param fileName file, in absolute path
+     * @param transitive include the files included indirectly
+     * @param files [output] array of files
+     */
+    void GetIncludedFiles(const wxFileName &fileName, bool transitive, wxArrayString &files);
+
+    /**
+     * return the files that include 'fileName' (directly or, when 'transitive' is set,
+     * through other headers). These are the files affected by a change to 'fileName'
+     * @param fileName file, in absolute path
+     * @param files [output] array of files
+     */
+    void GetDependentFiles(const wxFileName &fileName, bool transitive, wxArrayString &files);
+
     /**
      * Return function that is close to current line number and matches
      * file name
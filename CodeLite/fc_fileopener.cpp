@@ -2,12 +2,187 @@
 #include <cstdio>
 #include <cctype>
 #include <algorithm>
+#include <map>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <pthread.h>
+#endif
+
+//----------------------------------------------------------------------------
+// The include resolution cache.
+// Resolving an include used to probe every search path with fopen(). Instead,
+// we keep the listing of every directory we looked into and a table of
+// resolved includes. Both are shared by all the fcFileOpener instances (so
+// they are thread safe) and kept for the whole session
+//----------------------------------------------------------------------------
+
+// How often (in seconds) the cached directories are checked for modifications
+#define FC_CACHE_CHECK_INTERVAL 2
+
+namespace
+{
+
+class fcLock
+{
+#ifdef _WIN32
+	CRITICAL_SECTION m_cs;
+public:
+	fcLock()       { InitializeCriticalSection(&m_cs); }
+	~fcLock()      { DeleteCriticalSection(&m_cs);     }
+	void Lock()    { EnterCriticalSection(&m_cs);      }
+	void Unlock()  { LeaveCriticalSection(&m_cs);      }
+#else
+	pthread_mutex_t m_mutex;
+public:
+	fcLock()       { pthread_mutex_init(&m_mutex, NULL); }
+	~fcLock()      { pthread_mutex_destroy(&m_mutex);    }
+	void Lock()    { pthread_mutex_lock(&m_mutex);       }
+	void Unlock()  { pthread_mutex_unlock(&m_mutex);     }
+#endif
+};
+
+class fcLocker
+{
+	fcLock& m_lock;
+public:
+	fcLocker(fcLock& lock) : m_lock(lock) { m_lock.Lock();   }
+	~fcLocker()                           { m_lock.Unlock(); }
+};
+
+struct fcDirListing {
+	std::set<std::string> entries;
+	time_t                mtime;
+
+	fcDirListing() : mtime(0) {}
+};
+
+class fcIncludeCache
+{
+	typedef std::map<std::string, fcDirListing> DirMap_t;
+	typedef std::map<std::string, std::string>  ResolvedMap_t;
+
+	fcLock        m_lock;
+	DirMap_t      m_dirs;
+	ResolvedMap_t m_resolved;   // paths key + include name -> full path ("" if not found)
+	time_t        m_lastCheck;
+
+protected:
+	static time_t DoGetModificationTime(const std::string& dir) {
+		struct stat buff;
+		if ( stat(dir.c_str(), &buff) != 0 )
+			return 0;
+		return buff.st_mtime;
+	}
+
+	static void DoListDir(const std::string& dir, fcDirListing& listing) {
+		listing.entries.clear();
+		listing.mtime = DoGetModificationTime(dir);
+#ifdef _WIN32
+		WIN32_FIND_DATAA data;
+		std::string pattern = dir + "/*";
+		HANDLE h = FindFirstFileA(pattern.c_str(), &data);
+		if ( h == INVALID_HANDLE_VALUE )
+			return;
+		do {
+			std::string name = data.cFileName;
+			std::transform(name.begin(), name.end(), name.begin(), tolower);
+			listing.entries.insert(name);
+		} while ( FindNextFileA(h, &data) );
+		FindClose(h);
+#else
+		DIR* d = opendir(dir.c_str());
+		if ( !d )
+			return;
+		struct dirent* entry = NULL;
+		while ( (entry = readdir(d)) != NULL ) {
+			listing.entries.insert(entry->d_name);
+		}
+		closedir(d);
+#endif
+	}
+
+	// Re-list the directories that were modified since we listed them.
+	// Must be called with the lock held
+	void DoCheckForChanges() {
+		time_t now = time(NULL);
+		if ( now - m_lastCheck < FC_CACHE_CHECK_INTERVAL )
+			return;
+		m_lastCheck = now;
+
+		bool changed = false;
+		DirMap_t::iterator iter = m_dirs.begin();
+		for ( ; iter != m_dirs.end(); ++iter ) {
+			if ( DoGetModificationTime(iter->first) != iter->second.mtime ) {
+				DoListDir(iter->first, iter->second);
+				changed = true;
+			}
+		}
+
+		if ( changed ) {
+			// A header was added or removed, resolve everything again
+			m_resolved.clear();
+		}
+	}
+
+public:
+	fcIncludeCache() : m_lastCheck(time(NULL)) {}
+
+	bool FindResolved(const std::string& key, std::string& fullpath) {
+		fcLocker locker(m_lock);
+		DoCheckForChanges();
+		ResolvedMap_t::const_iterator iter = m_resolved.find(key);
+		if ( iter == m_resolved.end() )
+			return false;
+		fullpath = iter->second;
+		return true;
+	}
+
+	void SetResolved(const std::string& key, const std::string& fullpath) {
+		fcLocker locker(m_lock);
+		m_resolved[key] = fullpath;
+	}
+
+	/**
+	 * @brief return true if 'fullpath' exists. 'fullpath' is a normalized path
+	 */
+	bool Exists(const std::string& fullpath) {
+		size_t where = fullpath.rfind('/');
+		if ( where == std::string::npos || where == fullpath.length() - 1 )
+			return false;
+
+		std::string dir  = fullpath.substr(0, where);
+		std::string name = fullpath.substr(where + 1);
+		if ( dir.empty() || dir.at(dir.length() - 1) == ':' ) {
+			// the root folder
+			dir += "/";
+		}
+
+		fcLocker locker(m_lock);
+		DirMap_t::iterator iter = m_dirs.find(dir);
+		if ( iter == m_dirs.end() ) {
+			iter = m_dirs.insert(std::make_pair(dir, fcDirListing())).first;
+			DoListDir(dir, iter->second);
+		}
+		return iter->second.entries.count(name) != 0;
+	}
+};
+
+fcIncludeCache s_includeCache;
+
+} // namespace
 
 fcFileOpener* fcFileOpener::ms_instance = 0;
 
 fcFileOpener::fcFileOpener()
 		: _depth(0)
 		, _maxDepth(20)
+		, _collectGraph(false)
 {
 }
 
@@ -40,6 +215,7 @@ void fcFileOpener::AddSearchPath(const std::string& path)
 	}
 
 	_searchPath.push_back( p );
+	_pathsKey.clear();
 }
 
 bool fcFileOpener::IsPathExist(const std::string& path)
@@ -62,33 +238,109 @@ bool fcFileOpener::IsExcludePathExist(const std::string& path)
 	return false;
 }
 
+static std::string fcTrimInclude(const std::string& include_path)
+{
+	static std::string trimString("\"<> \t");
+
+	std::string mod_path ( include_path );
+	mod_path.erase(0, mod_path.find_first_not_of(trimString));
+	mod_path.erase(mod_path.find_last_not_of    (trimString)+1);
+	return mod_path;
+}
+
 FILE* fcFileOpener::OpenFile(const std::string& include_path)
 {
 	if ( include_path.empty() ) {
 		return NULL;
 	}
 
-	std::string mod_path ( include_path );
-	static std::string trimString("\"<> \t");
-
-	mod_path.erase(0, mod_path.find_first_not_of(trimString));
-	mod_path.erase(mod_path.find_last_not_of    (trimString)+1);
+	std::string mod_path = fcTrimInclude( include_path );
 
 	if ( _scannedfiles.find(mod_path) != _scannedfiles.end() ) {
 		// we already scanned this file
 		return NULL;
 	}
+	_scannedfiles.insert( mod_path );
+
+	std::string fullpath = Resolve( mod_path );
+	if ( fullpath.empty() ) {
+		return NULL;
+	}
 
-	// try to open the file as is
-	FILE *fp (NULL);
+	FILE *fp = fopen(fullpath.c_str(), "r" );
+	if ( fp ) {
+		_matchedfiles.insert( fullpath );
+	}
+	return fp;
+}
 
-	// try to prepend the search paths
+std::string fcFileOpener::ResolveInclude(const std::string& include_path)
+{
+	std::string mod_path = fcTrimInclude( include_path );
+	if ( mod_path.empty() ) {
+		return "";
+	}
+	return Resolve( mod_path );
+}
+
+void fcFileOpener::AddIncludeEdge(const std::string& file, const std::string& included)
+{
+	Set_t& includes = _includeGraph[file];
+	if ( !included.empty() ) {
+		includes.insert( included );
+	}
+}
+
+std::string fcFileOpener::Resolve(const std::string& name)
+{
+	std::string key = GetPathsKey() + "\n" + name;
+	std::string fullpath;
+	if ( s_includeCache.FindResolved(key, fullpath) ) {
+		return fullpath;
+	}
+
+	// Use the first search path that contains the file,
+	// unless it is located inside an excluded directory
+	fullpath.clear();
 	for (size_t i=0; i<_searchPath.size(); i++) {
-		fp = try_open(_searchPath.at(i), mod_path);
-		if ( fp ) return fp;
+		std::string candidate ( _searchPath.at(i) + "/" + name );
+		normalize_path( candidate );
+		if ( s_includeCache.Exists(candidate) && !IsExcluded(candidate) ) {
+			fullpath = candidate;
+			break;
+		}
 	}
-	_scannedfiles.insert( mod_path );
-	return NULL;
+
+	s_includeCache.SetResolved(key, fullpath);
+	return fullpath;
+}
+
+const std::string& fcFileOpener::GetPathsKey()
+{
+	if ( _pathsKey.empty() ) {
+		_pathsKey = "S:";
+		for (size_t i=0; i<_searchPath.size(); i++) {
+			_pathsKey += _searchPath.at(i) + ";";
+		}
+		_pathsKey += "E:";
+		for (size_t i=0; i<_excludePaths.size(); i++) {
+			_pathsKey += _excludePaths.at(i) + ";";
+		}
+	}
+	return _pathsKey;
+}
+
+bool fcFileOpener::IsExcluded(const std::string& fullpath) const
+{
+	std::string p = extract_path(fullpath);
+	for(size_t i=0; i<_excludePaths.size(); i++) {
+		size_t where = p.find(_excludePaths.at(i));
+		if(where != std::string::npos && where == 0) {
+			// the matched file is locatd inside an excluded directory
+			return true;
+		}
+	}
+	return false;
 }
 
 std::string fcFileOpener::extract_path(const std::string &filePath)
@@ -105,31 +357,6 @@ std::string fcFileOpener::extract_path(const std::string &filePath)
 	return p;
 }
 
-FILE* fcFileOpener::try_open(const std::string &path, const std::string &name)
-{
-	std::string fullpath ( path + "/" + name );
-	normalize_path( fullpath );
-
-	FILE *fp = fopen(fullpath.c_str(), "r" );
-	if ( fp ) {
-		_scannedfiles.insert( name );
-		std::string p = extract_path(fullpath);
-
-		for(size_t i=0; i<_excludePaths.size(); i++){
-			size_t where = p.find(_excludePaths.at(i));
-			if(where != std::string::npos && where == 0) {
-				// the matched file is locatd inside an excluded directory
-				fclose ( fp );
-				return NULL;
-			}
-		}
-
-		_matchedfiles.insert( fullpath );
-		return fp;
-	}
-	return NULL;
-}
-
 void fcFileOpener::AddExcludePath(const std::string& path)
 {
 	std::string normalizedPath ( path );
@@ -139,6 +366,7 @@ void fcFileOpener::AddExcludePath(const std::string& path)
 		return;
 	}
 	_excludePaths.push_back(normalizedPath);
+	_pathsKey.clear();
 }
 
 void fcFileOpener::normalize_path(std::string& path)
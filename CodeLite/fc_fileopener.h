@@ -6,6 +6,7 @@
 #include <set>
 #include <stdio.h>
 #include <list>
+#include <map>
 
 #ifndef WXDLLIMPEXP_CL
 
@@ -25,6 +26,7 @@ public:
     typedef std::list<std::string>   List_t;
     typedef std::set<std::string>    Set_t;
     typedef std::vector<std::string> Vector_t;
+    typedef std::map<std::string, Set_t> Graph_t; // file -> the files it includes
 
 protected:
     static fcFileOpener* ms_instance       ;
@@ -38,35 +40,57 @@ protected:
     Set_t    _namespaces       ;
     Set_t    _namespaceAliases ;
     List_t   _includeStatements;
+    std::string _pathsKey      ; // identifies the search and exclude paths in the include cache
+    bool     _collectGraph     ;
+    Graph_t  _includeGraph     ;
 
 private:
     bool IsPathExist(const std::string &path);
     bool IsExcludePathExist(const std::string &path);
     static void normalize_path( std::string &path );
-    FILE *try_open(const std::string &path, const std::string &name);
+    bool IsExcluded(const std::string &fullpath) const;
+    std::string Resolve(const std::string &name);
+    const std::string& GetPathsKey();
 
 public:
+    /**
+     * @brief the global instance, used by the non reentrant crawlerScan(const char*)
+     */
     static fcFileOpener* Instance();
     static void Release();
 
+    /**
+     * @brief construct a private scan context, to be passed to crawlerScan(const char*, fcFileOpener*)
+     */
+    fcFileOpener();
+    virtual ~fcFileOpener();
+
     static std::string extract_path(const std::string &filePath);
 
     void AddSearchPath(const std::string &path);
     void AddExcludePath(const std::string &path);
     FILE *OpenFile(const std::string &include_path);
 
+    /**
+     * @brief return the full path of an include statement, or an empty string
+     * if it can not be found in the search paths
+     */
+    std::string ResolveInclude(const std::string &include_path);
+
     void ClearResults()    {
         _matchedfiles.clear();
         _scannedfiles.clear();
         _namespaces.clear();
         _namespaceAliases.clear();
         _includeStatements.clear();
+        _includeGraph.clear();
         _depth = 0;
     }
 
     void ClearSearchPath() {
         _searchPath.clear();
         _excludePaths.clear();
+        _pathsKey.clear();
     }
 
     void incDepth() {
@@ -123,10 +147,23 @@ public:
     const List_t& GetIncludeStatements() const {
         return _includeStatements;
     }
-private:
-    fcFileOpener();
-    virtual ~fcFileOpener();
-
 
+    ////////////////////////////////////////////////////
+    // Include graph
+    void SetCollectIncludeGraph(bool collect) {
+        _collectGraph = collect;
+    }
+    bool IsCollectIncludeGraph() const {
+        return _collectGraph;
+    }
+    /**
+     * @brief record that 'file' includes 'included'. An empty 'included'
+     * only marks 'file' as scanned, so a file without includes still has
+     * an entry in the graph
+     */
+    void AddIncludeEdge(const std::string& file, const std::string& included);
+    const Graph_t& GetIncludeGraph() const {
+        return _includeGraph;
+    }
 };
 #endif // __fcfileopener__
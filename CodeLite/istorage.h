@@ -481,6 +481,32 @@ public:
 	 * @brief search for a single match in the database for an entry with a given name
 	 */
 	virtual TagEntryPtr GetTagsByNameLimitOne(const wxString& name) = 0;
+
+	/**
+	 * @brief store the include graph discovered by the crawler. Each key is a file
+	 * that was scanned, its value holds the full paths of the files it includes.
+	 * The previous edges of every key are replaced. Paths must be normalized with
+	 * TagsStorageSQLite::NormalizeIncludeGraphPath(), the other methods normalize their arguments
+	 */
+	virtual void StoreIncludeGraph(const std::map<wxString, wxArrayString>& graph) = 0;
+
+	/**
+	 * @brief delete the include edges of the given files
+	 */
+	virtual void DeleteIncludeGraph(const wxArrayString &files) = 0;
+
+	/**
+	 * @brief return the files included by 'file'
+	 * @param transitive when true, files included indirectly (through other headers) are returned as well
+	 */
+	virtual void GetIncludedFiles(const wxString &file, bool transitive, wxArrayString &files) = 0;
+
+	/**
+	 * @brief return the files that include 'file', i.e. the files that need to be
+	 * re-processed when 'file' is modified
+	 * @param transitive when true, files including 'file' indirectly are returned as well
+	 */
+	virtual void GetDependentFiles(const wxString &file, bool transitive, wxArrayString &files) = 0;
 };
 
 enum {
@@ -1759,20 +1759,17 @@ void Language::SetAdditionalScopes(const std::vector<wxString>& additionalScopes
         // do a deep scan of the entire include tree
         wxArrayString includePaths = GetTagsManager()->GetProjectPaths();
         {
-            wxCriticalSectionLocker locker( GetTagsManager()->m_crawlerLocker );
-
-            fcFileOpener::Instance()->ClearResults();
-            fcFileOpener::Instance()->ClearSearchPath();
+            fcFileOpener crawler;
             for(size_t i=0; i<includePaths.GetCount(); i++) {
-                fcFileOpener::Instance()->AddSearchPath( includePaths.Item(i).mb_str(wxConvUTF8).data() );
+                crawler.AddSearchPath( includePaths.Item(i).mb_str(wxConvUTF8).data() );
             }
 
             // Invoke the crawler
             const wxCharBuffer cfile = filename.mb_str(wxConvUTF8);
-            crawlerScan( cfile.data() );
+            crawlerScan( cfile.data(), &crawler );
 
-            std::set<std::string>::iterator iter = fcFileOpener::Instance()->GetNamespaces().begin();
-            for(; iter != fcFileOpener::Instance()->GetNamespaces().end(); iter++) {
+            std::set<std::string>::const_iterator iter = crawler.GetNamespaces().begin();
+            for(; iter != crawler.GetNamespaces().end(); iter++) {
                 this->m_additionalScopes.push_back( wxString(iter->c_str(), wxConvUTF8) );
             }
         }
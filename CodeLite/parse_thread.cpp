@@ -34,9 +34,128 @@
 #include "istorage.h"
 #include <wx/stopwatch.h>
 #include <wx/xrc/xmlres.h>
+#include <wx/hashset.h>
+#include <set>
 
 #define DEBUG_MESSAGE(x) CL_DEBUG1(x.c_str())
 
+// The maximum number of threads used to crawl the workspace files for include files
+#define PARSE_THREAD_MAX_CRAWLERS 4
+
+WX_DECLARE_HASH_SET(wxString, wxStringHash, wxStringEqual, ParseThreadFileSet_t);
+WX_DECLARE_STRING_HASH_MAP(wxString, ParseThreadPathMap_t);
+
+// The same headers appear over and over in the include graph, remember the
+// normalized form of the paths instead of constructing a wxFileName per edge
+static const wxString& ParseThreadNormalizePath(const std::string& path, ParseThreadPathMap_t& paths)
+{
+	wxString key(path.c_str(), wxConvUTF8);
+	ParseThreadPathMap_t::iterator iter = paths.find(key);
+	if( iter == paths.end() ) {
+		iter = paths.insert(ParseThreadPathMap_t::value_type(key, TagsStorageSQLite::NormalizeIncludeGraphPath(key))).first;
+	}
+	return iter->second;
+}
+
+// Convert the include graph collected by the crawler into the form stored
+// in the database: absolute and normalized paths. Edges of files that were
+// scanned by several crawlers are merged
+static void ParseThreadAddIncludeGraph(const fcFileOpener::Graph_t& graph, std::map<wxString, wxArrayString>& includeGraph, ParseThreadPathMap_t& paths)
+{
+	fcFileOpener::Graph_t::const_iterator iter = graph.begin();
+	for(; iter != graph.end(); iter++) {
+		wxArrayString& included = includeGraph[ ParseThreadNormalizePath(iter->first, paths) ];
+
+		// the edges already merged from another crawler
+		std::set<wxString> unique;
+		for(size_t i=0; i<included.GetCount(); i++) {
+			unique.insert(included.Item(i));
+		}
+
+		fcFileOpener::Set_t::const_iterator edge = iter->second.begin();
+		for(; edge != iter->second.end(); edge++) {
+			wxString file = ParseThreadNormalizePath(*edge, paths);
+			if( unique.insert(file).second ) {
+				included.Add(file);
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------
+// The state shared by the crawler threads of one crawl
+//--------------------------------------------------------------------------------------
+struct IncludeCrawlState
+{
+	wxMutex     m_mutex;
+	wxCondition m_cond;      // signaled each time a crawler is done
+	size_t      m_running;   // protected by m_mutex
+	bool        m_cancelled; // protected by m_mutex
+
+	IncludeCrawlState()
+		: m_cond(m_mutex)
+		, m_running(0)
+		, m_cancelled(false) {
+	}
+
+	bool IsCancelled() {
+		wxMutexLocker locker(m_mutex);
+		return m_cancelled;
+	}
+};
+
+//--------------------------------------------------------------------------------------
+// A helper thread that crawls a part of the workspace files. Each crawler
+// has its own fcFileOpener, so they do not share any state
+//--------------------------------------------------------------------------------------
+class IncludeCrawlerThread : public wxThread
+{
+	fcFileOpener             m_context;
+	std::vector<std::string> m_files;
+	IncludeCrawlState&       m_state;
+
+public:
+	IncludeCrawlerThread(const std::vector<std::string>& searchPaths, const std::vector<std::string>& excludePaths, IncludeCrawlState& state)
+		: wxThread(wxTHREAD_JOINABLE)
+		, m_state(state) {
+		m_context.SetCollectIncludeGraph(true);
+		for(size_t i=0; i<searchPaths.size(); i++) {
+			m_context.AddSearchPath(searchPaths.at(i));
+		}
+		for(size_t i=0; i<excludePaths.size(); i++) {
+			m_context.AddExcludePath(excludePaths.at(i));
+		}
+	}
+
+	void AddFile(const std::string& file) {
+		m_files.push_back(file);
+	}
+
+	const fcFileOpener::Set_t& GetResults() const {
+		return m_context.GetResults();
+	}
+
+	const fcFileOpener::Graph_t& GetIncludeGraph() const {
+		return m_context.GetIncludeGraph();
+	}
+
+	void Crawl() {
+		for(size_t i=0; i<m_files.size() && !m_state.IsCancelled(); i++) {
+			crawlerScan(m_files.at(i).c_str(), &m_context);
+		}
+
+		wxMutexLocker locker(m_state.m_mutex);
+		m_state.m_running--;
+		m_state.m_cond.Signal();
+	}
+
+protected:
+	virtual void* Entry() {
+		Crawl();
+		return NULL;
+	}
+};
+
 #define TEST_DESTROY() {\
 		if( TestDestroy() ) {\
 			DEBUG_MESSAGE( wxString::Format(wxT("ParseThread::ProcessIncludes -> received 'TestDestroy()'") ) );\
@@ -106,11 +225,18 @@ void ParseThread::ProcessRequest(ThreadRequest * request)
 void ParseThread::ParseIncludeFiles(ParseRequest* req, const wxString& filename, ITagsStoragePtr db)
 {
 	wxArrayString arrFiles;
-	GetFileListToParse(filename, arrFiles);
+	std::map<wxString, wxArrayString> includeGraph;
+	GetFileListToParse(filename, arrFiles, includeGraph);
 	int initalCount = arrFiles.GetCount();
 
 	TEST_DESTROY();
 
+	if ( !includeGraph.empty() ) {
+		db->Begin();
+		db->StoreIncludeGraph( includeGraph );
+		db->Commit();
+	}
+
 	DEBUG_MESSAGE( wxString::Format(wxT("Files that need parse %u"), (unsigned int)arrFiles.GetCount()) ) ;
 	TagsManagerST::Get()->FilterNonNeededFilesForRetaging(arrFiles, db);
 	DEBUG_MESSAGE( wxString::Format(wxT("Actual files that need parse %u"), (unsigned int)arrFiles.GetCount()) );
@@ -175,7 +301,17 @@ void ParseThread::ProcessIncludes(ParseRequest* req)
 	DEBUG_MESSAGE( wxString::Format(wxT("ProcessIncludes -> started")) ) ;
     
     std::set<std::string> *newSet = new std::set<std::string>();
-	FindIncludedFiles(req, newSet);
+	std::map<wxString, wxArrayString> includeGraph;
+	FindIncludedFiles(req, newSet, includeGraph);
+
+	// Keep the include graph, so the files affected by a change can be found later
+	if ( !includeGraph.empty() && !req->getDbfile().IsEmpty() ) {
+		ITagsStoragePtr db(new TagsStorageSQLite());
+		db->OpenDatabase( req->getDbfile() );
+		db->Begin();
+		db->StoreIncludeGraph( includeGraph );
+		db->Commit();
+	}
 
 #ifdef PARSE_THREAD_DBG
 	std::set<std::string>::iterator iter = newSet->begin();
@@ -250,51 +386,49 @@ void ParseThread::ProcessSimple(ParseRequest* req)
 	}
 }
 
-void ParseThread::GetFileListToParse(const wxString& filename, wxArrayString& arrFiles)
+void ParseThread::GetFileListToParse(const wxString& filename, wxArrayString& arrFiles, std::map<wxString, wxArrayString>& includeGraph)
 {
 	if ( !this->IsCrawlerEnabled() ) {
 		return;
 	}
 
-	{
-		wxCriticalSectionLocker locker( TagsManagerST::Get()->m_crawlerLocker );
-
-		wxArrayString includePaths, excludePaths;
-		GetSearchPaths( includePaths, excludePaths );
-        
-        fcFileOpener::Instance()->ClearResults();
-		fcFileOpener::Instance()->ClearSearchPath();
-		for(size_t i=0; i<includePaths.GetCount(); i++) {
-			fcFileOpener::Instance()->AddSearchPath( includePaths.Item(i).mb_str(wxConvUTF8).data() );
-		}
-
-		for(size_t i=0; i<excludePaths.GetCount(); i++) {
-			fcFileOpener::Instance()->AddExcludePath(excludePaths.Item(i).mb_str(wxConvUTF8).data());
-		}
+	// Skip binary files
+	if(TagsManagerST::Get()->IsBinaryFile(filename)) {
+		DEBUG_MESSAGE( wxString::Format(wxT("Skipping binary file %s"), filename.c_str()) );
+		return;
+	}
 
-		// Invoke the crawler
-		const wxCharBuffer cfile = filename.mb_str(wxConvUTF8);
+	wxArrayString includePaths, excludePaths;
+	GetSearchPaths( includePaths, excludePaths );
 
-		// Skip binary files
-		if(TagsManagerST::Get()->IsBinaryFile(filename)) {
-			DEBUG_MESSAGE( wxString::Format(wxT("Skipping binary file %s"), filename.c_str()) );
-			return;
-		}
-
-		// Before using the 'crawlerScan' we lock it, since it is not mt-safe
-		crawlerScan( cfile.data() );
+	// Use a private crawler context, no locking is required
+	fcFileOpener crawler;
+	crawler.SetCollectIncludeGraph(true);
+	for(size_t i=0; i<includePaths.GetCount(); i++) {
+		crawler.AddSearchPath( includePaths.Item(i).mb_str(wxConvUTF8).data() );
+	}
 
+	for(size_t i=0; i<excludePaths.GetCount(); i++) {
+		crawler.AddExcludePath(excludePaths.Item(i).mb_str(wxConvUTF8).data());
 	}
 
-	std::set<std::string> fileSet = fcFileOpener::Instance()->GetResults();
-	std::set<std::string>::iterator iter = fileSet.begin();
+	// Invoke the crawler
+	const wxCharBuffer cfile = filename.mb_str(wxConvUTF8);
+	crawlerScan( cfile.data(), &crawler );
+
+	ParseThreadFileSet_t uniqueFiles;
+	const fcFileOpener::Set_t& fileSet = crawler.GetResults();
+	fcFileOpener::Set_t::const_iterator iter = fileSet.begin();
 	for (; iter != fileSet.end(); iter++ ) {
 		wxFileName fn(wxString((*iter).c_str(), wxConvUTF8));
 		fn.MakeAbsolute();
-		if ( arrFiles.Index(fn.GetFullPath()) == wxNOT_FOUND ) {
+		if ( uniqueFiles.insert(fn.GetFullPath()).second ) {
 			arrFiles.Add(fn.GetFullPath());
 		}
 	}
+
+	ParseThreadPathMap_t paths;
+	ParseThreadAddIncludeGraph(crawler.GetIncludeGraph(), includeGraph, paths);
 }
 
 void ParseThread::ParseAndStoreFiles(ParseRequest* req, const wxArrayString& arrFiles, int initalCount, ITagsStoragePtr db)
@@ -360,6 +494,7 @@ void ParseThread::ProcessDeleteTagsOfFiles(ParseRequest* req)
 	}
 
 	db->DeleteFromFiles(file_array);
+	db->DeleteIncludeGraph(file_array);
 	db->Commit();
 	DEBUG_MESSAGE(wxString(wxT("ParseThread::ProcessDeleteTagsOfFile - completed")));
 }
@@ -462,7 +597,7 @@ void ParseThread::ProcessParseAndStore(ParseRequest* req)
 	}
 }
 
-void ParseThread::FindIncludedFiles(ParseRequest* req, std::set<std::string>* newSet)
+void ParseThread::FindIncludedFiles(ParseRequest* req, std::set<std::string>* newSet, std::map<wxString, wxArrayString>& includeGraph)
 {
 	wxArrayString searchPaths, excludePaths, filteredFileList;
 	GetSearchPaths( searchPaths, excludePaths );
@@ -480,36 +615,69 @@ void ParseThread::FindIncludedFiles(ParseRequest* req, std::set<std::string>* ne
 		filteredFileList.Add( fn.GetFullPath() );
 	}
 
-	wxArrayString arrFiles;
-
-	// Clear the results once
-	{
-		// Before using the 'crawlerScan' we lock it, since it is not mt-safe
-		wxCriticalSectionLocker locker( TagsManagerST::Get()->m_crawlerLocker );
+	std::vector<std::string> cSearchPaths, cExcludePaths;
+	for(size_t i=0; i<searchPaths.GetCount(); i++) {
+		DEBUG_MESSAGE( wxString::Format(wxT("ParseThread: Using Search Path: %s "), searchPaths.Item(i).c_str()) );
+		cSearchPaths.push_back( _C(searchPaths.Item(i)).data() );
+	}
 
-		fcFileOpener::Instance()->ClearResults();
-		fcFileOpener::Instance()->ClearSearchPath();
+	for(size_t i=0; i<excludePaths.GetCount(); i++) {
+		DEBUG_MESSAGE( wxString::Format(wxT("ParseThread: Using Exclude Path: %s "), excludePaths.Item(i).c_str()) );
+		cExcludePaths.push_back( _C(excludePaths.Item(i)).data() );
+	}
 
-		for(size_t i=0; i<searchPaths.GetCount(); i++) {
-			const wxCharBuffer path = _C(searchPaths.Item(i));
-			DEBUG_MESSAGE( wxString::Format(wxT("ParseThread: Using Search Path: %s "), searchPaths.Item(i).c_str()) );
-			fcFileOpener::Instance()->AddSearchPath(path.data());
+	// The crawler is reentrant: split the files between a few crawler threads.
+	// Each thread gets a contiguous range of files, files in the same folder
+	// usually include the same headers, which each crawler scans only once
+	size_t crawlersCount = wxThread::GetCPUCount() > 0 ? (size_t)wxThread::GetCPUCount() : 1;
+	crawlersCount = wxMin(crawlersCount, (size_t)PARSE_THREAD_MAX_CRAWLERS);
+	crawlersCount = wxMin(crawlersCount, (filteredFileList.GetCount() / 10) + 1);
+
+	IncludeCrawlState state;
+	state.m_running = crawlersCount;
+
+	std::vector<IncludeCrawlerThread*> crawlers;
+	size_t filesPerCrawler = (filteredFileList.GetCount() + crawlersCount - 1) / crawlersCount;
+	for(size_t i=0; i<crawlersCount; i++) {
+		IncludeCrawlerThread* crawler = new IncludeCrawlerThread(cSearchPaths, cExcludePaths, state);
+		for(size_t j=i*filesPerCrawler; j<(i+1)*filesPerCrawler && j<filteredFileList.GetCount(); j++) {
+			crawler->AddFile( filteredFileList.Item(j).mb_str(wxConvUTF8).data() );
 		}
+		crawlers.push_back(crawler);
+	}
 
-		for(size_t i=0; i<excludePaths.GetCount(); i++) {
-			const wxCharBuffer path = _C(excludePaths.Item(i));
-			DEBUG_MESSAGE( wxString::Format(wxT("ParseThread: Using Exclude Path: %s "), excludePaths.Item(i).c_str()) );
-			fcFileOpener::Instance()->AddExcludePath(path.data());
+	std::vector<bool> started;
+	for(size_t i=0; i<crawlers.size(); i++) {
+		started.push_back(crawlers.at(i)->Create() == wxTHREAD_NO_ERROR && crawlers.at(i)->Run() == wxTHREAD_NO_ERROR);
+		if( !started.back() ) {
+			// Could not start the thread, crawl its files here
+			crawlers.at(i)->Crawl();
 		}
+	}
 
-		for(size_t i=0; i<filteredFileList.GetCount(); i++) {
-			const wxCharBuffer cfile = filteredFileList.Item(i).mb_str(wxConvUTF8);
-			crawlerScan(cfile.data());
-			if( TestDestroy() ) {
-				return;
+	// Wait for the crawlers. A shutdown request is not signaled: wake up from time
+	// to time to check for it and cancel the crawl
+	{
+		wxMutexLocker locker(state.m_mutex);
+		while( state.m_running > 0 ) {
+			state.m_cond.WaitTimeout(100);
+			if( !state.m_cancelled && TestDestroy() ) {
+				state.m_cancelled = true;
 			}
 		}
-        newSet->insert(fcFileOpener::Instance()->GetResults().begin(), fcFileOpener::Instance()->GetResults().end());
+	}
+
+	bool cancelled = state.IsCancelled();
+	ParseThreadPathMap_t paths;
+	for(size_t i=0; i<crawlers.size(); i++) {
+		if( started.at(i) ) {
+			crawlers.at(i)->Wait();
+		}
+		if( !cancelled ) {
+			newSet->insert(crawlers.at(i)->GetResults().begin(), crawlers.at(i)->GetResults().end());
+			ParseThreadAddIncludeGraph(crawlers.at(i)->GetIncludeGraph(), includeGraph, paths);
+		}
+		delete crawlers.at(i);
 	}
 }
 
@@ -605,12 +773,10 @@ void ParseThread::ProcessIncludeStatements(ParseRequest* req)
     {
         wxString file = req->getFile();
         // Retrieve the "include" files on this file only
-        wxCriticalSectionLocker locker(TagsManagerST::Get()->m_crawlerLocker);
-        fcFileOpener::Instance()->ClearResults();
-        fcFileOpener::Instance()->ClearSearchPath();
-        crawlerScan(file.mb_str(wxConvUTF8).data());
+        fcFileOpener crawler;
+        crawlerScan(file.mb_str(wxConvUTF8).data(), &crawler);
 
-        const fcFileOpener::List_t& incls = fcFileOpener::Instance()->GetIncludeStatements();
+        const fcFileOpener::List_t& incls = crawler.GetIncludeStatements();
         matches->insert(matches->end(), incls.begin(), incls.end());
     }
     
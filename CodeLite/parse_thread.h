@@ -163,10 +163,10 @@ private:
 	void ProcessDeleteTagsOfFiles (ParseRequest *req);
 	void ProcessSimpleNoIncludes  (ParseRequest *req);
 	void ProcessIncludeStatements (ParseRequest *req);
-	void GetFileListToParse(const wxString &filename, wxArrayString &arrFiles);
+	void GetFileListToParse(const wxString &filename, wxArrayString &arrFiles, std::map<wxString, wxArrayString> &includeGraph);
 	void ParseAndStoreFiles(ParseRequest *req, const wxArrayString &arrFiles, int initalCount, ITagsStoragePtr db);
 
-	void FindIncludedFiles(ParseRequest *req, std::set<std::string> *newSet);
+	void FindIncludedFiles(ParseRequest *req, std::set<std::string> *newSet, std::map<wxString, wxArrayString> &includeGraph);
 };
 
 class WXDLLIMPEXP_CL ParseThreadST 
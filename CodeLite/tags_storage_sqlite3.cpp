@@ -117,6 +117,10 @@ void TagsStorageSQLite::CreateSchema()
         sql = wxT("create  table if not exists SIMPLE_MACROS (ID INTEGER PRIMARY KEY AUTOINCREMENT, file string, name string);");
         m_db->ExecuteUpdate(sql);
 
+        // file -> included file edges, as discovered by the include crawler
+        sql = wxT("create  table if not exists INCLUDE_GRAPH (ID INTEGER PRIMARY KEY AUTOINCREMENT, file string, included string);");
+        m_db->ExecuteUpdate(sql);
+
         // create unuque index on Files' file column
         sql = wxT("CREATE UNIQUE INDEX IF NOT EXISTS FILES_NAME on FILES(file)");
         m_db->ExecuteUpdate(sql);
@@ -182,6 +186,13 @@ void TagsStorageSQLite::CreateSchema()
         sql = wxT("CREATE INDEX IF NOT EXISTS SIMPLE_MACROS_FILE on SIMPLE_MACROS(file);");
         m_db->ExecuteUpdate(sql);
 
+        // the unique index also serves the forward queries, the second one the reverse queries
+        sql = wxT("CREATE UNIQUE INDEX IF NOT EXISTS INCLUDE_GRAPH_UNIQ on INCLUDE_GRAPH(file, included);");
+        m_db->ExecuteUpdate(sql);
+
+        sql = wxT("CREATE INDEX IF NOT EXISTS INCLUDE_GRAPH_INCLUDED on INCLUDE_GRAPH(included);");
+        m_db->ExecuteUpdate(sql);
+
         sql = wxT("create table if not exists tags_version (version string primary key);");
         m_db->ExecuteUpdate(sql);
 
@@ -220,6 +231,7 @@ void TagsStorageSQLite::RecreateDatabase()
             m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS MACROS"));
             m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS SIMPLE_MACROS"));
             m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS GLOBAL_TAGS"));
+            m_db->ExecuteUpdate(wxT("DROP TABLE IF EXISTS INCLUDE_GRAPH"));
 
             // drop indexes
             m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS FILES_NAME"));
@@ -236,6 +248,8 @@ void TagsStorageSQLite::RecreateDatabase()
             m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS SIMPLE_MACROS_FILE"));
             m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS GLOBAL_TAGS_IDX_1"));
             m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS GLOBAL_TAGS_IDX_2"));
+            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS INCLUDE_GRAPH_UNIQ"));
+            m_db->ExecuteUpdate(wxT("DROP INDEX IF EXISTS INCLUDE_GRAPH_INCLUDED"));
 
             // Recreate the schema
             CreateSchema();
@@ -1600,3 +1614,112 @@ void TagsStorageSQLite::GetTagsByPartName(const wxString& partname, std::vector<
         CL_DEBUG(wxT("%s"), e.GetMessage().c_str());
     }
 }
+
+void TagsStorageSQLite::StoreIncludeGraph(const std::map<wxString, wxArrayString>& graph)
+{
+    if (graph.empty()) {
+        return;
+    }
+
+    try {
+        wxSQLite3Statement stmntDelete = m_db->GetPrepareStatement(wxT("delete from INCLUDE_GRAPH where file=?"));
+        wxSQLite3Statement stmntInsert = m_db->GetPrepareStatement(wxT("insert or ignore into INCLUDE_GRAPH values(NULL, ?, ?)"));
+
+        std::map<wxString, wxArrayString>::const_iterator iter = graph.begin();
+        for(; iter != graph.end(); iter++) {
+            // replace the edges of this file
+            stmntDelete.Bind(1, iter->first);
+            stmntDelete.ExecuteUpdate();
+            stmntDelete.Reset();
+
+            const wxArrayString &included = iter->second;
+            for(size_t i=0; i<included.GetCount(); i++) {
+                stmntInsert.Bind(1, iter->first);
+                stmntInsert.Bind(2, included.Item(i));
+                stmntInsert.ExecuteUpdate();
+                stmntInsert.Reset();
+            }
+        }
+
+    } catch (wxSQLite3Exception &e) {
+        CL_DEBUG(wxT("%s"), e.GetMessage().c_str());
+    }
+}
+
+void TagsStorageSQLite::DeleteIncludeGraph(const wxArrayString& files)
+{
+    if (files.IsEmpty()) {
+        return;
+    }
+
+    try {
+        wxSQLite3Statement stmnt = m_db->GetPrepareStatement(wxT("delete from INCLUDE_GRAPH where file=?"));
+        for (size_t i=0; i<files.GetCount(); i++) {
+            stmnt.Bind(1, NormalizeIncludeGraphPath(files.Item(i)));
+            stmnt.ExecuteUpdate();
+            stmnt.Reset();
+        }
+
+    } catch (wxSQLite3Exception &e) {
+        CL_DEBUG(wxT("%s"), e.GetMessage().c_str());
+    }
+}
+
+wxString TagsStorageSQLite::NormalizeIncludeGraphPath(const wxString& path)
+{
+    // The crawler lowercases the paths on Windows (see normalize_path() in
+    // fc_fileopener.cpp), wxPATH_NORM_CASE does the same for the queries
+    wxFileName fn(path);
+    fn.Normalize(wxPATH_NORM_CASE | wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE);
+    return fn.GetFullPath();
+}
+
+void TagsStorageSQLite::GetIncludedFiles(const wxString& file, bool transitive, wxArrayString& files)
+{
+    DoGetIncludeGraphFiles(file, transitive, false, files);
+}
+
+void TagsStorageSQLite::GetDependentFiles(const wxString& file, bool transitive, wxArrayString& files)
+{
+    DoGetIncludeGraphFiles(file, transitive, true, files);
+}
+
+void TagsStorageSQLite::DoGetIncludeGraphFiles(const wxString& file, bool transitive, bool reverse, wxArrayString& files)
+{
+    if (file.IsEmpty()) {
+        return;
+    }
+
+    try {
+        // The bundled sqlite does not support recursive queries, so we walk
+        // the graph here (breadth first), one indexed lookup per file
+        wxString sql = reverse ?
+                       wxT("select file from INCLUDE_GRAPH where included=?") :
+                       wxT("select included from INCLUDE_GRAPH where file=?");
+        wxSQLite3Statement stmnt = m_db->GetPrepareStatement(sql);
+
+        wxString start = NormalizeIncludeGraphPath(file);
+        std::set<wxString> visited;
+        visited.insert(start);
+
+        wxArrayString queue;
+        queue.Add(start);
+        for (size_t i=0; i<queue.GetCount(); i++) {
+            stmnt.Bind(1, queue.Item(i));
+            wxSQLite3ResultSet rs = stmnt.ExecuteQuery();
+            while ( rs.NextRow() ) {
+                wxString other = rs.GetString(0);
+                if ( visited.insert(other).second ) {
+                    files.Add(other);
+                    if ( transitive ) {
+                        queue.Add(other);
+                    }
+                }
+            }
+            stmnt.Reset();
+        }
+
+    } catch (wxSQLite3Exception &e) {
+        CL_DEBUG(wxT("%s"), e.GetMessage().c_str());
+    }
+}
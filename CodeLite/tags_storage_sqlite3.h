@@ -148,10 +148,22 @@ private:
 	void DoAddLimitPartToQuery(wxString &sql, const std::vector<TagEntryPtr> &tags);
 	int  DoInsertTagEntry( const TagEntry &tag );
 
+	/**
+	 * @brief walk the include graph starting from 'file'
+	 * @param reverse follow the edges from the included file to the including file
+	 */
+	void DoGetIncludeGraphFiles(const wxString &file, bool transitive, bool reverse, wxArrayString &files);
+
 public:
 	static TagEntry *FromSQLite3ResultSet(wxSQLite3ResultSet &rs);
 	static void      PPTokenFromSQlite3ResultSet(wxSQLite3ResultSet &rs, PPToken &token);
 
+	/**
+	 * @brief return the form of 'path' used by the include graph table: absolute,
+	 * without '.' and '..' components and, on case insensitive file systems, in lower case
+	 */
+	static wxString  NormalizeIncludeGraphPath(const wxString &path);
+
 public:
 	/**
 	 * Execute a query sql and return result set.
@@ -591,6 +603,26 @@ public:
 	TagEntryPtr GetTagsByNameLimitOne(const wxString& name);
 	void GetTagsByPartName(const wxString& partname, std::vector<TagEntryPtr>& tags);
 
+	/**
+	 * @copydoc ITagStorage::StoreIncludeGraph
+	 */
+	virtual void StoreIncludeGraph(const std::map<wxString, wxArrayString>& graph);
+
+	/**
+	 * @copydoc ITagStorage::DeleteIncludeGraph
+	 */
+	virtual void DeleteIncludeGraph(const wxArrayString &files);
+
+	/**
+	 * @copydoc ITagStorage::GetIncludedFiles
+	 */
+	virtual void GetIncludedFiles(const wxString &file, bool transitive, wxArrayString &files);
+
+	/**
+	 * @copydoc ITagStorage::GetDependentFiles
+	 */
+	virtual void GetDependentFiles(const wxString &file, bool transitive, wxArrayString &files);
+
 
 };
 
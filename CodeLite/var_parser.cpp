@@ -38,6 +38,7 @@ static char yysccsid[] = "@(#)yaccpar	1.9 (Berkeley) 02/21/93";
 #include "vector" 
 #include "stdio.h"
 #include "map"
+#include "cl_parser_state.h"
 #include "variable.h"
 #include "cl_typedef.h"
 
@@ -55,26 +56,22 @@ void syncParser();
 void var_consumeDefaultValue(char c1, char c2);
 void var_consumeDefaultValueIfNeeded();
 
-static  VariableList *        gs_vars = NULL;
-static  std::vector<Variable> gs_names;
-static  bool                  g_isUsedWithinFunc = false;
-static  std::string           s_tmpString;
-static  Variable              curr_var;
-static  std::string           s_templateInitList;
-static  bool                  isBasicType = false;
-
 /*---------------------------------------------*/
 /* externs defined in the lexer*/
 /*---------------------------------------------*/
-extern char *cl_scope_text;
+extern char* cl_scope_lex_text();
+#define cl_scope_text cl_scope_lex_text()
 extern int cl_scope_lex();
 extern void cl_scope_less(int count);
 
-extern int cl_scope_lineno;
-extern std::vector<std::string> currentScope;
+extern int cl_scope_lex_lineno();
+#define cl_scope_lineno cl_scope_lex_lineno()
+extern std::vector<std::string>& cl_scope_lex_current_scope();
+#define currentScope cl_scope_lex_current_scope()
 extern bool setLexerInput(const std::string &in, const std::map<std::string, std::string> &ignoreMap);
 extern void setUseIgnoreMacros(bool ignore);
 extern void cl_scope_lex_clean();
+extern const std::string& cl_scope_lex_lval();
 
 /*************** Standard ytab.c continues here *********************/
 #define LE_AUTO 257
@@ -552,21 +549,73 @@ typedef int YYSTYPE;
 #define YYMAXDEPTH 500
 #endif
 #endif
-int yydebug;
-int yynerrs;
-int yyerrflag;
-int yychar;
-short *yyssp;
-YYSTYPE *yyvsp;
-YYSTYPE yyval;
-YYSTYPE yylval;
-short yyss[YYSTACKSIZE];
-YYSTYPE yyvs[YYSTACKSIZE];
 #define yystacksize YYSTACKSIZE
+/*
+ * The parser state: the variables byacc generates as globals and the parser's
+ * own statics live in the clParserState of the calling thread (see
+ * cl_parser_state.h). Every function using them declares:
+ * clVarParserState* yyps = cl_var_parser_state();
+ */
+struct clVarParserState : public clParserStateModule
+{
+    int                    yydebug_r;
+    int                    yynerrs_r;
+    int                    yyerrflag_r;
+    int                    yychar_r;
+    short                 *yyssp_r;
+    YYSTYPE               *yyvsp_r;
+    YYSTYPE                yyval_r;
+    short                  yyss_r[YYSTACKSIZE];
+    YYSTYPE                yyvs_r[YYSTACKSIZE];
+
+    VariableList          *gs_vars_r;
+    std::vector<Variable>  gs_names_r;
+    bool                   g_isUsedWithinFunc_r;
+    std::string            s_tmpString_r;
+    Variable               curr_var_r;
+    std::string            s_templateInitList_r;
+    bool                   isBasicType_r;
+
+    clVarParserState()
+        : yydebug_r(0)
+        , yynerrs_r(0)
+        , yyerrflag_r(0)
+        , yychar_r(0)
+        , yyssp_r(NULL)
+        , yyvsp_r(NULL)
+        , gs_vars_r(NULL)
+        , g_isUsedWithinFunc_r(false)
+        , isBasicType_r(false)
+    {}
+};
+
+static clVarParserState* cl_var_parser_state()
+{
+    return clParserState::Current()->GetModule<clVarParserState>(clParserState::kVarParser);
+}
+
+#define cl_var_debug        yyps->yydebug_r
+#define cl_var_nerrs        yyps->yynerrs_r
+#define cl_var_errflag      yyps->yyerrflag_r
+#define cl_var_char         yyps->yychar_r
+#define cl_var_ssp          yyps->yyssp_r
+#define cl_var_vsp          yyps->yyvsp_r
+#define cl_var_val          yyps->yyval_r
+#define cl_var_ss           yyps->yyss_r
+#define cl_var_vs           yyps->yyvs_r
+#define cl_var_lval         cl_scope_lex_lval()
+#define gs_vars             yyps->gs_vars_r
+#define gs_names            yyps->gs_names_r
+#define g_isUsedWithinFunc  yyps->g_isUsedWithinFunc_r
+#define s_tmpString         yyps->s_tmpString_r
+#define curr_var            yyps->curr_var_r
+#define s_templateInitList  yyps->s_templateInitList_r
+#define isBasicType         yyps->isBasicType_r
 void yyerror(char *s) {}
 
 void var_consumeAutoAssignment(const std::string& varname)
 {
+    clVarParserState* yyps = cl_var_parser_state();
     // Collect everything until we encounter the first ';'
     std::string expression;
     while ( true ) {
@@ -659,6 +708,7 @@ void var_consumeDefaultValueIfNeeded()
  
 void var_consumeDefaultValue(char c1, char c2)
 {
+    clVarParserState* yyps = cl_var_parser_state();
     int depth = 0;
     bool cont(true);
 
@@ -690,6 +740,7 @@ void var_consumeDefaultValue(char c1, char c2)
 
 void clean_up()
 {
+    clVarParserState* yyps = cl_var_parser_state();
     gs_vars = NULL;
 
     // restore settings
@@ -704,6 +755,7 @@ void clean_up()
 // return the scope name at the end of the input string
 void get_variables(const std::string &in, VariableList &li, const std::map<std::string, std::string> &ignoreMap, bool isUsedWithinFunc)
 {
+    clVarParserState* yyps = cl_var_parser_state();
     //provide the lexer with new input
     if( !setLexerInput(in, ignoreMap) ){
         return;
@@ -724,6 +776,7 @@ void get_variables(const std::string &in, VariableList &li, const std::map<std::
 
 bool is_primitive_type(const std::string &in)
 {
+    clVarParserState* yyps = cl_var_parser_state();
     std::string input = "@"; // Hack the input string...
     input += in;
     input += ";";
@@ -746,6 +799,7 @@ bool is_primitive_type(const std::string &in)
 int
 yyparse()
 {
+    clVarParserState* yyps = cl_var_parser_state();
     register int yym, yyn, yystate;
 #if YYDEBUG
     register char *yys;
@@ -27,7 +27,9 @@
 WorkerThread::WorkerThread()
 : wxThread(wxTHREAD_JOINABLE)
 , m_notifiedWindow( NULL )
-, m_sleep(200)
+, m_currentRequest( NULL )
+, m_wakeupCond( m_wakeupMutex )
+, m_stopRequested( false )
 {
 }
 
@@ -46,6 +48,17 @@ void* WorkerThread::Entry()
 {
 	while( true )
 	{
+		{
+			// Sleep until there is something to do
+			wxMutexLocker locker(m_wakeupMutex);
+			while( !m_stopRequested && !HasRequests() ) {
+				m_wakeupCond.Wait();
+			}
+
+			if( m_stopRequested )
+				break;
+		}
+
 		// Did we get a request to terminate?
 		if(TestDestroy())
 			break;
@@ -55,23 +68,76 @@ void* WorkerThread::Entry()
 		{
 			// Call user's implementation for processing request
 			ProcessRequest( request );
-			delete request;
 
-			wxThread::Sleep(10);  // Allow other threads to work as well
+			{
+				wxCriticalSectionLocker locker(m_cs);
+				m_currentRequest = NULL;
+			}
+			delete request;
 			request = NULL;
-			continue; // to avoid the sleep
 		}
-
-		// Sleep for 1 seconds, and then try again
-		wxThread::Sleep(m_sleep);
 	}
 	return NULL;
 }
 
 void WorkerThread::Add(ThreadRequest *request)
+{
+	{
+		wxCriticalSectionLocker locker(m_cs);
+		if( !request->GetCoalescingKey().IsEmpty() ) {
+			// latest wins
+			DoCancel( request->GetCoalescingKey() );
+		}
+		DoEnqueue( request );
+	}
+
+	// The signal is sent while holding the mutex: the thread is either waiting on
+	// the condition or has not tested the queue yet, so it can not be missed
+	wxMutexLocker locker(m_wakeupMutex);
+	m_wakeupCond.Signal();
+}
+
+size_t WorkerThread::Cancel(const wxString &key)
+{
+	wxCriticalSectionLocker locker(m_cs);
+	return DoCancel( key );
+}
+
+void WorkerThread::DoEnqueue(ThreadRequest *request)
+{
+	// Requests with the same priority keep their order
+	std::deque<ThreadRequest*>::iterator iter = m_queue.begin();
+	while( iter != m_queue.end() && (*iter)->GetPriority() <= request->GetPriority() ) {
+		++iter;
+	}
+	m_queue.insert(iter, request);
+}
+
+size_t WorkerThread::DoCancel(const wxString &key)
+{
+	size_t count = 0;
+	std::deque<ThreadRequest*>::iterator iter = m_queue.begin();
+	while( iter != m_queue.end() ) {
+		if( (*iter)->GetCoalescingKey() == key ) {
+			delete (*iter);
+			iter = m_queue.erase(iter);
+			count++;
+
+		} else {
+			++iter;
+		}
+	}
+
+	if( m_currentRequest && m_currentRequest->GetCoalescingKey() == key ) {
+		m_currentRequest->Cancel();
+	}
+	return count;
+}
+
+bool WorkerThread::HasRequests()
 {
 	wxCriticalSectionLocker locker(m_cs);
-	m_queue.push_back(request);
+	return !m_queue.empty();
 }
 
 ThreadRequest *WorkerThread::GetRequest()
@@ -82,11 +148,19 @@ ThreadRequest *WorkerThread::GetRequest()
 		req = m_queue.front();
 		m_queue.pop_front();
 	}
+	m_currentRequest = req;
 	return req;
 }
 
 void WorkerThread::Stop()
 {
+	{
+		// Wake up the thread if it is waiting for requests
+		wxMutexLocker locker(m_wakeupMutex);
+		m_stopRequested = true;
+		m_wakeupCond.Broadcast();
+	}
+
 #if wxVERSION_NUMBER < 2904
     if(IsAlive()) {
         Delete();
@@ -112,9 +186,3 @@ void WorkerThread::Start(int priority)
 	SetPriority(priority);
 	Run();
 }
-
-void WorkerThread::SetSleepInterval(size_t ms)
-{
-	m_sleep = ms;
-}
-
@@ -28,6 +28,7 @@
 #include <deque>
 #include "wx/thread.h"
 #include "wx/event.h"
+#include "wx/string.h"
 #include "codelite_exports.h"
 
 
@@ -37,8 +38,70 @@
 class WXDLLIMPEXP_CL ThreadRequest
 {
 public:
-    ThreadRequest() {};
+    enum ePriority {
+        kPriorityHigh = 0, // interactive requests (code completion, searches)
+        kPriorityNormal,
+        kPriorityLow       // background work (warm-up, full retag)
+    };
+
+protected:
+    int                       m_priority;
+    wxString                  m_coalescingKey;
+    bool                      m_cancelled;     // protected by m_cancelledLock
+    mutable wxCriticalSection m_cancelledLock; // Cancel() is called from other threads
+
+public:
+    ThreadRequest() : m_priority(kPriorityNormal), m_cancelled(false) {};
     virtual ~ThreadRequest() {};
+
+    // the cancellation state is not copied: a copy is a new request
+    ThreadRequest(const ThreadRequest& other)
+        : m_priority(other.m_priority)
+        , m_coalescingKey(other.m_coalescingKey)
+        , m_cancelled(false)
+    {}
+
+    ThreadRequest& operator=(const ThreadRequest& other) {
+        m_priority      = other.m_priority;
+        m_coalescingKey = other.m_coalescingKey;
+        return *this;
+    }
+
+    /**
+     * @brief requests with a higher priority are processed first. Requests with the
+     * same priority are processed in the order they were added
+     */
+    void SetPriority(int priority) {
+        this->m_priority = priority;
+    }
+    int GetPriority() const {
+        return m_priority;
+    }
+
+    /**
+     * @brief "latest wins" key. Adding a request with a non empty key drops the
+     * requests with the same key that are still waiting in the queue and cancels
+     * the one being processed (see IsCancelled())
+     */
+    void SetCoalescingKey(const wxString& key) {
+        this->m_coalescingKey = key;
+    }
+    const wxString& GetCoalescingKey() const {
+        return m_coalescingKey;
+    }
+
+    /**
+     * @brief return true if this request was superseded or cancelled while it was
+     * processed. Long running requests should test it and return early
+     */
+    bool IsCancelled() const {
+        wxCriticalSectionLocker locker(m_cancelledLock);
+        return m_cancelled;
+    }
+    void Cancel() {
+        wxCriticalSectionLocker locker(m_cancelledLock);
+        m_cancelled = true;
+    }
 };
 
 /**
@@ -50,15 +113,16 @@ class WXDLLIMPEXP_CL WorkerThread : public wxThread
 protected:
     wxCriticalSection          m_cs;
     wxEvtHandler *             m_notifiedWindow;
-    std::deque<ThreadRequest*> m_queue;
-    size_t                     m_sleep;
+    std::deque<ThreadRequest*> m_queue;          // ordered by priority, protected by m_cs
+    ThreadRequest*             m_currentRequest; // protected by m_cs
+
+private:
+    // The thread sleeps on m_wakeupCond until a request is added or Stop() is called
+    wxMutex                    m_wakeupMutex;
+    wxCondition                m_wakeupCond;
+    bool                       m_stopRequested;  // protected by m_wakeupMutex
 
 public:
-    /**
-     * @brief set the sleep interval. If non is set, 200ms is the default
-     */
-    void SetSleepInterval(size_t ms);
-
     /**
      * Default constructor.
      */
@@ -86,6 +150,13 @@ public:
      */
     void Add(ThreadRequest *request);
 
+    /**
+     * @brief cancel all the requests with the given coalescing key: the pending ones are
+     * removed from the queue and the one being processed is flagged as cancelled
+     * @return the number of pending requests removed
+     */
+    size_t Cancel(const wxString &key);
+
     /**
      * Set the window to be notified when a change was done
      * between current source file tree and the actual tree.
@@ -126,6 +197,22 @@ protected:
      * \return true if there is a request to process
      */
     ThreadRequest* GetRequest();
+
+    /**
+     * @brief insert 'request' after the queued requests with the same or higher priority.
+     * Must be called with m_cs locked
+     */
+    void DoEnqueue(ThreadRequest *request);
+
+    /**
+     * @brief see Cancel(). Must be called with m_cs locked
+     */
+    size_t DoCancel(const wxString &key);
+
+    /**
+     * @brief return true if the queue is not empty
+     */
+    bool HasRequests();
 };
 
 #endif // WORKER_THREAD_H
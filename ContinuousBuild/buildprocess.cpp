@@ -31,6 +31,15 @@ void BuildProcess::Stop()
 		m_process = NULL;
 	}
 	m_fileName.Clear();
+	m_output.Clear();
+}
+
+void BuildProcess::Terminate()
+{
+	// Kill the process but keep it: the termination event is still sent
+	if(m_process){
+		m_process->Terminate();
+	}
 }
 
 bool BuildProcess::IsBusy()
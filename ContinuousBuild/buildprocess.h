@@ -8,6 +8,7 @@ class BuildProcess
 	IProcess*     m_process;
 	wxEvtHandler* m_evtHandler;
 	wxString      m_fileName;
+	wxString      m_output;
 
 public:
 	BuildProcess();
@@ -15,6 +16,7 @@ public:
 
 	bool Execute(const wxString &cmd, const wxString &fileName, const wxString &workingDirectory, wxEvtHandler *evtHandler);
 	void Stop();
+	void Terminate();
 	bool IsBusy();
 
 	void SetFileName(const wxString& fileName) {
@@ -24,6 +26,19 @@ public:
 		return m_fileName;
 	}
 
+	// The output is kept until the process ends: the output of compilations
+	// running in parallel must not be mixed
+	void AppendOutput(const wxString& output) {
+		this->m_output << output;
+	}
+	const wxString& GetOutput() const {
+		return m_output;
+	}
+
+	IProcess* GetProcess() const {
+		return m_process;
+	}
+
 	int GetPid() const {
 		if(m_process) {
 			return m_process->GetPid();
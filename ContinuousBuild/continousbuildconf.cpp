@@ -1,7 +1,7 @@
 #include "continousbuildconf.h"
 ContinousBuildConf::ContinousBuildConf()
 		: m_enabled(false)
-		, m_parallelProcesses(1)
+		, m_parallelProcesses(0)
 {
 }
 
@@ -4,16 +4,30 @@
 #include <wx/msgdlg.h>
 #include "imanager.h"
 #include "drawingutils.h"
+#include <wx/sizer.h>
 
 ContinousBuildPane::ContinousBuildPane( wxWindow* parent, IManager *manager, ContinuousBuild *plugin )
 		: ContinousBuildBasePane( parent )
 		, m_mgr(manager)
 		, m_plugin(plugin)
+		, m_spinParallelProcesses(NULL)
 {
 	ContinousBuildConf conf;
 	m_mgr->GetConfigTool()->ReadObject(wxT("ContinousBuildConf"), &conf);
 	m_checkBox1->SetValue(conf.GetEnabled());
 
+	// The number of files compiled at the same time
+	wxSizer* sizer = m_checkBox1->GetContainingSizer();
+	if (sizer) {
+		wxStaticText* label = new wxStaticText(this, wxID_ANY, _("Parallel compilations:"));
+		m_spinParallelProcesses = new wxSpinCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(60, -1), wxSP_ARROW_KEYS, 0, 64, (int)conf.GetParallelProcesses());
+		m_spinParallelProcesses->SetToolTip(_("The number of files compiled at the same time. 0: one per CPU"));
+		sizer->Insert(1, label, 0, wxALIGN_CENTER_VERTICAL|wxLEFT, 10);
+		sizer->Insert(2, m_spinParallelProcesses, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+		m_spinParallelProcesses->Connect(wxEVT_COMMAND_SPINCTRL_UPDATED, wxSpinEventHandler(ContinousBuildPane::OnParallelProcesses), NULL, this);
+		Layout();
+	}
+
 	m_listBoxQueue->SetForegroundColour(DrawingUtils::GetOutputPaneFgColour());
 	m_listBoxQueue->SetBackgroundColour(DrawingUtils::GetOutputPaneBgColour());
 }
@@ -75,6 +89,15 @@ void ContinousBuildPane::OnEnableContBuildUI(wxUpdateUIEvent& event)
 void ContinousBuildPane::OnEnableCB(wxCommandEvent& event)
 {
 	ContinousBuildConf conf;
+	m_mgr->GetConfigTool()->ReadObject(wxT("ContinousBuildConf"), &conf);
 	conf.SetEnabled(event.IsChecked());
 	m_mgr->GetConfigTool()->WriteObject(wxT("ContinousBuildConf"), &conf);
 }
+
+void ContinousBuildPane::OnParallelProcesses(wxSpinEvent& event)
+{
+	ContinousBuildConf conf;
+	m_mgr->GetConfigTool()->ReadObject(wxT("ContinousBuildConf"), &conf);
+	conf.SetParallelProcesses((size_t)event.GetPosition());
+	m_mgr->GetConfigTool()->WriteObject(wxT("ContinousBuildConf"), &conf);
+}
@@ -7,6 +7,7 @@ Subclass of ContinousBuildBasePane, which is generated by wxFormBuilder.
 */
 
 #include "continousbuildbasepane.h"
+#include <wx/spinctrl.h>
 class IManager;
 class ContinuousBuild;
 
@@ -15,6 +16,7 @@ class ContinousBuildPane : public ContinousBuildBasePane
 {
 	IManager *       m_mgr;
 	ContinuousBuild *m_plugin;
+	wxSpinCtrl *     m_spinParallelProcesses;
 
 protected:
 	// Handlers for ContinousBuildBasePane events.
@@ -33,6 +35,7 @@ protected:
 	 * @param event
 	 */
 	virtual void OnEnableContBuildUI( wxUpdateUIEvent& event );
+	void OnParallelProcesses( wxSpinEvent& event );
 
 public:
 	/** Constructor */
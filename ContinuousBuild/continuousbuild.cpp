@@ -18,6 +18,7 @@
 #include <wx/log.h>
 #include <wx/imaglist.h>
 #include "cl_command_event.h"
+#include <wx/thread.h>
 
 static ContinuousBuild* thePlugin = NULL;
 //Define the plugin entry point
@@ -47,13 +48,20 @@ extern "C" EXPORT int GetPluginInterfaceVersion()
 BEGIN_EVENT_TABLE(ContinuousBuild, IPlugin)
     EVT_COMMAND(wxID_ANY, wxEVT_PROC_DATA_READ,  ContinuousBuild::OnBuildProcessOutput)
     EVT_COMMAND(wxID_ANY, wxEVT_PROC_TERMINATED, ContinuousBuild::OnBuildProcessEnded)
+    EVT_TIMER(wxID_ANY, ContinuousBuild::OnTimer)
 END_EVENT_TABLE()
 
 static const wxString CONT_BUILD = wxT("BuildQ");
 
+// Successive saves (e.g. "Save All") are compiled together once no file
+// was saved for this long
+#define CONT_BUILD_SAVE_DELAY 500
+
 ContinuousBuild::ContinuousBuild(IManager *manager)
     : IPlugin(manager)
+    , m_timer(this)
     , m_buildInProgress(false)
+    , m_sessionStarted(false)
 {
     m_longName = _("Continuous build plugin which compiles files on save and report errors");
     m_shortName = wxT("ContinuousBuild");
@@ -92,6 +100,9 @@ void ContinuousBuild::HookPopupMenu(wxMenu *menu, MenuType type)
 
 void ContinuousBuild::UnPlug()
 {
+    m_timer.Stop();
+    DoClearProcesses();
+
     // before this plugin is un-plugged we must remove the tab we added
     for (size_t i=0; i<m_mgr->GetOutputPaneNotebook()->GetPageCount(); i++) {
         if (m_view == m_mgr->GetOutputPaneNotebook()->GetPage(i)) {
@@ -119,19 +130,143 @@ void ContinuousBuild::OnFileSaved(wxCommandEvent& e)
     m_mgr->GetConfigTool()->ReadObject(wxT("ContinousBuildConf"), &conf);
 
     if (conf.GetEnabled()) {
-        DoBuild( e.GetString() );
+        // The compilation of the previous version of the file is useless now
+        wxString fileName = e.GetString();
+        if (DoCancel(fileName)) {
+            CL_DEBUG(wxString::Format(wxT("Cancelled the compilation of %s\n"), fileName.c_str()));
+        }
+
+        // Wait for the saves to settle
+        if (m_savedFiles.Index(fileName) == wxNOT_FOUND) {
+            m_savedFiles.Add(fileName);
+        }
+        m_timer.Start(CONT_BUILD_SAVE_DELAY, wxTIMER_ONE_SHOT);
+
     } else {
         CL_DEBUG(wxT("ContinuousBuild is disabled\n"));
     }
 }
 
-void ContinuousBuild::DoBuild(const wxString& fileName)
+void ContinuousBuild::OnTimer(wxTimerEvent& e)
+{
+    wxUnusedVar(e);
+    DoScheduleSavedFiles();
+}
+
+size_t ContinuousBuild::DoGetParallelProcesses()
+{
+    ContinousBuildConf conf;
+    m_mgr->GetConfigTool()->ReadObject(wxT("ContinousBuildConf"), &conf);
+
+    // 0 means: one compilation per CPU
+    size_t count = conf.GetParallelProcesses();
+    if (count == 0) {
+        int cpus = wxThread::GetCPUCount();
+        count = cpus > 0 ? (size_t)cpus : 1;
+    }
+    return count;
+}
+
+void ContinuousBuild::DoScheduleSavedFiles()
+{
+    wxArrayString savedFiles = m_savedFiles;
+    m_savedFiles.Clear();
+
+    if (m_buildInProgress || !m_mgr->IsWorkspaceOpen()) {
+        DoStartQueued();
+        return;
+    }
+
+    // A header is replaced by the sources that include it
+    wxArrayString files;
+    for (size_t i=0; i<savedFiles.GetCount(); i++) {
+        const wxString& fileName = savedFiles.Item(i);
+        if (FileExtManager::GetType(fileName) == FileExtManager::TypeHeader) {
+            m_dependencies.GetSources(m_mgr, fileName, files);
+            CL_DEBUG(wxString::Format(wxT("%s: %u affected source(s)\n"), fileName.c_str(), (unsigned int)files.GetCount()));
+
+        } else if (files.Index(fileName) == wxNOT_FOUND) {
+            files.Add(fileName);
+        }
+    }
+
+    for (size_t i=0; i<files.GetCount(); i++) {
+        const wxString& fileName = files.Item(i);
+
+        // A source compiled while one of its headers was saved must be compiled again
+        DoCancel(fileName);
+        if (m_files.Index(fileName) == wxNOT_FOUND) {
+            m_files.Add(fileName);
+            m_view->AddFile(fileName);
+        }
+    }
+    DoStartQueued();
+}
+
+void ContinuousBuild::DoStartQueued()
+{
+    size_t parallelProcesses = DoGetParallelProcesses();
+    while (m_buildProcesses.size() < parallelProcesses && m_files.IsEmpty() == false) {
+        wxString fileName = m_files.Item(0);
+        m_files.RemoveAt(0);
+
+        if (!DoBuild(fileName)) {
+            m_view->RemoveFile(fileName);
+        }
+    }
+
+    if (m_sessionStarted && m_buildProcesses.empty()) {
+        // All the files were compiled
+        m_sessionStarted = false;
+        clCommandEvent event(wxEVT_SHELL_COMMAND_PROCESS_ENDED);
+        EventNotifier::Get()->AddPendingEvent(event);
+    }
+}
+
+bool ContinuousBuild::DoCancel(const wxString& fileName)
+{
+    BuildProcessList_t::iterator iter = m_buildProcesses.begin();
+    for (; iter != m_buildProcesses.end(); iter++) {
+        if ((*iter)->GetFileName() == fileName) {
+            DoKill(*iter);
+            m_buildProcesses.erase(iter);
+            m_view->RemoveFile(fileName);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ContinuousBuild::DoKill(BuildProcess* buildProcess)
+{
+    // The process is only killed here: events carrying its IProcess may already be
+    // queued. It is deleted once its own termination event arrives, so its address
+    // can't be reused by another compilation in the meantime
+    buildProcess->Terminate();
+    m_cancelledProcesses.push_back(buildProcess);
+}
+
+void ContinuousBuild::DoClearProcesses()
+{
+    BuildProcessList_t::iterator iter = m_buildProcesses.begin();
+    for (; iter != m_buildProcesses.end(); iter++) {
+        delete (*iter);
+    }
+    m_buildProcesses.clear();
+
+    for (iter = m_cancelledProcesses.begin(); iter != m_cancelledProcesses.end(); iter++) {
+        delete (*iter);
+    }
+    m_cancelledProcesses.clear();
+}
+
+bool ContinuousBuild::DoBuild(const wxString& fileName)
 {
     CL_DEBUG(wxT("DoBuild\n"));
     // Make sure a workspace is opened
     if (!m_mgr->IsWorkspaceOpen()) {
         CL_DEBUG(wxT("No workspace opened!\n"));
-        return;
+        return false;
     }
 
 
@@ -145,117 +280,150 @@ void ContinuousBuild::DoBuild(const wxString& fileName)
 
     default: {
         CL_DEBUG(wxT("Non source file\n"));
-        return;
+        return false;
     }
     }
 
     wxString projectName = m_mgr->GetProjectNameByFile(fileName);
     if(projectName.IsEmpty()) {
         CL_DEBUG(wxT("Project name is empty\n"));
-        return;
+        return false;
     }
 
     wxString errMsg;
     ProjectPtr project = m_mgr->GetWorkspace()->FindProjectByName(projectName, errMsg);
     if(!project) {
         CL_DEBUG(wxT("Could not find project for file\n"));
-        return;
+        return false;
     }
 
     // get the selected configuration to be build
     BuildConfigPtr bldConf = m_mgr->GetWorkspace()->GetProjBuildConf( project->GetName(), wxEmptyString );
     if ( !bldConf ) {
         CL_DEBUG(wxT("Failed to locate build configuration\n"));
-        return;
+        return false;
     }
 
     BuilderPtr builder = m_mgr->GetBuildManager()->GetBuilder( wxT( "GNU makefile for g++/gcc" ) );
     if(!builder) {
         CL_DEBUG(wxT("Failed to located builder\n"));
-        return;
+        return false;
     }
 
     // Only normal file builds are supported
     if(bldConf->IsCustomBuild()) {
         CL_DEBUG(wxT("Build is custom. Skipping\n"));
-        return;
+        return false;
     }
 
     // get the single file command to use
     wxString cmd      = builder->GetSingleFileCmd(projectName, bldConf->GetName(), fileName);
     WrapInShell(cmd);
 
-    if( m_buildProcess.IsBusy() ) {
-        // add the build to the queue
-        if (m_files.Index(fileName) == wxNOT_FOUND) {
-            m_files.Add(fileName);
-
-            // update the UI
-            m_view->AddFile(fileName);
-        }
-        return;
+    if (!m_sessionStarted) {
+        // The compilations running together share a single session of the build tab
+        m_sessionStarted = true;
+        clCommandEvent event(wxEVT_SHELL_COMMAND_STARTED);
+
+        // Associate the build event details
+        BuildEventDetails *eventData = new BuildEventDetails();
+        eventData->SetProjectName(projectName);
+        eventData->SetConfiguration(bldConf->GetName());
+        eventData->SetIsCustomProject(bldConf->IsCustomBuild());
+        eventData->SetIsClean(false);
+
+        event.SetClientObject(eventData);
+        // Fire it up
+        EventNotifier::Get()->AddPendingEvent(event);
     }
 
-    clCommandEvent event(wxEVT_SHELL_COMMAND_STARTED);
-
-    // Associate the build event details
-    BuildEventDetails *eventData = new BuildEventDetails();
-    eventData->SetProjectName(projectName);
-    eventData->SetConfiguration(bldConf->GetName());
-    eventData->SetIsCustomProject(bldConf->IsCustomBuild());
-    eventData->SetIsClean(false);
-
-    event.SetClientObject(eventData);
-    // Fire it up
-    EventNotifier::Get()->AddPendingEvent(event);
-
     EnvSetter env(NULL, NULL, projectName);
     CL_DEBUG(wxString::Format(wxT("cmd:%s\n"), cmd.c_str()));
-    if(!m_buildProcess.Execute(cmd, fileName, project->GetFileName().GetPath(), this))
-        return;
+    BuildProcess* buildProcess = new BuildProcess();
+    if(!buildProcess->Execute(cmd, fileName, project->GetFileName().GetPath(), this)) {
+        delete buildProcess;
+        return false;
+    }
+    m_buildProcesses.push_back(buildProcess);
 
     // Set some messages
     m_mgr->SetStatusMessage(wxString::Format(wxT("%s %s..."), _("Compiling"), wxFileName(fileName).GetFullName().c_str()), 0);
 
     // Add this file to the UI queue
     m_view->AddFile(fileName);
+    return true;
+}
+
+BuildProcess* ContinuousBuild::DoFindProcess(IProcess* process)
+{
+    BuildProcessList_t::iterator iter = m_buildProcesses.begin();
+    for (; iter != m_buildProcesses.end(); iter++) {
+        if ((*iter)->GetProcess() == process) {
+            return *iter;
+        }
+    }
+    return NULL;
 }
 
 void ContinuousBuild::OnBuildProcessEnded(wxCommandEvent& e)
 {
-    // remove the file from the UI
     ProcessEventData *ped = (ProcessEventData*)e.GetClientData();
+    IProcess* process = ped->GetProcess();
     delete ped;
 
-    int pid = m_buildProcess.GetPid();
-    m_view->RemoveFile(m_buildProcess.GetFileName());
+    // A compilation that was cancelled: it can be released now
+    BuildProcessList_t::iterator iter = m_cancelledProcesses.begin();
+    for (; iter != m_cancelledProcesses.end(); iter++) {
+        if ((*iter)->GetProcess() == process) {
+            delete (*iter);
+            m_cancelledProcesses.erase(iter);
+            return;
+        }
+    }
+
+    BuildProcess* buildProcess = DoFindProcess(process);
+    if (!buildProcess) {
+        return;
+    }
+
+    // remove the file from the UI
+    int pid = buildProcess->GetPid();
+    m_view->RemoveFile(buildProcess->GetFileName());
 
-    clCommandEvent event(wxEVT_SHELL_COMMAND_PROCESS_ENDED);
-    EventNotifier::Get()->AddPendingEvent(event);
+    if (buildProcess->GetOutput().IsEmpty() == false) {
+        clCommandEvent event(wxEVT_SHELL_COMMAND_ADDLINE);
+        event.SetString(buildProcess->GetOutput());
+        EventNotifier::Get()->AddPendingEvent(event);
+    }
 
     int exitCode(-1);
     if(IProcess::GetProcessExitCode(pid, exitCode) && exitCode != 0) {
-        m_view->AddFailedFile(m_buildProcess.GetFileName());
+        m_view->AddFailedFile(buildProcess->GetFileName());
     }
 
     // Release the resources allocted for this build
-    m_buildProcess.Stop();
+    m_buildProcesses.remove(buildProcess);
+    delete buildProcess;
 
     // if the queue is not empty, start another build
-    if (m_files.IsEmpty() == false) {
-
-        wxString fileName = m_files.Item(0);
-        m_files.RemoveAt(0);
-
-        DoBuild(fileName);
-    }
+    DoStartQueued();
 }
 
 void ContinuousBuild::StopAll()
 {
     // empty the queue
     m_files.Clear();
-    m_buildProcess.Stop();
+    m_savedFiles.Clear();
+    m_timer.Stop();
+
+    BuildProcessList_t::iterator iter = m_buildProcesses.begin();
+    for (; iter != m_buildProcesses.end(); iter++) {
+        DoKill(*iter);
+    }
+    m_buildProcesses.clear();
+
+    // End the session of the build tab
+    DoStartQueued();
 }
 
 void ContinuousBuild::OnIgnoreFileSaved(wxCommandEvent& e)
@@ -266,6 +434,8 @@ void ContinuousBuild::OnIgnoreFileSaved(wxCommandEvent& e)
 
     // Clear the queue
     m_files.Clear();
+    m_savedFiles.Clear();
+    m_timer.Stop();
 
     // Clear the view
     m_view->ClearAll();
@@ -281,9 +451,11 @@ void ContinuousBuild::OnBuildProcessOutput(wxCommandEvent& e)
 {
     ProcessEventData *ped = (ProcessEventData*)e.GetClientData();
 
-    clCommandEvent event(wxEVT_SHELL_COMMAND_ADDLINE);
-    event.SetString(ped->GetData());
-    EventNotifier::Get()->AddPendingEvent(event);
+    // The output is sent to the build tab once the compilation ends
+    BuildProcess* buildProcess = DoFindProcess(ped->GetProcess());
+    if (buildProcess) {
+        buildProcess->AppendOutput(ped->GetData());
+    }
 
     //m_mgr->AddBuildOuptut(ped->GetData(), false);
     delete ped;
@@ -3,7 +3,10 @@
 
 #include "plugin.h"
 #include "buildprocess.h"
+#include "dependencymap.h"
 #include "compiler.h"
+#include <wx/timer.h>
+#include <list>
 
 class wxEvtHandler;
 class ContinousBuildPane;
@@ -11,14 +14,30 @@ class ShellCommand;
 
 class ContinuousBuild : public IPlugin
 {
+	typedef std::list<BuildProcess*> BuildProcessList_t;
+
 	ContinousBuildPane *m_view;
 	wxEvtHandler *      m_topWin;
-	BuildProcess        m_buildProcess;
-	wxArrayString       m_files;
+	BuildProcessList_t  m_buildProcesses; // the compilations running
+	BuildProcessList_t  m_cancelledProcesses; // killed, waiting for their termination event
+	wxArrayString       m_files;          // the files waiting to be compiled
+	wxArrayString       m_savedFiles;     // the files saved, waiting for the saves to settle
+	wxTimer             m_timer;
+	DependencyMap       m_dependencies;
 	bool                m_buildInProgress;
+	bool                m_sessionStarted;
+
+protected:
+	size_t      DoGetParallelProcesses();
+	void        DoScheduleSavedFiles();
+	void        DoStartQueued();
+	bool        DoCancel(const wxString &fileName);
+	void        DoKill(BuildProcess *buildProcess);
+	BuildProcess* DoFindProcess(IProcess *process);
+	void        DoClearProcesses();
 
 public:
-	void        DoBuild(const wxString &fileName);
+	bool        DoBuild(const wxString &fileName);
 
 public:
 	ContinuousBuild(IManager *manager);
@@ -42,6 +61,7 @@ public:
 	void OnStopIgnoreFileSaved (wxCommandEvent &e);
 	void OnBuildProcessEnded   (wxCommandEvent &e);
 	void OnBuildProcessOutput  (wxCommandEvent &e);
+	void OnTimer               (wxTimerEvent &e);
 };
 
 #endif //ContinuousBuild
@@ -0,0 +1,100 @@
+#include "dependencymap.h"
+#include "imanager.h"
+#include "workspace.h"
+#include "build_config.h"
+#include "compiler.h"
+#include "globals.h"
+#include "build_statistics.h"
+#include <wx/filename.h>
+#include <wx/dir.h>
+#include <wx/log.h>
+
+DependencyMap::DependencyMap()
+{
+}
+
+DependencyMap::~DependencyMap()
+{
+}
+
+void DependencyMap::DoGetDepFiles(IManager* mgr, const wxString& projectName, wxArrayString& depFiles, wxString& projectPath)
+{
+	Workspace* workspace = mgr->GetWorkspace();
+
+	wxString errMsg;
+	ProjectPtr project = workspace->FindProjectByName(projectName, errMsg);
+	if ( !project )
+		return;
+
+	// Only our Makefiles generate the dependency files
+	BuildConfigPtr bldConf = workspace->GetProjBuildConf(projectName, wxEmptyString);
+	if ( !bldConf || bldConf->IsCustomBuild() )
+		return;
+
+	CompilerPtr cmp = bldConf->GetCompiler();
+	if ( !cmp || cmp->GetDependSuffix().IsEmpty() )
+		return;
+
+	projectPath = project->GetFileName().GetPath();
+
+	wxString intermediateDir = ExpandAllVariables(bldConf->GetIntermediateDirectory(), workspace, projectName, bldConf->GetName(), wxEmptyString);
+	wxFileName dir = wxFileName::DirName(intermediateDir);
+	dir.MakeAbsolute(projectPath);
+	if ( !dir.DirExists() )
+		return;
+
+	wxDir::GetAllFiles(dir.GetPath(), &depFiles, wxT("*") + cmp->GetDependSuffix(), wxDIR_FILES);
+}
+
+void DependencyMap::GetSources(IManager* mgr, const wxString& header, wxArrayString& sources)
+{
+	if ( !mgr->IsWorkspaceOpen() )
+		return;
+
+	wxLogNull nl;
+	wxFileName fnHeader(header);
+	fnHeader.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE);
+	wxString headerPath = fnHeader.GetFullPath();
+
+	wxArrayString projects;
+	mgr->GetWorkspace()->GetProjectList(projects);
+
+	DepFileMap_t depFiles;
+	for (size_t i=0; i<projects.GetCount(); i++) {
+		wxArrayString files;
+		wxString projectPath;
+		DoGetDepFiles(mgr, projects.Item(i), files, projectPath);
+
+		for (size_t n=0; n<files.GetCount(); n++) {
+			const wxString& file = files.Item(n);
+			time_t modified = wxFileName(file).GetModificationTime().GetTicks();
+
+			// Parse the file again only if it was modified since it was cached
+			DepFileMap_t::iterator iter = m_depFiles.find(file);
+			if ( iter != m_depFiles.end() && iter->second.m_modified == modified ) {
+				depFiles[file] = iter->second;
+
+			} else {
+				DepFile& depFile = depFiles[file];
+				depFile.m_modified = modified;
+				BuildStatistics::ReadDependencies(file, wxEmptyString, projectPath, depFile.m_files);
+			}
+		}
+	}
+
+	// Entries of files that no longer exist are dropped
+	m_depFiles.swap(depFiles);
+
+	DepFileMap_t::const_iterator iter = m_depFiles.begin();
+	for (; iter != m_depFiles.end(); ++iter) {
+		const wxArrayString& files = iter->second.m_files;
+		for (size_t i=1; i<files.GetCount(); i++) {
+			if ( files.Item(i) == headerPath ) {
+				if ( sources.Index(files.Item(0)) == wxNOT_FOUND ) {
+					sources.Add(files.Item(0));
+				}
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,44 @@
+#ifndef __dependencymap__
+#define __dependencymap__
+
+#include <wx/string.h>
+#include <wx/arrstr.h>
+#include <map>
+
+class IManager;
+
+/**
+ * @class DependencyMap
+ * @brief find the sources affected by a header, using the dependency files (*.o.d)
+ * generated by the last builds of the workspace projects. A dependency file is parsed
+ * again only when it changes
+ */
+class DependencyMap
+{
+	struct DepFile {
+		time_t        m_modified;
+		wxArrayString m_files; // the source first, then the headers it includes
+	};
+	typedef std::map<wxString, DepFile> DepFileMap_t;
+
+	DepFileMap_t m_depFiles;
+
+protected:
+	void DoGetDepFiles(IManager *mgr, const wxString &projectName, wxArrayString &depFiles, wxString &projectPath);
+
+public:
+	DependencyMap();
+	virtual ~DependencyMap();
+
+	/**
+	 * @brief add to 'sources' the sources of the workspace that include 'header'
+	 * (directly or not). 'header' is a full path
+	 */
+	void GetSources(IManager *mgr, const wxString &header, wxArrayString &sources);
+
+	void Clear() {
+		m_depFiles.clear();
+	}
+};
+
+#endif // __dependencymap__
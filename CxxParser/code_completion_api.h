@@ -5,6 +5,7 @@
 #include "variable.h"
 #include "function.h"
 #include "expression_result.h"
+#include "cl_parser_state.h"
 
 extern WXDLLIMPEXP_CL std::string       get_scope_name(const std::string &in, std::vector<std::string > &additionlNS, const std::map<std::string, std::string> &ignoreTokens);
 extern WXDLLIMPEXP_CL void              get_variables(const std::string &in, VariableList &li, const std::map<std::string, std::string> &ignoreMap, bool isUsedWithinFunc);
@@ -15,11 +16,20 @@ extern WXDLLIMPEXP_CL ExpressionResult &parse_expression(const std::string &in);
 extern WXDLLIMPEXP_CL bool              setLexerInput(const std::string &in, const std::map<std::string, std::string> &ignoreTokens);
 extern WXDLLIMPEXP_CL void              cl_scope_lex_clean();
 
+// Reentrant variants: run the parser on 'state' instead of the calling thread's
+// own state. A state must not be used by two threads at the same time
+extern WXDLLIMPEXP_CL std::string       get_scope_name(clParserState &state, const std::string &in, std::vector<std::string > &additionlNS, const std::map<std::string, std::string> &ignoreTokens);
+extern WXDLLIMPEXP_CL void              get_variables(clParserState &state, const std::string &in, VariableList &li, const std::map<std::string, std::string> &ignoreMap, bool isUsedWithinFunc);
+extern WXDLLIMPEXP_CL bool              is_primitive_type(clParserState &state, const std::string &in);
+extern WXDLLIMPEXP_CL void              get_functions(clParserState &state, const std::string &in, FunctionList &li, const std::map<std::string, std::string> &ignoreTokens);
+extern WXDLLIMPEXP_CL void              get_typedefs(clParserState &state, const std::string &in, clTypedefList &li);
+extern WXDLLIMPEXP_CL ExpressionResult &parse_expression(clParserState &state, const std::string &in);
+
 // We dont use WXDLLIMPEXP_CL intentionally to avoid people using these members/functions
 // directly
 extern int cl_scope_lex();
-extern int cl_scope_lineno;
-extern std::string cl_scope_text;
+extern int cl_scope_lex_lineno();
+extern char* cl_scope_lex_text();
 
 class WXDLLIMPEXP_CL CppLexer
 {
@@ -38,10 +48,10 @@ public:
         return cl_scope_lex();
     }
     int line_number() const {
-        return cl_scope_lineno;
+        return cl_scope_lex_lineno();
     }
     std::string text() const {
-        return cl_scope_text;
+        return cl_scope_lex_text();
     }
 };
 #endif // CODECOMPLETION_API_H
@@ -38,6 +38,7 @@ static char yysccsid[] = "@(#)yaccpar	1.9 (Berkeley) 02/21/93";
 #include "vector"
 #include "stdio.h"
 #include "map"
+#include "cl_parser_state.h"
 #include "expression_result.h"
 
 #define YYSTYPE std::string
@@ -45,18 +46,20 @@ static char yysccsid[] = "@(#)yaccpar	1.9 (Berkeley) 02/21/93";
 
 void cl_expr_error(char *string);
 
-static ExpressionResult result;
-
 /*---------------------------------------------*/
 /* externs defined in the lexer*/
 /*---------------------------------------------*/
-extern char *cl_expr_text;
+extern char* cl_expr_lex_text();
+#define cl_expr_text cl_expr_lex_text()
 extern int cl_expr_lex();
 extern int cl_expr_parse();
-extern int cl_expr_lineno;
-extern std::vector<std::string> currentScope;
+extern int cl_expr_lex_lineno();
+#define cl_expr_lineno cl_expr_lex_lineno()
+extern std::vector<std::string>& cl_scope_lex_current_scope();
+#define currentScope cl_scope_lex_current_scope()
 extern bool setExprLexerInput(const std::string &in);
 extern void cl_expr_lex_clean();
+extern const std::string& cl_expr_lex_lval();
 
 /*************** Standard ytab.c continues here *********************/
 #define LE_AUTO 257
@@ -399,17 +402,53 @@ typedef int YYSTYPE;
 #define YYMAXDEPTH 500
 #endif
 #endif
-int yydebug;
-int yynerrs;
-int yyerrflag;
-int yychar;
-short *yyssp;
-YYSTYPE *yyvsp;
-YYSTYPE yyval;
-YYSTYPE yylval;
-short yyss[YYSTACKSIZE];
-YYSTYPE yyvs[YYSTACKSIZE];
 #define yystacksize YYSTACKSIZE
+/*
+ * The parser state: the variables byacc generates as globals and the parser's
+ * own statics live in the clParserState of the calling thread (see
+ * cl_parser_state.h). Every function using them declares:
+ * clExprParserState* yyps = cl_expr_parser_state();
+ */
+struct clExprParserState : public clParserStateModule
+{
+    int               yydebug_r;
+    int               yynerrs_r;
+    int               yyerrflag_r;
+    int               yychar_r;
+    short            *yyssp_r;
+    YYSTYPE          *yyvsp_r;
+    YYSTYPE           yyval_r;
+    short             yyss_r[YYSTACKSIZE];
+    YYSTYPE           yyvs_r[YYSTACKSIZE];
+
+    ExpressionResult  result_r;
+
+    clExprParserState()
+        : yydebug_r(0)
+        , yynerrs_r(0)
+        , yyerrflag_r(0)
+        , yychar_r(0)
+        , yyssp_r(NULL)
+        , yyvsp_r(NULL)
+    {}
+};
+
+static clExprParserState* cl_expr_parser_state()
+{
+    return clParserState::Current()->GetModule<clExprParserState>(clParserState::kExprParser);
+}
+
+#define cl_expr_debug    yyps->yydebug_r
+#define cl_expr_nerrs    yyps->yynerrs_r
+#define cl_expr_errflag  yyps->yyerrflag_r
+#define cl_expr_char     yyps->yychar_r
+#define cl_expr_ssp      yyps->yyssp_r
+#define cl_expr_vsp      yyps->yyvsp_r
+#define cl_expr_val      yyps->yyval_r
+#define cl_expr_ss       yyps->yyss_r
+#define cl_expr_vs       yyps->yyvs_r
+#define cl_expr_lval     cl_expr_lex_lval()
+#define result           yyps->result_r
 void yyerror(char *s) {}
 
 void expr_consumBracketsContent(char openBrace)
@@ -508,6 +547,7 @@ void expr_syncParser(){
 // return the scope name at the end of the input string
 ExpressionResult &parse_expression(const std::string &in)
 {
+	clExprParserState* yyps = cl_expr_parser_state();
 	result.Reset();
 	//provide the lexer with new input
 	if( !setExprLexerInput(in) ){
@@ -528,6 +568,7 @@ ExpressionResult &parse_expression(const std::string &in)
 int
 yyparse()
 {
+    clExprParserState* yyps = cl_expr_parser_state();
     register int yym, yyn, yystate;
 #if YYDEBUG
     register char *yys;
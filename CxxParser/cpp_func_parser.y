@@ -8,6 +8,7 @@
 #include "vector"
 #include "stdio.h"
 #include "map"
+#include "cl_parser_state.h"
 #include "function.h"
 
 #define YYDEBUG_LEXER_TEXT (cl_func_lval)
@@ -22,18 +23,16 @@
 int cl_func_parse();
 void cl_func_error(char *string);
 
-static FunctionList *g_funcs = NULL;
-static clFunction curr_func;
-
 //---------------------------------------------
 // externs defined in the lexer
 //---------------------------------------------
 extern char *cl_func_text;
 extern int cl_scope_lex();
 extern bool setLexerInput(const std::string &in, const std::map<std::string, std::string> &ignoreTokens);
-extern int cl_scope_lineno;
+extern int cl_scope_lex_lineno();
+#define cl_scope_lineno cl_scope_lex_lineno()
 extern void cl_scope_lex_clean();
-
+extern const std::string& cl_scope_lex_lval();
 
 /*************** Standard ytab.c continues here *********************/
 %}
@@ -309,10 +308,60 @@ variable_decl		:	nested_scope_specifier basic_type_name special_star_amp
 							}
 						;
 %%
+/*
+ * The parser state: the variables byacc generates as globals and the parser's
+ * own statics live in the clParserState of the calling thread (see
+ * cl_parser_state.h). Every function using them declares:
+ * clFuncParserState* yyps = cl_func_parser_state();
+ */
+struct clFuncParserState : public clParserStateModule
+{
+    int             yydebug_r;
+    int             yynerrs_r;
+    int             yyerrflag_r;
+    int             yychar_r;
+    short          *yyssp_r;
+    YYSTYPE        *yyvsp_r;
+    YYSTYPE         yyval_r;
+    short           yyss_r[YYSTACKSIZE];
+    YYSTYPE         yyvs_r[YYSTACKSIZE];
+
+    FunctionList   *g_funcs_r;
+    clFunction      curr_func_r;
+
+    clFuncParserState()
+        : yydebug_r(0)
+        , yynerrs_r(0)
+        , yyerrflag_r(0)
+        , yychar_r(0)
+        , yyssp_r(NULL)
+        , yyvsp_r(NULL)
+        , g_funcs_r(NULL)
+    {}
+};
+
+static clFuncParserState* cl_func_parser_state()
+{
+    return clParserState::Current()->GetModule<clFuncParserState>(clParserState::kFuncParser);
+}
+
+#define cl_func_debug    yyps->yydebug_r
+#define cl_func_nerrs    yyps->yynerrs_r
+#define cl_func_errflag  yyps->yyerrflag_r
+#define cl_func_char     yyps->yychar_r
+#define cl_func_ssp      yyps->yyssp_r
+#define cl_func_vsp      yyps->yyvsp_r
+#define cl_func_val      yyps->yyval_r
+#define cl_func_ss       yyps->yyss_r
+#define cl_func_vs       yyps->yyvs_r
+#define cl_func_lval     cl_scope_lex_lval()
+#define g_funcs          yyps->g_funcs_r
+#define curr_func        yyps->curr_func_r
 void yyerror(char *s) {}
 
 void func_consumeFuncArgList()
 {
+	clFuncParserState* yyps = cl_func_parser_state();
 	curr_func.m_signature = "(";
 
 	int depth = 1;
@@ -396,6 +445,7 @@ void func_consumeTemplateDecl()
 // return the scope name at the end of the input string
 void get_functions(const std::string &in, FunctionList &li, const std::map<std::string, std::string> &ignoreTokens)
 {
+	clFuncParserState* yyps = cl_func_parser_state();
 	if( !setLexerInput(in, ignoreTokens) )
 	{
 		return;
@@ -117,9 +117,6 @@
 
 typedef struct yy_buffer_state *YY_BUFFER_STATE;
 
-extern int yyleng;
-extern FILE *yyin, *yyout;
-
 #define EOB_ACT_CONTINUE_SCAN 0
 #define EOB_ACT_END_OF_FILE 1
 #define EOB_ACT_LAST_MATCH 2
@@ -217,8 +214,6 @@ struct yy_buffer_state
 #define YY_BUFFER_EOF_PENDING 2
 	};
 
-static YY_BUFFER_STATE yy_current_buffer = 0;
-
 /* We provide macros for accessing buffer states in case in the
  * future we want to put the buffer states in a more general
  * "scanner state".
@@ -226,23 +221,9 @@ static YY_BUFFER_STATE yy_current_buffer = 0;
 #define YY_CURRENT_BUFFER yy_current_buffer
 
 
-/* yy_hold_char holds the character lost when yytext is formed. */
-static char yy_hold_char;
-
-static int yy_n_chars;		/* number of characters read into yy_ch_buf */
-
-
-int yyleng;
-
-/* Points to current character in buffer. */
-static char *yy_c_buf_p = (char *) 0;
-static int yy_init = 1;		/* whether we need to initialize */
-static int yy_start = 0;	/* start state number */
-
-/* Flag which is used to allow yywrap()'s to do buffer switches
- * instead of setting up a fresh yyin.  A bit of a hack ...
+/* The scanner variables (yy_hold_char, yy_c_buf_p, yy_start...) are part
+ * of the scanner state, see clScopeLexerState below
  */
-static int yy_did_buffer_switch_on_eof;
 
 void yyrestart YY_PROTO(( FILE *input_file ));
 
@@ -283,11 +264,7 @@ static void yy_flex_free YY_PROTO(( void * ));
 
 #define YY_USES_REJECT
 typedef unsigned char YY_CHAR;
-FILE *yyin = (FILE *) 0, *yyout = (FILE *) 0;
 typedef int yy_state_type;
-extern int yylineno;
-int yylineno = 1;
-extern char *yytext;
 #define yytext_ptr yytext
 
 static yy_state_type yy_get_previous_state YY_PROTO(( void ));
@@ -812,9 +789,6 @@ static yyconst short int yy_chk[924] =
       484,  484,  484
     } ;
 
-static yy_state_type yy_state_buf[YY_BUF_SIZE + 2], *yy_state_ptr;
-static char *yy_full_match;
-static int yy_lp;
 #define REJECT \
 { \
 *yy_cp = yy_hold_char; /* undo effects of setting up yytext */ \
@@ -825,7 +799,6 @@ goto find_rule; \
 #define yymore() yymore_used_but_not_detected
 #define YY_MORE_ADJ 0
 #define YY_RESTORE_YY_MORE_OFFSET
-char *yytext;
 #define INITIAL 0
 /* Included code before lex code */
 /*************** Includes and Defines *****************************/
@@ -834,6 +807,7 @@ char *yytext;
 #include "map"
 #include "cpp_lexer.h"		// YACC generated definitions based on C++ grammar
 #include "errno.h"
+#include "cl_parser_state.h"
 
 #define YYSTYPE std::string
 #define ECHO
@@ -843,13 +817,6 @@ char *yytext;
 #include <string.h>
 #include <vector>
 
-extern std::string cl_scope_lval;
-extern std::string cl_var_lval;
-extern std::string cl_func_lval;
-extern std::string cl_typedef_lval;
-
-std::vector<std::string> currentScope;
-
 bool setLexerInput(const std::string &in, const std::map<std::string, std::string> &ignoreTokens);
 void setUseIgnoreMacros(bool ignore);
 
@@ -858,19 +825,109 @@ void printScopeName();
 void cl_scope_lex_clean();
 void cl_scope_less(int count);
 
-//we keep a very primitive map with only symbol name
-//that we encountered so far
-std::map<std::string, std::string> g_symbols;
-std::map<std::string, std::string> g_macros;
-
-static std::map<std::string, std::string> g_ignoreList;
-static bool gs_useMacroIgnore = true;
-
 bool isaTYPE(char *string);
 bool isaMACRO(char *string);
 bool isignoredToken(char *string);
 
-static bool defineFound = false;
+/* The scanner state. Instead of global variables, the scanner uses the state
+ * of the calling thread's clParserState (see cl_parser_state.h), so several
+ * threads can scan at the same time
+ */
+struct clScopeLexerState : public clParserStateModule
+{
+	YY_BUFFER_STATE yy_current_buffer_r;
+	char            yy_hold_char_r;                 /* the character lost when yytext is formed */
+	int             yy_n_chars_r;                   /* number of characters read into yy_ch_buf */
+	int             yyleng_r;
+	char           *yy_c_buf_p_r;                   /* points to current character in buffer */
+	int             yy_init_r;                      /* whether we need to initialize */
+	int             yy_start_r;                     /* start state number */
+	int             yy_did_buffer_switch_on_eof_r;
+	FILE           *yyin_r;
+	FILE           *yyout_r;
+	int             yylineno_r;
+	char           *yytext_r;
+	yy_state_type   yy_state_buf_r[YY_BUF_SIZE + 2];
+	yy_state_type  *yy_state_ptr_r;
+	char           *yy_full_match_r;
+	int             yy_lp_r;
+
+	/* the value of the last token, read by the scope, variable, function and typedef parsers */
+	std::string     yylval_r;
+
+	std::vector<std::string> currentScope_r;
+
+	//we keep a very primitive map with only symbol name
+	//that we encountered so far
+	std::map<std::string, std::string> g_symbols_r;
+	std::map<std::string, std::string> g_macros_r;
+
+	std::map<std::string, std::string> g_ignoreList_r;
+	bool            gs_useMacroIgnore_r;
+	bool            defineFound_r;
+	int             anonScopeCounter_r;
+
+	clScopeLexerState()
+		: yy_current_buffer_r(0)
+		, yy_hold_char_r(0)
+		, yy_n_chars_r(0)
+		, yyleng_r(0)
+		, yy_c_buf_p_r(0)
+		, yy_init_r(1)
+		, yy_start_r(0)
+		, yy_did_buffer_switch_on_eof_r(0)
+		, yyin_r(0)
+		, yyout_r(0)
+		, yylineno_r(1)
+		, yytext_r(0)
+		, yy_state_ptr_r(0)
+		, yy_full_match_r(0)
+		, yy_lp_r(0)
+		, gs_useMacroIgnore_r(true)
+		, defineFound_r(false)
+		, anonScopeCounter_r(0)
+	{}
+
+	virtual ~clScopeLexerState() {
+		if ( yy_current_buffer_r ) {
+			if ( yy_current_buffer_r->yy_is_our_buffer )
+				free( yy_current_buffer_r->yy_ch_buf );
+			free( yy_current_buffer_r );
+		}
+	}
+};
+
+static clScopeLexerState* cl_scope_lex_state()
+{
+	return clParserState::Current()->GetModule<clScopeLexerState>(clParserState::kScopeLexer);
+}
+
+/* Every function accessing the scanner state starts with:
+ * clScopeLexerState* yyg = cl_scope_lex_state();
+ * yy_n_chars is also a member of yy_buffer_state, so it is accessed as
+ * yyg->yy_n_chars_r rather than through a macro
+ */
+#define yy_current_buffer             yyg->yy_current_buffer_r
+#define yy_hold_char                  yyg->yy_hold_char_r
+#define yy_c_buf_p                    yyg->yy_c_buf_p_r
+#define yy_init                       yyg->yy_init_r
+#define yy_start                      yyg->yy_start_r
+#define yy_did_buffer_switch_on_eof   yyg->yy_did_buffer_switch_on_eof_r
+#define yy_state_buf                  yyg->yy_state_buf_r
+#define yy_state_ptr                  yyg->yy_state_ptr_r
+#define yy_full_match                 yyg->yy_full_match_r
+#define yy_lp                         yyg->yy_lp_r
+#define cl_scope_in                   yyg->yyin_r
+#define cl_scope_out                  yyg->yyout_r
+#define cl_scope_leng                 yyg->yyleng_r
+#define cl_scope_lineno               yyg->yylineno_r
+#define cl_scope_text                 yyg->yytext_r
+#define currentScope                  yyg->currentScope_r
+#define g_symbols                     yyg->g_symbols_r
+#define g_macros                      yyg->g_macros_r
+#define g_ignoreList                  yyg->g_ignoreList_r
+#define gs_useMacroIgnore             yyg->gs_useMacroIgnore_r
+#define defineFound                   yyg->defineFound_r
 
 /* Prototypes */
 #define WHITE_RETURN(x) /* do nothing */
@@ -899,10 +956,7 @@ static bool defineFound = false;
 #define LITERAL_RETURN(x)   RETURN_VAL(x)            /* a string literal */
 #define C_COMMENT_RETURN(x) RETURN_VAL(x)	     /* C Style comment  */
 #define RETURN_VAL(x) {\
-								cl_scope_lval   = yytext;\
-								cl_var_lval     = yytext;\
-								cl_func_lval    = yytext;\
-								cl_typedef_lval = yytext;\
+								yyg->yylval_r = yytext;\
 								return(x);}
 
 #define PREPR 1
@@ -1062,6 +1116,7 @@ YY_MALLOC_DECL
 
 YY_DECL
 	{
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	register yy_state_type yy_current_state;
 	register char *yy_cp, *yy_bp;
 	register int yy_act;
@@ -1812,7 +1867,7 @@ ECHO;
 			 * this is the first action (other than possibly a
 			 * back-up) that will match for the new input source.
 			 */
-			yy_n_chars = yy_current_buffer->yy_n_chars;
+			yyg->yy_n_chars_r = yy_current_buffer->yy_n_chars;
 			yy_current_buffer->yy_input_file = yyin;
 			yy_current_buffer->yy_buffer_status = YY_BUFFER_NORMAL;
 			}
@@ -1824,7 +1879,7 @@ ECHO;
 		 * end-of-buffer state).  Contrast this with the test
 		 * in input().
 		 */
-		if ( yy_c_buf_p <= &yy_current_buffer->yy_ch_buf[yy_n_chars] )
+		if ( yy_c_buf_p <= &yy_current_buffer->yy_ch_buf[yyg->yy_n_chars_r] )
 			{ /* This was really a NUL. */
 			yy_state_type yy_next_state;
 
@@ -1903,7 +1958,7 @@ ECHO;
 
 			case EOB_ACT_LAST_MATCH:
 				yy_c_buf_p =
-				&yy_current_buffer->yy_ch_buf[yy_n_chars];
+				&yy_current_buffer->yy_ch_buf[yyg->yy_n_chars_r];
 
 				yy_current_state = yy_get_previous_state();
 
@@ -1932,12 +1987,13 @@ ECHO;
 
 static int yy_get_next_buffer()
 	{
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	register char *dest = yy_current_buffer->yy_ch_buf;
 	register char *source = yytext_ptr;
 	register int number_to_move, i;
 	int ret_val;
 
-	if ( yy_c_buf_p > &yy_current_buffer->yy_ch_buf[yy_n_chars + 1] )
+	if ( yy_c_buf_p > &yy_current_buffer->yy_ch_buf[yyg->yy_n_chars_r + 1] )
 		YY_FATAL_ERROR(
 		"fatal flex scanner internal error--end of buffer missed" );
 
@@ -1972,7 +2028,7 @@ static int yy_get_next_buffer()
 		/* don't do the read, it's not guaranteed to return an EOF,
 		 * just force an EOF
 		 */
-		yy_current_buffer->yy_n_chars = yy_n_chars = 0;
+		yy_current_buffer->yy_n_chars = yyg->yy_n_chars_r = 0;
 
 	else
 		{
@@ -2026,12 +2082,12 @@ static int yy_get_next_buffer()
 
 		/* Read in more data. */
 		YY_INPUT( (&yy_current_buffer->yy_ch_buf[number_to_move]),
-			yy_n_chars, num_to_read );
+			yyg->yy_n_chars_r, num_to_read );
 
-		yy_current_buffer->yy_n_chars = yy_n_chars;
+		yy_current_buffer->yy_n_chars = yyg->yy_n_chars_r;
 		}
 
-	if ( yy_n_chars == 0 )
+	if ( yyg->yy_n_chars_r == 0 )
 		{
 		if ( number_to_move == YY_MORE_ADJ )
 			{
@@ -2050,9 +2106,9 @@ static int yy_get_next_buffer()
 	else
 		ret_val = EOB_ACT_CONTINUE_SCAN;
 
-	yy_n_chars += number_to_move;
-	yy_current_buffer->yy_ch_buf[yy_n_chars] = YY_END_OF_BUFFER_CHAR;
-	yy_current_buffer->yy_ch_buf[yy_n_chars + 1] = YY_END_OF_BUFFER_CHAR;
+	yyg->yy_n_chars_r += number_to_move;
+	yy_current_buffer->yy_ch_buf[yyg->yy_n_chars_r] = YY_END_OF_BUFFER_CHAR;
+	yy_current_buffer->yy_ch_buf[yyg->yy_n_chars_r + 1] = YY_END_OF_BUFFER_CHAR;
 
 	yytext_ptr = &yy_current_buffer->yy_ch_buf[0];
 
@@ -2064,6 +2120,7 @@ static int yy_get_next_buffer()
 
 static yy_state_type yy_get_previous_state()
 	{
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	register yy_state_type yy_current_state;
 	register char *yy_cp;
 
@@ -2102,6 +2159,7 @@ static yy_state_type yy_try_NUL_trans( yy_current_state )
 yy_state_type yy_current_state;
 #endif
 	{
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	register int yy_is_jam;
 
 	register YY_CHAR yy_c = 1;
@@ -2129,6 +2187,7 @@ int c;
 register char *yy_bp;
 #endif
 	{
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	register char *yy_cp = yy_c_buf_p;
 
 	/* undo effects of setting up yytext */
@@ -2137,7 +2196,7 @@ register char *yy_bp;
 	if ( yy_cp < yy_current_buffer->yy_ch_buf + 2 )
 		{ /* need to shift things up to make room */
 		/* +2 for EOB chars. */
-		register int number_to_move = yy_n_chars + 2;
+		register int number_to_move = yyg->yy_n_chars_r + 2;
 		register char *dest = &yy_current_buffer->yy_ch_buf[
 					yy_current_buffer->yy_buf_size + 2];
 		register char *source =
@@ -2149,7 +2208,7 @@ register char *yy_bp;
 		yy_cp += (int) (dest - source);
 		yy_bp += (int) (dest - source);
 		yy_current_buffer->yy_n_chars =
-			yy_n_chars = yy_current_buffer->yy_buf_size;
+			yyg->yy_n_chars_r = yy_current_buffer->yy_buf_size;
 
 		if ( yy_cp < yy_current_buffer->yy_ch_buf + 2 )
 			YY_FATAL_ERROR( "flex scanner push-back overflow" );
@@ -2173,6 +2232,7 @@ static int yyinput()
 static int input()
 #endif
 	{
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	int c;
 
 	*yy_c_buf_p = yy_hold_char;
@@ -2183,7 +2243,7 @@ static int input()
 		 * If this occurs *before* the EOB characters, then it's a
 		 * valid NUL; if not, then we've hit the end of the buffer.
 		 */
-		if ( yy_c_buf_p < &yy_current_buffer->yy_ch_buf[yy_n_chars] )
+		if ( yy_c_buf_p < &yy_current_buffer->yy_ch_buf[yyg->yy_n_chars_r] )
 			/* This was really a NUL. */
 			*yy_c_buf_p = '\0';
 
@@ -2250,6 +2310,7 @@ void yyrestart( input_file )
 FILE *input_file;
 #endif
 	{
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	if ( ! yy_current_buffer )
 		yy_current_buffer = yy_create_buffer( yyin, YY_BUF_SIZE );
 
@@ -2265,6 +2326,7 @@ void yy_switch_to_buffer( new_buffer )
 YY_BUFFER_STATE new_buffer;
 #endif
 	{
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	if ( yy_current_buffer == new_buffer )
 		return;
 
@@ -2273,7 +2335,7 @@ YY_BUFFER_STATE new_buffer;
 		/* Flush out information for old buffer. */
 		*yy_c_buf_p = yy_hold_char;
 		yy_current_buffer->yy_buf_pos = yy_c_buf_p;
-		yy_current_buffer->yy_n_chars = yy_n_chars;
+		yy_current_buffer->yy_n_chars = yyg->yy_n_chars_r;
 		}
 
 	yy_current_buffer = new_buffer;
@@ -2294,7 +2356,8 @@ void yy_load_buffer_state( void )
 void yy_load_buffer_state()
 #endif
 	{
-	yy_n_chars = yy_current_buffer->yy_n_chars;
+	clScopeLexerState* yyg = cl_scope_lex_state();
+	yyg->yy_n_chars_r = yy_current_buffer->yy_n_chars;
 	yytext_ptr = yy_c_buf_p = yy_current_buffer->yy_buf_pos;
 	yyin = yy_current_buffer->yy_input_file;
 	yy_hold_char = *yy_c_buf_p;
@@ -2339,6 +2402,7 @@ void yy_delete_buffer( b )
 YY_BUFFER_STATE b;
 #endif
 	{
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	if ( ! b )
 		return;
 
@@ -2393,6 +2457,7 @@ YY_BUFFER_STATE b;
 #endif
 
 	{
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	if ( ! b )
 		return;
 
@@ -2678,11 +2743,13 @@ int main()
 
 bool isaTYPE(char *string)
 {
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	return g_symbols.find(string) != g_symbols.end();
 }
 
 bool isignoredToken(char *string)
 {
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	std::map<std::string, std::string>::iterator iter = g_ignoreList.find(string);
 	if(iter == g_ignoreList.end()){
 		/* this string is not in the ignore macro list */
@@ -2695,6 +2762,7 @@ bool isignoredToken(char *string)
 
 bool isaMACRO(char *string)
 {
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	if(gs_useMacroIgnore) {
 		return g_macros.find(string) != g_macros.end();
 	}else{
@@ -2704,6 +2772,7 @@ bool isaMACRO(char *string)
 
 void cl_scope_lex_clean()
 {
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	yy_flush_buffer(YY_CURRENT_BUFFER);
 	yy_delete_buffer(YY_CURRENT_BUFFER);
 	cl_scope_lineno = 1;
@@ -2731,17 +2800,18 @@ void printScopeName()
 
 void increaseScope()
 {
-	static int value = 0;
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	std::string scopeName("__anon_");
 
 	char buf[100];
-	sprintf(buf, "%d", value++);
+	sprintf(buf, "%d", yyg->anonScopeCounter_r++);
 	scopeName += buf;
 	currentScope.push_back(scopeName);
 }
 
 std::string getCurrentScope()
 {
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	//format scope name
 	std::string scope;
 	if(currentScope.empty()){
@@ -2768,6 +2838,7 @@ std::string getCurrentScope()
 /*******************************************************************/
 bool setLexerInput(const std::string &in, const std::map<std::string, std::string> &ignoreTokens)
 {
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	BEGIN INITIAL;
 	yy_scan_string(in.c_str());
 
@@ -2778,6 +2849,7 @@ bool setLexerInput(const std::string &in, const std::map<std::string, std::strin
 }
 
 void setUseIgnoreMacros(bool ignore) {
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	gs_useMacroIgnore = ignore;
 }
 
@@ -2786,5 +2858,31 @@ int yywrap(){
 }
 
 void cl_scope_less(int count){
+	clScopeLexerState* yyg = cl_scope_lex_state();
 	yyless(count);
 }
+
+/* Accessors used by the parsers, which do not see the scanner state */
+char* cl_scope_lex_text()
+{
+	clScopeLexerState* yyg = cl_scope_lex_state();
+	return yytext;
+}
+
+int cl_scope_lex_lineno()
+{
+	clScopeLexerState* yyg = cl_scope_lex_state();
+	return yylineno;
+}
+
+const std::string& cl_scope_lex_lval()
+{
+	clScopeLexerState* yyg = cl_scope_lex_state();
+	return yyg->yylval_r;
+}
+
+std::vector<std::string>& cl_scope_lex_current_scope()
+{
+	clScopeLexerState* yyg = cl_scope_lex_state();
+	return currentScope;
+}
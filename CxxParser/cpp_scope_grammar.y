@@ -8,6 +8,7 @@
 #include <vector>
 #include <stdio.h>
 #include <map>
+#include "cl_parser_state.h"
 #include <string.h>
 
 #define YYDEBUG_LEXER_TEXT (cl_scope_lval)
@@ -16,28 +17,27 @@
 static std::string readInitializer(const char* delim);
 static void readClassName();
 
-static std::string className;
-
-static std::string templateInitList;
 int cl_scope_parse();
 void cl_scope_error(char *string);
 void syncParser();
 
-static std::vector<std::string> gs_additionlNS;
-
 //---------------------------------------------
 // externs defined in the lexer
 //---------------------------------------------
-extern char *cl_scope_text;
+extern char* cl_scope_lex_text();
+#define cl_scope_text cl_scope_lex_text()
 extern int cl_scope_lex();
 extern bool setLexerInput(const std::string &in, const std::map<std::string, std::string> &ignoreTokens);
-extern int cl_scope_lineno;
-extern std::vector<std::string> currentScope;
+extern int cl_scope_lex_lineno();
+#define cl_scope_lineno cl_scope_lex_lineno()
+extern std::vector<std::string>& cl_scope_lex_current_scope();
+#define currentScope cl_scope_lex_current_scope()
 extern void printScopeName();	//print the current scope name
 extern void increaseScope();	//increase scope with anonymouse value
 extern std::string getCurrentScope();
 extern void cl_scope_lex_clean();
 extern void cl_scope_less(int count);
+extern const std::string& cl_scope_lex_lval();
 
 /*************** Standard ytab.c continues here *********************/
 %}
@@ -443,6 +443,56 @@ union_decl			:	stmnt_starter LE_UNION LE_IDENTIFIER '{'
 							}
 						;
 %%
+/*
+ * The parser state: the variables byacc generates as globals and the parser's
+ * own statics live in the clParserState of the calling thread (see
+ * cl_parser_state.h). Every function using them declares:
+ * clScopeParserState* yyps = cl_scope_parser_state();
+ */
+struct clScopeParserState : public clParserStateModule
+{
+    int                       yydebug_r;
+    int                       yynerrs_r;
+    int                       yyerrflag_r;
+    int                       yychar_r;
+    short                    *yyssp_r;
+    YYSTYPE                  *yyvsp_r;
+    YYSTYPE                   yyval_r;
+    short                     yyss_r[YYSTACKSIZE];
+    YYSTYPE                   yyvs_r[YYSTACKSIZE];
+
+    std::string               className_r;
+    std::string               templateInitList_r;
+    std::vector<std::string>  gs_additionlNS_r;
+
+    clScopeParserState()
+        : yydebug_r(0)
+        , yynerrs_r(0)
+        , yyerrflag_r(0)
+        , yychar_r(0)
+        , yyssp_r(NULL)
+        , yyvsp_r(NULL)
+    {}
+};
+
+static clScopeParserState* cl_scope_parser_state()
+{
+    return clParserState::Current()->GetModule<clScopeParserState>(clParserState::kScopeParser);
+}
+
+#define cl_scope_debug    yyps->yydebug_r
+#define cl_scope_nerrs    yyps->yynerrs_r
+#define cl_scope_errflag  yyps->yyerrflag_r
+#define cl_scope_char     yyps->yychar_r
+#define cl_scope_ssp      yyps->yyssp_r
+#define cl_scope_vsp      yyps->yyvsp_r
+#define cl_scope_val      yyps->yyval_r
+#define cl_scope_ss       yyps->yyss_r
+#define cl_scope_vs       yyps->yyvs_r
+#define cl_scope_lval     cl_scope_lex_lval()
+#define className         yyps->className_r
+#define templateInitList  yyps->templateInitList_r
+#define gs_additionlNS    yyps->gs_additionlNS_r
 void yyerror(char *s) {}
 
 void syncParser(){
@@ -485,6 +535,7 @@ void consumeFuncArgList(){
 
 void readClassName()
 {
+    clScopeParserState* yyps = cl_scope_parser_state();
 #define NEXT_TOK()          c = cl_scope_lex(); if(c == 0) {className.clear(); return;}
 #define BREAK_IF_NOT(x)     if(c != (int)x) {className.clear(); break;}
 #define BREAK_IF_NOT2(x, y) if(c != (int)x && c != (int)y) break;
@@ -572,6 +623,7 @@ void consumeDecl()
 
 void consumeTemplateDecl()
 {
+	clScopeParserState* yyps = cl_scope_parser_state();
 	templateInitList.clear();
 	int dep = 0;
 	while( true ){
@@ -658,6 +710,7 @@ std::string get_scope_name(	const std::string &in,
 							std::vector<std::string> &additionalNS,
 							const std::map<std::string, std::string> &ignoreTokens)
 {
+	clScopeParserState* yyps = cl_scope_parser_state();
 	if( !setLexerInput(in, ignoreTokens) ){
 		return "";
 	}
@@ -8,6 +8,7 @@
 #include "vector"
 #include "stdio.h"
 #include "map"
+#include "cl_parser_state.h"
 #include "expression_result.h"
 
 #define YYSTYPE std::string
@@ -15,18 +16,20 @@
 
 void cl_expr_error(char *string);
 
-static ExpressionResult result;
-
 //---------------------------------------------
 // externs defined in the lexer
 //---------------------------------------------
-extern char *cl_expr_text;
+extern char* cl_expr_lex_text();
+#define cl_expr_text cl_expr_lex_text()
 extern int cl_expr_lex();
 extern int cl_expr_parse();
-extern int cl_expr_lineno;
-extern std::vector<std::string> currentScope;
+extern int cl_expr_lex_lineno();
+#define cl_expr_lineno cl_expr_lex_lineno()
+extern std::vector<std::string>& cl_scope_lex_current_scope();
+#define currentScope cl_scope_lex_current_scope()
 extern bool setExprLexerInput(const std::string &in);
 extern void cl_expr_lex_clean();
+extern const std::string& cl_expr_lex_lval();
 
 /*************** Standard ytab.c continues here *********************/
 %}
@@ -305,6 +308,52 @@ array_brackets 	:	/* empty */ { $$ = ""; }
 				|	'[' { expr_consumBracketsContent('['); $$ = "[]";}
 				;
 %%
+/*
+ * The parser state: the variables byacc generates as globals and the parser's
+ * own statics live in the clParserState of the calling thread (see
+ * cl_parser_state.h). Every function using them declares:
+ * clExprParserState* yyps = cl_expr_parser_state();
+ */
+struct clExprParserState : public clParserStateModule
+{
+    int               yydebug_r;
+    int               yynerrs_r;
+    int               yyerrflag_r;
+    int               yychar_r;
+    short            *yyssp_r;
+    YYSTYPE          *yyvsp_r;
+    YYSTYPE           yyval_r;
+    short             yyss_r[YYSTACKSIZE];
+    YYSTYPE           yyvs_r[YYSTACKSIZE];
+
+    ExpressionResult  result_r;
+
+    clExprParserState()
+        : yydebug_r(0)
+        , yynerrs_r(0)
+        , yyerrflag_r(0)
+        , yychar_r(0)
+        , yyssp_r(NULL)
+        , yyvsp_r(NULL)
+    {}
+};
+
+static clExprParserState* cl_expr_parser_state()
+{
+    return clParserState::Current()->GetModule<clExprParserState>(clParserState::kExprParser);
+}
+
+#define cl_expr_debug    yyps->yydebug_r
+#define cl_expr_nerrs    yyps->yynerrs_r
+#define cl_expr_errflag  yyps->yyerrflag_r
+#define cl_expr_char     yyps->yychar_r
+#define cl_expr_ssp      yyps->yyssp_r
+#define cl_expr_vsp      yyps->yyvsp_r
+#define cl_expr_val      yyps->yyval_r
+#define cl_expr_ss       yyps->yyss_r
+#define cl_expr_vs       yyps->yyvs_r
+#define cl_expr_lval     cl_expr_lex_lval()
+#define result           yyps->result_r
 void yyerror(char *s) {}
 
 void expr_consumBracketsContent(char openBrace)
@@ -403,6 +452,7 @@ void expr_syncParser(){
 // return the scope name at the end of the input string
 ExpressionResult &parse_expression(const std::string &in)
 {
+	clExprParserState* yyps = cl_expr_parser_state();
 	result.Reset();
 	//provide the lexer with new input
 	if( !setExprLexerInput(in) ){
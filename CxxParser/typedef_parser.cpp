@@ -38,6 +38,7 @@ static char yysccsid[] = "@(#)yaccpar	1.9 (Berkeley) 02/21/93";
 #include "vector"
 #include "stdio.h"
 #include "map"
+#include "cl_parser_state.h"
 #include "variable.h"
 #include "cl_typedef.h"
 
@@ -53,26 +54,19 @@ int  cl_typedef_parse();
 void syncParser();
 void typedef_consumeDefaultValue(char c1, char c2);
 
-static  VariableList *           gs_vars = NULL;
-static  std::vector<std::string> gs_names;
-static  bool                     g_isUsedWithinFunc = false;
-static  std::string              s_tmpString;
-static  Variable                 curr_var;
-static  clTypedefList            gs_typedefs;
-static  clTypedef                gs_currentTypedef;
-static  std::string              s_templateInitList;
-
 /*---------------------------------------------*/
 /* externs defined in the lexer*/
 /*---------------------------------------------*/
-extern char *cl_scope_text;
+extern char* cl_scope_lex_text();
+#define cl_scope_text cl_scope_lex_text()
 extern int   cl_scope_lex();
 extern void  cl_scope_less(int count);
-extern int   cl_scope_lineno;
+extern int cl_scope_lex_lineno();
+#define cl_scope_lineno cl_scope_lex_lineno()
 extern void  cl_scope_lex_clean();
 extern bool  setLexerInput(const std::string &in, const std::map<std::string, std::string> &ignoreMap);
 extern void  setUseIgnoreMacros(bool ignore);
-
+extern const std::string& cl_scope_lex_lval();
 
 /*************** Standard ytab.c continues here *********************/
 #define LE_AUTO 257
@@ -392,17 +386,69 @@ typedef int YYSTYPE;
 #define YYMAXDEPTH 500
 #endif
 #endif
-int yydebug;
-int yynerrs;
-int yyerrflag;
-int yychar;
-short *yyssp;
-YYSTYPE *yyvsp;
-YYSTYPE yyval;
-YYSTYPE yylval;
-short yyss[YYSTACKSIZE];
-YYSTYPE yyvs[YYSTACKSIZE];
 #define yystacksize YYSTACKSIZE
+/*
+ * The parser state: the variables byacc generates as globals and the parser's
+ * own statics live in the clParserState of the calling thread (see
+ * cl_parser_state.h). Every function using them declares:
+ * clTypedefParserState* yyps = cl_typedef_parser_state();
+ */
+struct clTypedefParserState : public clParserStateModule
+{
+    int                       yydebug_r;
+    int                       yynerrs_r;
+    int                       yyerrflag_r;
+    int                       yychar_r;
+    short                    *yyssp_r;
+    YYSTYPE                  *yyvsp_r;
+    YYSTYPE                   yyval_r;
+    short                     yyss_r[YYSTACKSIZE];
+    YYSTYPE                   yyvs_r[YYSTACKSIZE];
+
+    VariableList             *gs_vars_r;
+    std::vector<std::string>  gs_names_r;
+    bool                      g_isUsedWithinFunc_r;
+    std::string               s_tmpString_r;
+    Variable                  curr_var_r;
+    clTypedefList             gs_typedefs_r;
+    clTypedef                 gs_currentTypedef_r;
+    std::string               s_templateInitList_r;
+
+    clTypedefParserState()
+        : yydebug_r(0)
+        , yynerrs_r(0)
+        , yyerrflag_r(0)
+        , yychar_r(0)
+        , yyssp_r(NULL)
+        , yyvsp_r(NULL)
+        , gs_vars_r(NULL)
+        , g_isUsedWithinFunc_r(false)
+    {}
+};
+
+static clTypedefParserState* cl_typedef_parser_state()
+{
+    return clParserState::Current()->GetModule<clTypedefParserState>(clParserState::kTypedefParser);
+}
+
+#define cl_typedef_debug    yyps->yydebug_r
+#define cl_typedef_nerrs    yyps->yynerrs_r
+#define cl_typedef_errflag  yyps->yyerrflag_r
+#define cl_typedef_char     yyps->yychar_r
+#define cl_typedef_ssp      yyps->yyssp_r
+#define cl_typedef_vsp      yyps->yyvsp_r
+#define cl_typedef_val      yyps->yyval_r
+#define cl_typedef_ss       yyps->yyss_r
+#define cl_typedef_vs       yyps->yyvs_r
+#define cl_typedef_lval     cl_scope_lex_lval()
+#define gs_vars             yyps->gs_vars_r
+#define gs_names            yyps->gs_names_r
+#define g_isUsedWithinFunc  yyps->g_isUsedWithinFunc_r
+#define s_tmpString         yyps->s_tmpString_r
+#define curr_var            yyps->curr_var_r
+#define gs_typedefs         yyps->gs_typedefs_r
+#define gs_currentTypedef   yyps->gs_currentTypedef_r
+#define s_templateInitList  yyps->s_templateInitList_r
 void yyerror(char *s) {}
 
 
@@ -459,6 +505,7 @@ std::string typedef_consumBracketsContent(char openBrace)
 
 void typedef_consumeDefaultValue(char c1, char c2)
 {
+	clTypedefParserState* yyps = cl_typedef_parser_state();
 	int depth = 0;
 	bool cont(true);
 
@@ -489,6 +536,7 @@ void typedef_consumeDefaultValue(char c1, char c2)
 
 void do_clean_up()
 {
+	clTypedefParserState* yyps = cl_typedef_parser_state();
 	gs_vars = NULL;
 
     // restore settings
@@ -503,6 +551,7 @@ void do_clean_up()
 // return the scope name at the end of the input string
 void get_typedefs(const std::string &in, clTypedefList &li)
 {
+	clTypedefParserState* yyps = cl_typedef_parser_state();
 	std::map<std::string, std::string> dummy;
 
     // provide the lexer with new input
@@ -523,6 +572,7 @@ void get_typedefs(const std::string &in, clTypedefList &li)
 int
 yyparse()
 {
+    clTypedefParserState* yyps = cl_typedef_parser_state();
     register int yym, yyn, yystate;
 #if YYDEBUG
     register char *yys;
@@ -66,6 +66,14 @@ BuildPage::BuildPage( wxWindow* parent, int id, wxPoint pos, wxSize size, int st
     m_generateAsteriskCleanTarget = new wxCheckBox(this, wxID_ANY, _("Use asterisk (*) for the clean target (e.g. rm -f *.o)"));
     mainSizer->Add( m_generateAsteriskCleanTarget, 0, wxEXPAND | wxALL, 5 );
 
+    m_buildProjectsInParallel = new wxCheckBox(this, wxID_ANY, _("Build projects that don't depend on each other in parallel"));
+    m_buildProjectsInParallel->SetToolTip(_("Projects are built at the same time, sharing the jobs of the build tool.\nEach project waits only for the projects it depends on: the order of the build order list is not kept"));
+    mainSizer->Add( m_buildProjectsInParallel, 0, wxEXPAND | wxALL, 5 );
+
+    m_collectBuildStatistics = new wxCheckBox(this, wxID_ANY, _("Collect build statistics"));
+    m_collectBuildStatistics->SetToolTip(_("Measure the time and memory used to compile every file (see Build > Build Statistics...)"));
+    mainSizer->Add( m_collectBuildStatistics, 0, wxEXPAND | wxALL, 5 );
+
     long fix(1);
     EditorConfigST::Get()->GetLongValue(wxT("FixBuildToolOnStartup"), fix);
     m_fixOnStartup->SetValue(fix ? true : false);
@@ -74,6 +82,14 @@ BuildPage::BuildPage( wxWindow* parent, int id, wxPoint pos, wxSize size, int st
     EditorConfigST::Get()->GetLongValue(wxT("CleanTragetWithAsterisk"), asterisk);
     m_generateAsteriskCleanTarget->SetValue(asterisk ? true : false);
 
+    long parallel(0);
+    EditorConfigST::Get()->GetLongValue(wxT("BuildProjectsInParallel"), parallel);
+    m_buildProjectsInParallel->SetValue(parallel ? true : false);
+
+    long statistics(0);
+    EditorConfigST::Get()->GetLongValue(wxT("CollectBuildStatistics"), statistics);
+    m_collectBuildStatistics->SetValue(statistics ? true : false);
+
     this->SetSizer( mainSizer );
     this->Layout();
     CustomInit();
@@ -101,6 +117,8 @@ void BuildPage::Save()
 {
     EditorConfigST::Get()->SaveLongValue(wxT("FixBuildToolOnStartup"),    m_fixOnStartup->IsChecked()                ? 1 : 0);
     EditorConfigST::Get()->SaveLongValue(wxT("CleanTragetWithAsterisk"),  m_generateAsteriskCleanTarget->IsChecked() ? 1 : 0);
+    EditorConfigST::Get()->SaveLongValue(wxT("BuildProjectsInParallel"),  m_buildProjectsInParallel->IsChecked()     ? 1 : 0);
+    EditorConfigST::Get()->SaveLongValue(wxT("CollectBuildStatistics"),   m_collectBuildStatistics->IsChecked()      ? 1 : 0);
 
     // Save current page displayed as 'selected' builder
     int sel = (int) m_bookBuildSystems->GetSelection();
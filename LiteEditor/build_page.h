@@ -53,6 +53,8 @@ protected:
     wxChoicebook* m_bookBuildSystems;
     wxCheckBox *m_fixOnStartup;
     wxCheckBox *m_generateAsteriskCleanTarget;
+    wxCheckBox *m_buildProjectsInParallel;
+    wxCheckBox *m_collectBuildStatistics;
 
     void CustomInit();
     wxPanel *CreateBuildSystemPage(const wxString &name);
@@ -0,0 +1,227 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : build_statistics_dlg.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "build_statistics_dlg.h"
+#include "build_statistics_manager.h"
+#include "windowattrmanager.h"
+#include <wx/sizer.h>
+#include <wx/filedlg.h>
+#include <wx/msgdlg.h>
+#include <algorithm>
+
+namespace
+{
+
+struct BuildStatisticsSorter {
+    int  m_column;
+    bool m_ascending;
+
+    BuildStatisticsSorter(int column, bool ascending) : m_column(column), m_ascending(ascending) {}
+
+    bool operator()(const BuildStatistics::Entry &a, const BuildStatistics::Entry &b) const {
+        int res = BuildStatistics::Compare(a, b, m_column);
+        return m_ascending ? res < 0 : res > 0;
+    }
+};
+
+}
+
+BuildStatisticsDlg::BuildStatisticsDlg(wxWindow* parent)
+    : wxDialog(parent, wxID_ANY, _("Build Statistics"), wxDefaultPosition, wxSize(800, 500), wxDEFAULT_DIALOG_STYLE|wxRESIZE_BORDER)
+    , m_report(BuildStatistics::kFiles)
+    , m_sortColumn(BuildStatistics::kColLast)
+    , m_sortAscending(false)
+{
+    wxBoxSizer* mainSizer = new wxBoxSizer(wxVERTICAL);
+
+    wxBoxSizer* topSizer = new wxBoxSizer(wxHORIZONTAL);
+    wxArrayString reports;
+    reports.Add(_("Files"));
+    reports.Add(_("Headers"));
+    reports.Add(_("Projects"));
+    m_choiceReport = new wxChoice(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, reports);
+    m_choiceReport->SetSelection(0);
+    m_choiceReport->SetToolTip(_("Headers: the time spent compiling the translation units that include the header"));
+    topSizer->Add(m_choiceReport, 0, wxALL|wxALIGN_CENTER_VERTICAL, 5);
+
+    m_staticSummary = new wxStaticText(this, wxID_ANY, wxEmptyString);
+    topSizer->Add(m_staticSummary, 1, wxALL|wxALIGN_CENTER_VERTICAL, 5);
+    mainSizer->Add(topSizer, 0, wxEXPAND, 5);
+
+    m_listCtrl = new wxListCtrl(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT|wxLC_SINGLE_SEL);
+    mainSizer->Add(m_listCtrl, 1, wxALL|wxEXPAND, 5);
+
+    wxBoxSizer* buttonSizer = new wxBoxSizer(wxHORIZONTAL);
+    m_buttonExportCSV = new wxButton(this, wxID_ANY, _("Export CSV..."));
+    buttonSizer->Add(m_buttonExportCSV, 0, wxALL, 5);
+
+    m_buttonExportJSON = new wxButton(this, wxID_ANY, _("Export JSON..."));
+    buttonSizer->Add(m_buttonExportJSON, 0, wxALL, 5);
+
+    m_buttonClear = new wxButton(this, wxID_ANY, _("Clear History"));
+    buttonSizer->Add(m_buttonClear, 0, wxALL, 5);
+
+    buttonSizer->AddStretchSpacer();
+    wxButton* buttonClose = new wxButton(this, wxID_CANCEL, _("&Close"));
+    buttonSizer->Add(buttonClose, 0, wxALL, 5);
+    mainSizer->Add(buttonSizer, 0, wxEXPAND, 5);
+
+    SetSizer(mainSizer);
+    Layout();
+    CentreOnParent();
+
+    m_choiceReport->Connect(wxEVT_COMMAND_CHOICE_SELECTED, wxCommandEventHandler(BuildStatisticsDlg::OnReportChanged), NULL, this);
+    m_listCtrl->Connect(wxEVT_COMMAND_LIST_COL_CLICK, wxListEventHandler(BuildStatisticsDlg::OnColumnClicked), NULL, this);
+    m_buttonExportCSV->Connect(wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(BuildStatisticsDlg::OnExportCSV), NULL, this);
+    m_buttonExportCSV->Connect(wxEVT_UPDATE_UI, wxUpdateUIEventHandler(BuildStatisticsDlg::OnExportUI), NULL, this);
+    m_buttonExportJSON->Connect(wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(BuildStatisticsDlg::OnExportJSON), NULL, this);
+    m_buttonExportJSON->Connect(wxEVT_UPDATE_UI, wxUpdateUIEventHandler(BuildStatisticsDlg::OnExportUI), NULL, this);
+    m_buttonClear->Connect(wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(BuildStatisticsDlg::OnClear), NULL, this);
+    m_buttonClear->Connect(wxEVT_UPDATE_UI, wxUpdateUIEventHandler(BuildStatisticsDlg::OnExportUI), NULL, this);
+
+    m_stats.Open();
+    DoLoadReport();
+    WindowAttrManager::Load(this, wxT("BuildStatisticsDlg"), NULL);
+}
+
+BuildStatisticsDlg::~BuildStatisticsDlg()
+{
+    WindowAttrManager::Save(this, wxT("BuildStatisticsDlg"), NULL);
+    m_stats.Close();
+}
+
+void BuildStatisticsDlg::DoLoadReport()
+{
+    m_report = (BuildStatistics::eReport)m_choiceReport->GetSelection();
+    m_stats.GetReport(m_report, m_entries);
+    BuildStatistics::GetColumns(m_report, m_columns);
+
+    // The report comes sorted by the most recent time, slowest first
+    m_sortColumn    = BuildStatistics::kColLast;
+    m_sortAscending = false;
+
+    m_listCtrl->Freeze();
+    m_listCtrl->ClearAll();
+    for(size_t i=0; i<m_columns.size(); ++i) {
+        int column = m_columns.at(i);
+        m_listCtrl->InsertColumn(i, BuildStatistics::GetColumnTitle(m_report, column),
+                                 column <= BuildStatistics::kColName ? wxLIST_FORMAT_LEFT : wxLIST_FORMAT_RIGHT,
+                                 column == BuildStatistics::kColName ? 300 : wxLIST_AUTOSIZE_USEHEADER);
+    }
+    m_listCtrl->Thaw();
+
+    wxString summary;
+    summary << wxString::Format(_("%u builds recorded"), (unsigned int)m_stats.GetBuildsCount());
+    if ( !BuildStatisticsManager::IsEnabled() ) {
+        summary << _(" - the collection is disabled, enable it from Settings > Build Settings");
+    }
+    m_staticSummary->SetLabel(summary);
+
+    DoPopulate();
+}
+
+void BuildStatisticsDlg::DoPopulate()
+{
+    m_listCtrl->Freeze();
+    m_listCtrl->DeleteAllItems();
+    for(size_t n=0; n<m_entries.size(); ++n) {
+        const BuildStatistics::Entry& entry = m_entries.at(n);
+        long item = m_listCtrl->InsertItem(n, BuildStatistics::GetColumnValue(entry, m_columns.at(0)));
+        for(size_t i=1; i<m_columns.size(); ++i) {
+            m_listCtrl->SetItem(item, i, BuildStatistics::GetColumnValue(entry, m_columns.at(i)));
+        }
+    }
+    m_listCtrl->Thaw();
+}
+
+void BuildStatisticsDlg::DoExport(bool json)
+{
+    wxString wildcard = json ? wxT("JSON files (*.json)|*.json") : wxT("CSV files (*.csv)|*.csv");
+    wxString filename = ::wxFileSelector(_("Export Build Statistics"), wxEmptyString,
+                                         json ? wxT("build_statistics.json") : wxT("build_statistics.csv"),
+                                         wxEmptyString, wildcard, wxFD_SAVE|wxFD_OVERWRITE_PROMPT, this);
+    if ( filename.IsEmpty() )
+        return;
+
+    bool res = json ? BuildStatistics::ExportJSON(m_report, m_entries, filename) :
+                      BuildStatistics::ExportCSV (m_report, m_entries, filename);
+    if ( !res ) {
+        wxMessageBox(wxString::Format(_("Failed to write file '%s'"), filename.c_str()), wxT("CodeLite"), wxOK|wxICON_WARNING|wxCENTER, this);
+    }
+}
+
+void BuildStatisticsDlg::OnReportChanged(wxCommandEvent& e)
+{
+    wxUnusedVar(e);
+    DoLoadReport();
+}
+
+void BuildStatisticsDlg::OnColumnClicked(wxListEvent& e)
+{
+    int col = e.GetColumn();
+    if ( col < 0 || col >= (int)m_columns.size() )
+        return;
+
+    // Clicking the sorted column again reverses the order. Times are sorted slowest
+    // first, the text columns alphabetically
+    int column = m_columns.at(col);
+    if ( column == m_sortColumn ) {
+        m_sortAscending = !m_sortAscending;
+
+    } else {
+        m_sortColumn    = column;
+        m_sortAscending = column == BuildStatistics::kColProject || column == BuildStatistics::kColConfiguration || column == BuildStatistics::kColName;
+    }
+
+    std::stable_sort(m_entries.begin(), m_entries.end(), BuildStatisticsSorter(m_sortColumn, m_sortAscending));
+    DoPopulate();
+}
+
+void BuildStatisticsDlg::OnExportCSV(wxCommandEvent& e)
+{
+    wxUnusedVar(e);
+    DoExport(false);
+}
+
+void BuildStatisticsDlg::OnExportJSON(wxCommandEvent& e)
+{
+    wxUnusedVar(e);
+    DoExport(true);
+}
+
+void BuildStatisticsDlg::OnExportUI(wxUpdateUIEvent& e)
+{
+    e.Enable(!m_entries.empty());
+}
+
+void BuildStatisticsDlg::OnClear(wxCommandEvent& e)
+{
+    wxUnusedVar(e);
+    if ( wxMessageBox(_("Delete the build statistics of this workspace?"), wxT("CodeLite"), wxYES_NO|wxCANCEL|wxICON_QUESTION|wxCENTER, this) != wxYES )
+        return;
+
+    m_stats.Clear();
+    DoLoadReport();
+}
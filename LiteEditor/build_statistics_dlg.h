@@ -0,0 +1,75 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : build_statistics_dlg.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef BUILDSTATISTICSDLG_H
+#define BUILDSTATISTICSDLG_H
+
+#include <wx/dialog.h>
+#include <wx/choice.h>
+#include <wx/listctrl.h>
+#include <wx/stattext.h>
+#include <wx/button.h>
+#include "build_statistics.h"
+
+/**
+ * @class BuildStatisticsDlg
+ * @brief show the slowest files, headers and projects of the recorded builds
+ */
+class BuildStatisticsDlg : public wxDialog
+{
+protected:
+    wxChoice*     m_choiceReport;
+    wxStaticText* m_staticSummary;
+    wxListCtrl*   m_listCtrl;
+    wxButton*     m_buttonExportCSV;
+    wxButton*     m_buttonExportJSON;
+    wxButton*     m_buttonClear;
+
+    BuildStatistics              m_stats;
+    BuildStatistics::eReport     m_report;
+    BuildStatistics::EntryVec_t  m_entries;
+    std::vector<int>             m_columns;
+    int                          m_sortColumn;
+    bool                         m_sortAscending;
+
+protected:
+    void DoLoadReport();
+    void DoPopulate();
+    void DoExport(bool json);
+
+    // Event handlers
+    void OnReportChanged(wxCommandEvent &e);
+    void OnColumnClicked(wxListEvent &e);
+    void OnExportCSV(wxCommandEvent &e);
+    void OnExportJSON(wxCommandEvent &e);
+    void OnExportUI(wxUpdateUIEvent &e);
+    void OnClear(wxCommandEvent &e);
+
+public:
+    BuildStatisticsDlg(wxWindow* parent);
+    virtual ~BuildStatisticsDlg();
+};
+
+#endif // BUILDSTATISTICSDLG_H
@@ -0,0 +1,173 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : build_statistics_manager.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "build_statistics_manager.h"
+#include "event_notifier.h"
+#include "editor_config.h"
+#include "workspace.h"
+#include "build_config.h"
+#include "compiler.h"
+#include "plugin.h"
+#include "jobqueue.h"
+#include <wx/utils.h>
+#include <wx/thread.h>
+
+static BuildStatisticsManager *ms_BuildStatisticsManager = NULL;
+
+// The job queue runs several jobs at once: the imports take turns
+static wxMutex s_importMutex;
+
+//------------------------------------------------------------------------------
+// BuildStatisticsImportJob
+//------------------------------------------------------------------------------
+
+BuildStatisticsImportJob::BuildStatisticsImportJob(const wxString &filename, const wxArrayString &files, const BuildStatistics::ProjectInfoMap_t &projects)
+    : m_dbfile(filename.c_str())
+{
+    // Deep copy the strings, they are used by another thread
+    for(size_t i=0; i<files.GetCount(); ++i) {
+        m_files.Add( files.Item(i).c_str() );
+    }
+
+    BuildStatistics::ProjectInfoMap_t::const_iterator iter = projects.begin();
+    for(; iter != projects.end(); ++iter) {
+        BuildStatistics::ProjectInfo& info = m_projects[iter->first.c_str()];
+        info.m_name          = iter->second.m_name.c_str();
+        info.m_configuration = iter->second.m_configuration.c_str();
+        info.m_objectSuffix  = iter->second.m_objectSuffix.c_str();
+        info.m_dependSuffix  = iter->second.m_dependSuffix.c_str();
+    }
+}
+
+BuildStatisticsImportJob::~BuildStatisticsImportJob()
+{
+}
+
+void BuildStatisticsImportJob::Process(wxThread *thread)
+{
+    wxUnusedVar(thread);
+
+    wxMutexLocker locker(s_importMutex);
+    BuildStatistics stats(m_dbfile);
+    stats.Open();
+    stats.Import(m_files, m_projects);
+}
+
+//------------------------------------------------------------------------------
+// BuildStatisticsManager
+//------------------------------------------------------------------------------
+
+BuildStatisticsManager::BuildStatisticsManager()
+    : m_collecting(false)
+{
+    EventNotifier::Get()->Connect(wxEVT_BUILD_STARTING, clBuildEventHandler(BuildStatisticsManager::OnBuildStarting), NULL, this);
+    EventNotifier::Get()->Connect(wxEVT_BUILD_ENDED,    clBuildEventHandler(BuildStatisticsManager::OnBuildEnded),    NULL, this);
+}
+
+BuildStatisticsManager::~BuildStatisticsManager()
+{
+    EventNotifier::Get()->Disconnect(wxEVT_BUILD_STARTING, clBuildEventHandler(BuildStatisticsManager::OnBuildStarting), NULL, this);
+    EventNotifier::Get()->Disconnect(wxEVT_BUILD_ENDED,    clBuildEventHandler(BuildStatisticsManager::OnBuildEnded),    NULL, this);
+}
+
+BuildStatisticsManager& BuildStatisticsManager::Get()
+{
+    if ( !ms_BuildStatisticsManager ) {
+        ms_BuildStatisticsManager = new BuildStatisticsManager;
+    }
+    return *ms_BuildStatisticsManager;
+}
+
+void BuildStatisticsManager::Release()
+{
+    wxDELETE(ms_BuildStatisticsManager);
+}
+
+bool BuildStatisticsManager::IsEnabled()
+{
+    long collect(0);
+    EditorConfigST::Get()->GetLongValue(wxT("CollectBuildStatistics"), collect);
+    return collect ? true : false;
+}
+
+void BuildStatisticsManager::OnBuildStarting(clBuildEvent& e)
+{
+    e.Skip();
+    if ( !IsEnabled() )
+        return;
+
+    // Only the projects built by our Makefiles call the compiler through $(CXX) and $(CC)
+    BuildConfigPtr bldConf = WorkspaceST::Get()->GetProjBuildConf(e.GetProjectName(), e.GetConfigurationName());
+    if ( !bldConf || bldConf->IsCustomBuild() || !bldConf->GetCompiler() )
+        return;
+
+    BuildStatistics stats;
+    ::wxSetEnv(wxT("CL_BUILD_STATS"), stats.GetFileName().GetFullPath());
+
+    wxString cxx = bldConf->GetCompiler()->GetTool(wxT("CXX"));
+    wxString cc  = bldConf->GetCompiler()->GetTool(wxT("CC"));
+
+    cxx.Prepend(wxT("codelitegcc "));
+    cc.Prepend(wxT("codelitegcc "));
+
+    ::wxSetEnv("CXX", cxx);
+    ::wxSetEnv("CC" ,  cc);
+
+    m_collecting    = true;
+    m_project       = e.GetProjectName();
+    m_configuration = e.GetConfigurationName();
+}
+
+void BuildStatisticsManager::OnBuildEnded(clBuildEvent& e)
+{
+    e.Skip();
+    if ( !m_collecting )
+        return;
+
+    m_collecting = false;
+
+    // Clear environment variables previously set by this class
+    ::wxUnsetEnv("CL_BUILD_STATS");
+    ::wxUnsetEnv("CXX");
+    ::wxUnsetEnv("CC");
+
+    if ( !WorkspaceST::Get()->GetBuildMatrix() )
+        return;
+
+    // Take the records of this build now: an import still waiting in the queue
+    // must not pick them up and match them against another build's projects
+    BuildStatistics stats;
+    wxArrayString files;
+    stats.ClaimRecords(files);
+    if ( files.IsEmpty() )
+        return;
+
+    // The workspace can only be queried from the main thread: collect what the
+    // import needs here and let the job queue do the rest
+    BuildStatistics::ProjectInfoMap_t projects;
+    BuildStatistics::GetProjectsInfo(m_project, m_configuration, projects);
+
+    JobQueueSingleton::Instance()->PushJob( new BuildStatisticsImportJob(stats.GetFileName().GetFullPath(), files, projects) );
+}
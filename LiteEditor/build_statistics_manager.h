@@ -0,0 +1,83 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : build_statistics_manager.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef BUILDSTATISTICSMANAGER_H
+#define BUILDSTATISTICSMANAGER_H
+
+#include <wx/event.h>
+#include "build_statistics.h"
+#include "cl_command_event.h"
+#include "job.h"
+
+/**
+ * @class BuildStatisticsImportJob
+ * @brief import the records of a build into the build statistics database.
+ * The imports run one at a time
+ */
+class BuildStatisticsImportJob : public Job
+{
+    wxString                          m_dbfile;
+    wxArrayString                     m_files;
+    BuildStatistics::ProjectInfoMap_t m_projects;
+
+public:
+    BuildStatisticsImportJob(const wxString &filename, const wxArrayString &files, const BuildStatistics::ProjectInfoMap_t &projects);
+    virtual ~BuildStatisticsImportJob();
+
+public:
+    virtual void Process(wxThread *thread);
+};
+
+/**
+ * @class BuildStatisticsManager
+ * @brief when enabled ("CollectBuildStatistics"), run the compilers through codelitegcc
+ * so every compilation is measured, and import the measurements once the build ends
+ */
+class BuildStatisticsManager : public wxEvtHandler
+{
+protected:
+    bool     m_collecting;
+    wxString m_project;
+    wxString m_configuration;
+
+protected:
+    // Event handlers
+    void OnBuildStarting(clBuildEvent &e);
+    void OnBuildEnded(clBuildEvent &e);
+
+public:
+    BuildStatisticsManager();
+    virtual ~BuildStatisticsManager();
+
+    static BuildStatisticsManager& Get();
+    static void Release();
+
+    /**
+     * @brief is the collection enabled in the build settings?
+     */
+    static bool IsEnabled();
+};
+
+#endif // BUILDSTATISTICSMANAGER_H
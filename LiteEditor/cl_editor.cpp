@@ -67,6 +67,8 @@
 #include "findresultstab.h"
 #include "bookmark_manager.h"
 #include "clang_code_completion.h"
+#include "memory_mapped_file.h"
+#include <climits>
 
 // fix bug in wxscintilla.h
 #ifdef EVT_STC_CALLTIP_CLICK
@@ -165,6 +167,8 @@ LEditor::LEditor(wxWindow* parent)
     , m_positionToEnsureVisible  (wxNOT_FOUND)
     , m_fullLineCopyCut          (false)
     , m_findBookmarksActive      (false)
+    , m_highlightSnapshot        (NULL)
+    , m_highlightId              (0)
 {
     ms_bookmarkShapes[wxT("Small Rectangle")]   = wxSTC_MARK_SMALLRECT;
     ms_bookmarkShapes[wxT("Rounded Rectangle")] = wxSTC_MARK_ROUNDRECT;
@@ -207,6 +211,7 @@ LEditor::~LEditor()
     Unbind(wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler(LEditor::OnChangeActiveBookmarkType), this, XRCID("BookmarkTypes[start]"), XRCID("BookmarkTypes[end]"));
 
     delete m_deltas;
+    DoReleaseHighlightSnapshot();
     
     if ( this->HasCapture() ) {
         this->ReleaseMouse();
@@ -2685,9 +2690,10 @@ void LEditor::ReloadFile()
     // Read the file we currently support:
     // BOM, Auto-Detect encoding & User defined encoding
     m_fileBom.Clear();
-    ReadFileWithConversion(m_fileName.GetFullPath(), text, GetOptions()->GetFileFontEncoding(), &m_fileBom);
-
-    SetText( text );
+    if ( !DoLoadUTF8File(m_fileName.GetFullPath()) ) {
+        ReadFileWithConversion(m_fileName.GetFullPath(), text, GetOptions()->GetFileFontEncoding(), &m_fileBom);
+        SetText( text );
+    }
 
     m_modifyTime = GetFileLastModifiedTime();
 
@@ -2717,6 +2723,80 @@ void LEditor::ReloadFile()
     LoadCollapsedFoldsFromArray(folds);
 }
 
+// Return true if 7 bit text decodes to the same characters in 'encoding'
+static bool IsAsciiCompatibleEncoding(wxFontEncoding encoding)
+{
+    switch ( encoding ) {
+    case wxFONTENCODING_UTF7:
+    case wxFONTENCODING_UTF16BE:
+    case wxFONTENCODING_UTF16LE:
+    case wxFONTENCODING_UTF32BE:
+    case wxFONTENCODING_UTF32LE:
+        return false;
+    default:
+        return true;
+    }
+}
+
+bool LEditor::DoLoadUTF8File(const wxString& fileName)
+{
+#if wxVERSION_NUMBER >= 2900
+    // Scintilla stores the document as UTF-8: a file that is already UTF-8 is
+    // mapped and handed to Scintilla as-is, without converting it to a wxString
+    // and back again. Anything else goes through ReadFileWithConversion()
+    clMemoryMappedFile file;
+    if ( !file.Open(fileName) || file.GetLength() >= (size_t)INT_MAX ) {
+        return false;
+    }
+
+    const char* data = file.GetData();
+    size_t      len  = file.GetLength();
+
+    // A UTF-8 BOM is skipped (and written back on save), other BOMs need a conversion
+    char header[4] = { 0, 0, 0, 0 };
+    memcpy(header, data, std::min(len, sizeof(header)));
+
+    BOM bom;
+    wxFontEncoding bomEncoding = BOM::Encoding(header);
+    if ( bomEncoding == wxFONTENCODING_UTF8 ) {
+        bom.SetData(data, 3);
+        data += 3;
+        len  -= 3;
+
+    } else if ( bomEncoding != wxFONTENCODING_SYSTEM ) {
+        return false;
+    }
+
+    bool isAscii = false;
+    if ( !IsValidUTF8(data, len, &isAscii) ) {
+        return false;
+    }
+
+    // Without a BOM the user's encoding is tried first (see ReadFileWithConversion()),
+    // non ASCII content is used as-is only if that encoding is UTF-8
+    wxFontEncoding encoding = GetOptions()->GetFileFontEncoding();
+    if ( bom.Len() == 0 && encoding != wxFONTENCODING_UTF8 && !(isAscii && IsAsciiCompatibleEncoding(encoding)) ) {
+        return false;
+    }
+
+    m_fileBom = bom;
+
+    // The undo buffer is emptied once the file is loaded: do not keep a copy
+    // of the whole file in it meanwhile
+    SetUndoCollection(false);
+    ClearAll();
+    Allocate(len + 1);
+    if ( len ) {
+        AddTextRaw(data, len);
+    }
+    SetUndoCollection(true);
+    return true;
+#else
+    wxUnusedVar(fileName);
+    return false;
+#endif
+}
+
 void LEditor::SetEditorText(const wxString &text)
 {
     HideCompletionBox();
@@ -3598,20 +3678,54 @@ void LEditor::DoHighlightWord()
         return;
     }
 
+    // The snapshot is shared by all the highlight jobs until the document is modified
+    if ( !m_highlightSnapshot ) {
+        m_highlightSnapshot = new StringHighlightSnapshot(GetTextRaw(), GetLength());
+    }
+
+    // The lines on screen are searched first
+    int firstLine    = DocLineFromVisible(GetFirstVisibleLine());
+    int lastLine     = DocLineFromVisible(GetFirstVisibleLine() + LinesOnScreen());
+    int visibleStart = PositionFromLine(firstLine);
+    int visibleEnd   = GetLineEndPosition(lastLine);
+
     // to make the code "smoother" we move the search task to different thread
     StringHighlighterJob *j = new StringHighlighterJob( clMainFrame::Get()->GetMainBook(),
-            GetText().c_str(),
-            word.c_str(),
-            GetFileName().GetFullPath().c_str());
+            m_highlightSnapshot,
+            word,
+            GetFileName().GetFullPath(),
+            ++m_highlightId,
+            visibleStart,
+            visibleEnd);
+
+    // A new word supersedes the highlighting of the previous one
+    j->SetCoalescingKey( wxT("highlight:") + GetFileName().GetFullPath() );
+    j->SetPriority( Job::kPriorityHigh );
     JobQueueSingleton::Instance()->PushJob( j );
 }
 
+void LEditor::DoCancelHighlightWord()
+{
+    // Results of older requests that are already on their way are ignored
+    ++m_highlightId;
+    JobQueueSingleton::Instance()->Cancel( wxT("highlight:") + GetFileName().GetFullPath() );
+}
+
+void LEditor::DoReleaseHighlightSnapshot()
+{
+    if ( m_highlightSnapshot ) {
+        m_highlightSnapshot->DecRef();
+        m_highlightSnapshot = NULL;
+    }
+}
+
 void LEditor::HighlightWord(bool highlight)
 {
     if (highlight) {
         DoHighlightWord();
     } else {
-        SetIndicatorCurrent(2);
+        DoCancelHighlightWord();
+        SetIndicatorCurrent(MARKER_WORD_HIGHLIGHT);
         IndicatorClearRange(0, GetLength());
     }
 }
@@ -4088,6 +4202,11 @@ void LEditor::OnChange(wxStyledTextEvent& event)
 
     if (event.GetModificationType() & wxSTC_MOD_INSERTTEXT || event.GetModificationType() & wxSTC_MOD_DELETETEXT) {
 
+        // The word highlighter must not search an outdated text, nor apply the
+        // positions found by a search that is already running
+        DoCancelHighlightWord();
+        DoReleaseHighlightSnapshot();
+
         // Cache details of the number of lines added/removed
         // This is used to 'update' any affected FindInFiles result. See bug 3153847
         if (event.GetModificationType() & wxSTC_PERFORMED_UNDO) {
@@ -4341,7 +4460,12 @@ void LEditor::SetLexerName(const wxString& lexerName)
 
 void LEditor::HighlightWord(StringHighlightOutput* highlightOutput)
 {
-    // the search highlighter thread has completed the calculations, fetch the results and mark them in the editor
+    // the search highlighter thread has completed a batch, fetch the results and mark them in the editor
+    if ( highlightOutput->id != m_highlightId ) {
+        // a batch of a superseded request
+        return;
+    }
+
     std::vector<std::pair<int, int> > *matches = highlightOutput->matches;
     SetIndicatorCurrent(MARKER_WORD_HIGHLIGHT);
 
@@ -4349,8 +4473,10 @@ void LEditor::HighlightWord(StringHighlightOutput* highlightOutput)
     IndicatorSetUnder(MARKER_WORD_HIGHLIGHT, true);
 #endif
 
-    // clear the old markers
-    IndicatorClearRange(0, GetLength());
+    // the first batch of a request replaces the old markers
+    if ( highlightOutput->clear ) {
+        IndicatorClearRange(0, GetLength());
+    }
 
     for (size_t i=0; i<matches->size(); i++) {
         std::pair<int, int> p = matches->at(i);
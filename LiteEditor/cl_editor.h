@@ -137,6 +137,8 @@ class LEditor : public wxStyledTextCtrl, public IEditor
     bool                                        m_fullLineCopyCut;
     std::vector< std::pair<int,int> >           m_savedMarkers;
     bool                                        m_findBookmarksActive;
+    StringHighlightSnapshot*                    m_highlightSnapshot; // the text the word highlighter searches, released on modification
+    int                                         m_highlightId;       // identifies the latest word highlight request
     std::map<int, wxString>                     m_compilerMessagesMap;
     
 public:
@@ -806,6 +808,9 @@ private:
     void BraceMatch(const bool& bSelRegion);
     void BraceMatch(long pos);
     void DoHighlightWord();
+    void DoCancelHighlightWord();
+    void DoReleaseHighlightSnapshot();
+    bool DoLoadUTF8File(const wxString &fileName);
     void DoSetStatusMessage(const wxString &msg, int col, int seconds_to_live = wxID_ANY);
     bool IsOpenBrace (int position);
     bool IsCloseBrace(int position);
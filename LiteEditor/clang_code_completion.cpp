@@ -37,6 +37,7 @@ ClangCodeCompletion::ClangCodeCompletion()
     : m_allEditorsAreClosing(false)
 {
     EventNotifier::Get()->Connect(wxEVT_ACTIVE_EDITOR_CHANGED,  wxCommandEventHandler(ClangCodeCompletion::OnFileLoaded),        NULL, this);
+    EventNotifier::Get()->Connect(wxEVT_ACTIVE_EDITOR_CHANGED,  wxCommandEventHandler(ClangCodeCompletion::OnActiveEditorChanged),NULL, this);
     EventNotifier::Get()->Connect(wxEVT_FILE_SAVED,             wxCommandEventHandler(ClangCodeCompletion::OnFileSaved),         NULL, this);
     EventNotifier::Get()->Connect(wxEVT_ALL_EDITORS_CLOSING,    wxCommandEventHandler(ClangCodeCompletion::OnAllEditorsClosing), NULL, this);
     EventNotifier::Get()->Connect(wxEVT_ALL_EDITORS_CLOSED,     wxCommandEventHandler(ClangCodeCompletion::OnAllEditorsClosed ), NULL, this);
@@ -48,6 +49,7 @@ ClangCodeCompletion::ClangCodeCompletion()
 ClangCodeCompletion::~ClangCodeCompletion()
 {
     EventNotifier::Get()->Disconnect(wxEVT_ACTIVE_EDITOR_CHANGED,  wxCommandEventHandler(ClangCodeCompletion::OnFileLoaded),        NULL, this);
+    EventNotifier::Get()->Disconnect(wxEVT_ACTIVE_EDITOR_CHANGED,  wxCommandEventHandler(ClangCodeCompletion::OnActiveEditorChanged),NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_FILE_SAVED,             wxCommandEventHandler(ClangCodeCompletion::OnFileSaved),         NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_ALL_EDITORS_CLOSING,    wxCommandEventHandler(ClangCodeCompletion::OnAllEditorsClosing), NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_ALL_EDITORS_CLOSED,     wxCommandEventHandler(ClangCodeCompletion::OnAllEditorsClosed ), NULL, this);
@@ -134,6 +136,24 @@ void ClangCodeCompletion::OnFileLoaded(wxCommandEvent& e)
     }
 }
 
+void ClangCodeCompletion::OnActiveEditorChanged(wxCommandEvent& e)
+{
+    e.Skip();
+    CHECK_CLANG_ENABLED_RET();
+
+    // Parse the files the user is likely to visit next while clang is idle. The warm-up
+    // waits for clang to be idle by itself: unlike the caching above, it is scheduled
+    // on every editor switch, even when clang is busy
+    if(TagsManagerST::Get()->GetCtagsOptions().GetClangCachePolicy() != TagsOptionsData::CLANG_CACHE_ON_FILE_LOAD || m_allEditorsAreClosing)
+        return;
+
+    IEditor *editor = (IEditor*)e.GetClientData();
+    if(!editor || editor->GetProjectName().IsEmpty() || !TagsManagerST::Get()->IsValidCtagsFile(editor->GetFileName()))
+        return;
+
+    m_clang.ScheduleWarmup(editor);
+}
+
 void ClangCodeCompletion::OnAllEditorsClosed(wxCommandEvent& e)
 {
     e.Skip();
@@ -96,6 +96,7 @@ protected:
 
     // Event handling
     void OnFileLoaded(wxCommandEvent &e);
+    void OnActiveEditorChanged(wxCommandEvent &e);
     void OnFileSaved(wxCommandEvent &e);
     void OnAllEditorsClosing(wxCommandEvent &e);
     void OnAllEditorsClosed(wxCommandEvent &e);
@@ -5,6 +5,7 @@
 #include "compilation_database.h"
 #include "pluginmanager.h"
 #include "clang_macro_handler.h"
+#include <wx/hashmap.h>
 #include <wx/regex.h>
 #include "code_completion_box.h"
 #include "clangpch_cache.h"
@@ -53,9 +54,15 @@ ClangDriver::ClangDriver()
     , m_activeEditor(NULL)
     , m_position(wxNOT_FOUND)
 {
+    m_warmupTimer = new wxTimer(this);
+    Connect(m_warmupTimer->GetId(), wxEVT_TIMER, wxTimerEventHandler(ClangDriver::OnWarmupTimer), NULL, this);
+
     m_index = clang_createIndex(0, 0);
-    m_pchMakerThread.SetSleepInterval(30);
-    m_pchMakerThread.Start();
+    for(size_t i=0; i<CLANG_WORKER_THREADS; ++i) {
+        ClangWorkerThread* worker = new ClangWorkerThread(&m_tuCache, &m_pchStore);
+        worker->Start();
+        m_workers.push_back(worker);
+    }
 #ifdef __WXMSW__
     m_clangCleanerThread.Start();
 #endif
@@ -64,6 +71,7 @@ ClangDriver::ClangDriver()
     EventNotifier::Get()->Connect(wxEVT_CLANG_TU_CREATE_ERROR,   wxCommandEventHandler(ClangDriver::OnTUCreateError),  NULL, this);
     EventNotifier::Get()->Connect(wxEVT_CMD_CLANG_MACRO_HADNLER_DELETE, wxCommandEventHandler(ClangDriver::OnDeletMacroHandler),  NULL, this);
     EventNotifier::Get()->Connect(wxEVT_WORKSPACE_LOADED, wxCommandEventHandler(ClangDriver::OnWorkspaceLoaded), NULL, this);
+    EventNotifier::Get()->Connect(wxEVT_CLANG_WARMUP_ENDED, wxCommandEventHandler(ClangDriver::OnWarmupEnded), NULL, this);
 }
 
 ClangDriver::~ClangDriver()
@@ -74,9 +82,20 @@ ClangDriver::~ClangDriver()
     EventNotifier::Get()->Disconnect(wxEVT_CLANG_TU_CREATE_ERROR,   wxCommandEventHandler(ClangDriver::OnTUCreateError), NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_CMD_CLANG_MACRO_HADNLER_DELETE, wxCommandEventHandler(ClangDriver::OnDeletMacroHandler),  NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_WORKSPACE_LOADED, wxCommandEventHandler(ClangDriver::OnWorkspaceLoaded), NULL, this);
+    EventNotifier::Get()->Disconnect(wxEVT_CLANG_WARMUP_ENDED, wxCommandEventHandler(ClangDriver::OnWarmupEnded), NULL, this);
+
+    m_warmupTimer->Stop();
+    Disconnect(m_warmupTimer->GetId(), wxEVT_TIMER, wxTimerEventHandler(ClangDriver::OnWarmupTimer), NULL, this);
+    wxDELETE(m_warmupTimer);
 
-    m_pchMakerThread.Stop();
-    m_pchMakerThread.ClearCache(); // clear cache and dispose all translation units
+    for(size_t i=0; i<m_workers.size(); ++i) {
+        m_workers.at(i)->Stop();
+    }
+    m_workers.at(0)->ClearCache(); // clear cache and dispose all translation units
+    for(size_t i=0; i<m_workers.size(); ++i) {
+        delete m_workers.at(i);
+    }
+    m_workers.clear();
 #ifdef __WXMSW__
     m_clangCleanerThread.Stop();
 #endif
@@ -183,6 +202,7 @@ ClangThreadRequest* ClangDriver::DoMakeClangThreadRequest(IEditor* editor, Worki
             lineNumber,
             column, DoCreateListOfModifiedBuffers(editor));
     request->SetFileName( source_file.GetFullPath() );
+    request->SetPriority(ThreadRequest::kPriorityHigh);
     return request;
 }
 
@@ -203,6 +223,9 @@ void ClangDriver::CodeCompletion(IEditor* editor)
         return;
     }
 
+    // User requests always take precedence over warm-up
+    DoCancelWarmup();
+
     m_activeEditor = editor;
     m_isBusy       = true;
     ClangThreadRequest * request = DoMakeClangThreadRequest(m_activeEditor, GetContext());
@@ -217,7 +240,15 @@ void ClangDriver::CodeCompletion(IEditor* editor)
     /////////////////////////////////////////////////////////////////
     // Put a request on the parsing thread
     //
-    m_pchMakerThread.Add( request );
+    DoQueueRequest( request );
+}
+
+void ClangDriver::DoQueueRequest(ClangThreadRequest* request)
+{
+    // Route by file name: the same file always goes to the same worker,
+    // so a completion in one file never waits for a reparse of another
+    unsigned long hash = wxStringHash::stringHash(request->GetFileName().wc_str());
+    m_workers.at(hash % m_workers.size())->Add( request );
 }
 
 void ClangDriver::Abort()
@@ -405,12 +436,13 @@ FileTypeCmpArgs_t ClangDriver::DoPrepareCompilationArgs(const wxString& projectN
 
 void ClangDriver::ClearCache()
 {
-    m_pchMakerThread.ClearCache();
+    DoCancelWarmup();
+    m_workers.at(0)->ClearCache();
 }
 
 bool ClangDriver::IsCacheEmpty()
 {
-    return m_pchMakerThread.IsCacheEmpty();
+    return m_tuCache.IsEmpty();
 }
 
 void ClangDriver::DoCleanup()
@@ -691,7 +723,11 @@ void ClangDriver::QueueRequest(IEditor *editor, WorkingContext context)
         return;
     }
 
-    m_pchMakerThread.Add( DoMakeClangThreadRequest(editor, context) );
+    DoCancelWarmup();
+    ClangThreadRequest* request = DoMakeClangThreadRequest(editor, context);
+    if ( request ) {
+        DoQueueRequest( request );
+    }
 }
 
 void ClangDriver::ReparseFile(const wxString& filename)
@@ -699,7 +735,7 @@ void ClangDriver::ReparseFile(const wxString& filename)
     //CHECK_CLANG_ENABLED();
     //
     //ClangThreadRequest *req = new ClangThreadRequest(m_index, filename, wxT(""), wxArrayString(), wxT(""), ::CTX_ReparseTU, 0, 0);
-    //m_pchMakerThread.Add( req );
+    //DoQueueRequest( req );
     //CL_DEBUG(wxT("Queued request to re-parse file: %s"), filename.c_str());
 }
 
@@ -723,7 +759,7 @@ void ClangDriver::OnCacheCleared(wxCommandEvent& e)
                 ::CTX_CachePCH, 0, 0, DoCreateListOfModifiedBuffers(editor));
 
         req->SetPchFile(pchFile);
-        m_pchMakerThread.Add( req );
+        DoQueueRequest( req );
         CL_DEBUG( "Preparing clang thread request... done" );
         CL_DEBUG(wxT("OnCacheCleared:: Queued request to build TU for file: %s"), editor->GetFileName().GetFullPath().c_str());
     }
@@ -832,6 +868,13 @@ void ClangDriver::OnWorkspaceLoaded(wxCommandEvent& event)
     cachePath << WorkspaceST::Get()->GetWorkspaceFileName().GetPath() << wxFileName::GetPathSeparator() << wxT(".clang");
     wxMkdir(cachePath);
     ClangTUCache::DeleteDirectoryContent(cachePath);
+
+    // The PCH store is persistent, it is kept across sessions
+    wxString pchPath;
+    pchPath << WorkspaceST::Get()->GetPrivateFolder() << wxFileName::GetPathSeparator() << wxT("clang-pch");
+    wxMkdir(WorkspaceST::Get()->GetPrivateFolder());
+    wxMkdir(pchPath);
+    m_pchStore.SetFolder(pchPath);
 }
 
 ClangThreadRequest::List_t ClangDriver::DoCreateListOfModifiedBuffers(IEditor* excludeEditor)
@@ -866,4 +909,189 @@ void ClangDriver::DoDeleteTempFile(const wxString& fileName)
     }*/
 }
 
+void ClangDriver::ScheduleWarmup(IEditor* editor)
+{
+    if(!editor)
+        return;
+
+    m_warmupQueue.clear();
+
+    wxArrayString candidates;
+    DoCollectWarmupCandidates(editor, candidates);
+    for(size_t i=0; i<candidates.GetCount() && m_warmupQueue.size() < CLANG_WARMUP_MAX_FILES; i++) {
+        if(m_tuCache.Contains(candidates.Item(i)))
+            continue;
+        m_warmupQueue.push_back(candidates.Item(i));
+    }
+
+    CL_DEBUG(wxT("clang warm-up: %u files scheduled after %s"), (unsigned)m_warmupQueue.size(), editor->GetFileName().GetFullName().c_str());
+    if(!m_warmupQueue.empty()) {
+        m_warmupTimer->Start(CLANG_WARMUP_IDLE_DELAY_MS, true);
+    }
+}
+
+void ClangDriver::DoCollectWarmupCandidates(IEditor* editor, wxArrayString& files)
+{
+    wxArrayString all;
+    wxFileName activeFile = editor->GetFileName();
+
+    // 1. The header / source counterpart of the active file
+    FileExtManager::FileType type = FileExtManager::GetType(activeFile.GetFullName());
+    wxArrayString exts;
+    if(type == FileExtManager::TypeSourceC || type == FileExtManager::TypeSourceCpp) {
+        exts.Add(wxT("h"));
+        exts.Add(wxT("hpp"));
+        exts.Add(wxT("hxx"));
+        exts.Add(wxT("hh"));
+
+    } else {
+        exts.Add(wxT("cpp"));
+        exts.Add(wxT("cxx"));
+        exts.Add(wxT("cc"));
+        exts.Add(wxT("c"));
+    }
+
+    for(size_t i=0; i<exts.GetCount(); i++) {
+        wxFileName otherFile(activeFile);
+        otherFile.SetExt(exts.Item(i));
+        if(otherFile.FileExists()) {
+            all.Add(otherFile.GetFullPath());
+        }
+    }
+
+    // 2. The other open editors
+    std::vector<LEditor*> editors;
+    clMainFrame::Get()->GetMainBook()->GetAllEditors(editors, MainBook::kGetAll_IncludeDetached);
+    for(size_t i=0; i<editors.size(); i++) {
+        all.Add(editors.at(i)->GetFileName().GetFullPath());
+    }
+
+    // 3. The most recently opened files
+    wxArrayString recentFiles;
+    clMainFrame::Get()->GetMainBook()->GetRecentlyOpenedFiles(recentFiles);
+    for(size_t i=0; i<recentFiles.GetCount() && i<CLANG_WARMUP_RECENT_FILES; i++) {
+        all.Add(recentFiles.Item(i));
+    }
+
+    // Keep only workspace C/C++ files, in order of preference and without duplicates
+    for(size_t i=0; i<all.GetCount(); i++) {
+        const wxString &fileName = all.Item(i);
+        if(fileName == activeFile.GetFullPath() || files.Index(fileName) != wxNOT_FOUND)
+            continue;
+
+        wxFileName fn(fileName);
+        if(!fn.FileExists() || !TagsManagerST::Get()->IsValidCtagsFile(fn))
+            continue;
+
+        if(ManagerST::Get()->GetProjectNameByFile(fileName).IsEmpty())
+            continue;
+
+        files.Add(fileName);
+    }
+}
+
+ClangThreadRequest* ClangDriver::DoMakeWarmupRequest(const wxString& fileName)
+{
+    // Prefer the editor content if the file is open
+    wxString buffer;
+    LEditor* editor = clMainFrame::Get()->GetMainBook()->FindEditor(fileName);
+    if(editor) {
+        buffer = editor->GetText();
+
+    } else if(!ReadFileWithConversion(fileName, buffer)) {
+        return NULL;
+    }
+
+    wxString projectPath;
+    wxString pchFile;
+    FileTypeCmpArgs_t compileFlags = DoPrepareCompilationArgs(ManagerST::Get()->GetProjectNameByFile(fileName), fileName, projectPath, pchFile);
+
+    ClangThreadRequest* request = new ClangThreadRequest(m_index,
+            fileName,
+            buffer,
+            compileFlags,
+            wxT(""),
+            CTX_CachePCH,
+            0,
+            0, DoCreateListOfModifiedBuffers(editor));
+    request->SetWarmup(true);
+    request->SetPriority(ThreadRequest::kPriorityLow);
+    return request;
+}
+
+void ClangDriver::DoCancelWarmup()
+{
+    m_warmupQueue.clear();
+    m_warmupTimer->Stop();
+
+    // Drop the warm-up request which did not start yet. A request which is already
+    // being parsed can not be interrupted, it will report back when done
+    size_t cancelled = 0;
+    for(size_t i=0; i<m_workers.size(); ++i) {
+        cancelled += m_workers.at(i)->CancelWarmupRequests();
+    }
+
+    if(cancelled) {
+        CL_DEBUG(wxT("clang warm-up: cancelled warm-up of file %s"), m_warmupFile.c_str());
+        m_warmupFile.Clear();
+    }
+}
+
+bool ClangDriver::DoHasWarmupBudget() const
+{
+    // Warm-up may only use the free part of the cache, so it
+    // never evicts the TUs the user is actually working on
+    return m_tuCache.GetMemoryUsage() < (m_tuCache.GetMaxMemory() / 4) * 3;
+}
+
+void ClangDriver::OnWarmupTimer(wxTimerEvent& e)
+{
+    if(m_warmupQueue.empty() || !m_warmupFile.IsEmpty())
+        return;
+
+    if(!(TagsManagerST::Get()->GetCtagsOptions().GetClangOptions() & CC_CLANG_ENABLED)) {
+        m_warmupQueue.clear();
+        return;
+    }
+
+    if(m_isBusy) {
+        // clang is serving the user, try again later
+        m_warmupTimer->Start(CLANG_WARMUP_IDLE_DELAY_MS, true);
+        return;
+    }
+
+    if(!DoHasWarmupBudget()) {
+        CL_DEBUG(wxT("clang warm-up: TU cache is almost full, warm-up stopped"));
+        m_warmupQueue.clear();
+        return;
+    }
+
+    wxString fileName = m_warmupQueue.front();
+    m_warmupQueue.pop_front();
+
+    ClangThreadRequest* request = m_tuCache.Contains(fileName) ? NULL : DoMakeWarmupRequest(fileName);
+    if(!request) {
+        // Nothing to be done for this file, move on to the next one
+        if(!m_warmupQueue.empty()) {
+            m_warmupTimer->Start(CLANG_WARMUP_IDLE_DELAY_MS, true);
+        }
+        return;
+    }
+
+    CL_DEBUG(wxT("clang warm-up: queued file %s"), fileName.c_str());
+    m_warmupFile = fileName;
+    DoQueueRequest(request);
+}
+
+void ClangDriver::OnWarmupEnded(wxCommandEvent& e)
+{
+    ClangThreadReply* reply = reinterpret_cast<ClangThreadReply*>( e.GetClientData() );
+    wxDELETE(reply);
+
+    m_warmupFile.Clear();
+    if(!m_warmupQueue.empty()) {
+        m_warmupTimer->Start(CLANG_WARMUP_IDLE_DELAY_MS, true);
+    }
+}
+
 #endif // HAS_LIBCLANG
@@ -35,6 +35,19 @@
 #include "clang_pch_maker_thread.h"
 #include <clang-c/Index.h>
 #include "clang_cleaner_thread.h"
+#include <vector>
+#include <deque>
+#include <wx/timer.h>
+
+// Number of threads serving clang requests. Requests for the same file are
+// always handled by the same thread, so they are processed in order
+#define CLANG_WORKER_THREADS 3
+
+// Warm-up: the maximum number of files parsed ahead of time per editor switch,
+// and how long clang must be idle before the next file is parsed
+#define CLANG_WARMUP_MAX_FILES 6
+#define CLANG_WARMUP_RECENT_FILES 4
+#define CLANG_WARMUP_IDLE_DELAY_MS 1500
 
 class IEditor;
 class ClangDriverCleaner;
@@ -48,12 +61,17 @@ class ClangDriver : public wxEvtHandler
 {
 protected:
     bool               m_isBusy;
-    ClangWorkerThread  m_pchMakerThread;
+    ClangTUCache       m_tuCache;
+    ClangPCHStore      m_pchStore;
+    std::vector<ClangWorkerThread*> m_workers;
     WorkingContext     m_context;
     CXIndex            m_index;
     IEditor*           m_activeEditor;
     int                m_position;
     ClangCleanerThread m_clangCleanerThread;
+    std::deque<wxString> m_warmupQueue;
+    wxString           m_warmupFile;  // the file being warmed up, empty if none
+    wxTimer*           m_warmupTimer;
     
 protected:
     void                DoCleanup();
@@ -61,7 +79,12 @@ protected:
     void                DoParseCompletionString(CXCompletionString str, int depth, wxString &entryName, wxString &signature, wxString &completeString, wxString &returnValue);
     void                DoGotoDefinition(ClangThreadReply *reply);
     ClangThreadRequest* DoMakeClangThreadRequest(IEditor* editor, WorkingContext context);
+    void                DoQueueRequest(ClangThreadRequest* request);
     ClangThreadRequest::List_t DoCreateListOfModifiedBuffers(IEditor *excludeEditor);
+    ClangThreadRequest* DoMakeWarmupRequest(const wxString &fileName);
+    void                DoCollectWarmupCandidates(IEditor* editor, wxArrayString &files);
+    void                DoCancelWarmup();
+    bool                DoHasWarmupBudget() const;
 
     // Event handlers
     void OnDeletMacroHandler(wxCommandEvent &e);
@@ -77,6 +100,13 @@ public:
     void CodeCompletion(IEditor *editor);
     void Abort();
 
+    /**
+     * @brief parse, in the background, the files the user is likely to visit after 'editor':
+     * its header/source counterpart, the other open editors and the recently opened files.
+     * Files are parsed one by one while clang is idle, as long as the TU cache has room for them
+     */
+    void ScheduleWarmup(IEditor *editor);
+
     bool IsBusy() const {
         return m_isBusy;
     }
@@ -96,6 +126,8 @@ public:
     void OnCacheCleared(wxCommandEvent &e);
     void OnTUCreateError(wxCommandEvent &e);
     void OnWorkspaceLoaded(wxCommandEvent &event);
+    void OnWarmupEnded(wxCommandEvent &e);
+    void OnWarmupTimer(wxTimerEvent &e);
 };
 
 #endif // HAS_LIBCLANG
@@ -23,9 +23,12 @@ const wxEventType wxEVT_CLANG_PCH_CACHE_STARTED = XRCID("clang_pch_cache_started
 const wxEventType wxEVT_CLANG_PCH_CACHE_ENDED   = XRCID("clang_pch_cache_ended");
 const wxEventType wxEVT_CLANG_PCH_CACHE_CLEARED = XRCID("clang_pch_cache_cleared");
 const wxEventType wxEVT_CLANG_TU_CREATE_ERROR   = XRCID("clang_pch_create_error");
+const wxEventType wxEVT_CLANG_WARMUP_ENDED      = XRCID("clang_warmup_ended");
 extern const wxEventType wxEVT_UPDATE_STATUS_BAR;
 
-ClangWorkerThread::ClangWorkerThread()
+ClangWorkerThread::ClangWorkerThread(ClangTUCache* cache, ClangPCHStore* pchStore)
+    : m_cache(cache)
+    , m_pchStore(pchStore)
 {
     clang_toggleCrashRecovery(1);
 }
@@ -36,20 +39,30 @@ ClangWorkerThread::~ClangWorkerThread()
 
 void ClangWorkerThread::ProcessRequest(ThreadRequest* request)
 {
-    // Send start event
-    PostEvent(wxEVT_CLANG_PCH_CACHE_STARTED, "");
-
     ClangThreadRequest *task = dynamic_cast<ClangThreadRequest*>( request );
     wxASSERT_MSG(task, "ClangWorkerThread: NULL task");
 
+    if(task->IsWarmup()) {
+        // Warm-up requests are silent, the driver does not wait for them
+        DoWarmup(task);
+        return;
+    }
+
+    // Send start event
+    PostEvent(wxEVT_CLANG_PCH_CACHE_STARTED, "");
+
+    bool isCached = m_cache->RecordLookup(task->GetFileName());
     {
-        // A bit of optimization
-        wxCriticalSectionLocker locker(m_criticalSection);
-        if(task->GetContext() == CTX_CachePCH && m_cache.Contains(task->GetFileName())) {
-            // Nothing to be done here
-            PostEvent(wxEVT_CLANG_PCH_CACHE_ENDED, task->GetFileName());
-            return;
-        }
+        size_t hits, misses, warmupHits;
+        m_cache->GetStatistics(hits, misses, warmupHits);
+        CL_DEBUG(wxT("clang TU cache: %u hits (%u by warm-up), %u misses"), (unsigned)hits, (unsigned)warmupHits, (unsigned)misses);
+    }
+
+    // A bit of optimization
+    if(task->GetContext() == CTX_CachePCH && isCached) {
+        // Nothing to be done here
+        PostEvent(wxEVT_CLANG_PCH_CACHE_ENDED, task->GetFileName());
+        return;
     }
 
     CL_DEBUG(wxT("==========> [ ClangPchMakerThread ] ProcessRequest started: %s"), task->GetFileName().c_str());
@@ -249,28 +262,62 @@ void ClangWorkerThread::ProcessRequest(ThreadRequest* request)
     }
 }
 
+void ClangWorkerThread::DoWarmup(ClangThreadRequest* task)
+{
+    if(!m_cache->Contains(task->GetFileName())) {
+        CL_DEBUG(wxT("clang warm-up: parsing file %s"), task->GetFileName().c_str());
+
+        ClangCacheEntry cacheEntry;
+        cacheEntry.TU = DoCreateTU(task->GetIndex(), task, true);
+        if(cacheEntry.TU) {
+            cacheEntry.lastReparse = time(NULL);
+            cacheEntry.sourceFile  = task->GetFileName();
+            cacheEntry.warmup      = true;
+            DoCacheResult(cacheEntry);
+        }
+        DoSetStatusMsg(wxT(""));
+    }
+    PostEvent(wxEVT_CLANG_WARMUP_ENDED, task->GetFileName());
+}
+
+size_t ClangWorkerThread::CancelWarmupRequests()
+{
+    wxCriticalSectionLocker locker(m_cs);
+    size_t count = 0;
+    std::deque<ThreadRequest*>::iterator iter = m_queue.begin();
+    while(iter != m_queue.end()) {
+        ClangThreadRequest* req = dynamic_cast<ClangThreadRequest*>(*iter);
+        if(req && req->IsWarmup()) {
+            delete req;
+            iter = m_queue.erase(iter);
+            count++;
+
+        } else {
+            ++iter;
+        }
+    }
+    return count;
+}
+
 ClangCacheEntry ClangWorkerThread::findEntry(const wxString& filename)
 {
-    wxCriticalSectionLocker locker(m_criticalSection);
-    ClangCacheEntry entry = m_cache.GetPCH(filename);
-    return entry;
+    return m_cache->GetPCH(filename);
 }
 
 void ClangWorkerThread::DoCacheResult(ClangCacheEntry entry)
 {
-    wxCriticalSectionLocker locker(m_criticalSection);
-    m_cache.AddPCH(entry);
+    // Measure the TU outside of the cache lock, this is done after every use
+    // since reparsing and code completion change the TU size
+    entry.memoryUsage = ClangTUCache::GetTUMemoryUsage(entry.TU);
+    m_cache->AddPCH(entry);
 
-    CL_DEBUG(wxT("caching Translation Unit file: %s, %p"), entry.sourceFile.c_str(), (void*)entry.TU);
+    CL_DEBUG(wxT("caching Translation Unit file: %s, %p (%u KB)"), entry.sourceFile.c_str(), (void*)entry.TU, (unsigned)(entry.memoryUsage / 1024));
     CL_DEBUG(wxT(" ==========> [ ClangPchMakerThread ] PCH creation ended successfully <=============="));
 }
 
 void ClangWorkerThread::ClearCache()
 {
-    {
-        wxCriticalSectionLocker locker(m_criticalSection);
-        m_cache.Clear();
-    }
+    m_cache->Clear();
 
     this->DoSetStatusMsg(wxT("clang: cache cleared"));
 
@@ -281,11 +328,10 @@ void ClangWorkerThread::ClearCache()
 
 bool ClangWorkerThread::IsCacheEmpty()
 {
-    wxCriticalSectionLocker locker(m_criticalSection);
-    return m_cache.IsEmpty();
+    return m_cache->IsEmpty();
 }
 
-char** ClangWorkerThread::MakeCommandLine(ClangThreadRequest* req, int& argc, FileExtManager::FileType fileType)
+wxArrayString ClangWorkerThread::MakeCompilerArgs(ClangThreadRequest* req, FileExtManager::FileType fileType)
 {
     bool isHeader = !(fileType == FileExtManager::TypeSourceC || fileType == FileExtManager::TypeSourceCpp);
     wxArrayString tokens;
@@ -315,32 +361,7 @@ char** ClangWorkerThread::MakeCommandLine(ClangThreadRequest* req, int& argc, Fi
     tokens.Add(wxT("-fdelayed-template-parsing"));
 #endif
 
-//    static bool gotPCH = false;
-//    if(!gotPCH) {
-//        int nArgc(0);
-//        wxArrayString pchTokens;
-//        pchTokens.insert(pchTokens.end(), tokens.begin(), tokens.end());
-//        pchTokens.Add(wxT("-x"));
-//        pchTokens.Add(wxT("c++-header"));
-//        char **pArgv = ClangUtils::MakeArgv(pchTokens, nArgc);
-//        CXTranslationUnit PCH = clang_parseTranslationUnit(req->GetIndex(), "/home/eran/mypch.h", pArgv, nArgc,
-//                                NULL,
-//                                0,
-//                                CXTranslationUnit_Incomplete);
-//
-//        ClangUtils::FreeArgv(pArgv, nArgc);
-//
-//        if(PCH) {
-//            clang_saveTranslationUnit(PCH, "/home/eran/mypch.pch", clang_defaultSaveOptions(PCH));
-//            clang_disposeTranslationUnit(PCH);
-//
-//            tokens.Add(wxT("-include-pch"));
-//            tokens.Add(wxT("/home/eran/mypch.pch"));
-//        }
-//        gotPCH = true;
-//    }
-    char **argv = ClangUtils::MakeArgv(tokens, argc);
-    return argv;
+    return tokens;
 }
 
 void ClangWorkerThread::DoSetStatusMsg(const wxString& msg)
@@ -396,15 +417,7 @@ CXTranslationUnit ClangWorkerThread::DoCreateTU(CXIndex index, ClangThreadReques
     DoSetStatusMsg(wxString::Format(wxT("clang: parsing file %s..."), fn.GetFullName().c_str()));
 
     FileExtManager::FileType type = FileExtManager::GetType(task->GetFileName());
-    int argc(0);
-    char **argv = MakeCommandLine(task, argc, type);
-
-    for(int i=0; i<argc; i++) {
-        CL_DEBUG(wxT("Command Line Argument: %s"), wxString(argv[i], wxConvUTF8).c_str());
-    }
-
-    std::string c_filename = task->GetFileName().mb_str(wxConvUTF8).data();
-    CL_DEBUG(wxT("Calling clang_parseTranslationUnit..."));
+    wxArrayString args = MakeCompilerArgs(task, type);
 
     // First time, need to create it
     unsigned flags;
@@ -421,14 +434,17 @@ CXTranslationUnit ClangWorkerThread::DoCreateTU(CXIndex index, ClangThreadReques
                 | CXTranslationUnit_DetailedPreprocessingRecord;
     }
 
-    CXTranslationUnit TU = clang_parseTranslationUnit(index,
-                           c_filename.c_str(),
-                           argv,
-                           argc,
-                           NULL, 0, flags);
-
-    CL_DEBUG(wxT("Calling clang_parseTranslationUnit... done"));
-    ClangUtils::FreeArgv(argv, argc);
+    // Use a shared PCH for the file's leading system includes, when one is available
+    wxString pchFile = m_pchStore ? m_pchStore->GetPCH(args, task->GetDirtyBuffer(), type) : wxString();
+    CXTranslationUnit TU = DoParseTU(index, task, args, pchFile, flags);
+    if(!pchFile.IsEmpty() && (!TU || ClangPCHStore::IsPCHRejected(TU))) {
+        // The PCH is stale, parse without it
+        if(TU) {
+            clang_disposeTranslationUnit(TU);
+        }
+        m_pchStore->Invalidate(pchFile);
+        TU = DoParseTU(index, task, args, wxT(""), flags);
+    }
 
     if(TU && reparse) {
         CL_DEBUG(wxT("Calling clang_reparseTranslationUnit..."));
@@ -441,11 +457,40 @@ CXTranslationUnit ClangWorkerThread::DoCreateTU(CXIndex index, ClangThreadReques
 
             // The only thing that left to be done here, is to dispose the TU
             clang_disposeTranslationUnit(TU);
-            PostEvent(wxEVT_CLANG_TU_CREATE_ERROR, task->GetFileName());
+            if(!task->IsWarmup()) {
+                PostEvent(wxEVT_CLANG_TU_CREATE_ERROR, task->GetFileName());
+            }
             return NULL;
         }
     }
     return TU;
 }
 
+CXTranslationUnit ClangWorkerThread::DoParseTU(CXIndex index, ClangThreadRequest* task, const wxArrayString& args, const wxString& pchFile, unsigned flags)
+{
+    wxArrayString tokens = args;
+    if(!pchFile.IsEmpty()) {
+        tokens.Add(wxT("-include-pch"));
+        tokens.Add(pchFile);
+    }
+
+    int argc(0);
+    char **argv = ClangUtils::MakeArgv(tokens, argc);
+    for(int i=0; i<argc; i++) {
+        CL_DEBUG(wxT("Command Line Argument: %s"), wxString(argv[i], wxConvUTF8).c_str());
+    }
+
+    std::string c_filename = task->GetFileName().mb_str(wxConvUTF8).data();
+    CL_DEBUG(wxT("Calling clang_parseTranslationUnit..."));
+    CXTranslationUnit TU = clang_parseTranslationUnit(index,
+                           c_filename.c_str(),
+                           argv,
+                           argc,
+                           NULL, 0, flags);
+
+    CL_DEBUG(wxT("Calling clang_parseTranslationUnit... done"));
+    ClangUtils::FreeArgv(argv, argc);
+    return TU;
+}
+
 #endif // HAS_LIBCLANG
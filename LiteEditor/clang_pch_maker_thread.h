@@ -30,6 +30,7 @@
 
 #include "worker_thread.h" // Base class: ThreadRequest
 #include "clangpch_cache.h"
+#include "clang_pch_store.h"
 #include <clang-c/Index.h>
 #include <set>
 #include "fileextmanager.h"
@@ -41,6 +42,7 @@ extern const wxEventType wxEVT_CLANG_PCH_CACHE_STARTED ;
 extern const wxEventType wxEVT_CLANG_PCH_CACHE_ENDED   ;
 extern const wxEventType wxEVT_CLANG_PCH_CACHE_CLEARED ;
 extern const wxEventType wxEVT_CLANG_TU_CREATE_ERROR ;
+extern const wxEventType wxEVT_CLANG_WARMUP_ENDED ;
 
 typedef std::map<FileExtManager::FileType, wxArrayString> FileTypeCmpArgs_t;
 
@@ -84,6 +86,7 @@ private:
     unsigned          _line;
     unsigned          _column;
     List_t            _modifiedBuffers;
+    bool              _warmup;
 
 public:
     ClangThreadRequest( CXIndex index,
@@ -101,7 +104,8 @@ public:
         , _filterWord(filterWord)
         , _context(context)
         , _line(line)
-        , _column(column) {
+        , _column(column)
+        , _warmup(false) {
         // Perform a deep copy of the map (as wxWidgets is not known for its wxString thread safety)
         FileTypeCmpArgs_t::const_iterator iter = compArgs.begin();
         for(; iter != compArgs.end(); ++iter) {
@@ -156,6 +160,16 @@ public:
     const List_t& GetModifiedBuffers() const {
         return _modifiedBuffers;
     }
+    /**
+     * @brief a warm-up request parses a file the user is likely to need next.
+     * It only fills the TU cache and is dropped as soon as a user request arrives
+     */
+    void SetWarmup(bool warmup) {
+        this->_warmup = warmup;
+    }
+    bool IsWarmup() const {
+        return _warmup;
+    }
 };
 
 ////////////////////////////////////////////////////////////
@@ -166,22 +180,29 @@ class ClangWorkerThread : public WorkerThread
 {
     friend class CacheReturner;
 protected:
-    wxCriticalSection m_criticalSection;
-    ClangTUCache     m_cache;
+    ClangTUCache*    m_cache;    // shared by all the workers
+    ClangPCHStore*   m_pchStore; // shared by all the workers
 
 public:
-    ClangWorkerThread();
+    ClangWorkerThread(ClangTUCache* cache, ClangPCHStore* pchStore);
     virtual ~ClangWorkerThread();
 
 protected:
-    char**             MakeCommandLine(ClangThreadRequest* req, int& argc, FileExtManager::FileType fileType);
+    wxArrayString      MakeCompilerArgs(ClangThreadRequest* req, FileExtManager::FileType fileType);
+    CXTranslationUnit  DoParseTU(CXIndex index, ClangThreadRequest *task, const wxArrayString& args, const wxString& pchFile, unsigned flags);
     void               DoCacheResult(ClangCacheEntry entry);
     void DoSetStatusMsg(const wxString &msg);
     bool               DoGotoDefinition(CXTranslationUnit& TU, ClangThreadRequest* request, ClangThreadReply* reply);
     void               PostEvent(int type, const wxString &fileName);
     CXTranslationUnit  DoCreateTU(CXIndex index, ClangThreadRequest *task, bool reparse);
+    void               DoWarmup(ClangThreadRequest *task);
 public:
     virtual void ProcessRequest(ThreadRequest* task);
+    /**
+     * @brief remove all the warm-up requests which are still waiting in the queue
+     * @return the number of requests removed
+     */
+    size_t            CancelWarmupRequests();
     ClangCacheEntry findEntry(const wxString &filename);
     void              ClearCache();
     bool              IsCacheEmpty();
@@ -0,0 +1,246 @@
+#if HAS_LIBCLANG
+
+#include "clang_pch_store.h"
+#include "clang_utils.h"
+#include "file_logger.h"
+#include "jobqueue.h"
+#include "wxmd5.h"
+#include <wx/filename.h>
+#include <wx/filefn.h>
+#include <wx/ffile.h>
+#include <wx/log.h>
+
+// Don't look for the include prefix beyond this line
+#define CLANG_PCH_MAX_PREFIX_LINES 500
+
+ClangPCHStore::ClangPCHStore()
+{
+}
+
+ClangPCHStore::~ClangPCHStore()
+{
+}
+
+void ClangPCHStore::SetFolder(const wxString& folder)
+{
+    wxCriticalSectionLocker locker(m_cs);
+    m_folder = folder.c_str();
+    m_requested.clear();
+    m_invalidated.clear();
+}
+
+wxString ClangPCHStore::GetPCH(const wxArrayString& args, const wxString& buffer, FileExtManager::FileType fileType)
+{
+    if(fileType != FileExtManager::TypeSourceC && fileType != FileExtManager::TypeSourceCpp) {
+        return wxT("");
+    }
+
+    wxString folder;
+    {
+        wxCriticalSectionLocker locker(m_cs);
+        folder = m_folder.c_str();
+    }
+
+    if(folder.IsEmpty()) {
+        return wxT("");
+    }
+
+    wxArrayString includes = GetIncludePrefix(buffer);
+    if(includes.IsEmpty()) {
+        return wxT("");
+    }
+
+    // Build the header content and the key
+    wxString content;
+    for(size_t i=0; i<includes.GetCount(); i++) {
+        content << includes.Item(i) << wxT("\n");
+    }
+
+    wxArrayString pchArgs = args;
+    pchArgs.Add(wxT("-x"));
+    pchArgs.Add(fileType == FileExtManager::TypeSourceC ? wxT("c-header") : wxT("c++-header"));
+
+    wxString key;
+    for(size_t i=0; i<pchArgs.GetCount(); i++) {
+        key << pchArgs.Item(i) << wxT("\n");
+    }
+    key << content;
+    key = wxMD5::GetDigest(key);
+
+    wxFileName pchFile(folder, key + wxT(".pch"));
+    if(pchFile.FileExists()) {
+        return pchFile.GetFullPath();
+    }
+
+    {
+        wxCriticalSectionLocker locker(m_cs);
+        if(m_requested.count(key)) {
+            // already being built (or failed to build) during this session
+            return wxT("");
+        }
+        m_requested.insert(key);
+    }
+
+    wxFileName headerFile(folder, key + wxT(".h"));
+    CL_DEBUG(wxT("Queuing PCH build: %s"), pchFile.GetFullPath().c_str());
+    JobQueueSingleton::Instance()->PushJob(new ClangPCHBuildJob(headerFile.GetFullPath(), pchFile.GetFullPath(), content, pchArgs));
+    return wxT("");
+}
+
+void ClangPCHStore::Invalidate(const wxString& pchFile)
+{
+    wxString key = wxFileName(pchFile).GetName();
+    CL_DEBUG(wxT("PCH %s was rejected by clang, deleting it"), pchFile.c_str());
+    {
+        wxLogNull nolog;
+        ::wxRemoveFile(pchFile);
+    }
+
+    // Allow a single rebuild per session, if the new PCH is rejected as well
+    // we keep the key as 'requested' so it won't be built again
+    wxCriticalSectionLocker locker(m_cs);
+    if(m_invalidated.count(key) == 0) {
+        m_invalidated.insert(key);
+        m_requested.erase(key);
+    }
+}
+
+bool ClangPCHStore::IsPCHRejected(CXTranslationUnit TU)
+{
+    bool rejected = false;
+    unsigned count = clang_getNumDiagnostics(TU);
+    for(unsigned i=0; i<count && !rejected; i++) {
+        CXDiagnostic diag = clang_getDiagnostic(TU, i);
+        if(clang_getDiagnosticSeverity(diag) == CXDiagnostic_Fatal) {
+            CXString str = clang_getDiagnosticSpelling(diag);
+            wxString message(clang_getCString(str), wxConvUTF8);
+            clang_disposeString(str);
+            rejected = message.Contains(wxT("precompiled header")) || message.Contains(wxT("AST file"));
+        }
+        clang_disposeDiagnostic(diag);
+    }
+    return rejected;
+}
+
+wxArrayString ClangPCHStore::GetIncludePrefix(const wxString& buffer)
+{
+    wxArrayString includes;
+    bool inComment = false;
+    size_t start = 0;
+    size_t lineCount = 0;
+    while(start < buffer.length() && lineCount < CLANG_PCH_MAX_PREFIX_LINES) {
+        size_t end = buffer.find(wxT('\n'), start);
+        if(end == wxString::npos) {
+            end = buffer.length();
+        }
+
+        wxString line = buffer.Mid(start, end - start);
+        line.Trim().Trim(false);
+        start = end + 1;
+        ++lineCount;
+
+        if(inComment) {
+            int where = line.Find(wxT("*/"));
+            if(where == wxNOT_FOUND) {
+                continue;
+            }
+            inComment = false;
+            line = line.Mid(where + 2).Trim(false);
+        }
+
+        if(line.IsEmpty() || line.StartsWith(wxT("//"))) {
+            continue;
+        }
+
+        if(line.StartsWith(wxT("/*"))) {
+            int where = line.Find(wxT("*/"));
+            if(where == wxNOT_FOUND) {
+                inComment = true;
+                continue;
+            }
+            if(line.Mid(where + 2).Trim(false).IsEmpty()) {
+                continue;
+            }
+            break;
+        }
+
+        // Only system/library includes are shared: they are the same for all the
+        // files of a project and they are not expected to change while editing
+        wxString rest;
+        if(!line.StartsWith(wxT("#"), &rest)) {
+            break;
+        }
+
+        rest.Trim(false);
+        if(!rest.StartsWith(wxT("include"), &rest)) {
+            break;
+        }
+
+        // Stop at the first project header: it may define macros (_GNU_SOURCE,
+        // NDEBUG, UNICODE...) that change how the library includes that follow it
+        // are parsed, so these must not be moved into the PCH ahead of it
+        rest.Trim(false);
+        if(!rest.StartsWith(wxT("<")) || !rest.EndsWith(wxT(">"))) {
+            break;
+        }
+        includes.Add(wxString() << wxT("#include ") << rest);
+    }
+    return includes;
+}
+
+ClangPCHBuildJob::ClangPCHBuildJob(const wxString& headerFile, const wxString& pchFile, const wxString& content, const wxArrayString& args)
+    : Job(NULL)
+    , m_headerFile(headerFile.c_str())
+    , m_pchFile(pchFile.c_str())
+    , m_content(content.c_str())
+{
+    // Perform a deep copy, this object is used by another thread
+    for(size_t i=0; i<args.GetCount(); i++) {
+        m_args.Add(args.Item(i).c_str());
+    }
+}
+
+ClangPCHBuildJob::~ClangPCHBuildJob()
+{
+}
+
+void ClangPCHBuildJob::Process(wxThread* thread)
+{
+    wxUnusedVar(thread);
+
+    {
+        wxFFile fp(m_headerFile, wxT("w+b"));
+        if(!fp.IsOpened() || !fp.Write(m_content, wxConvUTF8)) {
+            return;
+        }
+        fp.Close();
+    }
+
+    CXIndex index = clang_createIndex(0, 0);
+    int argc(0);
+    char **argv = ClangUtils::MakeArgv(m_args, argc);
+    CXTranslationUnit TU = clang_parseTranslationUnit(index,
+                           m_headerFile.mb_str(wxConvUTF8).data(),
+                           argv,
+                           argc,
+                           NULL, 0, CXTranslationUnit_Incomplete);
+    ClangUtils::FreeArgv(argv, argc);
+
+    if(TU) {
+        // Save into a temporary file first so a PCH is never seen half written
+        wxString tmpFile = m_pchFile + wxT(".tmp");
+        if(clang_saveTranslationUnit(TU, tmpFile.mb_str(wxConvUTF8).data(), clang_defaultSaveOptions(TU)) == CXSaveError_None) {
+            ::wxRenameFile(tmpFile, m_pchFile, true);
+            CL_DEBUG(wxT("PCH created: %s"), m_pchFile.c_str());
+
+        } else {
+            wxLogNull nolog;
+            ::wxRemoveFile(tmpFile);
+            CL_DEBUG(wxT("Failed to save PCH: %s"), m_pchFile.c_str());
+        }
+        clang_disposeTranslationUnit(TU);
+    }
+    clang_disposeIndex(index);
+}
+
+#endif // HAS_LIBCLANG
@@ -0,0 +1,82 @@
+#ifndef CLANGPCHSTORE_H
+#define CLANGPCHSTORE_H
+
+#if HAS_LIBCLANG
+
+#include <wx/string.h>
+#include <wx/arrstr.h>
+#include <wx/thread.h>
+#include <clang-c/Index.h>
+#include "macros.h"
+#include "fileextmanager.h"
+#include "job.h" // Base class: Job
+
+/**
+ * @class ClangPCHStore
+ * @brief a persistent store of precompiled headers kept under the workspace private folder.
+ * A PCH is keyed by the compiler arguments and by the leading run of '#include <...>' lines
+ * of the source file. All the files that share both reuse the same PCH, also across IDE restarts.
+ * PCHs are built in the background by the job queue; all methods are thread safe
+ */
+class ClangPCHStore
+{
+    wxCriticalSection m_cs;
+    wxString          m_folder;
+    wxStringSet_t     m_requested;   // keys whose build was queued during this session
+    wxStringSet_t     m_invalidated; // keys that were found stale during this session
+
+public:
+    ClangPCHStore();
+    virtual ~ClangPCHStore();
+
+    /**
+     * @brief set the folder holding the PCH files. An empty folder disables the store
+     */
+    void SetFolder(const wxString& folder);
+
+    /**
+     * @brief return the PCH file to use for a source file compiled with 'args' or an empty string.
+     * When there is no PCH yet, its build is queued and an empty string is returned
+     */
+    wxString GetPCH(const wxArrayString& args, const wxString& buffer, FileExtManager::FileType fileType);
+
+    /**
+     * @brief clang rejected the PCH (e.g. one of its headers was modified since it was built).
+     * Delete it so it is rebuilt on the next use
+     */
+    void Invalidate(const wxString& pchFile);
+
+    /**
+     * @brief return true if the TU failed to load its precompiled header
+     */
+    static bool IsPCHRejected(CXTranslationUnit TU);
+
+    /**
+     * @brief return the '#include <...>' lines found at the top of the buffer,
+     * skipping comments and empty lines, up to the first line of any other kind
+     * (including an '#include "..."' line)
+     */
+    static wxArrayString GetIncludePrefix(const wxString& buffer);
+};
+
+/**
+ * @class ClangPCHBuildJob
+ * @brief build a single PCH file of the ClangPCHStore
+ */
+class ClangPCHBuildJob : public Job
+{
+    wxString      m_headerFile;
+    wxString      m_pchFile;
+    wxString      m_content;
+    wxArrayString m_args;
+
+public:
+    ClangPCHBuildJob(const wxString& headerFile, const wxString& pchFile, const wxString& content, const wxArrayString& args);
+    virtual ~ClangPCHBuildJob();
+
+public:
+    virtual void Process(wxThread* thread);
+};
+
+#endif // HAS_LIBCLANG
+#endif // CLANGPCHSTORE_H
@@ -7,7 +7,11 @@
 #include "file_logger.h"
 
 ClangTUCache::ClangTUCache()
-    : m_maxItems(10)
+    : m_memoryUsage(0)
+    , m_maxMemory(CLANG_TU_CACHE_DEFAULT_MEMORY_MB * 1024 * 1024)
+    , m_hits(0)
+    , m_misses(0)
+    , m_warmupHits(0)
 {
 }
 
@@ -15,63 +19,125 @@ ClangTUCache::~ClangTUCache()
 {
 }
 
+void ClangTUCache::SetMaxMemory(size_t maxMemory)
+{
+    wxCriticalSectionLocker locker(m_cs);
+    m_maxMemory = maxMemory;
+}
+
+size_t ClangTUCache::GetMemoryUsage() const
+{
+    wxCriticalSectionLocker locker(m_cs);
+    return m_memoryUsage;
+}
+
+bool ClangTUCache::RecordLookup(const wxString& filename)
+{
+    wxCriticalSectionLocker locker(m_cs);
+    CacheMap_t::iterator iter = m_cache.find(filename);
+    if(iter == m_cache.end()) {
+        m_misses++;
+        return false;
+    }
+
+    m_hits++;
+    if(iter->second.entry.warmup) {
+        // Count a warm-up TU only once, the first time the user needs it
+        m_warmupHits++;
+        iter->second.entry.warmup = false;
+    }
+    return true;
+}
+
+void ClangTUCache::GetStatistics(size_t& hits, size_t& misses, size_t& warmupHits) const
+{
+    wxCriticalSectionLocker locker(m_cs);
+    hits       = m_hits;
+    misses     = m_misses;
+    warmupHits = m_warmupHits;
+}
+
+size_t ClangTUCache::GetTUMemoryUsage(CXTranslationUnit TU)
+{
+    if(!TU) {
+        return 0;
+    }
+
+    size_t total = 0;
+    CXTUResourceUsage usage = clang_getCXTUResourceUsage(TU);
+    for(unsigned i=0; i<usage.numEntries; i++) {
+        total += usage.entries[i].amount;
+    }
+    clang_disposeCXTUResourceUsage(usage);
+    return total;
+}
+
 ClangCacheEntry ClangTUCache::GetPCH(const wxString& filename)
 {
-    std::map<wxString, ClangCacheEntry>::iterator iter = m_cache.find(filename);
+    wxCriticalSectionLocker locker(m_cs);
+    CacheMap_t::iterator iter = m_cache.find(filename);
     if(iter == m_cache.end()) {
         return ClangCacheEntry();
     }
     // Remove this entry from the cache. It is up to the caller to place it back!
-    ClangCacheEntry entry = iter->second;
+    ClangCacheEntry entry = iter->second.entry;
+    m_memoryUsage -= entry.memoryUsage;
+    m_lru.erase(iter->second.lruPosition);
     m_cache.erase(iter);
     return entry;
 }
 
 void ClangTUCache::AddPCH(ClangCacheEntry entry)
 {
+    wxCriticalSectionLocker locker(m_cs);
+
     // See if we already have a cache entry for this file name
-    std::map<wxString, ClangCacheEntry>::iterator iter = m_cache.find(entry.sourceFile);
-    if(iter != m_cache.end() && iter->second.TU == entry.TU) {
-        // the entry in the cache is the same as this one
-        // Just update the access-time
-        iter->second.lastAccessed = time(NULL);
-        return;
+    CacheMap_t::iterator iter = m_cache.find(entry.sourceFile);
+    if(iter != m_cache.end()) {
+        if(iter->second.entry.TU == entry.TU) {
+            // the entry in the cache is the same as this one
+            // Just update the access-time and move it to the front
+            iter->second.entry.lastAccessed = time(NULL);
+            m_lru.splice(m_lru.begin(), m_lru, iter->second.lruPosition);
+            return;
+        }
+        // A different TU for the same file: the new one wins
+        DoRemoveEntry(iter);
     }
 
     entry.lastAccessed = time(NULL);
-    m_cache.insert(std::make_pair(entry.sourceFile, entry));
-
-    if(m_cache.size() > m_maxItems) {
-        CL_DEBUG1(wxT("clang PCH cache size reached its maximum size, removing last accessed entry"));
-        time_t oldest_timestamp = time(NULL);
-        // iterate over the cache and remove the oldest item from the cache
-        std::map<wxString, ClangCacheEntry>::iterator it = m_cache.begin();
-        wxString key_to_remove;
-        for(; it != m_cache.end(); it++) {
-            if(it->second.lastAccessed <= oldest_timestamp) {
-                key_to_remove    = it->first;
-                oldest_timestamp = it->second.lastAccessed;
-            }
-        }
-
-        if(key_to_remove.IsEmpty() == false) {
-            CL_DEBUG(wxT("Removing entry for key: %s"), key_to_remove.c_str());
-            RemoveEntry(key_to_remove);
-        }
+    m_lru.push_front(entry.sourceFile);
+
+    CacheNode node;
+    node.entry       = entry;
+    node.lruPosition = m_lru.begin();
+    m_cache.insert(std::make_pair(entry.sourceFile, node));
+    m_memoryUsage += entry.memoryUsage;
+
+    // Evict the least recently used TUs until we are back within the budget.
+    // The entry we just added is always kept, even if it alone exceeds the budget
+    while(m_memoryUsage > m_maxMemory && m_cache.size() > 1) {
+        const wxString& key_to_remove = m_lru.back();
+        CL_DEBUG(wxT("clang TU cache exceeds its memory budget (%u MB), removing entry for key: %s"),
+                 (unsigned)(m_memoryUsage / (1024 * 1024)), key_to_remove.c_str());
+        DoRemoveEntry(m_cache.find(key_to_remove));
     }
 }
 
 void ClangTUCache::Clear()
 {
+    wxCriticalSectionLocker locker(m_cs);
     CL_DEBUG(wxT("clang PCH cache cleared!"));
-    std::map<wxString, ClangCacheEntry>::iterator it = m_cache.begin();
+    CacheMap_t::iterator it = m_cache.begin();
     for(; it != m_cache.end(); it++) {
-        if(it->second.TU) {
-            CL_DEBUG(wxT("Deleting TU: %p"), (void*)it->second.TU);
-            clang_disposeTranslationUnit(it->second.TU);
+        if(it->second.entry.TU) {
+            CL_DEBUG(wxT("Deleting TU: %p"), (void*)it->second.entry.TU);
+            clang_disposeTranslationUnit(it->second.entry.TU);
         }
     }
     m_cache.clear();
+    m_lru.clear();
+    m_memoryUsage = 0;
 
     // Clear the TU from the file system
     //if(WorkspaceST::Get()->IsOpen()) {
@@ -85,29 +151,46 @@ void ClangTUCache::Clear()
 
 void ClangTUCache::RemoveEntry(const wxString& filename)
 {
-    std::map<wxString, ClangCacheEntry>::iterator iter = m_cache.find(filename);
+    wxCriticalSectionLocker locker(m_cs);
+    CacheMap_t::iterator iter = m_cache.find(filename);
     if(iter != m_cache.end()) {
-        CL_DEBUG(wxT("clang_disposeTranslationUnit for TU: %p"), (void*)iter->second.TU);
-        clang_disposeTranslationUnit(iter->second.TU);
-        {
-            wxLogNull nolog;
-            wxRemoveFile(iter->second.fileTU);
-        }
-        // it is now safe to erase the iter
-        m_cache.erase(iter);
+        DoRemoveEntry(iter);
     }
 }
 
+void ClangTUCache::DoRemoveEntry(CacheMap_t::iterator iter)
+{
+    CL_DEBUG(wxT("clang_disposeTranslationUnit for TU: %p"), (void*)iter->second.entry.TU);
+    clang_disposeTranslationUnit(iter->second.entry.TU);
+    {
+        wxLogNull nolog;
+        wxRemoveFile(iter->second.entry.fileTU);
+    }
+    m_memoryUsage -= iter->second.entry.memoryUsage;
+    m_lru.erase(iter->second.lruPosition);
+
+    // it is now safe to erase the iter
+    m_cache.erase(iter);
+}
+
+bool ClangTUCache::IsEmpty() const
+{
+    wxCriticalSectionLocker locker(m_cs);
+    return m_cache.empty();
+}
+
 bool ClangTUCache::Contains(const wxString& filename) const
 {
+    wxCriticalSectionLocker locker(m_cs);
     return m_cache.find(filename) != m_cache.end();
 }
 
 wxString ClangTUCache::GetTuFileName(const wxString& sourceFile) const
 {
-    std::map<wxString, ClangCacheEntry>::const_iterator iter = m_cache.find(sourceFile);
+    wxCriticalSectionLocker locker(m_cs);
+    CacheMap_t::const_iterator iter = m_cache.find(sourceFile);
     if(iter != m_cache.end())
-        return iter->second.fileTU;
+        return iter->second.entry.fileTU;
     return wxT("");
 }
 
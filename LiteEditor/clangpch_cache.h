@@ -29,8 +29,10 @@
 #if HAS_LIBCLANG
 
 #include <wx/string.h>
+#include <wx/thread.h>
 #include <map>
 #include <set>
+#include <list>
 #include "globals.h"
 #include <clang-c/Index.h>
 
@@ -42,10 +44,12 @@ public:
 	wxString          fileTU;
 	wxString          sourceFile;
 	time_t            lastReparse;
+	size_t            memoryUsage; // bytes, as reported by clang_getCXTUResourceUsage
+	bool              warmup;      // created by a warm-up request and not yet used
 	
 public:
 	
-	ClangCacheEntry() : TU(NULL), lastAccessed(0), lastReparse(0) {}
+	ClangCacheEntry() : TU(NULL), lastAccessed(0), lastReparse(0), memoryUsage(0), warmup(false) {}
 	ClangCacheEntry(const ClangCacheEntry &rhs) {
 		*this = rhs;
 	}
@@ -56,6 +60,8 @@ public:
 		this->fileTU       = rhs.fileTU;
 		this->sourceFile   = rhs.sourceFile;
 		this->lastReparse  = rhs.lastReparse;
+		this->memoryUsage  = rhs.memoryUsage;
+		this->warmup       = rhs.warmup;
 	}
 	
 	bool IsOk() const {
@@ -63,15 +69,61 @@ public:
 	}
 };
 
+// Default memory budget of the TU cache
+#define CLANG_TU_CACHE_DEFAULT_MEMORY_MB 1024
+
+/**
+ * @class ClangTUCache
+ * @brief a LRU cache of translation units, bounded by the memory used by the cached TUs.
+ * The cache is shared by all the clang worker threads, all methods are thread safe.
+ * A TU returned by GetPCH() is removed from the cache, so it is never used by two threads
+ */
 class ClangTUCache
 {
 protected:
-	std::map<wxString, ClangCacheEntry> m_cache;
-	size_t                              m_maxItems;
+	struct CacheNode {
+		ClangCacheEntry                entry;
+		std::list<wxString>::iterator  lruPosition;
+	};
+	
+	typedef std::map<wxString, CacheNode> CacheMap_t;
+	
+	CacheMap_t                 m_cache;
+	std::list<wxString>        m_lru;          // most recently used first
+	size_t                     m_memoryUsage;  // total bytes used by the cached TUs
+	size_t                     m_maxMemory;
+	size_t                     m_hits;         // user requests that found their TU in the cache
+	size_t                     m_misses;       // user requests that had to parse their TU
+	size_t                     m_warmupHits;   // hits on TUs that were created by a warm-up request
+	mutable wxCriticalSection  m_cs;
+	
+protected:
+	void DoRemoveEntry(CacheMap_t::iterator iter);
 	
 public:
 	ClangTUCache();
 	virtual ~ClangTUCache();
+	
+	/**
+	 * @brief set the memory budget (in bytes) of the cache
+	 */
+	void SetMaxMemory(size_t maxMemory);
+	size_t GetMaxMemory() const {
+		return m_maxMemory;
+	}
+	size_t GetMemoryUsage() const;
+	
+	/**
+	 * @brief record a user request for 'filename' in the cache statistics
+	 * @return true if the TU of the file is cached
+	 */
+	bool RecordLookup(const wxString &filename);
+	void GetStatistics(size_t &hits, size_t &misses, size_t &warmupHits) const;
+	
+	/**
+	 * @brief return the number of bytes used by the given translation unit
+	 */
+	static size_t GetTUMemoryUsage(CXTranslationUnit TU);
 
 	ClangCacheEntry GetPCH(const wxString &filename);
 	void AddPCH(ClangCacheEntry entry);
@@ -79,9 +131,7 @@ public:
 	void Clear();
     bool Contains(const wxString &filename) const;
 	wxString GetTuFileName(const wxString &sourceFile) const;
-	bool IsEmpty() const {
-		return m_cache.empty();
-	}
+	bool IsEmpty() const;
 	
 	static void DeleteDirectoryContent(const wxString &directory);
 };
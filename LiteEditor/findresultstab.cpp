@@ -42,6 +42,9 @@
 #include "event_notifier.h"
 #include "theme_handler.h"
 #include "cl_config.h"
+#include <algorithm>
+#include <string>
+#include <vector>
 
 // Custom styles
 #define LEX_FIF_DEFAULT        0
@@ -52,10 +55,122 @@
 #define LEX_FIF_SCOPE          5
 #define LEX_FIF_MATCH_COMMENT  6
 
+// The number of matches a Find in Files page renders at once, the rest are
+// rendered on demand (see FindResultsTab::DoShowMoreMatches)
+#define FIF_DEFAULT_MAX_RENDERED_MATCHES 5000
+
+static size_t GetMaxRenderedMatches()
+{
+    int count = clConfig::Get().Read("FindInFilesMaxRenderedMatches", FIF_DEFAULT_MAX_RENDERED_MATCHES);
+    return count > 0 ? (size_t)count : FIF_DEFAULT_MAX_RENDERED_MATCHES;
+}
+
+/**
+ * @class FindResultsStore
+ * @brief the matches of a search that were not rendered yet. Matches are kept in a
+ * compact form: the file name and the searched string are stored once and not per match,
+ * the matched line is kept as UTF-8
+ */
+class FindResultsStore
+{
+    struct Match {
+        size_t      m_file;
+        int         m_position;
+        int         m_lineNumber;
+        int         m_column;
+        int         m_len;
+        int         m_columnInChars;
+        int         m_lenInChars;
+        short       m_matchState;
+        std::string m_pattern;
+    };
+
+    std::vector<wxString> m_files;
+    std::vector<Match>    m_matches;
+    size_t                m_next;
+    wxString              m_findWhat;
+    size_t                m_flags;
+
+public:
+    FindResultsStore()
+        : m_next(0)
+        , m_flags(0)
+    {}
+
+    void Add(const SearchResult &result) {
+        if ( m_matches.empty() ) {
+            m_findWhat = result.GetFindWhat();
+            m_flags    = result.GetFlags();
+        }
+
+        // the search thread reports the matches of a file together
+        if ( m_files.empty() || m_files.back() != result.GetFileName() ) {
+            m_files.push_back( result.GetFileName() );
+        }
+
+        m_matches.push_back( Match() );
+        Match& match = m_matches.back();
+        match.m_file          = m_files.size() - 1;
+        match.m_position      = result.GetPosition();
+        match.m_lineNumber    = result.GetLineNumber();
+        match.m_column        = result.GetColumn();
+        match.m_len           = result.GetLen();
+        match.m_columnInChars = result.GetColumnInChars();
+        match.m_lenInChars    = result.GetLenInChars();
+        match.m_matchState    = result.GetMatchState();
+
+        const wxCharBuffer pattern = result.GetPattern().mb_str(wxConvUTF8);
+        if ( pattern.data() ) {
+            match.m_pattern = pattern.data();
+        }
+    }
+
+    /**
+     * @brief move up to 'count' matches (in the order they were added) into 'results'
+     */
+    void Take(size_t count, SearchResultList &results) {
+        for ( ; count && m_next < m_matches.size(); --count, ++m_next ) {
+            const Match& match = m_matches.at(m_next);
+            SearchResult result;
+            result.SetFileName     ( m_files.at(match.m_file) );
+            result.SetFindWhat     ( m_findWhat );
+            result.SetFlags        ( m_flags );
+            result.SetPosition     ( match.m_position );
+            result.SetLineNumber   ( match.m_lineNumber );
+            result.SetColumn       ( match.m_column );
+            result.SetLen          ( match.m_len );
+            result.SetColumnInChars( match.m_columnInChars );
+            result.SetLenInChars   ( match.m_lenInChars );
+            result.SetMatchState   ( match.m_matchState );
+            result.SetPattern      ( wxString(match.m_pattern.c_str(), wxConvUTF8) );
+            results.push_back( result );
+        }
+
+        if ( m_next == m_matches.size() ) {
+            Clear();
+        }
+    }
+
+    size_t GetCount() const {
+        return m_matches.size() - m_next;
+    }
+
+    void Clear() {
+        // release the memory as well
+        std::vector<wxString>().swap( m_files );
+        std::vector<Match>().swap( m_matches );
+        m_next = 0;
+    }
+};
+
 class MySTC : public wxStyledTextCtrl
 {
 public:
-    MySTC(wxWindow* parent) : wxStyledTextCtrl( parent ) {}
+    FindResultsStore m_pending;      // matches that are not rendered yet
+    int              m_showMoreLine; // the line of the "show more" message or wxNOT_FOUND
+
+public:
+    MySTC(wxWindow* parent) : wxStyledTextCtrl( parent ), m_showMoreLine(wxNOT_FOUND) {}
     virtual ~MySTC() {
         if ( HasCapture() ) {
             ReleaseMouse();
@@ -63,6 +178,13 @@ public:
     }
 };
 
+// The range of a match in the results page, relative to the start of a line
+struct FindResultsRange {
+    int m_line;
+    int m_start;
+    int m_len;
+};
+
 BEGIN_EVENT_TABLE(FindResultsTab, OutputTabWindow)
     EVT_COMMAND(wxID_ANY, wxEVT_SEARCH_THREAD_SEARCHSTARTED,  FindResultsTab::OnSearchStart)
     EVT_COMMAND(wxID_ANY, wxEVT_SEARCH_THREAD_MATCHFOUND,     FindResultsTab::OnSearchMatch)
@@ -267,6 +389,12 @@ void FindResultsTab::Clear()
 {
     MatchInfo& matchInfo = GetMatchInfo(m_book ? m_book->GetSelection() : 0);
     matchInfo.clear();
+
+    MySTC *stc = dynamic_cast<MySTC*>(m_sci);
+    if (stc) {
+        stc->m_pending.Clear();
+        stc->m_showMoreLine = wxNOT_FOUND;
+    }
     OutputTabWindow::Clear();
 }
 
@@ -410,46 +538,158 @@ void FindResultsTab::OnSearchMatch(wxCommandEvent& e)
     }
 
     MatchInfo& matchInfo = GetMatchInfo(m);
-    for (SearchResultList::iterator iter = res->begin(); iter != res->end(); iter++) {
+
+    // A Find in Files page renders a limited number of matches, the others
+    // are kept until the user asks for them. Replace in Files needs them all
+    MySTC *stc = m_book ? dynamic_cast<MySTC*>(m_recv) : NULL;
+    if (stc) {
+        size_t maxMatches = GetMaxRenderedMatches();
+        size_t room = 0;
+        if (stc->m_pending.GetCount() == 0 && matchInfo.size() < maxMatches) {
+            room = maxMatches - matchInfo.size();
+        }
+
+        SearchResultList::iterator iter = res->begin();
+        for (; room && iter != res->end(); ++iter, --room) {}
+
+        for (SearchResultList::iterator pending = iter; pending != res->end(); ++pending) {
+            stc->m_pending.Add(*pending);
+        }
+        res->erase(iter, res->end());
+    }
+
+    DoInsertMatches(m_recv, matchInfo, *res, wxNOT_FOUND);
+    delete res;
+}
+
+int FindResultsTab::DoInsertMatches(wxStyledTextCtrl* sci, MatchInfo& matchInfo, const SearchResultList& results, int line)
+{
+    if (results.empty()) {
+        return 0;
+    }
+
+    // Format all the lines first and insert them at once, inserting
+    // them one by one is what makes a big search freeze the UI
+    int firstLine = (line == wxNOT_FOUND) ? sci->GetLineCount()-1 : line;
+    int curLine   = firstLine;
+    SearchData *d = GetSearchData(sci);
+
+    wxString buffer;
+    std::vector<FindResultsRange> ranges;
+    ranges.reserve(results.size());
+
+    for (SearchResultList::const_iterator iter = results.begin(); iter != results.end(); iter++) {
         if (matchInfo.empty() || matchInfo.rbegin()->second.GetFileName() != iter->GetFileName()) {
             wxFileName fn(iter->GetFileName());
             fn.MakeRelativeTo();
 
-            AppendText(fn.GetFullPath() + wxT("\n"));
+            buffer << fn.GetFullPath() << wxT("\n");
+            ++curLine;
         }
 
-        int lineno = m_recv->GetLineCount()-1;
-        matchInfo.insert(std::make_pair(lineno, *iter));
-        wxString text = iter->GetPattern();
+        SearchResult& result = matchInfo.insert(std::make_pair(curLine, *iter)).first->second;
+        wxString text = result.GetPattern();
         int delta = -text.Length();
         text.Trim(false);
         delta += text.Length();
         text.Trim();
 
         wxString linenum;
-        if(iter->GetMatchState() == CppWordScanner::STATE_CPP_COMMENT || iter->GetMatchState() == CppWordScanner::STATE_C_COMMENT)
-            linenum = wxString::Format(wxT(" %5u //"), iter->GetLineNumber());
+        if(result.GetMatchState() == CppWordScanner::STATE_CPP_COMMENT || result.GetMatchState() == CppWordScanner::STATE_C_COMMENT)
+            linenum = wxString::Format(wxT(" %5u //"), result.GetLineNumber());
         else
-            linenum = wxString::Format(wxT(" %5u "), iter->GetLineNumber());
+            linenum = wxString::Format(wxT(" %5u "), result.GetLineNumber());
 
-        SearchData *d = GetSearchData(m_recv);
         // Print the scope name
-        if (d->GetDisplayScope()) {
-            TagEntryPtr tag = TagsManagerST::Get()->FunctionFromFileLine(iter->GetFileName(), iter->GetLineNumber());
+        if (d && d->GetDisplayScope()) {
+            TagEntryPtr tag = TagsManagerST::Get()->FunctionFromFileLine(result.GetFileName(), result.GetLineNumber());
             wxString scopeName (wxT("global"));
             if(tag) {
                 scopeName = tag->GetPath();
             }
 
             linenum << wxT("[ ") << scopeName << wxT(" ] ");
-            iter->SetScope(scopeName);
+            result.SetScope(scopeName);
         }
 
         delta += linenum.Length();
-        AppendText(linenum + text + wxT("\n"));
-        m_recv->IndicatorFillRange(m_sci->PositionFromLine(lineno)+iter->GetColumn()+delta, iter->GetLen());
+        buffer << linenum << text << wxT("\n");
+
+        FindResultsRange range;
+        range.m_line  = curLine;
+        range.m_start = result.GetColumn() + delta;
+        range.m_len   = result.GetLen();
+        ranges.push_back(range);
+        ++curLine;
     }
-    delete res;
+
+    if (line == wxNOT_FOUND) {
+        AppendText(buffer);
+
+    } else {
+        sci->SetReadOnly(false);
+        sci->InsertText(sci->PositionFromLine(line), buffer);
+        sci->SetReadOnly(true);
+    }
+
+    sci->SetIndicatorCurrent(1);
+    for (size_t i=0; i<ranges.size(); ++i) {
+        sci->IndicatorFillRange(sci->PositionFromLine(ranges.at(i).m_line) + ranges.at(i).m_start, ranges.at(i).m_len);
+    }
+    return curLine - firstLine;
+}
+
+void FindResultsTab::DoInsertShowMore(wxStyledTextCtrl* sci, int line)
+{
+    MySTC *stc = dynamic_cast<MySTC*>(sci);
+    if (!stc || stc->m_pending.GetCount() == 0) {
+        return;
+    }
+
+    size_t count = stc->m_pending.GetCount();
+    wxString message;
+    message << wxT("====== ") << wxString::Format(_("%u more matches are not shown, double click here to show the next %u"),
+                                                   (unsigned int)count,
+                                                   (unsigned int)std::min(count, GetMaxRenderedMatches()))
+            << wxT(" ======\n");
+
+    if (line == wxNOT_FOUND) {
+        line = stc->GetLineCount()-1;
+    }
+
+    stc->SetReadOnly(false);
+    stc->InsertText(stc->PositionFromLine(line), message);
+    stc->SetReadOnly(true);
+    stc->m_showMoreLine = line;
+}
+
+void FindResultsTab::DoShowMoreMatches(wxStyledTextCtrl* sci)
+{
+    MySTC *stc = dynamic_cast<MySTC*>(sci);
+    if (!stc || stc->m_showMoreLine == wxNOT_FOUND || !m_book) {
+        return;
+    }
+
+    size_t page = m_book->GetPageIndex(stc);
+    if (page == Notebook::npos) {
+        return;
+    }
+
+    // The next matches take the place of the "show more" line
+    int line = stc->m_showMoreLine;
+    stc->m_showMoreLine = wxNOT_FOUND;
+
+    int start = stc->PositionFromLine(line);
+    stc->SetReadOnly(false);
+    stc->DeleteRange(start, stc->PositionFromLine(line+1) - start);
+    stc->SetReadOnly(true);
+
+    SearchResultList results;
+    stc->m_pending.Take(GetMaxRenderedMatches(), results);
+
+    clWindowUpdateLocker locker(stc);
+    line += DoInsertMatches(stc, GetMatchInfo(page), results, line);
+    DoInsertShowMore(stc, line);
 }
 
 void FindResultsTab::OnSearchEnded(wxCommandEvent& e)
@@ -462,6 +702,7 @@ void FindResultsTab::OnSearchEnded(wxCommandEvent& e)
     // did the page closed before the search ended?
     if(m_book && m_book->GetPageIndex(m_recv) != Notebook::npos) {
 
+        DoInsertShowMore(m_recv, wxNOT_FOUND);
         AppendText(summary->GetMessage() + wxT("\n"));
         m_recv = NULL;
         if (m_tb->GetToolState(XRCID("scroll_on_output"))) {
@@ -528,6 +769,7 @@ void FindResultsTab::OnSearchCancel(wxCommandEvent &e)
 
     // did the page closed before the search ended?
     if(m_book && m_book->GetPageIndex(m_recv) != Notebook::npos) {
+        DoInsertShowMore(m_recv, wxNOT_FOUND);
         AppendText(*str + wxT("\n"));
     }
 
@@ -578,7 +820,11 @@ void FindResultsTab::OnMouseDClick(wxStyledTextEvent &e)
     int line = m_sci->LineFromPosition(pos);
     int style = m_sci->GetStyleAt(pos);
 
-    if (style == LEX_FIF_FILE || style == LEX_FIF_HEADER) {
+    MySTC *stc = dynamic_cast<MySTC*>(m_sci);
+    if (stc && stc->m_showMoreLine == line && m_recv != m_sci) {
+        DoShowMoreMatches(m_sci);
+
+    } else if (style == LEX_FIF_FILE || style == LEX_FIF_HEADER) {
         m_sci->ToggleFold(line);
 
     } else {
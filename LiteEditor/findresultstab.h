@@ -85,6 +85,9 @@ protected:
     virtual void OnStyleNeeded     (wxStyledTextEvent &e);
     SearchData*  GetSearchData     (wxStyledTextCtrl *sci   );
     void         DoOpenSearchResult(const SearchResult &result, wxStyledTextCtrl *sci, int markerLine);
+    int          DoInsertMatches   (wxStyledTextCtrl *sci, MatchInfo &matchInfo, const SearchResultList &results, int line);
+    void         DoInsertShowMore  (wxStyledTextCtrl *sci, int line);
+    void         DoShowMoreMatches (wxStyledTextCtrl *sci);
     void         OnThemeChanged    (wxCommandEvent &e);
     DECLARE_EVENT_TABLE()
 
@@ -67,6 +67,8 @@
 #include "syntaxhighlightdlg.h"
 #include "dirsaver.h"
 #include "batchbuilddlg.h"
+#include "build_statistics_dlg.h"
+#include "build_statistics_manager.h"
 #include "detachedpanesinfo.h"
 #include "dockablepanemenumanager.h"
 #include "dockablepane.h"
@@ -404,6 +406,7 @@ BEGIN_EVENT_TABLE(clMainFrame, wxFrame)
     EVT_MENU(XRCID("clean_workspace"),          clMainFrame::OnCleanWorkspace)
     EVT_MENU(XRCID("rebuild_workspace"),        clMainFrame::OnReBuildWorkspace)
     EVT_MENU(XRCID("batch_build"),              clMainFrame::OnBatchBuild)
+    EVT_MENU(XRCID("build_statistics"),         clMainFrame::OnBuildStatistics)
 
     EVT_UPDATE_UI(XRCID("execute_no_debug"),        clMainFrame::OnExecuteNoDebugUI)
     EVT_UPDATE_UI(XRCID("stop_executed_program"),   clMainFrame::OnStopExecutedProgramUI)
@@ -417,6 +420,7 @@ BEGIN_EVENT_TABLE(clMainFrame, wxFrame)
     EVT_UPDATE_UI(XRCID("clean_workspace"),         clMainFrame::OnCleanWorkspaceUI)
     EVT_UPDATE_UI(XRCID("rebuild_workspace"),       clMainFrame::OnReBuildWorkspaceUI)
     EVT_UPDATE_UI(XRCID("batch_build"),             clMainFrame::OnBatchBuildUI)
+    EVT_UPDATE_UI(XRCID("build_statistics"),        clMainFrame::OnBuildStatisticsUI)
 
     //-------------------------------------------------------
     // Debug menu
@@ -693,12 +697,16 @@ clMainFrame::clMainFrame(wxWindow *pParent, wxWindowID id, const wxString& title
     
     // Start the code completion manager, we do this by calling it once
     CodeCompletionManager::Get();
+
+    // Start collecting the build statistics (when enabled)
+    BuildStatisticsManager::Get();
 }
 
 clMainFrame::~clMainFrame(void)
 {
     // Free the code completion manager
     CodeCompletionManager::Release();
+    BuildStatisticsManager::Release();
     
     // this will make sure that the main menu bar's member m_widget is freed before the we enter wxMenuBar destructor
     // see this wxWidgets bug report for more details:
@@ -3912,6 +3920,19 @@ void clMainFrame::OnBatchBuild(wxCommandEvent& e)
     ManagerST::Get()->ProcessCommandQueue();
 }
 
+void clMainFrame::OnBuildStatisticsUI(wxUpdateUIEvent& e)
+{
+    CHECK_SHUTDOWN();
+    e.Enable(ManagerST::Get()->IsWorkspaceOpen());
+}
+
+void clMainFrame::OnBuildStatistics(wxCommandEvent& e)
+{
+    wxUnusedVar(e);
+    BuildStatisticsDlg dlg(this);
+    dlg.ShowModal();
+}
+
 void clMainFrame::SetFrameTitle(LEditor* editor)
 {
     wxString title;
@@ -535,6 +535,8 @@ protected:
     void OnGotoCodeLiteDownloadPage(wxCommandEvent &e);
     void OnBatchBuild(wxCommandEvent &e);
     void OnBatchBuildUI(wxUpdateUIEvent &e);
+    void OnBuildStatistics(wxCommandEvent &e);
+    void OnBuildStatisticsUI(wxUpdateUIEvent &e);
     void OnSyntaxHighlight(wxCommandEvent &e);
     void OnShowWhitespaceUI(wxUpdateUIEvent &e);
     void OnShowWhitespace(wxCommandEvent &e);
@@ -894,6 +894,7 @@ void Manager::RetagWorkspace(TagsManager::RetagType type)
         parsingRequest->setDbFile(TagsManagerST::Get()->GetDatabase()->GetDatabaseFileName().GetFullPath().c_str());
         parsingRequest->_evtHandler = this;
         parsingRequest->_quickRetag = (type == TagsManager::Retag_Quick);
+        parsingRequest->SetPriority(ThreadRequest::kPriorityLow);
         ParseThreadST::Get()->Add ( parsingRequest );
         clMainFrame::Get()->SetStatusMessage(_("Scanning for include files to parse..."), 0);
 
@@ -901,6 +902,7 @@ void Manager::RetagWorkspace(TagsManager::RetagType type)
         parsingRequest->setType(ParseRequest::PR_PARSE_FILE_NO_INCLUDES);
         parsingRequest->setDbFile(TagsManagerST::Get()->GetDatabase()->GetDatabaseFileName().GetFullPath().c_str());
         parsingRequest->_quickRetag = true;
+        parsingRequest->SetPriority(ThreadRequest::kPriorityLow);
         ParseThreadST::Get()->Add ( parsingRequest );
 
     }
@@ -925,6 +927,9 @@ void Manager::RetagFile ( const wxString& filename )
     req->setDbFile   ( TagsManagerST::Get()->GetDatabase()->GetDatabaseFileName().GetFullPath().c_str() );
     req->setFile     ( absFile.GetFullPath().c_str() );
     req->setType     ( ParseRequest::PR_FILESAVED );
+
+    // Saving the file again before it was parsed makes the pending request useless
+    req->SetCoalescingKey( wxT("retag:") + absFile.GetFullPath() );
     ParseThreadST::Get()->Add ( req );
 
     wxString msg = wxString::Format(wxT( "Re-tagging file %s..." ), absFile.GetFullName().c_str());
@@ -32,6 +32,7 @@
 #include "cl_editor.h"
 #include "manager.h"
 #include "replaceinfilespanel.h"
+#include "replace_in_files_engine.h"
 
 
 BEGIN_EVENT_TABLE(ReplaceInFilesPanel, FindResultsTab)
@@ -170,49 +171,16 @@ void ReplaceInFilesPanel::DoSaveResults(wxStyledTextCtrl *sci,
                                         std::map<int,SearchResult>::iterator begin,
                                         std::map<int,SearchResult>::iterator end)
 {
+    // The replacements were made in an open editor, the user decides whether to save it
     if (!sci || begin == end)
         return;
-    bool ok = true;
-    if (dynamic_cast<LEditor*>(sci) == NULL) {
-        // it's a temp editor, check if we have any changes to save
-        if (sci->GetModify() && !WriteFileWithBackup(begin->second.GetFileName(), sci->GetText(), false)) {
-            wxMessageBox(_("Failed to save file:\n") + begin->second.GetFileName(), _("CodeLite - Replace"),
-                         wxICON_ERROR|wxOK);
-            wxLogMessage(wxT("Replace: Failed to write file ") + begin->second.GetFileName());
-            ok = false;
-        }
-        delete sci;
-    }
     for (; begin != end; begin++) {
         if ((m_sci->MarkerGet(begin->first) & 7<<0x7) == 1<<0x7) {
-            m_sci->MarkerAdd(begin->first, ok ? 0x9 : 0x8);
+            m_sci->MarkerAdd(begin->first, 0x9);
         }
     }
 }
 
-wxStyledTextCtrl *ReplaceInFilesPanel::DoGetEditor(const wxString &fileName)
-{
-    // look for open editor first
-    wxStyledTextCtrl *sci = clMainFrame::Get()->GetMainBook()->FindEditor(fileName);
-    if (sci) {
-        // FIXME: if editor is already modified, the found locations may not be accurate
-        return sci;
-    }
-
-    // not open for editing, so make our own temp editor
-    wxString content;
-    if (!ReadFileWithConversion(fileName, content)) {
-        wxMessageBox(_("Failed to open file:\n") + fileName, _("CodeLite - Replace"), wxICON_ERROR|wxOK);
-        wxLogMessage(wxT("Replace: Failed to read file ") + fileName);
-        return NULL;
-    }
-
-    sci = new wxStyledTextCtrl(this);
-    sci->Hide();
-    sci->SetText(content);
-    return sci;
-}
-
 void ReplaceInFilesPanel::OnReplace(wxCommandEvent& e)
 {
     // FIX bug#2770561
@@ -226,9 +194,15 @@ void ReplaceInFilesPanel::OnReplace(wxCommandEvent& e)
         m_replaceWith->Append(m_replaceWith->GetValue());
     }
 
-    // Step 1: apply selected replacements
+    // Step 1: apply selected replacements. Files opened in an editor are modified through
+    // the editor, the others are collected and handed to the ReplaceInFilesEngine
 
-    wxStyledTextCtrl *sci = NULL; // file that is being altered by replacements
+    const wxString replaceWith = m_replaceWith->GetValue();
+    std::vector<ReplaceInFilesEngine::File> files;
+    std::vector< std::vector<int> > filesLines; // the result pane line of every edit in 'files'
+
+    wxStyledTextCtrl *sci = NULL; // open editor that is being altered by replacements
+    bool isOpen = false;          // is 'lastFile' opened in an editor?
 
     wxString lastFile; // track offsets of pending substitutions caused by previous substitutions
     long lastLine = 0;
@@ -252,7 +226,9 @@ void ReplaceInFilesPanel::OnReplace(wxCommandEvent& e)
             firstInFile = i;
             lastFile = i->second.GetFileName();
             lastLine = 0;
-            sci = NULL;
+            sci = clMainFrame::Get()->GetMainBook()->FindEditor(lastFile);
+            isOpen = (sci != NULL);
+            // FIXME: if editor is already modified, the found locations may not be accurate
         }
 
         if (i->second.GetLineNumber() == lastLine) {
@@ -265,22 +241,28 @@ void ReplaceInFilesPanel::OnReplace(wxCommandEvent& e)
             // not selected for application
             continue;
 
+        if (!isOpen) {
+            // the engine verifies the line and uses the offsets in characters
+            if (i->second.GetPattern().Mid(i->second.GetColumnInChars(), i->second.GetLenInChars()) == replaceWith)
+                continue; // no change needed
+
+            if (files.empty() || files.back().m_fileName != lastFile) {
+                files.push_back(ReplaceInFilesEngine::File(lastFile));
+                filesLines.push_back(std::vector<int>());
+            }
+            files.back().m_edits.push_back(ReplaceInFilesEngine::Edit(i->second.GetLineNumber(),
+                                                                      i->second.GetColumnInChars(),
+                                                                      i->second.GetLenInChars(),
+                                                                      i->second.GetPattern()));
+            filesLines.back().push_back(i->first);
+            continue;
+        }
+
         // extract originally matched text for safety check later
         wxString text = i->second.GetPattern().Mid(i->second.GetColumn()-delta, i->second.GetLen());
         if (text == m_replaceWith->GetValue())
             continue; // no change needed
 
-        // need an editor for this file (try only once per file though)
-        if (!sci && lastLine == 0) {
-            sci = DoGetEditor(i->second.GetFileName());
-            lastLine = i->second.GetLineNumber();
-        }
-        if (!sci) {
-            // couldn't open file
-            m_sci->MarkerAdd(i->first, 0x8);
-            continue;
-        }
-
         long pos = sci->PositionFromLine(i->second.GetLineNumber()-1);
         if (pos < 0) {
             // invalid line number
@@ -303,9 +285,32 @@ void ReplaceInFilesPanel::OnReplace(wxCommandEvent& e)
         i->second.SetPattern(m_sci->GetLine(i->first)); // includes prior updates to same line
         i->second.SetLen(m_replaceWith->GetValue().Length());
     }
-    m_progress->SetValue(0);
     DoSaveResults(sci, firstInFile, matchInfo.end());
 
+    if (!files.empty()) {
+        wxBusyCursor bc;
+        ReplaceInFilesEngine engine(replaceWith, EditorConfigST::Get()->GetOptions()->GetFileFontEncoding());
+        engine.Run(files);
+
+        wxArrayString failedFiles;
+        for (size_t f = 0; f < files.size(); f++) {
+            const ReplaceInFilesEngine::File& file = files.at(f);
+            if (!file.m_error.IsEmpty()) {
+                wxLogMessage(wxT("Replace: ") + file.m_error + wxT(": ") + file.m_fileName);
+                failedFiles.Add(file.m_fileName);
+            }
+            for (size_t e = 0; e < file.m_edits.size(); e++) {
+                m_sci->MarkerAdd(filesLines.at(f).at(e), file.m_edits.at(e).m_replaced ? 0x9 : 0x8);
+            }
+        }
+
+        if (!failedFiles.IsEmpty()) {
+            wxMessageBox(_("Failed to save file:\n") + wxJoin(failedFiles, wxT('\n')), _("CodeLite - Replace"),
+                         wxICON_ERROR|wxOK);
+        }
+    }
+    m_progress->SetValue(0);
+
     // Disable the 'buffer limit' feature during replace
     clMainFrame::Get()->GetMainBook()->SetUseBuffereLimit(true);
 
@@ -37,8 +37,6 @@ class ReplaceInFilesPanel : public FindResultsTab
     void DoSaveResults(wxStyledTextCtrl *sci, std::map<int,SearchResult>::iterator begin,
                        std::map<int,SearchResult>::iterator end);
 
-    wxStyledTextCtrl *DoGetEditor(const wxString &fileName);
-
     // Event handlers
     virtual void OnSearchStart(wxCommandEvent   &e);
     virtual void OnSearchMatch(wxCommandEvent   &e);
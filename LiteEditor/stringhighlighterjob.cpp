@@ -22,59 +22,134 @@
 //
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
-#include "stringsearcher.h"
 #include "stringhighlighterjob.h"
-#include <vector>
+#include <string.h>
 
-StringHighlighterJob::StringHighlighterJob(wxEvtHandler *parent, const wxChar *str, const wxChar *word, const wxChar* filename)
+// The document outside of the visible range is reported in batches of this size
+#define HIGHLIGHT_BATCH_SIZE (1024*1024)
+
+static inline bool IsWordChar(char ch)
+{
+	return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_';
+}
+
+StringHighlighterJob::StringHighlighterJob(wxEvtHandler *parent, StringHighlightSnapshot *snapshot, const wxString &word, const wxString &filename, int id, int visibleStart, int visibleEnd)
 		: Job(parent)
-		, m_str(str)
-		, m_word(word)
-		, m_filename(filename)
+		, m_snapshot(snapshot->IncRef())
+		, m_filename(filename.c_str())
+		, m_id(id)
+		, m_visibleStart(visibleStart < 0 ? 0 : visibleStart)
+		, m_visibleEnd(visibleEnd < 0 ? 0 : visibleEnd)
 {
+	const wxCharBuffer utf8 = word.mb_str(wxConvUTF8);
+	if ( utf8.data() ) {
+		m_word = utf8.data();
+	}
+
+	size_t len = m_snapshot->GetLength();
+	if ( m_visibleEnd > len ) {
+		m_visibleEnd = len;
+	}
+	if ( m_visibleStart > m_visibleEnd ) {
+		m_visibleStart = m_visibleEnd;
+	}
 }
 
 StringHighlighterJob::~StringHighlighterJob()
 {
+	m_snapshot->DecRef();
 }
 
-void StringHighlighterJob::Process(wxThread* thread)
+bool StringHighlighterJob::DoMatchAt(const char* text, size_t len, size_t pos) const
 {
-	wxUnusedVar(thread);
-	if ( m_str.IsEmpty() || m_word.IsEmpty() ) {
-		return;
+	size_t wordLen = m_word.length();
+	if ( pos + wordLen > len || memcmp(text + pos, m_word.c_str(), wordLen) != 0 ) {
+		return false;
 	}
 
-	int pos(0);
-	int match_len(0);
+	// whole word only
+	if ( pos > 0 && IsWordChar(text[pos-1]) ) {
+		return false;
+	}
+	if ( pos + wordLen < len && IsWordChar(text[pos + wordLen]) ) {
+		return false;
+	}
+	return true;
+}
 
-	// remove reverse search
-	int offset(0);
+void StringHighlighterJob::DoSearch(size_t from, size_t to, std::vector<std::pair<int, int> >* matches) const
+{
+	// Report the matches starting in [from, to)
+	const char* text = m_snapshot->GetText();
+	size_t len = m_snapshot->GetLength();
+	char first = m_word.at(0);
+
+	size_t pos = from;
+	while ( pos < to ) {
+		const char* p = (const char*)memchr(text + pos, first, to - pos);
+		if ( !p ) {
+			break;
+		}
 
+		pos = p - text;
+		if ( DoMatchAt(text, len, pos) ) {
+			matches->push_back( std::make_pair((int)pos, (int)m_word.length()) );
+			pos += m_word.length();
+
+		} else {
+			++pos;
+		}
+	}
+}
+
+void StringHighlighterJob::DoPost(std::vector<std::pair<int, int> >* matches, bool clear)
+{
 	// allocate result on the heap (will be freed by the caller)
 	StringHighlightOutput *results = new StringHighlightOutput;
-
 	results->filename = m_filename.c_str();
-	results->matches  = new std::vector<std::pair<int, int> >;
-
-#if wxVERSION_NUMBER >= 2900
-	const wchar_t* pin = m_str.c_str().AsWChar();
-	const wchar_t* pwo = m_word.c_str().AsWChar();
-#else
-	const wchar_t* pin = m_str.c_str();
-	const wchar_t* pwo = m_word.c_str();
-#endif
-
-	while ( StringFindReplacer::Search(pin, offset, pwo, wxSD_MATCHCASE | wxSD_MATCHWHOLEWORD, pos, match_len) ) {
-		// add result
-		std::pair<int, int> match;
-		match.first = pos;
-		match.second = match_len;
-
-		results->matches->push_back( match );
-		offset = pos + match_len;
-	}
+	results->matches  = matches;
+	results->id       = m_id;
+	results->clear    = clear;
 
 	// report the result back to parent
 	Post((void*) results);
 }
+
+void StringHighlighterJob::Process(wxThread* thread)
+{
+	wxUnusedVar(thread);
+	if ( m_word.empty() || !m_snapshot->GetText() ) {
+		return;
+	}
+
+	// The visible range first: this is what the user is looking at. This batch is
+	// always posted, even if empty, it clears the previous highlighting
+	std::vector<std::pair<int, int> > *matches = new std::vector<std::pair<int, int> >;
+	DoSearch(m_visibleStart, m_visibleEnd, matches);
+	DoPost(matches, true);
+
+	// Now the rest of the document, in batches
+	size_t len = m_snapshot->GetLength();
+	size_t ranges[2][2] = { { 0, m_visibleStart }, { m_visibleEnd, len } };
+	for ( size_t i=0; i<2; i++ ) {
+		for ( size_t from = ranges[i][0]; from < ranges[i][1]; from += HIGHLIGHT_BATCH_SIZE ) {
+			if ( IsCancelled() ) {
+				// superseded by a newer request
+				return;
+			}
+
+			size_t to = from + HIGHLIGHT_BATCH_SIZE;
+			if ( to > ranges[i][1] ) {
+				to = ranges[i][1];
+			}
+
+			matches = new std::vector<std::pair<int, int> >;
+			DoSearch(from, to, matches);
+			if ( matches->empty() ) {
+				delete matches;
+				continue;
+			}
+			DoPost(matches, false);
+		}
+	}
+}
@@ -26,14 +26,69 @@
 #define __stringhighlighterjob__
 
 #include "job.h"
+#include <wx/buffer.h>
+#include <wx/thread.h>
 #include <vector>
+#include <string>
+
+/**
+ * @class StringHighlightSnapshot
+ * @brief a read only, reference counted copy of an editor text (raw UTF-8, so the offsets
+ * are the editor positions). The editor keeps it until the document is modified, so
+ * highlighting several words in a row copies the document only once
+ */
+class StringHighlightSnapshot
+{
+	wxCharBuffer      m_text;
+	size_t            m_length;
+	int               m_refCount;
+	wxCriticalSection m_cs;
+
+private:
+	~StringHighlightSnapshot() {}
+	StringHighlightSnapshot(const StringHighlightSnapshot&);
+	StringHighlightSnapshot& operator=(const StringHighlightSnapshot&);
+
+public:
+	StringHighlightSnapshot(const wxCharBuffer &text, size_t length)
+		: m_text(text)
+		, m_length(length)
+		, m_refCount(1)
+	{}
+
+	const char* GetText() const {
+		return m_text.data();
+	}
+	size_t GetLength() const {
+		return m_length;
+	}
+
+	StringHighlightSnapshot* IncRef() {
+		wxCriticalSectionLocker locker(m_cs);
+		++m_refCount;
+		return this;
+	}
+
+	void DecRef() {
+		bool last = false;
+		{
+			wxCriticalSectionLocker locker(m_cs);
+			last = (--m_refCount == 0);
+		}
+		if ( last ) {
+			delete this;
+		}
+	}
+};
 
 struct StringHighlightOutput
 {
 	wxString                           filename;
 	std::vector<std::pair<int, int> >* matches;
+	int                                id;    // the highlight request these matches belong to
+	bool                               clear; // true for the first batch of a request
 
-	StringHighlightOutput() : filename(wxT("")), matches(NULL)
+	StringHighlightOutput() : filename(wxT("")), matches(NULL), id(0), clear(false)
 	{}
 
 	~StringHighlightOutput()
@@ -45,15 +100,28 @@ struct StringHighlightOutput
 	}
 };
 
+/**
+ * @class StringHighlighterJob
+ * @brief find all the whole word, case sensitive occurrences of a word. The visible
+ * range of the editor is reported first, the rest of the document follows in batches.
+ * The job stops as soon as it is superseded by a newer job of the same editor
+ */
 class StringHighlighterJob : public Job
 {
+	StringHighlightSnapshot* m_snapshot;
+	std::string              m_word;
+	wxString                 m_filename;
+	int                      m_id;
+	size_t                   m_visibleStart;
+	size_t                   m_visibleEnd;
 
-	wxString m_str;
-	wxString m_word;
-	wxString m_filename;
+protected:
+	bool DoMatchAt(const char* text, size_t len, size_t pos) const;
+	void DoSearch(size_t from, size_t to, std::vector<std::pair<int, int> >* matches) const;
+	void DoPost(std::vector<std::pair<int, int> >* matches, bool clear);
 
 public:
-	StringHighlighterJob(wxEvtHandler *parent, const wxChar *str, const wxChar *word, const wxChar *filename);
+	StringHighlighterJob(wxEvtHandler *parent, StringHighlightSnapshot *snapshot, const wxString &word, const wxString &filename, int id, int visibleStart, int visibleEnd);
 	virtual ~StringHighlighterJob();
 
 public:
@@ -257,6 +257,10 @@ void svSymbolTree::BuildTree(const wxFileName& fn)
     req->setFile(fn.GetFullPath());
     req->setType(ParseRequest::PR_PARSE_INCLUDE_STATEMENTS);
     req->_uid = m_uid; // Identifies this request
+    
+    // Only the reply to the latest request is used, drop the older ones
+    req->SetCoalescingKey(wxT("outline-include-statements"));
+    req->SetPriority(ThreadRequest::kPriorityHigh);
     ParseThreadST::Get()->Add( req );
     
     wxTreeItemId root = GetRootItem();
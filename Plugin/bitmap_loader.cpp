@@ -2,13 +2,17 @@
 #include <wx/tokenzr.h>
 #include <wx/stdpaths.h>
 #include <wx/ffile.h>
+#include <wx/wfstream.h>
+#include <wx/mstream.h>
+#include <wx/image.h>
 #include "globals.h"
 #include "editor_config.h"
 #include "optionsconfig.h"
-#include "cl_standard_paths.h"
 
-std::map<wxString, wxBitmap> BitmapLoader::m_toolbarsBitmaps;
-std::map<wxString, wxString> BitmapLoader::m_manifest;
+wxFileName                     BitmapLoader::m_zipPath;
+std::map<wxString, wxZipEntry> BitmapLoader::m_zipIndex;
+std::map<wxString, wxBitmap>   BitmapLoader::m_toolbarsBitmaps;
+std::map<wxString, wxString>   BitmapLoader::m_manifest;
 
 BitmapLoader::~BitmapLoader()
 {
@@ -40,11 +44,13 @@ BitmapLoader::BitmapLoader()
     fn = wxFileName(wxStandardPaths::Get().GetDataDir(), zipname);
 #endif
 
-    if(m_manifest.empty() || m_toolbarsBitmaps.empty()) {
+    // Only the archive index and the manifest are read here, the bitmaps
+    // themselves are decoded by LoadBitmap() when first requested
+    if(m_manifest.empty() || m_zipIndex.empty()) {
         m_zipPath = fn;
         if(m_zipPath.FileExists()) {
+            doIndexZip();
             doLoadManifest();
-            doLoadBitmaps();
         }
     }
 }
@@ -55,83 +61,124 @@ const wxBitmap& BitmapLoader::LoadBitmap(const wxString& name)
     if(iter != m_toolbarsBitmaps.end())
         return iter->second;
 
-    return wxNullBitmap;
+    std::map<wxString, wxString>::const_iterator manifestIter = m_manifest.find(name);
+    if(manifestIter == m_manifest.end())
+        return wxNullBitmap;
+
+    // First request: decode it. A bitmap that fails to decode is cached as well
+    // so we don't try again
+    wxString key = name.BeforeLast(wxT('/'));
+    wxBitmap& bmp = m_toolbarsBitmaps[name];
+    bmp = doLoadBitmap( wxString::Format(wxT("%s/%s"), key.c_str(), manifestIter->second.c_str()) );
+    return bmp;
 }
 
-void BitmapLoader::doLoadManifest()
+void BitmapLoader::doIndexZip()
 {
-    wxString targetFile;
-    if(ExtractFileFromZip(m_zipPath.GetFullPath(), wxT("manifest.ini"), clStandardPaths::Get().GetUserDataDir(), targetFile)) {
-        // we got the file extracted, read it
-        wxFileName manifest(targetFile);
-        wxFFile fp(manifest.GetFullPath(), wxT("r"));
-        if(fp.IsOpened())  {
-
-            wxString content;
-            fp.ReadAll(&content);
-
-            m_manifest.clear();
-            wxArrayString entries = wxStringTokenize(content, wxT("\n"), wxTOKEN_STRTOK);
-            for(size_t i=0; i<entries.size(); i++) {
-                wxString entry = entries[i];
-                entry.Trim().Trim(false);
-
-                // empty?
-                if(entry.empty())
-                    continue;
-
-                // comment?
-                if(entry.StartsWith(wxT(";")))
-                    continue;
-
-                wxString key = entry.BeforeFirst(wxT('='));
-                wxString val = entry.AfterFirst (wxT('='));
-                key.Trim().Trim(false);
-                val.Trim().Trim(false);
-
-                wxString key16, key24;
-                key16 = key;
-                key24 = key;
-
-                key16.Replace(wxT("<size>"), wxT("16"));
-                key24.Replace(wxT("<size>"), wxT("24"));
-
-                key16.Replace(wxT("."), wxT("/"));
-                key24.Replace(wxT("."), wxT("/"));
-
-                m_manifest[key16] = val;
-                m_manifest[key24] = val;
-            }
-
-            fp.Close();
-            wxRemoveFile( manifest.GetFullPath() );
-        }
-        wxRemoveFile( targetFile );
+    m_zipIndex.clear();
+
+    // wxZipInputStream reads the central directory of a seekable stream, so
+    // this does not decompress anything
+    wxFFileInputStream in(m_zipPath.GetFullPath());
+    if(!in.IsOk())
+        return;
+
+    wxZipInputStream zip(in);
+    wxZipEntry *entry = zip.GetNextEntry();
+    while(entry) {
+        wxString name = entry->GetName();
+        name.MakeLower();
+        name.Replace(wxT("\\"), wxT("/"));
+        m_zipIndex.insert(std::make_pair(name, *entry));
+
+        delete entry;
+        entry = zip.GetNextEntry();
     }
 }
 
-wxBitmap BitmapLoader::doLoadBitmap(const wxString& filepath)
+bool BitmapLoader::doReadZipEntry(const wxString& filepath, wxMemoryBuffer& content)
+{
+    wxString name(filepath);
+    name.MakeLower();
+    name.Replace(wxT("\\"), wxT("/"));
+
+    std::map<wxString, wxZipEntry>::iterator iter = m_zipIndex.find(name);
+    if(iter == m_zipIndex.end())
+        return false;
+
+    wxFFileInputStream in(m_zipPath.GetFullPath());
+    if(!in.IsOk())
+        return false;
+
+    // Seek directly to the entry using the index
+    wxZipInputStream zip(in);
+    if(!zip.OpenEntry(iter->second))
+        return false;
+
+    char buffer[4096];
+    content.SetDataLen(0);
+    while(zip.CanRead()) {
+        zip.Read(buffer, sizeof(buffer));
+        size_t bytes = zip.LastRead();
+        if(bytes == 0)
+            break;
+        content.AppendData(buffer, bytes);
+    }
+    return zip.Eof();
+}
+
+void BitmapLoader::doLoadManifest()
 {
-    wxString bitmapFile;
-    if(ExtractFileFromZip(m_zipPath.GetFullPath(), filepath, clStandardPaths::Get().GetUserDataDir(), bitmapFile)) {
-        wxBitmap bmp;
-        if(bmp.LoadFile(bitmapFile, wxBITMAP_TYPE_PNG)) {
-            wxRemoveFile(bitmapFile);
-            return bmp;
+    wxMemoryBuffer buffer;
+    if(doReadZipEntry(wxT("manifest.ini"), buffer)) {
+        wxString content((const char*)buffer.GetData(), wxConvUTF8, buffer.GetDataLen());
+        m_manifest.clear();
+        wxArrayString entries = wxStringTokenize(content, wxT("\n"), wxTOKEN_STRTOK);
+        for(size_t i=0; i<entries.size(); i++) {
+            wxString entry = entries[i];
+            entry.Trim().Trim(false);
+
+            // empty?
+            if(entry.empty())
+                continue;
+
+            // comment?
+            if(entry.StartsWith(wxT(";")))
+                continue;
+
+            wxString key = entry.BeforeFirst(wxT('='));
+            wxString val = entry.AfterFirst (wxT('='));
+            key.Trim().Trim(false);
+            val.Trim().Trim(false);
+
+            wxString key16, key24;
+            key16 = key;
+            key24 = key;
+
+            key16.Replace(wxT("<size>"), wxT("16"));
+            key24.Replace(wxT("<size>"), wxT("24"));
+
+            key16.Replace(wxT("."), wxT("/"));
+            key24.Replace(wxT("."), wxT("/"));
+
+            m_manifest[key16] = val;
+            m_manifest[key24] = val;
         }
-        wxRemoveFile(bitmapFile);
     }
-    return wxNullBitmap;
 }
 
-void BitmapLoader::doLoadBitmaps()
+wxBitmap BitmapLoader::doLoadBitmap(const wxString& filepath)
 {
-    std::map<wxString, wxString>::iterator iter = m_manifest.begin();
-    for(; iter != m_manifest.end(); iter++) {
-        wxString key = iter->first;
-        key = key.BeforeLast(wxT('/'));
-        m_toolbarsBitmaps[iter->first] = doLoadBitmap( wxString::Format(wxT("%s/%s"), key.c_str(), iter->second.c_str()) );
+    // Decode straight from memory, no temporary files
+    wxMemoryBuffer buffer;
+    if(doReadZipEntry(filepath, buffer)) {
+        wxMemoryInputStream stream(buffer.GetData(), buffer.GetDataLen());
+        wxImage img;
+        if(img.LoadFile(stream, wxBITMAP_TYPE_PNG)) {
+            return wxBitmap(img);
+        }
     }
+    return wxNullBitmap;
 }
 
 int BitmapLoader::GetMimeImageId(FileExtManager::FileType type) const
@@ -29,6 +29,8 @@
 #include <wx/filename.h>
 #include <wx/bitmap.h>
 #include <wx/imaglist.h>
+#include <wx/zipstrm.h>
+#include <wx/buffer.h>
 #include <map>
 #include "fileextmanager.h"
 #include "codelite_exports.h"
@@ -40,8 +42,9 @@ public:
     typedef std::map<FileExtManager::FileType, wxBitmap> BitmapMap_t;
     
 protected:
-    wxFileName                              m_zipPath;
-    static std::map<wxString, wxBitmap>     m_toolbarsBitmaps;
+    static wxFileName                       m_zipPath;
+    static std::map<wxString, wxZipEntry>   m_zipIndex;        // the zip central directory, by lower case entry name
+    static std::map<wxString, wxBitmap>     m_toolbarsBitmaps; // bitmaps decoded so far
     static std::map<wxString, wxString>     m_manifest;
     std::map<FileExtManager::FileType, int> m_fileIndexMap;
     bool                                    m_bMapPopulated;
@@ -75,11 +78,16 @@ public:
     int GetMimeImageId(FileExtManager::FileType type) const;
 
 protected:
+    void            doIndexZip();
+    bool            doReadZipEntry(const wxString &filepath, wxMemoryBuffer &content);
     void            doLoadManifest();
-    void            doLoadBitmaps();
     wxBitmap        doLoadBitmap(const wxString &filepath);
 
 public:
+    /**
+     * @brief return the bitmap 'name' (e.g. "mime/16/cpp"). The bitmap is decoded
+     * from the icons archive the first time it is requested
+     */
     const wxBitmap& LoadBitmap(const wxString &name);
 
 };
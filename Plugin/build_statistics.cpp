@@ -0,0 +1,743 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : build_statistics.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "build_statistics.h"
+#include "workspace.h"
+#include "project.h"
+#include "build_config.h"
+#include "compiler.h"
+#include "json_node.h"
+#include "globals.h"
+#include <wx/tokenzr.h>
+#include <wx/datetime.h>
+#include <wx/ffile.h>
+#include <wx/log.h>
+#include <algorithm>
+
+// Only the most recent builds are kept
+#define BUILD_STATISTICS_MAX_BUILDS 50
+
+//------------------------------------------------------------------------------
+// Helpers
+//------------------------------------------------------------------------------
+
+// Directories are compared using this form: codelitegcc reports the working
+// directory of the compiler, which is the project path
+static wxString NormalizeDir(const wxString &dir)
+{
+    wxFileName fn = wxFileName::DirName(dir);
+    fn.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_CASE);
+    return fn.GetPath();
+}
+
+static wxString NormalizeFile(const wxString &file, const wxString &cwd)
+{
+    wxFileName fn(file);
+    fn.Normalize(wxPATH_NORM_DOTS | wxPATH_NORM_ABSOLUTE, cwd);
+    return fn.GetFullPath();
+}
+
+// A compilation imported from the codelitegcc records
+struct BuildCompile {
+    wxString      m_project;
+    wxString      m_configuration;
+    wxString      m_file;
+    long          m_wall;
+    long          m_cpu;
+    long          m_rss;
+    long          m_exitCode;
+    wxArrayString m_headers;
+
+    BuildCompile() : m_wall(0), m_cpu(0), m_rss(0), m_exitCode(0) {}
+};
+typedef std::map<wxString, BuildCompile> CompileMap_t;
+
+// A report entry being computed
+struct BuildAccumulator {
+    BuildStatistics::Entry m_entry;
+    double                 m_total;
+
+    BuildAccumulator() : m_total(0) {}
+};
+typedef std::map<wxString, BuildAccumulator> AccumulatorMap_t;
+
+static bool SortByLastDesc(const BuildStatistics::Entry &a, const BuildStatistics::Entry &b)
+{
+    return a.m_last > b.m_last;
+}
+
+static wxString GetColumnKey(BuildStatistics::eReport report, int column)
+{
+    switch ( column ) {
+    case BuildStatistics::kColProject:
+        return wxT("project");
+    case BuildStatistics::kColConfiguration:
+        return wxT("configuration");
+    case BuildStatistics::kColName:
+        return report == BuildStatistics::kHeaders ? wxT("header") : wxT("file");
+    case BuildStatistics::kColCount:
+        return report == BuildStatistics::kHeaders ? wxT("translationUnits") : wxT("files");
+    case BuildStatistics::kColLast:
+        return wxT("lastMs");
+    case BuildStatistics::kColAverage:
+        return wxT("averageMs");
+    case BuildStatistics::kColMax:
+        return wxT("maxMs");
+    case BuildStatistics::kColCpu:
+        return wxT("cpuMs");
+    case BuildStatistics::kColPeakRss:
+        return wxT("peakRssKb");
+    case BuildStatistics::kColBuilds:
+    default:
+        return wxT("builds");
+    }
+}
+
+static long GetColumnNumber(const BuildStatistics::Entry &entry, int column)
+{
+    switch ( column ) {
+    case BuildStatistics::kColCount:
+        return entry.m_count;
+    case BuildStatistics::kColLast:
+        return entry.m_last;
+    case BuildStatistics::kColAverage:
+        return entry.m_average;
+    case BuildStatistics::kColMax:
+        return entry.m_max;
+    case BuildStatistics::kColCpu:
+        return entry.m_cpu;
+    case BuildStatistics::kColPeakRss:
+        return entry.m_peakRss;
+    case BuildStatistics::kColBuilds:
+        return (long)entry.m_builds;
+    default:
+        return 0;
+    }
+}
+
+static bool IsTextColumn(int column)
+{
+    return column == BuildStatistics::kColProject || column == BuildStatistics::kColConfiguration || column == BuildStatistics::kColName;
+}
+
+//------------------------------------------------------------------------------
+// BuildStatistics
+//------------------------------------------------------------------------------
+
+BuildStatistics::BuildStatistics(const wxFileName& filename)
+    : m_db(NULL)
+    , m_filename(filename)
+{
+}
+
+BuildStatistics::~BuildStatistics()
+{
+    Close();
+}
+
+wxFileName BuildStatistics::GetFileName() const
+{
+    wxFileName dbfile;
+    if ( !m_filename.IsOk() ) {
+        dbfile = wxFileName(WorkspaceST::Get()->GetPrivateFolder(), "build_statistics.db");
+
+    } else {
+        dbfile = m_filename;
+    }
+    return dbfile;
+}
+
+void BuildStatistics::GetProjectsInfo(const wxString& project, const wxString& configuration, ProjectInfoMap_t& projects)
+{
+    projects.clear();
+
+    Workspace* workspace = WorkspaceST::Get();
+    BuildMatrixPtr matrix = workspace->GetBuildMatrix();
+    if ( !matrix ) {
+        return;
+    }
+
+    wxString workspaceConf = matrix->GetSelectedConfigurationName();
+    wxArrayString names;
+    workspace->GetProjectList(names);
+
+    for(size_t i=0; i<names.GetCount(); ++i) {
+        wxString errMsg;
+        ProjectPtr proj = workspace->FindProjectByName(names.Item(i), errMsg);
+        if ( !proj ) {
+            continue;
+        }
+
+        ProjectInfo info;
+        info.m_name = names.Item(i);
+        if ( info.m_name == project && !configuration.IsEmpty() ) {
+            info.m_configuration = configuration;
+
+        } else {
+            info.m_configuration = matrix->GetProjectSelectedConf(workspaceConf, info.m_name);
+        }
+
+        BuildConfigPtr bldConf = workspace->GetProjBuildConf(info.m_name, info.m_configuration);
+        if ( bldConf ) {
+            CompilerPtr cmp = bldConf->GetCompiler();
+            if ( cmp ) {
+                info.m_objectSuffix = cmp->GetObjectSuffix();
+                info.m_dependSuffix = cmp->GetDependSuffix();
+            }
+        }
+        projects[NormalizeDir(proj->GetFileName().GetPath())] = info;
+    }
+}
+
+void BuildStatistics::Open()
+{
+    // Close the old database
+    if ( m_db ) {
+        Close();
+    }
+
+    try {
+
+        m_db = new wxSQLite3Database();
+        m_db->Open(GetFileName().GetFullPath());
+
+        // The import runs on a worker thread while the report may be open
+        m_db->SetBusyTimeout(5000);
+        CreateDatabase();
+
+    } catch (wxSQLite3Exception &e) {
+
+        wxUnusedVar(e);
+        delete m_db;
+        m_db = NULL;
+
+    }
+}
+
+void BuildStatistics::Close()
+{
+    if ( m_db ) {
+
+        try {
+            m_db->Close();
+            delete m_db;
+
+        } catch (wxSQLite3Exception &e) {
+            wxUnusedVar(e);
+        }
+    }
+    m_db = NULL;
+}
+
+void BuildStatistics::CreateDatabase()
+{
+    if ( !IsOpened() )
+        return;
+
+    try {
+
+        m_db->ExecuteUpdate("CREATE TABLE IF NOT EXISTS BUILDS (ID INTEGER PRIMARY KEY AUTOINCREMENT, BUILD_DATE TEXT)");
+        m_db->ExecuteUpdate("CREATE TABLE IF NOT EXISTS COMPILES (BUILD_ID INTEGER, PROJECT TEXT, CONFIG TEXT, FILE_NAME TEXT, WALL INTEGER, CPU INTEGER, RSS INTEGER, EXIT_CODE INTEGER)");
+        m_db->ExecuteUpdate("CREATE TABLE IF NOT EXISTS HEADERS (BUILD_ID INTEGER, PROJECT TEXT, CONFIG TEXT, HEADER TEXT, TU_COUNT INTEGER, WALL INTEGER)");
+        m_db->ExecuteUpdate("CREATE INDEX IF NOT EXISTS COMPILES_IDX1 ON COMPILES(BUILD_ID)");
+        m_db->ExecuteUpdate("CREATE INDEX IF NOT EXISTS HEADERS_IDX1 ON HEADERS(BUILD_ID)");
+
+    } catch (wxSQLite3Exception &e) {
+        wxUnusedVar(e);
+    }
+}
+
+void BuildStatistics::ReadDependencies(const wxString& depFile, const wxString& source, const wxString& cwd, wxArrayString& headers)
+{
+    wxString content;
+    {
+        wxFFile fp(depFile, wxT("rb"));
+        if ( !fp.IsOpened() || !fp.ReadAll(&content, wxConvUTF8) ) {
+            return;
+        }
+    }
+
+    // Only the first rule is of interest ("OBJECT: SOURCE HEADER1 HEADER2 \"), the ones
+    // that follow are the phony targets added by -MP. The target ends with the first colon
+    // followed by a white space (a drive letter colon is followed by a path separator)
+    size_t len   = content.length();
+    size_t start = wxString::npos;
+    for(size_t i=0; i<len; ++i) {
+        if ( content[i] == wxT(':') && (i + 1 == len || wxIsspace(content[i + 1])) ) {
+            start = i + 1;
+            break;
+        }
+    }
+
+    if ( start == wxString::npos ) {
+        return;
+    }
+
+    wxArrayString tokens;
+    wxString token;
+    for(size_t i=start; i<len; ++i) {
+        wxChar ch = content[i];
+        if ( ch == wxT('\\') && i + 1 < len ) {
+            wxChar next = content[i + 1];
+            if ( next == wxT('\n') || (next == wxT('\r') && i + 2 < len && content[i + 2] == wxT('\n')) ) {
+                // line continuation
+                i += (next == wxT('\n')) ? 1 : 2;
+                if ( !token.IsEmpty() ) {
+                    tokens.Add(token);
+                    token.Clear();
+                }
+
+            } else if ( next == wxT(' ') || next == wxT('#') ) {
+                // escaped character
+                token << next;
+                ++i;
+
+            } else {
+                // a Windows path separator
+                token << ch;
+            }
+
+        } else if ( ch == wxT('\n') ) {
+            break;
+
+        } else if ( wxIsspace(ch) ) {
+            if ( !token.IsEmpty() ) {
+                tokens.Add(token);
+                token.Clear();
+            }
+
+        } else {
+            token << ch;
+        }
+    }
+
+    if ( !token.IsEmpty() ) {
+        tokens.Add(token);
+    }
+
+    for(size_t i=0; i<tokens.GetCount(); ++i) {
+        wxString header = NormalizeFile(tokens.Item(i), cwd);
+        if ( header != source ) {
+            headers.Add(header);
+        }
+    }
+}
+
+void BuildStatistics::ClaimRecords(wxArrayString& files) const
+{
+    wxFileName logFile( GetFileName() );
+    logFile.SetFullName( logFile.GetFullName() + ".txt" );
+    ::ClaimCodeLiteLogFiles( logFile, files );
+}
+
+size_t BuildStatistics::Import(const wxArrayString& files, const ProjectInfoMap_t& projects)
+{
+    if ( !IsOpened() )
+        return 0;
+
+    wxLogNull nl;
+
+    wxString content;
+    for(size_t n=0; n<files.GetCount(); ++n) {
+        wxFFile fp(files.Item(n), wxT("rb"));
+        if ( fp.IsOpened() ) {
+            wxString fileContent;
+            fp.ReadAll(&fileContent, wxConvUTF8);
+            fp.Close();
+            content << fileContent << wxT("\n");
+        }
+        ::wxRemoveFile( files.Item(n) );
+    }
+
+    // A record: FILE|CWD|OBJECT|WALL|CPU|RSS|EXIT_CODE. The same file compiled
+    // twice in a build keeps its last record
+    CompileMap_t compiles;
+    wxArrayString lines = ::wxStringTokenize(content, "\n\r", wxTOKEN_STRTOK);
+    for(size_t i=0; i<lines.GetCount(); ++i) {
+        wxArrayString parts = ::wxStringTokenize(lines.Item(i), wxT("|"), wxTOKEN_RET_EMPTY_ALL);
+        if ( parts.GetCount() != 7 )
+            continue;
+
+        BuildCompile compile;
+        wxString cwd    = parts.Item(1).Trim().Trim(false);
+        wxString object = parts.Item(2).Trim().Trim(false);
+        compile.m_file  = NormalizeFile(parts.Item(0).Trim().Trim(false), cwd);
+        if ( !parts.Item(3).ToLong(&compile.m_wall) || !parts.Item(4).ToLong(&compile.m_cpu) ||
+             !parts.Item(5).ToLong(&compile.m_rss)  || !parts.Item(6).ToLong(&compile.m_exitCode) )
+            continue;
+
+        ProjectInfoMap_t::const_iterator iter = projects.find( NormalizeDir(cwd) );
+        if ( iter != projects.end() ) {
+            const ProjectInfo& info = iter->second;
+            compile.m_project       = info.m_name;
+            compile.m_configuration = info.m_configuration;
+
+            // The dependency file is generated next to the object file
+            if ( compile.m_exitCode == 0 && !object.IsEmpty() && !info.m_objectSuffix.IsEmpty() && !info.m_dependSuffix.IsEmpty() ) {
+                wxString objectPath = NormalizeFile(object, cwd);
+                if ( objectPath.EndsWith(info.m_objectSuffix) ) {
+                    wxString depFile = objectPath.Left(objectPath.length() - info.m_objectSuffix.length()) + info.m_dependSuffix;
+                    ReadDependencies(depFile, compile.m_file, cwd, compile.m_headers);
+                }
+            }
+        }
+
+        wxString key;
+        key << compile.m_project << wxT("\t") << compile.m_configuration << wxT("\t") << compile.m_file;
+        compiles[key] = compile;
+    }
+
+    if ( compiles.empty() )
+        return 0;
+
+    // The cost of a header in this build: the translation units including it and the
+    // time spent compiling them
+    typedef std::map<wxString, std::pair<int, long> > HeaderMap_t;
+    HeaderMap_t headers;
+    CompileMap_t::const_iterator iter = compiles.begin();
+    for(; iter != compiles.end(); ++iter) {
+        const BuildCompile& compile = iter->second;
+        for(size_t i=0; i<compile.m_headers.GetCount(); ++i) {
+            wxString key;
+            key << compile.m_project << wxT("\t") << compile.m_configuration << wxT("\t") << compile.m_headers.Item(i);
+            std::pair<int, long>& cost = headers[key];
+            cost.first++;
+            cost.second += compile.m_wall;
+        }
+    }
+
+    try {
+
+        m_db->ExecuteUpdate("BEGIN");
+
+        wxSQLite3Statement stBuild = m_db->PrepareStatement("INSERT INTO BUILDS (BUILD_DATE) VALUES(?)");
+        stBuild.Bind(1, wxDateTime::Now().Format(wxT("%Y-%m-%d %H:%M:%S")));
+        stBuild.ExecuteUpdate();
+        wxLongLong buildId = m_db->GetLastRowId();
+
+        wxSQLite3Statement stCompile = m_db->PrepareStatement("INSERT INTO COMPILES (BUILD_ID, PROJECT, CONFIG, FILE_NAME, WALL, CPU, RSS, EXIT_CODE) VALUES(?, ?, ?, ?, ?, ?, ?, ?)");
+        for(iter = compiles.begin(); iter != compiles.end(); ++iter) {
+            const BuildCompile& compile = iter->second;
+            stCompile.Bind(1, buildId);
+            stCompile.Bind(2, compile.m_project);
+            stCompile.Bind(3, compile.m_configuration);
+            stCompile.Bind(4, compile.m_file);
+            stCompile.Bind(5, (int)compile.m_wall);
+            stCompile.Bind(6, (int)compile.m_cpu);
+            stCompile.Bind(7, (int)compile.m_rss);
+            stCompile.Bind(8, (int)compile.m_exitCode);
+            stCompile.ExecuteUpdate();
+            stCompile.Reset();
+        }
+
+        wxSQLite3Statement stHeader = m_db->PrepareStatement("INSERT INTO HEADERS (BUILD_ID, PROJECT, CONFIG, HEADER, TU_COUNT, WALL) VALUES(?, ?, ?, ?, ?, ?)");
+        HeaderMap_t::const_iterator hiter = headers.begin();
+        for(; hiter != headers.end(); ++hiter) {
+            wxArrayString parts = ::wxStringTokenize(hiter->first, wxT("\t"), wxTOKEN_RET_EMPTY_ALL);
+            if ( parts.GetCount() != 3 )
+                continue;
+
+            stHeader.Bind(1, buildId);
+            stHeader.Bind(2, parts.Item(0));
+            stHeader.Bind(3, parts.Item(1));
+            stHeader.Bind(4, parts.Item(2));
+            stHeader.Bind(5, hiter->second.first);
+            stHeader.Bind(6, (int)hiter->second.second);
+            stHeader.ExecuteUpdate();
+            stHeader.Reset();
+        }
+
+        // Drop the oldest builds
+        wxLongLong oldest = buildId - BUILD_STATISTICS_MAX_BUILDS;
+        if ( oldest > 0 ) {
+            wxSQLite3Statement stDelete = m_db->PrepareStatement("DELETE FROM BUILDS WHERE ID <= ?");
+            stDelete.Bind(1, oldest);
+            stDelete.ExecuteUpdate();
+
+            wxSQLite3Statement stDeleteCompiles = m_db->PrepareStatement("DELETE FROM COMPILES WHERE BUILD_ID <= ?");
+            stDeleteCompiles.Bind(1, oldest);
+            stDeleteCompiles.ExecuteUpdate();
+
+            wxSQLite3Statement stDeleteHeaders = m_db->PrepareStatement("DELETE FROM HEADERS WHERE BUILD_ID <= ?");
+            stDeleteHeaders.Bind(1, oldest);
+            stDeleteHeaders.ExecuteUpdate();
+        }
+
+        m_db->ExecuteUpdate("COMMIT");
+
+    } catch (wxSQLite3Exception &e) {
+        wxUnusedVar(e);
+        try {
+            m_db->ExecuteUpdate("ROLLBACK");
+
+        } catch (wxSQLite3Exception &e2) {
+            wxUnusedVar(e2);
+        }
+        return 0;
+    }
+    return compiles.size();
+}
+
+void BuildStatistics::GetReport(eReport report, EntryVec_t& entries)
+{
+    entries.clear();
+    if ( !IsOpened() )
+        return;
+
+    // All the queries return: BUILD_ID, PROJECT, CONFIG, NAME, WALL, CPU, RSS, COUNT
+    // ordered by build so the last row seen for an entry is its most recent one
+    wxString sql;
+    switch ( report ) {
+    case kHeaders:
+        sql = "SELECT BUILD_ID, PROJECT, CONFIG, HEADER, WALL, 0, 0, TU_COUNT FROM HEADERS ORDER BY BUILD_ID";
+        break;
+    case kProjects:
+        sql = "SELECT BUILD_ID, PROJECT, CONFIG, '', SUM(WALL), SUM(CPU), MAX(RSS), COUNT(*) FROM COMPILES "
+              "GROUP BY BUILD_ID, PROJECT, CONFIG ORDER BY BUILD_ID";
+        break;
+    case kFiles:
+    default:
+        sql = "SELECT BUILD_ID, PROJECT, CONFIG, FILE_NAME, WALL, CPU, RSS, 0 FROM COMPILES ORDER BY BUILD_ID";
+        break;
+    }
+
+    AccumulatorMap_t accumulators;
+    try {
+
+        wxSQLite3ResultSet rs = m_db->ExecuteQuery(sql);
+        while ( rs.NextRow() ) {
+            wxString project = rs.GetString(1);
+            wxString config  = rs.GetString(2);
+            wxString name    = rs.GetString(3);
+            long wall        = rs.GetInt(4);
+
+            wxString key;
+            key << project << wxT("\t") << config << wxT("\t") << name;
+
+            BuildAccumulator& acc = accumulators[key];
+            Entry& entry = acc.m_entry;
+            if ( entry.m_builds == 0 ) {
+                entry.m_project       = project;
+                entry.m_configuration = config;
+                entry.m_name          = name;
+            }
+
+            entry.m_builds++;
+            acc.m_total     += wall;
+            entry.m_last     = wall;
+            entry.m_max      = wxMax(entry.m_max, wall);
+            entry.m_cpu      = rs.GetInt(5);
+            entry.m_peakRss  = wxMax(entry.m_peakRss, (long)rs.GetInt(6));
+            entry.m_count    = rs.GetInt(7);
+        }
+
+    } catch (wxSQLite3Exception &e) {
+        wxUnusedVar(e);
+    }
+
+    entries.reserve(accumulators.size());
+    AccumulatorMap_t::iterator iter = accumulators.begin();
+    for(; iter != accumulators.end(); ++iter) {
+        Entry& entry = iter->second.m_entry;
+        entry.m_average = (long)(iter->second.m_total / entry.m_builds);
+        entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(), SortByLastDesc);
+}
+
+size_t BuildStatistics::GetBuildsCount()
+{
+    if ( !IsOpened() )
+        return 0;
+
+    try {
+        return m_db->ExecuteScalar("SELECT COUNT(*) FROM BUILDS");
+
+    } catch (wxSQLite3Exception &e) {
+        wxUnusedVar(e);
+    }
+    return 0;
+}
+
+void BuildStatistics::Clear()
+{
+    if ( !IsOpened() )
+        return;
+
+    try {
+
+        m_db->ExecuteUpdate("BEGIN");
+        m_db->ExecuteUpdate("DELETE FROM COMPILES");
+        m_db->ExecuteUpdate("DELETE FROM HEADERS");
+        m_db->ExecuteUpdate("DELETE FROM BUILDS");
+        m_db->ExecuteUpdate("COMMIT");
+
+    } catch (wxSQLite3Exception &e) {
+        wxUnusedVar(e);
+    }
+}
+
+void BuildStatistics::GetColumns(eReport report, std::vector<int>& columns)
+{
+    columns.clear();
+    columns.push_back(kColProject);
+    columns.push_back(kColConfiguration);
+    switch ( report ) {
+    case kHeaders:
+        columns.push_back(kColName);
+        columns.push_back(kColCount);
+        columns.push_back(kColLast);
+        columns.push_back(kColAverage);
+        columns.push_back(kColMax);
+        break;
+
+    case kProjects:
+        columns.push_back(kColCount);
+        columns.push_back(kColLast);
+        columns.push_back(kColAverage);
+        columns.push_back(kColMax);
+        columns.push_back(kColCpu);
+        columns.push_back(kColPeakRss);
+        break;
+
+    case kFiles:
+    default:
+        columns.push_back(kColName);
+        columns.push_back(kColLast);
+        columns.push_back(kColAverage);
+        columns.push_back(kColMax);
+        columns.push_back(kColCpu);
+        columns.push_back(kColPeakRss);
+        break;
+    }
+    columns.push_back(kColBuilds);
+}
+
+wxString BuildStatistics::GetColumnTitle(eReport report, int column)
+{
+    switch ( column ) {
+    case kColProject:
+        return _("Project");
+    case kColConfiguration:
+        return _("Configuration");
+    case kColName:
+        return report == kHeaders ? _("Header") : _("File");
+    case kColCount:
+        return report == kHeaders ? _("Translation units") : _("Files");
+    case kColLast:
+        return _("Last (ms)");
+    case kColAverage:
+        return _("Average (ms)");
+    case kColMax:
+        return _("Max (ms)");
+    case kColCpu:
+        return _("CPU (ms)");
+    case kColPeakRss:
+        return _("Peak memory (KB)");
+    case kColBuilds:
+    default:
+        return _("Builds");
+    }
+}
+
+wxString BuildStatistics::GetColumnValue(const Entry& entry, int column)
+{
+    switch ( column ) {
+    case kColProject:
+        return entry.m_project;
+    case kColConfiguration:
+        return entry.m_configuration;
+    case kColName:
+        return entry.m_name;
+    default:
+        return wxString() << GetColumnNumber(entry, column);
+    }
+}
+
+int BuildStatistics::Compare(const Entry& a, const Entry& b, int column)
+{
+    if ( IsTextColumn(column) ) {
+        return GetColumnValue(a, column).CmpNoCase(GetColumnValue(b, column));
+    }
+
+    long na = GetColumnNumber(a, column);
+    long nb = GetColumnNumber(b, column);
+    return na < nb ? -1 : (na > nb ? 1 : 0);
+}
+
+bool BuildStatistics::ExportCSV(eReport report, const EntryVec_t& entries, const wxFileName& fn)
+{
+    std::vector<int> columns;
+    GetColumns(report, columns);
+
+    wxString content;
+    for(size_t i=0; i<columns.size(); ++i) {
+        content << (i ? wxT(",") : wxT("")) << GetColumnTitle(report, columns.at(i));
+    }
+    content << wxT("\n");
+
+    for(size_t n=0; n<entries.size(); ++n) {
+        for(size_t i=0; i<columns.size(); ++i) {
+            wxString value = GetColumnValue(entries.at(n), columns.at(i));
+            if ( IsTextColumn(columns.at(i)) ) {
+                value.Replace(wxT("\""), wxT("\"\""));
+                value.Prepend(wxT("\"")).Append(wxT("\""));
+            }
+            content << (i ? wxT(",") : wxT("")) << value;
+        }
+        content << wxT("\n");
+    }
+
+    wxFFile fp(fn.GetFullPath(), wxT("w+b"));
+    if ( !fp.IsOpened() ) {
+        return false;
+    }
+    return fp.Write(content, wxConvUTF8) && fp.Close();
+}
+
+bool BuildStatistics::ExportJSON(eReport report, const EntryVec_t& entries, const wxFileName& fn)
+{
+    std::vector<int> columns;
+    GetColumns(report, columns);
+
+    JSONRoot root(cJSON_Array);
+    JSONElement arr = root.toElement();
+    for(size_t n=0; n<entries.size(); ++n) {
+        JSONElement obj = JSONElement::createObject();
+        for(size_t i=0; i<columns.size(); ++i) {
+            int column = columns.at(i);
+            if ( IsTextColumn(column) ) {
+                obj.addProperty(GetColumnKey(report, column), GetColumnValue(entries.at(n), column));
+
+            } else {
+                obj.addProperty(GetColumnKey(report, column), (int)GetColumnNumber(entries.at(n), column));
+            }
+        }
+        arr.arrayAppend(obj);
+    }
+
+    root.save(fn);
+    return fn.FileExists();
+}
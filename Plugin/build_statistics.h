@@ -0,0 +1,195 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : build_statistics.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef BUILDSTATISTICS_H
+#define BUILDSTATISTICS_H
+
+#include "codelite_exports.h"
+#include <wx/string.h>
+#include <wx/filename.h>
+#include <wx/wxsqlite3.h>
+#include <vector>
+#include <map>
+
+/**
+ * @class BuildStatistics
+ * @brief the history of the compilation times, kept in the workspace private folder
+ * (build_statistics.db).
+ *
+ * When CL_BUILD_STATS is set, codelitegcc measures every compilation (wall and CPU time,
+ * peak RSS) and appends a record to CL_BUILD_STATS.txt. Once the build ends, the records
+ * are imported as a new build. The cost of a header is the time spent compiling the
+ * translation units that include it (taken from the dependency files generated by make)
+ */
+class WXDLLIMPEXP_SDK BuildStatistics
+{
+public:
+    enum eReport {
+        kFiles = 0,
+        kHeaders,
+        kProjects
+    };
+
+    /**
+     * @brief a line of a report. Times are in milliseconds, memory in KB
+     */
+    struct Entry {
+        wxString m_project;
+        wxString m_configuration;
+        wxString m_name;      // the file or the header (empty for kProjects)
+        size_t   m_builds;    // the number of builds it appears in
+        long     m_last;      // wall time in the most recent of these builds
+        long     m_average;   // average wall time
+        long     m_max;       // highest wall time
+        long     m_cpu;       // CPU time in the most recent build
+        long     m_peakRss;   // highest peak RSS
+        long     m_count;     // kHeaders: translation units including it, kProjects: files compiled (most recent build)
+
+        Entry()
+            : m_builds(0), m_last(0), m_average(0), m_max(0), m_cpu(0), m_peakRss(0), m_count(0)
+        {}
+    };
+    typedef std::vector<Entry> EntryVec_t;
+
+    enum eColumn {
+        kColProject = 0,
+        kColConfiguration,
+        kColName,
+        kColCount,
+        kColLast,
+        kColAverage,
+        kColMax,
+        kColCpu,
+        kColPeakRss,
+        kColBuilds
+    };
+
+    /**
+     * @brief what the import needs to know about a project, collected from the
+     * workspace on the main thread
+     */
+    struct ProjectInfo {
+        wxString m_name;
+        wxString m_configuration;
+        wxString m_objectSuffix;
+        wxString m_dependSuffix;
+    };
+    // project path -> project info
+    typedef std::map<wxString, ProjectInfo> ProjectInfoMap_t;
+
+protected:
+    wxSQLite3Database* m_db;
+    wxFileName         m_filename;
+
+protected:
+    void CreateDatabase();
+
+public:
+    BuildStatistics(const wxFileName &filename = wxFileName());
+    virtual ~BuildStatistics();
+
+    /**
+     * @brief return the database file name, usually WORKSPACE_PATH/.codelite/build_statistics.db
+     * codelitegcc writes its records to the same file name with a '.txt' suffix
+     */
+    wxFileName GetFileName() const;
+
+    /**
+     * @brief collect the information the import needs for all the projects of the
+     * workspace. 'project' is built using 'configuration' (if not empty), the other
+     * projects use their configuration as selected by the workspace
+     * @note must be called from the main thread
+     */
+    static void GetProjectsInfo(const wxString &project, const wxString &configuration, ProjectInfoMap_t &projects);
+
+    /**
+     * @brief read the prerequisites of the first rule of a dependency file generated by the
+     * compiler (-MM). Relative paths are made absolute using 'cwd'. 'source' (a full path)
+     * is not added to 'headers', pass an empty string to keep it (it is then the first entry)
+     */
+    static void ReadDependencies(const wxString &depFile, const wxString &source, const wxString &cwd, wxArrayString &headers);
+
+    void Open();
+    void Close();
+    bool IsOpened() const {
+        return m_db && m_db->IsOpen();
+    }
+
+    /**
+     * @brief take the records written by codelitegcc during the build that just ended: the
+     * log files are renamed (see ClaimCodeLiteLogFiles()) so the next build starts a new log
+     * @param files [output] the files to pass to Import()
+     */
+    void ClaimRecords(wxArrayString &files) const;
+
+    /**
+     * @brief import the records claimed by ClaimRecords() as a new build. The files are
+     * deleted. Only the most recent builds are kept
+     * @return the number of compilations imported
+     * @note this method can be called from a worker thread
+     */
+    size_t Import(const wxArrayString &files, const ProjectInfoMap_t &projects);
+
+    /**
+     * @brief return the report over all the builds recorded, slowest first
+     */
+    void GetReport(eReport report, EntryVec_t &entries);
+
+    /**
+     * @brief return the number of builds recorded
+     */
+    size_t GetBuildsCount();
+
+    /**
+     * @brief delete the history
+     */
+    void Clear();
+
+    /**
+     * @brief return the columns (eColumn) shown by 'report', in display order
+     */
+    static void GetColumns(eReport report, std::vector<int> &columns);
+    static wxString GetColumnTitle(eReport report, int column);
+    static wxString GetColumnValue(const Entry &entry, int column);
+
+    /**
+     * @brief compare two entries by 'column'. Text columns sort alphabetically, the others
+     * numerically
+     * @return <0, 0 or >0
+     */
+    static int Compare(const Entry &a, const Entry &b, int column);
+
+    /**
+     * @brief write 'entries' to 'fn' as comma separated values
+     */
+    static bool ExportCSV(eReport report, const EntryVec_t &entries, const wxFileName &fn);
+
+    /**
+     * @brief write 'entries' to 'fn' as a JSON array
+     */
+    static bool ExportJSON(eReport report, const EntryVec_t &entries, const wxFileName &fn);
+};
+
+#endif // BUILDSTATISTICS_H
@@ -44,11 +44,22 @@
 #include "wx/sstream.h"
 #include "globals.h"
 #include "cl_command_event.h"
+#include "macromanager.h"
+#include "wxmd5.h"
+#include "wx_xml_compatibility.h"
+#include "procutils.h"
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/log.h>
+#include <string.h>
 
 wxStopWatch g_sw;
 
 static bool OS_WINDOWS = wxGetOsVersion() & wxOS_WINDOWS ? true : false;
 
+// The line of the makefile header that holds its fingerprint
+#define MAKEFILE_FINGERPRINT_PREFIX wxT("## Fingerprint: ")
+
 #if PERFORMANCE
 # define TIMER_START(){\
         g_sw.Start();\
@@ -89,6 +100,19 @@ static wxString GetMakeDirCmd(BuildConfigPtr bldConf, const wxString &relPath =
     return text;
 }
 
+// Append everything 'node' (and its siblings) holds to 'fingerprint'
+static void AddXmlFingerprint(wxString &fingerprint, const wxXmlNode *node)
+{
+    for(; node; node = node->GetNext()) {
+        fingerprint << wxT("<") << node->GetName() << wxT(">") << node->GetContent();
+        for(wxXmlProperty* prop = node->GetProperties(); prop; prop = prop->GetNext()) {
+            fingerprint << wxT(" ") << prop->GetName() << wxT("=") << prop->GetValue();
+        }
+        AddXmlFingerprint(fingerprint, node->GetChildren());
+        fingerprint << wxT("</>");
+    }
+}
+
 BuilderGnuMake::BuilderGnuMake()
     : Builder(wxT("GNU makefile for g++/gcc"), wxT("make"), wxT("-f"))
     , m_objectChunks(1)
@@ -108,6 +132,9 @@ bool BuilderGnuMake::Export(const wxString &project, const wxString &confToBuild
 {
     TIMER_START();
     PRINT_TIMESTAMP(_("Exporting makefile...\n"));
+
+    // The same project macros are expanded over and over while the makefiles are generated
+    MacroCacheScope macroCache;
     if (project.IsEmpty()) {
         return false;
     }
@@ -214,8 +241,10 @@ bool BuilderGnuMake::Export(const wxString &project, const wxString &confToBuild
     wxFileName wspfile(WorkspaceST::Get()->GetWorkspaceFileName());
 
     PRINT_TIMESTAMP(_("Generating makefile...\n"));
-    text << wxT(".PHONY: clean All\n\n");
-    text << wxT("All:\n");
+
+    // The build commands of every project, in build order
+    wxArrayString buildProjects;
+    wxArrayString buildRecipes;
 
     //iterate over the dependencies projects and generate makefile
     wxString buildTool = GetBuildToolCommand(project, confToBuild, false);
@@ -231,6 +260,7 @@ bool BuilderGnuMake::Export(const wxString &project, const wxString &confToBuild
     if (!isProjectOnly) {
         for (size_t i=0; i<depsArr.GetCount(); ++i) {
             bool isCustom(false);
+            wxString recipe;
             ProjectPtr dependProj = WorkspaceST::Get()->FindProjectByName(depsArr.Item(i), errMsg);
             if (!dependProj) {
                 continue;
@@ -253,7 +283,7 @@ bool BuilderGnuMake::Export(const wxString &project, const wxString &confToBuild
                 continue;
             }
             
-            text << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << dependProj->GetName() << wxT(" - ") << projectSelConf << wxT(" ]----------\"\n");
+            recipe << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << dependProj->GetName() << wxT(" - ") << projectSelConf << wxT(" ]----------\"\n");
             // make the paths relative, if it's sensible to do so
             wxFileName fn(dependProj->GetFileName());
             MakeRelativeIfSensible(fn, wspfile.GetPath());
@@ -270,11 +300,11 @@ bool BuilderGnuMake::Export(const wxString &project, const wxString &confToBuild
                 e.SetConfigurationName( projectSelConf );
                 e.SetProjectOnly(false);
                 EventNotifier::Get()->ProcessEvent(e);
-                text << wxT("\t") << e.GetCommand() << wxT("\n");
+                recipe << wxT("\t") << e.GetCommand() << wxT("\n");
                 
             } else if ( isCustom ) {
 
-                CreateCustomPreBuildEvents(dependProjbldConf, text);
+                CreateCustomPreBuildEvents(dependProjbldConf, recipe);
 
                 wxString customWd  = dependProjbldConf->GetCustomBuildWorkingDir();
                 wxString build_cmd = dependProjbldConf->GetCustomBuildCmd();
@@ -298,8 +328,8 @@ bool BuilderGnuMake::Export(const wxString &project, const wxString &confToBuild
                     customWdCmd << GetCdCmd(wspfile, fn);
                 }
 
-                text << wxT("\t") << customWdCmd << build_cmd << wxT("\n");
-                CreateCustomPostBuildEvents(dependProjbldConf, text);
+                recipe << wxT("\t") << customWdCmd << build_cmd << wxT("\n");
+                CreateCustomPostBuildEvents(dependProjbldConf, recipe);
 
             } else {
                 PRINT_TIMESTAMP(wxString::Format(_("Generating makefile for project %s...\n"), dependProj->GetName().c_str()));
@@ -308,15 +338,23 @@ bool BuilderGnuMake::Export(const wxString &project, const wxString &confToBuild
                 dep_file << wxFileName::GetPathSeparator() << dependProj->GetName();
                 depsProjs.Add(dep_file);
 
-                GenerateMakefile(dependProj, projectSelConf, confToBuild.IsEmpty() ? force : true, wxArrayString());
-                text << GetProjectMakeCommand(wspfile, fn, dependProj, projectSelConf);
+                GenerateMakefile(dependProj, projectSelConf, force, wxArrayString());
+                recipe << GetProjectMakeCommand(wspfile, fn, dependProj, projectSelConf);
                 PRINT_TIMESTAMP(wxString::Format(_("Generating makefile for project %s...done\n"), dependProj->GetName().c_str()));
             }
+
+            buildProjects.Add(dependProj->GetName());
+            buildRecipes.Add(recipe);
         }
     }
 
-    // Generate makefile for the project itself
-    GenerateMakefile(proj, confToBuild, confToBuild.IsEmpty() ? force : true, depsProjs);
+    // Generate makefile for the project itself. When the configuration is specified
+    // manually, the makefile may have been generated for another one: mark the project
+    // as modified so its fingerprint is checked
+    if (confToBuild.IsEmpty() == false) {
+        proj->SetModified( true );
+    }
+    GenerateMakefile(proj, confToBuild, force, depsProjs);
 
     // incase we manually specified the configuration to be built, set the project
     // as modified, so on next attempt to build it, CodeLite will sync the configuration
@@ -331,7 +369,8 @@ bool BuilderGnuMake::Export(const wxString &project, const wxString &confToBuild
         projectSelConf = confToBuild;
     }
 
-    text << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << project << wxT(" - ") << projectSelConf << wxT(" ]----------\"\n");
+    wxString recipe;
+    recipe << wxT("\t@echo \"") << wxGetTranslation(BUILD_PROJECT_PREFIX) << project << wxT(" - ") << projectSelConf << wxT(" ]----------\"\n");
 
     //make the paths relative, if it's sensible to do so
     wxFileName projectPath(proj->GetFileName());
@@ -350,11 +389,27 @@ bool BuilderGnuMake::Export(const wxString &project, const wxString &confToBuild
         EventNotifier::Get()->ProcessEvent(e);
 
         cmd = e.GetCommand();
-        text << wxT("\t") << cmd << wxT("\n");
+        recipe << wxT("\t") << cmd << wxT("\n");
 
     } else {
-        text << GetProjectMakeCommand(wspfile, projectPath, proj, projectSelConf);
+        recipe << GetProjectMakeCommand(wspfile, projectPath, proj, projectSelConf);
+
+    }
 
+    buildProjects.Add(project);
+    buildRecipes.Add(recipe);
+
+    long parallel(0);
+    EditorConfigST::Get()->GetLongValue(wxT("BuildProjectsInParallel"), parallel);
+    if (parallel && !isProjectOnly) {
+        CreateParallelBuildTargets(buildProjects, buildRecipes, IsOutputSyncSupported(project, confToBuild), text);
+
+    } else {
+        text << wxT(".PHONY: clean All\n\n");
+        text << wxT("All:\n");
+        for (size_t i=0; i<buildRecipes.GetCount(); i++) {
+            text << buildRecipes.Item(i);
+        }
     }
 
     //create the clean target
@@ -460,9 +515,7 @@ bool BuilderGnuMake::Export(const wxString &project, const wxString &confToBuild
 
     //dump the content to file
     PRINT_TIMESTAMP(_("Writing makefile...\n"));
-    wxFileOutputStream output(fn);
-    wxStringInputStream content(text);
-    output << content;
+    WriteMakefile(fn, text);
     PRINT_TIMESTAMP(_("Writing makefile...done\n"));
 
     return true;
@@ -481,7 +534,11 @@ void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString &confToBui
 
     // we handle custom builds and non-custom build separatly:
     if ( isPluginGeneratedMakefile ) {
-        if( force ) {
+        // A plugin makefile has no fingerprint: export it again when the configuration
+        // is specified manually, it may have been exported for another one. Only the
+        // project being built gets here, dependencies generated by a plugin are
+        // handled by Export()
+        if( force || !confToBuild.IsEmpty() ) {
             // Generate the makefile
             SendBuildEvent(wxEVT_PLUGIN_EXPORT_MAKEFILE, pname, tmpConfigName);
         }
@@ -519,6 +576,32 @@ void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString &confToBui
         }
     }
 
+    // A project is marked as modified for many reasons that don't affect its makefile:
+    // regenerate it only if the inputs it is generated from have changed, or if the
+    // makefile was removed or modified since we wrote it. The fingerprint is kept in
+    // the makefile header, so it survives a restart of CodeLite
+    wxString additionalCompileFlags = GetAdditionalCompileFlags(proj, bldConf);
+    wxString fingerprint = GetMakefileFingerprint(proj, bldConf, depsProj, additionalCompileFlags);
+    if (!force && wxFileName::FileExists(fn)) {
+        time_t modified = wxFileModificationTime(fn);
+        bool upToDate(false);
+
+        MakefileStateMap_t::const_iterator iter = m_makefiles.find(fn);
+        if (iter != m_makefiles.end()) {
+            upToDate = iter->second.m_fingerprint == fingerprint && iter->second.m_modified == modified;
+        } else {
+            upToDate = ReadMakefileFingerprint(fn) == fingerprint;
+        }
+
+        if (upToDate) {
+            MakefileState &state = m_makefiles[fn];
+            state.m_fingerprint = fingerprint;
+            state.m_modified    = modified;
+            proj->SetModified(false);
+            return;
+        }
+    }
+
     //generate the selected configuration for this project
     //wxTextOutputStream text(output);
     wxString text;
@@ -527,9 +610,10 @@ void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString &confToBui
     text << wxT("## Auto Generated makefile by CodeLite IDE") << wxT("\n");
     text << wxT("## any manual changes will be erased      ") << wxT("\n");
     text << wxT("##") << wxT("\n");
+    size_t fingerprintPos = text.length();
 
     // Create the makefile variables
-    CreateConfigsVariables(proj, bldConf, text);
+    CreateConfigsVariables(proj, bldConf, additionalCompileFlags, text);
 
 
     //----------------------------------------------------------
@@ -581,16 +665,227 @@ void BuilderGnuMake::GenerateMakefile(ProjectPtr proj, const wxString &confToBui
     CreateFileTargets(proj, confToBuild, text);
     CreateCleanTargets(proj, confToBuild, text);
 
+    // Record the fingerprint in the header, with a digest of the content so a makefile
+    // modified by hand is detected (see ReadMakefileFingerprint)
+    wxString fingerprintLine;
+    fingerprintLine << MAKEFILE_FINGERPRINT_PREFIX << fingerprint << wxT(" ") << wxMD5::GetDigest(text) << wxT("\n")
+                    << wxT("##") << wxT("\n");
+    text = text.Left(fingerprintPos) + fingerprintLine + text.Mid(fingerprintPos);
+
     //dump the content to a file
+    WriteMakefile(fn, text);
+
+    MakefileState &state = m_makefiles[fn];
+    state.m_fingerprint = fingerprint;
+    state.m_modified    = wxFileModificationTime(fn);
+
+    //mark the project as non-modified one
+    proj->SetModified(false);
+}
+
+void BuilderGnuMake::CreateParallelBuildTargets(const wxArrayString &projects, const wxArrayString &recipes, bool outputSync, wxString &text)
+{
+    // One target per project, depending on the targets of the projects it depends on.
+    // The last project is the one being built, it depends on all the others.
+    // make runs the projects that don't depend on each other at the same time: the
+    // sub-makes are invoked with $(MAKE), so they all share the top level make's
+    // job slots
+    BuildMatrixPtr matrix = WorkspaceST::Get()->GetBuildMatrix();
+    wxString workspaceSelConf = matrix->GetSelectedConfigurationName();
+
+    wxArrayString targets;
+    for (size_t i=0; i<projects.GetCount(); i++) {
+        wxString target(wxT("Project_"));
+        const wxString &name = projects.Item(i);
+        for (size_t j=0; j<name.length(); j++) {
+            wxChar ch = name.GetChar(j);
+            target << (wxIsalnum(ch) || ch == wxT('_') || ch == wxT('.') ? ch : wxT('_'));
+        }
+        if (targets.Index(target) != wxNOT_FOUND) {
+            target << wxT("_") << i;
+        }
+        targets.Add(target);
+    }
+
+    text << wxT(".PHONY: clean All");
+    for (size_t i=0; i<targets.GetCount(); i++) {
+        text << wxT(" ") << targets.Item(i);
+    }
+    text << wxT("\n\n");
+
+    // With GNU make 4.0 and later, GetBuildCommand() passes -Orecurse so the output
+    // of each project is kept in one block (starting with its 'Building project'
+    // line) instead of interleaving it. Setting it from the makefile has no effect on
+    // the running make. Older versions (e.g. make 3.81) can't: the build log would
+    // mix the lines of several projects and the errors would be reported against the
+    // wrong project, so the projects are built one after the other (their files are
+    // still compiled in parallel by their own makefiles)
+    if (!outputSync) {
+        text << wxT(".NOTPARALLEL:\n\n");
+    }
+
+    size_t last = targets.GetCount() - 1;
+    text << wxT("All: ") << targets.Item(last) << wxT("\n\n");
+
+    for (size_t i=0; i<targets.GetCount(); i++) {
+        text << targets.Item(i) << wxT(":");
+        if (i == last) {
+            for (size_t j=0; j<last; j++) {
+                text << wxT(" ") << targets.Item(j);
+            }
+
+        } else {
+            wxString errMsg;
+            ProjectPtr proj = WorkspaceST::Get()->FindProjectByName(projects.Item(i), errMsg);
+            if (proj) {
+                wxString projectSelConf = matrix->GetProjectSelectedConf(workspaceSelConf, proj->GetName());
+                wxArrayString deps = proj->GetDependencies(projectSelConf);
+                for (size_t j=0; j<deps.GetCount(); j++) {
+                    // dependencies that are not part of this build were dropped by the caller
+                    int where = projects.Index(deps.Item(j));
+                    if (where != wxNOT_FOUND && (size_t)where < last && (size_t)where != i) {
+                        text << wxT(" ") << targets.Item(where);
+                    }
+                }
+            }
+        }
+        text << wxT("\n") << recipes.Item(i) << wxT("\n");
+    }
+}
+
+wxString BuilderGnuMake::GetAdditionalCompileFlags(ProjectPtr proj, BuildConfigPtr bldConf)
+{
+    // Let the plugins add their content here
+    clBuildEvent e(wxEVT_GET_ADDITIONAL_COMPILEFLAGS);
+    e.SetProjectName( proj->GetName() );
+    e.SetConfigurationName( bldConf->GetName() );
+    EventNotifier::Get()->ProcessEvent(e);
+    return e.GetCommand();
+}
+
+wxString BuilderGnuMake::ReadMakefileFingerprint(const wxString &fn)
+{
+    // The header holds the fingerprint of the inputs and the digest of the rest of
+    // the makefile. Return the fingerprint only if the content still matches the
+    // digest: a makefile modified by hand must be generated again
+    wxLogNull nolog;
+    wxFFile input(fn, wxT("rb"));
+    wxString content;
+    if (!input.IsOpened() || !input.ReadAll(&content, wxConvUTF8)) {
+        return wxEmptyString;
+    }
+
+    int where = content.Find(MAKEFILE_FINGERPRINT_PREFIX);
+    if (where == wxNOT_FOUND) {
+        return wxEmptyString;
+    }
+
+    wxString line = content.Mid(where).BeforeFirst(wxT('\n'));
+    wxString rest = content.Mid(where + line.length() + 1);
+    if (!rest.StartsWith(wxT("##\n"), &rest)) {
+        return wxEmptyString;
+    }
+
+    line.Remove(0, wxString(MAKEFILE_FINGERPRINT_PREFIX).length());
+    wxString fingerprint = line.BeforeFirst(wxT(' '));
+    wxString digest      = line.AfterFirst(wxT(' '));
+    if (digest.IsEmpty() || wxMD5::GetDigest(content.Left(where) + rest) != digest) {
+        return wxEmptyString;
+    }
+    return fingerprint;
+}
+
+wxString BuilderGnuMake::GetMakefileFingerprint(ProjectPtr proj, BuildConfigPtr bldConf, const wxArrayString &depsProj, const wxString &additionalCompileFlags)
+{
+    wxString fingerprint;
+    fingerprint << GetName()                                            << wxT("\n")
+                << WorkspaceST::Get()->GetWorkspaceFileName().GetFullPath() << wxT("\n")
+                << WorkspaceST::Get()->GetStartupDir()                  << wxT("\n")
+                << proj->GetFileName().GetFullPath()                    << wxT("\n")
+                << bldConf->GetName()                                   << wxT("\n")
+                << wxGetUserName()                                      << wxT("\n")
+                << wxDateTime::Now().FormatDate()                       << wxT("\n");
+
+    for (size_t i=0; i<depsProj.GetCount(); i++) {
+        fingerprint << depsProj.Item(i) << wxT(";");
+    }
+    fingerprint << wxT("\n");
+
+    // the project settings and the build configuration (which includes the global settings)
+    wxXmlNode *node = proj->GetSettings()->ToXml();
+    AddXmlFingerprint(fingerprint, node);
+    delete node;
+
+    node = bldConf->ToXml();
+    AddXmlFingerprint(fingerprint, node);
+    delete node;
+
+    // the compiler settings
+    CompilerPtr cmp = BuildSettingsConfigST::Get()->GetCompiler(bldConf->GetCompilerType());
+    if (cmp) {
+        node = cmp->ToXml();
+        AddXmlFingerprint(fingerprint, node);
+        delete node;
+    }
+
+    // the project files
+    Project::FileInfoVector_t filesMetadata;
+    proj->GetFilesMetadata(filesMetadata);
+    Project::FileInfoVector_t::const_iterator iterFile = filesMetadata.begin();
+    for(; iterFile != filesMetadata.end(); ++iterFile) {
+        fingerprint << iterFile->GetFilenameRelpath() << wxT(":") << iterFile->GetFlags();
+        const wxStringSet_t &excludeConfigs = iterFile->GetExcludeConfigs();
+        wxStringSet_t::const_iterator iterConf = excludeConfigs.begin();
+        for(; iterConf != excludeConfigs.end(); ++iterConf) {
+            fingerprint << wxT(":") << *iterConf;
+        }
+        fingerprint << wxT("\n");
+    }
+
+    // the environment variables, they are copied into the makefile and used to expand the macros
+    EvnVarList vars;
+    EnvironmentConfig::Instance()->ReadObject(wxT("Variables"), &vars);
+    EnvMap varMap = vars.GetVariables(wxT(""), true, proj->GetName());
+    for (size_t i=0; i<varMap.GetCount(); i++) {
+        wxString name, value;
+        varMap.Get(i, name, value);
+        fingerprint << name << wxT("=") << value << wxT("\n");
+    }
+
+    // the flags added by the plugins
+    fingerprint << additionalCompileFlags << wxT("\n");
+
+    long asterisk(0);
+    EditorConfigST::Get()->GetLongValue(wxT("CleanTragetWithAsterisk"), asterisk);
+    fingerprint << asterisk;
+
+    return wxMD5::GetDigest(fingerprint);
+}
+
+bool BuilderGnuMake::WriteMakefile(const wxString &fn, const wxString &text)
+{
+    // Leave an up-to-date makefile untouched: rewriting it would only update its
+    // timestamp
+    const wxCharBuffer content = text.mb_str(wxConvUTF8);
+    size_t len = content.data() ? strlen(content.data()) : 0;
+    {
+        wxLogNull nolog;
+        wxFFile input(fn, wxT("rb"));
+        if (input.IsOpened() && input.Length() == (wxFileOffset)len) {
+            wxCharBuffer current(len);
+            if (input.Read(current.data(), len) == len && memcmp(current.data(), content.data(), len) == 0) {
+                return false;
+            }
+        }
+    }
+
     wxFFile output;
-    output.Open(fn, wxT("w+"));
+    output.Open(fn, wxT("w+b"));
     if (output.IsOpened()) {
-        output.Write(text);
+        output.Write(content.data(), len);
         output.Close();
     }
-
-    //mark the project as non-modified one
-    proj->SetModified(false);
+    return true;
 }
 
 void BuilderGnuMake::CreateMakeDirsTarget(BuildConfigPtr bldConf, const wxString &targetName, wxString &text)
@@ -1273,7 +1568,7 @@ void BuilderGnuMake::CreatePreBuildEvents(BuildConfigPtr bldConf, wxString &text
     }
 }
 
-void BuilderGnuMake::CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf, wxString &text)
+void BuilderGnuMake::CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf, const wxString &additionalCompileFlags, wxString &text)
 {
     wxString name = bldConf->GetName();
     name = NormalizeConfigName(name);
@@ -1346,13 +1641,7 @@ void BuilderGnuMake::CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldC
     wxString asOptions = bldConf->GetAssmeblerOptions();
     asOptions.Replace(";", " ");
     
-    // Let the plugins add their content here
-    clBuildEvent e(wxEVT_GET_ADDITIONAL_COMPILEFLAGS);
-    e.SetProjectName( proj->GetName() );
-    e.SetConfigurationName(bldConf->GetName());
-    EventNotifier::Get()->ProcessEvent(e);
-
-    wxString additionalCompileFlags = e.GetCommand();
+    // The flags added by the plugins
     if(additionalCompileFlags.IsEmpty() == false) {
         buildOpts << wxT(" ") << additionalCompileFlags;
         cBuildOpts << wxT(" ") << additionalCompileFlags;
@@ -1524,9 +1813,51 @@ wxString BuilderGnuMake::GetBuildCommand(const wxString &project, const wxString
     // fix: replace all Windows like slashes to POSIX
     buildTool.Replace(wxT("\\"), wxT("/"));
     cmd << buildTool << wxT(" Makefile");
+
+    // Keep the output of the projects built in parallel grouped by project (see
+    // CreateParallelBuildTargets)
+    long parallel(0);
+    EditorConfigST::Get()->GetLongValue(wxT("BuildProjectsInParallel"), parallel);
+    if (parallel && IsOutputSyncSupported(project, confToBuild)) {
+        cmd << wxT(" -Orecurse");
+    }
     return cmd;
 }
 
+bool BuilderGnuMake::IsOutputSyncSupported(const wxString &project, const wxString &confToBuild) const
+{
+    BuildConfigPtr bldConf = WorkspaceST::Get()->GetProjBuildConf(project, confToBuild);
+    if ( !bldConf )
+        return false;
+
+    CompilerPtr compiler = bldConf->GetCompiler();
+    if ( !compiler )
+        return false;
+
+    wxString makeTool = compiler->GetTool("MAKE");
+    makeTool = EnvironmentConfig::Instance()->ExpandVariables(makeTool, true);
+
+    // --output-sync was added in GNU make 4.0. Run each make tool only once
+    static std::map<wxString, bool> s_outputSync;
+    std::map<wxString, bool>::const_iterator iter = s_outputSync.find(makeTool);
+    if ( iter != s_outputSync.end() )
+        return iter->second;
+
+    bool supported(false);
+    wxArrayString output;
+    ProcUtils::SafeExecuteCommand(makeTool + wxT(" --version"), output);
+    for (size_t i=0; i<output.GetCount(); i++) {
+        wxString version;
+        if ( output.Item(i).StartsWith(wxT("GNU Make "), &version) ) {
+            long major(0);
+            supported = version.BeforeFirst(wxT('.')).ToLong(&major) && major >= 4;
+            break;
+        }
+    }
+    s_outputSync[makeTool] = supported;
+    return supported;
+}
+
 wxString BuilderGnuMake::GetCleanCommand(const wxString &project, const wxString &confToBuild)
 {
     wxString errMsg, cmd;
@@ -30,13 +30,24 @@
 #include "codelite_exports.h"
 #include <wx/wfstream.h>
 #include <wx/txtstrm.h>
+#include <map>
 /*
  * Build using a generated (Gnu) Makefile - this is made as a traditional multistep build :
  *  sources -> (preprocess) -> compile -> link -> exec/lib.
  */
 class WXDLLIMPEXP_SDK BuilderGnuMake : public Builder
 {
-    size_t m_objectChunks;
+    // What we know about a makefile we generated: the fingerprint of the
+    // inputs it was generated from and its modification time once written
+    struct MakefileState {
+        wxString m_fingerprint;
+        time_t   m_modified;
+    };
+    typedef std::map<wxString, MakefileState> MakefileStateMap_t;
+
+    size_t             m_objectChunks;
+    MakefileStateMap_t m_makefiles;
+
 public:
     BuilderGnuMake();
     BuilderGnuMake(const wxString &name, const wxString &buildTool, const wxString &buildToolOptions);
@@ -66,7 +77,13 @@ protected:
     
 private:
     void GenerateMakefile(ProjectPtr proj, const wxString &confToBuild, bool force, const wxArrayString &depsProj);
-    void CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf, wxString &text);
+    void CreateParallelBuildTargets(const wxArrayString &projects, const wxArrayString &recipes, bool outputSync, wxString &text);
+    bool IsOutputSyncSupported(const wxString &project, const wxString &confToBuild) const;
+    wxString GetAdditionalCompileFlags(ProjectPtr proj, BuildConfigPtr bldConf);
+    wxString GetMakefileFingerprint(ProjectPtr proj, BuildConfigPtr bldConf, const wxArrayString &depsProj, const wxString &additionalCompileFlags);
+    wxString ReadMakefileFingerprint(const wxString &fn);
+    bool WriteMakefile(const wxString &fn, const wxString &text);
+    void CreateConfigsVariables(ProjectPtr proj, BuildConfigPtr bldConf, const wxString &additionalCompileFlags, wxString &text);
     void CreateMakeDirsTarget(BuildConfigPtr bldConf, const wxString &targetName, wxString &text);
     void CreateTargets(const wxString &type, BuildConfigPtr bldConf, wxString &text, const wxString &projName);
     void CreatePreBuildEvents(BuildConfigPtr bldConf, wxString &text);
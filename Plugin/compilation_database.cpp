@@ -9,6 +9,8 @@
 #include "json_node.h"
 #include "project.h"
 #include <wx/dir.h>
+#include "globals.h"
+#include <map>
 
 const wxString DB_VERSION = "2.0";
 
@@ -130,14 +132,17 @@ void CompilationDatabase::Initialize()
     wxFileName clCustomCompileFile = GetFileName();
     clCustomCompileFile.SetExt("db.txt");
     
-    if ( cmakeCompilationDb.Exists() && !clCustomCompileFile.Exists() ) {
+    wxArrayString clCompileFiles;
+    GetCodeLiteCompilationFiles( clCustomCompileFile, clCompileFiles );
+    
+    if ( cmakeCompilationDb.Exists() && clCompileFiles.IsEmpty() ) {
         ProcessCMakeCompilationDatabase( cmakeCompilationDb );
         
     } else if ( cmakeCompilationDb.Exists() && clCustomCompileFile.Exists() && cmakeCompilationDb.GetModificationTime().GetTicks() > clCustomCompileFile.GetModificationTime().GetTicks() ) {
         // both cmake and our file exists, however, the cmake compilation database is newer - use it instead of ours
         ProcessCMakeCompilationDatabase( cmakeCompilationDb );
 
-    } else if ( clCustomCompileFile.Exists() ) {
+    } else if ( !clCompileFiles.IsEmpty() ) {
         // Our file is newer - use it instead
         ProcessCodeLiteCompilationDatabase( clCustomCompileFile );
 
@@ -308,51 +313,92 @@ void CompilationDatabase::ProcessCMakeCompilationDatabase(const wxFileName& comp
     }
 }
 
-void CompilationDatabase::ProcessCodeLiteCompilationDatabase(const wxFileName& compile_file)
+void CompilationDatabase::GetCodeLiteCompilationFiles(const wxFileName& compile_file, wxArrayString& files) const
 {
-    wxFFile fp(compile_file.GetFullPath(), wxT("rb"));
-    if( fp.IsOpened() ) {
-        wxString content;
-        fp.ReadAll(&content, wxConvUTF8);
+    files.Clear();
+    if ( compile_file.Exists() ) {
+        files.Add( compile_file.GetFullPath() );
+    }
 
-        if( content.IsEmpty() )
-            return;
+    // Per-process shards (and the leftovers of an interrupted merge)
+    wxDir dir;
+    if ( compile_file.DirExists() && dir.Open( compile_file.GetPath() ) ) {
+        wxString shard;
+        bool cont = dir.GetFirst(&shard, compile_file.GetFullName() + ".*", wxDIR_FILES);
+        while ( cont ) {
+            files.Add( wxFileName(compile_file.GetPath(), shard).GetFullPath() );
+            cont = dir.GetNext(&shard);
+        }
+    }
+}
 
+void CompilationDatabase::ProcessCodeLiteCompilationDatabase(const wxFileName& compile_file)
+{
+    wxLogNull nl;
 
-        wxArrayString lines = ::wxStringTokenize(content, "\n\r", wxTOKEN_STRTOK);
-        try {
+    // Only the files renamed by this call are read and deleted
+    wxArrayString files;
+    ::ClaimCodeLiteLogFiles( compile_file, files );
 
-            wxString sql;
-            sql = wxT("REPLACE INTO COMPILATION_TABLE (FILE_NAME, FILE_PATH, CWD, COMPILE_FLAGS) VALUES(?, ?, ?, ?)");
-            wxSQLite3Statement st = m_db->PrepareStatement(sql);
+    // Merge all the records, the same file is usually compiled more than once
+    // (e.g. by several configurations), the last record wins
+    typedef std::map<wxString, std::pair<wxString, wxString> > Records_t;
+    Records_t records;
+    for(size_t n=0; n<files.GetCount(); ++n) {
+        wxFFile fp(files.Item(n), wxT("rb"));
+        if( !fp.IsOpened() )
+            continue;
 
-            m_db->ExecuteUpdate("BEGIN");
-            for(size_t i=0; i<lines.GetCount(); ++i) {
-                wxArrayString parts = ::wxStringTokenize(lines.Item(i), wxT("|"), wxTOKEN_STRTOK);
-                if( parts.GetCount() != 3 )
-                    continue;
+        wxString content;
+        fp.ReadAll(&content, wxConvUTF8);
+        fp.Close();
+        ::wxRemoveFile( files.Item(n) );
 
-                wxString file_name = wxFileName(parts.Item(0).Trim().Trim(false)).GetFullPath();
-                wxString path      = wxFileName(file_name).GetPath();
-                wxString cwd       = parts.Item(1).Trim().Trim(false);
-                wxString cmp_flags = parts.Item(2).Trim().Trim(false);;
+        wxArrayString lines = ::wxStringTokenize(content, "\n\r", wxTOKEN_STRTOK);
+        for(size_t i=0; i<lines.GetCount(); ++i) {
+            wxArrayString parts = ::wxStringTokenize(lines.Item(i), wxT("|"), wxTOKEN_STRTOK);
+            if( parts.GetCount() != 3 )
+                continue;
+
+            wxString file_name = wxFileName(parts.Item(0).Trim().Trim(false)).GetFullPath();
+            wxString cwd       = parts.Item(1).Trim().Trim(false);
+            wxString cmp_flags = parts.Item(2).Trim().Trim(false);
+            records[file_name] = std::make_pair(cwd, cmp_flags);
+        }
+    }
 
-                st.Bind(1, file_name);
-                st.Bind(2, path);
-                st.Bind(3, cwd);
-                st.Bind(4, cmp_flags);
+    if ( records.empty() )
+        return;
 
-                st.ExecuteUpdate();
-            }
-            m_db->ExecuteUpdate("COMMIT");
+    try {
 
-        } catch (wxSQLite3Exception &e) {
-            wxUnusedVar(e);
-        }
+        wxSQLite3Statement stSelect = m_db->PrepareStatement("SELECT CWD, COMPILE_FLAGS FROM COMPILATION_TABLE WHERE FILE_NAME=?");
+        wxSQLite3Statement st       = m_db->PrepareStatement("REPLACE INTO COMPILATION_TABLE (FILE_NAME, FILE_PATH, CWD, COMPILE_FLAGS) VALUES(?, ?, ?, ?)");
 
-        wxLogNull nl;
-        fp.Close();
-        ::wxRemoveFile( compile_file.GetFullPath() );
+        m_db->ExecuteUpdate("BEGIN");
+        Records_t::const_iterator iter = records.begin();
+        for(; iter != records.end(); ++iter) {
+            const wxString& file_name = iter->first;
+            const wxString& cwd       = iter->second.first;
+            const wxString& cmp_flags = iter->second.second;
+
+            // Only write the records that actually changed
+            stSelect.Bind(1, file_name);
+            wxSQLite3ResultSet rs = stSelect.ExecuteQuery();
+            bool unchanged = rs.NextRow() && rs.GetString(0) == cwd && rs.GetString(1) == cmp_flags;
+            stSelect.Reset();
+            if ( unchanged )
+                continue;
+
+            st.Bind(1, file_name);
+            st.Bind(2, wxFileName(file_name).GetPath());
+            st.Bind(3, cwd);
+            st.Bind(4, cmp_flags);
+            st.ExecuteUpdate();
+        }
+        m_db->ExecuteUpdate("COMMIT");
 
+    } catch (wxSQLite3Exception &e) {
+        wxUnusedVar(e);
     }
 }
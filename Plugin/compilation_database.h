@@ -47,9 +47,17 @@ protected:
     
     /**
      * @brief process a codelite standard compilation file
+     * codelitegcc appends its records to 'compile_file', oversized records are written
+     * to per-process shards named 'compile_file.PID'. All of them are merged into the database
+     * and deleted
      */
     void ProcessCodeLiteCompilationDatabase( const wxFileName &compile_file );
     
+    /**
+     * @brief return the list of codelite compilation files waiting to be merged into the database
+     */
+    void GetCodeLiteCompilationFiles( const wxFileName &compile_file, wxArrayString &files ) const;
+    
 public:
     CompilationDatabase();
     CompilationDatabase(const wxString &filename);
@@ -67,6 +67,7 @@
 #include <wx/graphics.h>
 #include <wx/dcmemory.h>
 #include <wx/richmsgdlg.h>
+#include "macromanager.h"
 
 #ifdef __WXMSW__
 #include <Uxtheme.h>
@@ -269,27 +270,6 @@ static bool ReadBOMFile(const char *file_name, wxString &content, BOM& bom)
     return content.IsEmpty() == false;
 }
 
-static bool ReadFile8BitData(const char *file_name, wxString &content)
-{
-    content.Empty();
-
-    FILE *fp = fopen(file_name, "rb");
-    if ( fp ) {
-        struct stat buff;
-        if ( stat(file_name, &buff) == 0 ) {
-            size_t size = buff.st_size;
-            char *buffer = new char[size+1];
-            if ( fread(buffer, sizeof(char), size, fp) == size ) {
-                buffer[size] = 0;
-                content = wxString::From8BitData(buffer);
-            }
-            delete [] buffer;
-        }
-        fclose(fp);
-    }
-    return content.IsEmpty() == false;
-}
-
 bool SendCmdEvent(int eventId, void *clientData)
 {
     return EventNotifier::Get()->SendCommandEvent(eventId, clientData);
@@ -330,37 +310,129 @@ bool ReadFileWithConversion(const wxString &fileName, wxString &content, wxFontE
 {
     wxLogNull noLog;
     content.Clear();
+
+    // The file is read once and every conversion below decodes it from memory.
+    // It is not mapped: this is also called from worker threads (e.g. Find in Files)
+    // and a file truncated while mapped (by a build, a checkout...) raises SIGBUS
     wxFFile file(fileName, wxT("rb"));
+    if (!file.IsOpened()) {
+        return false;
+    }
 
+    // If we got a BOM pointer, test to see whether the file is BOM file
     const wxCharBuffer name = _C(fileName);
-    if (file.IsOpened()) {
+    if(bom && IsBOMFile(name.data())) {
+        return ReadBOMFile(name.data(), content, *bom);
+    }
+
+    wxFileOffset fileLen = file.Length();
+    if (fileLen <= 0) {
+        return false;
+    }
+
+    wxMemoryBuffer buffer;
+    size_t len = file.Read(buffer.GetWriteBuf(fileLen), fileLen);
+    buffer.UngetWriteBuf(len);
+    file.Close();
+
+    const char* data = (const char*)buffer.GetData();
+
+    if (encoding == wxFONTENCODING_DEFAULT)
+        encoding = EditorConfigST::Get()->GetOptions()->GetFileFontEncoding();
+
+    // first try the user defined encoding (except for UTF8: the UTF8 builtin appears to be faster)
+    if (encoding != wxFONTENCODING_UTF8) {
+        wxCSConv fontEncConv(encoding);
+        if (fontEncConv.IsOk()) {
+            content = wxString(data, fontEncConv, len);
+        }
+    }
 
-        // If we got a BOM pointer, test to see whether the file is BOM file
-        if(bom && IsBOMFile(name.data())) {
-            return ReadBOMFile(name.data(), content, *bom);
+    if (content.IsEmpty()) {
+        // now try the Utf8. Validating the buffer is much cheaper than a failed conversion
+        if (IsValidUTF8(data, len)) {
+            content = wxString(data, wxConvUTF8, len);
+        }
+
+        if (content.IsEmpty()) {
+            // try local 8 bit data (up to the first NULL, like the C string it used to be read into)
+            content = wxString::From8BitData(data, std::find(data, data + len, '\0') - data);
         }
+    }
+    return !content.IsEmpty();
+}
 
-        if (encoding == wxFONTENCODING_DEFAULT)
-            encoding = EditorConfigST::Get()->GetOptions()->GetFileFontEncoding();
+bool IsValidUTF8(const char *data, size_t len, bool *isAscii)
+{
+    const unsigned char* p   = (const unsigned char*)data;
+    const unsigned char* end = p + len;
+    bool ascii = true;
 
-        // first try the user defined encoding (except for UTF8: the UTF8 builtin appears to be faster)
-        if (encoding != wxFONTENCODING_UTF8) {
-            wxCSConv fontEncConv(encoding);
-            if (fontEncConv.IsOk()) {
-                file.ReadAll(&content, fontEncConv);
+    if (isAscii) {
+        *isAscii = false;
+    }
+
+    while (p < end) {
+        // Most source files are (almost) all ASCII: test 8 bytes at a time
+        if ((size_t)(end - p) >= sizeof(wxUint64)) {
+            wxUint64 word;
+            memcpy(&word, p, sizeof(word));
+            if ((word & wxULL(0x8080808080808080)) == 0) {
+                p += sizeof(word);
+                continue;
             }
         }
 
-        if (content.IsEmpty()) {
-            // now try the Utf8
-            file.ReadAll(&content, wxConvUTF8);
-            if (content.IsEmpty()) {
-                // try local 8 bit data
-                ReadFile8BitData(name.data(), content);
+        unsigned char ch = *p;
+        if (ch < 0x80) {
+            ++p;
+            continue;
+        }
+        ascii = false;
+
+        // The number of continuation bytes and the valid range of the first one
+        // (see the table of well-formed byte sequences in the Unicode standard)
+        size_t        count = 0;
+        unsigned char lo    = 0x80;
+        unsigned char hi    = 0xBF;
+        if (ch >= 0xC2 && ch <= 0xDF) {
+            count = 1;
+        } else if (ch == 0xE0) {
+            count = 2;
+            lo    = 0xA0;
+        } else if (ch == 0xED) {
+            count = 2;
+            hi    = 0x9F;
+        } else if (ch >= 0xE1 && ch <= 0xEF) {
+            count = 2;
+        } else if (ch == 0xF0) {
+            count = 3;
+            lo    = 0x90;
+        } else if (ch == 0xF4) {
+            count = 3;
+            hi    = 0x8F;
+        } else if (ch >= 0xF1 && ch <= 0xF3) {
+            count = 3;
+        } else {
+            return false;
+        }
+
+        if ((size_t)(end - p) <= count || p[1] < lo || p[1] > hi) {
+            return false;
+        }
+
+        for (size_t i = 2; i <= count; ++i) {
+            if ((p[i] & 0xC0) != 0x80) {
+                return false;
             }
         }
+        p += count + 1;
     }
-    return !content.IsEmpty();
+
+    if (isAscii) {
+        *isAscii = ascii;
+    }
+    return true;
 }
 
 bool RemoveDirectory(const wxString &path)
@@ -481,71 +553,9 @@ wxString ExpandAllVariables(const wxString &expression, Workspace *workspace, co
 
 wxString DoExpandAllVariables(const wxString &expression, Workspace *workspace, const wxString &projectName, const wxString &confToBuild, const wxString &fileName)
 {
-    wxString errMsg;
     wxString output(expression);
     DollarEscaper de(output);
-    if ( workspace ) {
-        output.Replace(wxT("$(WorkspaceName)"), workspace->GetName());
-        ProjectPtr proj = workspace->FindProjectByName(projectName, errMsg);
-        if (proj) {
-            wxString project_name(proj->GetName());
-
-            //make sure that the project name does not contain any spaces
-            project_name.Replace(wxT(" "), wxT("_"));
-
-            BuildConfigPtr bldConf = workspace->GetProjBuildConf(proj->GetName(), confToBuild);
-            output.Replace(wxT("$(ProjectPath)"),   proj->GetFileName().GetPath(wxPATH_GET_VOLUME|wxPATH_GET_SEPARATOR));
-            output.Replace(wxT("$(WorkspacePath)"), workspace->GetWorkspaceFileName().GetPath(wxPATH_GET_VOLUME|wxPATH_GET_SEPARATOR));
-            output.Replace(wxT("$(ProjectName)"),   project_name);
-
-            if (bldConf) {
-                output.Replace(wxT("$(ConfigurationName)"), bldConf->GetName());
-
-                // the IntermediateDirectory variable is special, since it can contains
-                // other variables in it.
-                wxString id(bldConf->GetIntermediateDirectory());
-
-                // Substitute all macros from $(IntermediateDirectory)
-                id.Replace(wxT("$(ProjectPath)"),       proj->GetFileName().GetPath(wxPATH_GET_VOLUME|wxPATH_GET_SEPARATOR));
-                id.Replace(wxT("$(WorkspacePath)"),     workspace->GetWorkspaceFileName().GetPath(wxPATH_GET_VOLUME|wxPATH_GET_SEPARATOR));
-                id.Replace(wxT("$(ProjectName)"),       project_name);
-                id.Replace(wxT("$(ConfigurationName)"), bldConf->GetName());
-
-                output.Replace(wxT("$(IntermediateDirectory)"), id);
-                output.Replace(wxT("$(OutDir)"),                id);
-            }
-
-            if(output.Find(wxT("$(ProjectFiles)")) != wxNOT_FOUND)
-                output.Replace(wxT("$(ProjectFiles)"),   proj->GetFiles());
-
-            if(output.Find(wxT("$(ProjectFilesAbs)")) != wxNOT_FOUND)
-                output.Replace(wxT("$(ProjectFilesAbs)"),proj->GetFiles(true));
-        }
-    }
-
-    if (fileName.IsEmpty() == false) {
-        wxFileName fn(fileName);
-
-        output.Replace(wxT("$(CurrentFileName)"), fn.GetName());
-
-        wxString fpath(fn.GetPath());
-        fpath.Replace(wxT("\\"), wxT("/"));
-        output.Replace(wxT("$(CurrentFilePath)"), fpath);
-        output.Replace(wxT("$(CurrentFileExt)"), fn.GetExt());
-
-        wxString ffullpath(fn.GetFullPath());
-        ffullpath.Replace(wxT("\\"), wxT("/"));
-        output.Replace(wxT("$(CurrentFileFullPath)"), ffullpath);
-    }
-
-    //exapnd common macros
-    wxDateTime now = wxDateTime::Now();
-    output.Replace(wxT("$(User)"), wxGetUserName());
-    output.Replace(wxT("$(Date)"), now.FormatDate());
-
-    if (workspace) {
-        output.Replace(wxT("$(CodeLitePath)"), workspace->GetStartupDir());
-    }
+    output = MacroManager::Instance()->ExpandWorkspaceMacros(output, workspace, projectName, confToBuild, fileName);
 
     //call the environment & workspace variables expand function
     output = EnvironmentConfig::Instance()->ExpandVariables(output, true);
@@ -1660,3 +1670,50 @@ wxStandardID PromptForYesNoDialogWithCheckbox(const wxString& message,
     }
     return static_cast<wxStandardID>(res);
 }
+
+static wxCriticalSection s_claimLock;
+static unsigned long     s_claimCounter = 0;
+
+void ClaimCodeLiteLogFiles(const wxFileName& logFile, wxArrayString& claimed)
+{
+    wxLogNull nl;
+    claimed.Clear();
+
+    wxArrayString candidates;
+    if ( logFile.Exists() ) {
+        candidates.Add( logFile.GetFullPath() );
+    }
+
+    // The per-process shards and the leftovers of an interrupted merge. A merge in
+    // progress (e.g. in another instance) renamed its files a moment ago: leave them
+    wxDir dir;
+    if ( logFile.DirExists() && dir.Open( logFile.GetPath() ) ) {
+        wxString mergePrefix = logFile.GetFullName() + wxT(".merge.");
+        time_t   now         = time(NULL);
+        wxString name;
+        bool cont = dir.GetFirst(&name, logFile.GetFullName() + wxT(".*"), wxDIR_FILES);
+        while ( cont ) {
+            wxFileName fn(logFile.GetPath(), name);
+            if ( !name.StartsWith(mergePrefix) || now - fn.GetModificationTime().GetTicks() > 60 ) {
+                candidates.Add( fn.GetFullPath() );
+            }
+            cont = dir.GetNext(&name);
+        }
+    }
+
+    // Renaming is atomic: a file is read by the one who renamed it, and a compiler that is
+    // still running starts a new log file instead of appending to a file about to be deleted
+    for(size_t i=0; i<candidates.GetCount(); ++i) {
+        unsigned long counter;
+        {
+            wxCriticalSectionLocker locker(s_claimLock);
+            counter = ++s_claimCounter;
+        }
+
+        wxString target;
+        target << logFile.GetFullPath() << wxT(".merge.") << (unsigned long)::wxGetProcessId() << wxT(".") << counter;
+        if ( ::wxRenameFile(candidates.Item(i), target, false) ) {
+            claimed.Add( target );
+        }
+    }
+}
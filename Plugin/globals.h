@@ -126,6 +126,16 @@ WXDLLIMPEXP_SDK long AppendListCtrlRow(wxListCtrl *list);
  */
 WXDLLIMPEXP_SDK bool ReadFileWithConversion(const wxString &fileName, wxString &content, wxFontEncoding encoding = wxFONTENCODING_DEFAULT, BOM *bom = NULL);
 
+/**
+ * \brief check whether a buffer holds valid UTF-8 (overlong forms, surrogates and
+ * code points above U+10FFFF are rejected)
+ * \param data the buffer, it does not need to be NULL terminated
+ * \param len the buffer length in bytes
+ * \param isAscii if not NULL, set to true if the buffer holds 7 bit characters only
+ * \return true if the buffer is valid UTF-8
+ */
+WXDLLIMPEXP_SDK bool IsValidUTF8(const char *data, size_t len, bool *isAscii = NULL);
+
 /**
  * \brief write file using UTF8 converter
  * \param fileName file path
@@ -415,4 +425,12 @@ WXDLLIMPEXP_SDK  wxStandardID PromptForYesNoDialogWithCheckbox( const wxString &
                                                                 long style = wxYES_NO|wxICON_QUESTION|wxYES_DEFAULT, 
                                                                 bool checkboxInitialValue = false);
 
+/**
+ * @brief take the log files written by codelitegcc: 'logFile', the per-process shards
+ * 'logFile.PID' and the leftovers of an interrupted merge are renamed to names unique
+ * to this call
+ * @param claimed [output] the renamed files, the caller reads and deletes them
+ */
+WXDLLIMPEXP_SDK void ClaimCodeLiteLogFiles(const wxFileName& logFile, wxArrayString& claimed);
+
 #endif //GLOBALS_H
@@ -29,6 +29,8 @@ const wxEventType wxEVT_CMD_JOB_STATUS_VOID_PTR = wxNewEventType();
 
 Job::Job(wxEvtHandler* parent)
 		: m_parent(parent)
+		, m_priority(kPriorityNormal)
+		, m_cancelled(false)
 {
 }
 
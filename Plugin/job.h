@@ -26,6 +26,7 @@
 #define __job__
 
 #include <wx/event.h>
+#include <wx/thread.h>
 #include "codelite_exports.h"
 
 extern WXDLLIMPEXP_SDK const wxEventType wxEVT_CMD_JOB_STATUS;
@@ -41,8 +42,19 @@ extern WXDLLIMPEXP_SDK const wxEventType wxEVT_CMD_JOB_STATUS_VOID_PTR;
  */
 class WXDLLIMPEXP_SDK Job
 {
+public:
+	enum ePriority {
+		kPriorityHigh = 0,
+		kPriorityNormal,
+		kPriorityLow
+	};
+
 protected:
-	wxEvtHandler *m_parent;
+	wxEvtHandler *            m_parent;
+	int                       m_priority;
+	wxString                  m_coalescingKey;
+	bool                      m_cancelled;     // protected by m_cancelledLock
+	mutable wxCriticalSection m_cancelledLock; // Cancel() is called from other threads
 	
 public:
 	/**
@@ -52,6 +64,40 @@ public:
 	Job(wxEvtHandler *parent = NULL);
 	virtual ~Job();
 
+	/**
+	 * @brief jobs with a higher priority are processed first
+	 */
+	void SetPriority(int priority) {
+		this->m_priority = priority;
+	}
+	int GetPriority() const {
+		return m_priority;
+	}
+
+	/**
+	 * @brief "latest wins" key. Pushing a job with a non empty key drops the jobs with the
+	 * same key that did not start yet and cancels the ones being processed
+	 */
+	void SetCoalescingKey(const wxString &key) {
+		this->m_coalescingKey = key;
+	}
+	const wxString& GetCoalescingKey() const {
+		return m_coalescingKey;
+	}
+
+	/**
+	 * @brief return true if the job was superseded by a newer job with the same key.
+	 * Long running jobs should test it (like thread->TestDestroy()) and return early
+	 */
+	bool IsCancelled() const {
+		wxCriticalSectionLocker locker(m_cancelledLock);
+		return m_cancelled;
+	}
+	void Cancel() {
+		wxCriticalSectionLocker locker(m_cancelledLock);
+		m_cancelled = true;
+	}
+
 public:
 	/**
 	 * @brief post string and int values to parent in a form of wxCommandEvent of type wxEVT_CMD_JOB_STATUS. the string can be accessed by using event.GetString() and the int
@@ -25,10 +25,11 @@
  #include "jobqueue.h"
 #include "job.h"
 
-JobQueueWorker::JobQueueWorker(wxCriticalSection *cs, std::deque<Job*> *queue)
+JobQueueWorker::JobQueueWorker(JobQueue *queue)
 		: wxThread(wxTHREAD_JOINABLE)
-		, m_cs(cs)
 		, m_queue(queue)
+		, m_currentJob(NULL)
+		, m_stopRequested(false)
 {
 }
 
@@ -37,6 +38,13 @@ JobQueueWorker::~JobQueueWorker()
 }
 void JobQueueWorker::Stop()
 {
+	{
+		// Wake up the thread if it is waiting for jobs
+		wxMutexLocker locker(m_queue->m_mutex);
+		m_stopRequested = true;
+		m_queue->m_cond.Broadcast();
+	}
+	
 #if wxVERSION_NUMBER < 2904
     if(IsAlive()) {
         Delete();
@@ -64,35 +72,57 @@ void JobQueueWorker::Start(int priority)
 
 Job *JobQueueWorker::GetJob()
 {
-	wxCriticalSectionLocker locker(*m_cs);
+	wxMutexLocker locker(m_queue->m_mutex);
 	Job *req(NULL);
-	if ( !m_queue->empty() ) {
-		req = m_queue->front();
-		m_queue->pop_front();
+	if ( !m_queue->m_queue.empty() ) {
+		req = m_queue->m_queue.front();
+		m_queue->m_queue.pop_front();
+	}
+	m_currentJob = req;
+	return req;
+}
+
+Job *JobQueueWorker::WaitForJob()
+{
+	wxMutexLocker locker(m_queue->m_mutex);
+	while ( !m_stopRequested && m_queue->m_queue.empty() ) {
+		m_queue->m_cond.Wait();
+	}
+	
+	if ( m_stopRequested ) {
+		return NULL;
 	}
+	
+	Job *req = m_queue->m_queue.front();
+	m_queue->m_queue.pop_front();
+	m_currentJob = req;
 	return req;
 }
 
 void* JobQueueWorker::Entry()
 {
 	while ( true ) {
+		Job *job = WaitForJob();
+		
 		// Did we get a request to terminate?
-		if (TestDestroy())
+		if ( !job || TestDestroy() ) {
+			if ( job ) {
+				wxMutexLocker locker(m_queue->m_mutex);
+				m_currentJob = NULL;
+				delete job;
+			}
 			break;
-
-		Job *job = GetJob();
-		if ( job ) {
-			// Call user's implementation for processing request
-			ProcessJob( job );
-
-			wxThread::Sleep(10);  // Allow other threads to work as well
-			delete job;
-			job = NULL;
-			continue; // to avoid the sleep
 		}
-
-		// Sleep for 200ms , and then try again
-		wxThread::Sleep(200);
+		
+		// Call user's implementation for processing request
+		ProcessJob( job );
+		
+		{
+			wxMutexLocker locker(m_queue->m_mutex);
+			m_currentJob = NULL;
+		}
+		delete job;
+		job = NULL;
 	}
 	return NULL;
 }
@@ -109,6 +139,7 @@ void JobQueueWorker::ProcessJob(Job *job)
 //--------------------------------------------------------------
 
 JobQueue::JobQueue()
+	: m_cond(m_mutex)
 {
 }
 
@@ -125,8 +156,46 @@ JobQueue::~JobQueue()
 
 void JobQueue::PushJob(Job *job)
 {
-	wxCriticalSectionLocker locker(m_cs);
-	m_queue.push_front(job);
+	wxMutexLocker locker(m_mutex);
+	if ( !job->GetCoalescingKey().IsEmpty() ) {
+		// latest wins
+		DoCancel( job->GetCoalescingKey() );
+	}
+	
+	// Newer jobs are processed first, but never before a job with a higher priority
+	std::deque<Job*>::iterator iter = m_queue.begin();
+	while ( iter != m_queue.end() && (*iter)->GetPriority() < job->GetPriority() ) {
+		++iter;
+	}
+	m_queue.insert(iter, job);
+	m_cond.Signal();
+}
+
+void JobQueue::Cancel(const wxString& key)
+{
+	wxMutexLocker locker(m_mutex);
+	DoCancel( key );
+}
+
+void JobQueue::DoCancel(const wxString& key)
+{
+	std::deque<Job*>::iterator iter = m_queue.begin();
+	while ( iter != m_queue.end() ) {
+		if ( (*iter)->GetCoalescingKey() == key ) {
+			delete (*iter);
+			iter = m_queue.erase(iter);
+			
+		} else {
+			++iter;
+		}
+	}
+	
+	for (size_t i=0; i<m_threads.size(); i++) {
+		Job *job = m_threads.at(i)->m_currentJob;
+		if ( job && job->GetCoalescingKey() == key ) {
+			job->Cancel();
+		}
+	}
 }
 
 void JobQueue::Start(size_t poolSize, int priority)
@@ -134,23 +203,31 @@ void JobQueue::Start(size_t poolSize, int priority)
 	size_t maxPoolSize = poolSize > 250 ? 250 : poolSize;
 	for(size_t i=0; i<maxPoolSize; i++) {
 		//create new thread
-		JobQueueWorker *worker = new JobQueueWorker(&m_cs, &m_queue);
+		JobQueueWorker *worker = new JobQueueWorker(this);
 		worker->Start(priority);
-		m_threads.push_back(worker);
+		{
+			wxMutexLocker locker(m_mutex);
+			m_threads.push_back(worker);
+		}
 	}
 }
 
 void JobQueue::Stop()
 {
 	//first loop and stop all running threads
-	for(size_t i=0; i<m_threads.size(); i++){
-		JobQueueWorker *worker = m_threads.at(i);
+	std::vector<JobQueueWorker*> threads;
+	{
+		wxMutexLocker locker(m_mutex);
+		threads.swap(m_threads);
+	}
+	
+	for(size_t i=0; i<threads.size(); i++){
+		JobQueueWorker *worker = threads.at(i);
 		//stop it
 		worker->Stop();
 		//delete it
 		delete worker;
 	}
-	m_threads.clear();
 }
 
 //-----------------------------------------------------
@@ -26,11 +26,13 @@
 #define __jobqueue__
 
 #include <wx/thread.h>
+#include <wx/string.h>
 #include <deque>
 #include <vector>
 #include "codelite_exports.h"
 
 class Job;
+class JobQueue;
 
 /**
  * @class JobQueueWorker
@@ -42,12 +44,15 @@ class Job;
  */
 class WXDLLIMPEXP_SDK JobQueueWorker : public wxThread
 {
-	wxCriticalSection *m_cs;
-	std::deque<Job*> *m_queue;
+	friend class JobQueue;
+	
+	JobQueue *m_queue;
+	Job      *m_currentJob;    // protected by the queue mutex
+	bool      m_stopRequested; // protected by the queue mutex
 	
 public:
 	/// default ctor/dtor
-	JobQueueWorker(wxCriticalSection *cs, std::deque<Job*> *queue);
+	JobQueueWorker(JobQueue *queue);
 	virtual ~JobQueueWorker();
 
 private:
@@ -80,6 +85,12 @@ public:
 	 */
 	Job *GetJob();
 	
+	/**
+	 * @brief wait until there is a job to process or the thread is stopped
+	 * @return job to process or NULL if the thread was stopped
+	 */
+	Job *WaitForJob();
+	
 	/**
 	 * @brief the main code that processes the job
 	 * @param job job to process
@@ -114,21 +125,41 @@ public:
  */ 
 class JobQueue 
 {
-	wxCriticalSection m_cs;
+	friend class JobQueueWorker;
+	
+	// m_mutex protects the queue and the workers state, the workers sleep on
+	// m_cond until a job is pushed
+	wxMutex m_mutex;
+	wxCondition m_cond;
 	std::deque<Job*> m_queue;
 	std::vector<JobQueueWorker*> m_threads;
-		
+	
+protected:
+	/**
+	 * @brief drop the pending jobs with the given key and cancel the running ones.
+	 * Must be called with m_mutex locked
+	 */
+	void DoCancel(const wxString &key);
+	
 public:
 	JobQueue();
 	virtual ~JobQueue();
 
 	/**
 	 * @brief add job to the queue. all jobs must be constructed on the heap.
-	 * note that the job will be freed when processing is done by the job queue 
+	 * note that the job will be freed when processing is done by the job queue.
+	 * Jobs with a higher priority (see Job::SetPriority()) are processed first and
+	 * a job with a coalescing key supersedes the older jobs with the same key
 	 * @param job job to process allocated on the heap
 	 */
 	virtual void PushJob(Job *job);
 	
+	/**
+	 * @brief cancel the jobs with the given coalescing key: the pending jobs are removed
+	 * and the running ones are flagged as cancelled (see Job::IsCancelled())
+	 */
+	virtual void Cancel(const wxString &key);
+	
 	/**
 	 * @brief 
 	 * @param poolSize
@@ -5,13 +5,412 @@
 #include "workspace.h"
 #include "imanager.h"
 #include <wx/regex.h>
+#include <wx/datetime.h>
+#include <wx/utils.h>
+#include <wx/thread.h>
+
+namespace
+{
+
+// The macros expanded by MacroManager
+enum eMacro {
+    kWorkspaceName = 0,
+    kProjectOutputFile,
+    kProjectWorkingDirectory,
+    kProjectRunWorkingDirectory,
+    kProjectPath,
+    kWorkspacePath,
+    kProjectName,
+    kIntermediateDirectory,
+    kConfigurationName,
+    kOutDir,
+    kProjectFiles,
+    kProjectFilesAbs,
+    kCurrentFileName,
+    kCurrentFilePath,
+    kCurrentFileExt,
+    kCurrentFileFullPath,
+    kCurrentSelection,
+    kCurrentSelectionRange,
+    kUser,
+    kDate,
+    kCodeLitePath,
+    kMacroCount
+};
+
+// The macros up to (and including) this one only depend on the workspace,
+// the project and the configuration, their values can be cached
+#define LAST_PROJECT_MACRO kProjectFilesAbs
+
+const wxChar* s_macroNames[kMacroCount] = {
+    wxT("WorkspaceName"),
+    wxT("ProjectOutputFile"),
+    wxT("ProjectWorkingDirectory"),
+    wxT("ProjectRunWorkingDirectory"),
+    wxT("ProjectPath"),
+    wxT("WorkspacePath"),
+    wxT("ProjectName"),
+    wxT("IntermediateDirectory"),
+    wxT("ConfigurationName"),
+    wxT("OutDir"),
+    wxT("ProjectFiles"),
+    wxT("ProjectFilesAbs"),
+    wxT("CurrentFileName"),
+    wxT("CurrentFilePath"),
+    wxT("CurrentFileExt"),
+    wxT("CurrentFileFullPath"),
+    wxT("CurrentSelection"),
+    wxT("CurrentSelectionRange"),
+    wxT("User"),
+    wxT("Date"),
+    wxT("CodeLitePath")
+};
+
+enum eMode {
+    kModeExpand = 0,   // MacroManager::Expand()
+    kModeWorkspace     // MacroManager::ExpandWorkspaceMacros()
+};
+
+// The macros were once expanded by a wxString::Replace() call each, in the orders
+// below. The value of a macro may contain other macros (e.g. $(ProjectOutputFile) is
+// usually "$(IntermediateDirectory)/$(ProjectName)"): only the macros that come after
+// it are expanded in the value, exactly like the Replace() calls did
+const int s_expandOrder[] = {
+    kWorkspaceName, kProjectOutputFile, kProjectWorkingDirectory, kProjectRunWorkingDirectory,
+    kProjectPath, kWorkspacePath, kProjectName, kIntermediateDirectory, kConfigurationName, kOutDir,
+    kProjectFiles, kProjectFilesAbs, kCurrentFileName, kCurrentFilePath, kCurrentFileExt,
+    kCurrentFileFullPath, kCurrentSelection, kCurrentSelectionRange, kUser, kDate, kCodeLitePath
+};
+
+const int s_workspaceOrder[] = {
+    kWorkspaceName, kProjectPath, kWorkspacePath, kProjectName, kConfigurationName,
+    kIntermediateDirectory, kOutDir, kProjectFiles, kProjectFilesAbs, kCurrentFileName,
+    kCurrentFilePath, kCurrentFileExt, kCurrentFileFullPath, kUser, kDate, kCodeLitePath
+};
+
+// Return the position of 'macro' in the expansion order of 'mode', wxNOT_FOUND
+// if the macro is not expanded in this mode
+int GetMacroRank(int mode, int macro)
+{
+    const int* order = (mode == kModeExpand) ? s_expandOrder : s_workspaceOrder;
+    size_t count     = (mode == kModeExpand) ? sizeof(s_expandOrder) / sizeof(int) : sizeof(s_workspaceOrder) / sizeof(int);
+    for(size_t i=0; i<count; ++i) {
+        if ( order[i] == macro ) {
+            return (int)i;
+        }
+    }
+    return wxNOT_FOUND;
+}
+
+inline bool IsMacroNameChar(wxChar ch)
+{
+    return (ch >= wxT('a') && ch <= wxT('z')) || (ch >= wxT('A') && ch <= wxT('Z')) || (ch >= wxT('0') && ch <= wxT('9')) || ch == wxT('_');
+}
+
+}
+
+/**
+ * @brief the macro values, computed when they are first needed
+ */
+struct MacroValues {
+    bool     m_evaluated[kMacroCount];
+    bool     m_available[kMacroCount]; // false if the macro has no value and is left as is
+    wxString m_values[kMacroCount];
+
+    MacroValues() {
+        for(int i=0; i<kMacroCount; ++i) {
+            m_evaluated[i] = false;
+            m_available[i] = false;
+        }
+    }
+};
+
+/**
+ * @brief the state of a single expansion: what the macros refer to and their values
+ */
+class MacroContext
+{
+public:
+    int          m_mode;
+    Workspace*   m_workspace;
+    wxString     m_project;
+    wxString     m_conf;
+    IManager*    m_manager;  // kModeExpand only
+    wxString     m_fileName; // kModeWorkspace only
+    MacroValues  m_local;
+    MacroValues* m_shared;   // the project values, shared by all the expansions of a MacroCacheScope
+
+protected:
+    bool           m_projectLoaded;
+    ProjectPtr     m_proj;
+    BuildConfigPtr m_bldConf;
+    bool           m_editorLoaded;
+    IEditor*       m_editor;
+
+protected:
+    void LoadProject() {
+        if ( m_projectLoaded ) {
+            return;
+        }
+        m_projectLoaded = true;
+
+        if ( m_workspace ) {
+            wxString errMsg;
+            m_proj = m_workspace->FindProjectByName(m_project, errMsg);
+            if ( m_proj ) {
+                m_bldConf = m_workspace->GetProjBuildConf(m_proj->GetName(), m_conf);
+            }
+        }
+    }
+
+    IEditor* GetEditor() {
+        if ( !m_editorLoaded ) {
+            m_editorLoaded = true;
+            m_editor = m_manager ? m_manager->GetActiveEditor() : NULL;
+        }
+        return m_editor;
+    }
+
+    bool GetCurrentFile(wxFileName &fn) {
+        if ( m_mode == kModeExpand ) {
+            IEditor* editor = GetEditor();
+            if ( !editor ) {
+                return false;
+            }
+            fn = editor->GetFileName();
+            return true;
+        }
+
+        if ( m_fileName.IsEmpty() ) {
+            return false;
+        }
+        fn = wxFileName(m_fileName);
+        return true;
+    }
+
+    bool DoGetValue(int macro, wxString &value);
+
+public:
+    MacroContext(int mode, Workspace* workspace, const wxString &project, const wxString &conf)
+        : m_mode(mode)
+        , m_workspace(workspace)
+        , m_project(project)
+        , m_conf(conf)
+        , m_manager(NULL)
+        , m_shared(NULL)
+        , m_projectLoaded(false)
+        , m_editorLoaded(false)
+        , m_editor(NULL)
+    {}
+
+    /**
+     * @brief return the value of 'macro'
+     * @return false if the macro has no value in this context
+     */
+    bool GetValue(int macro, wxString &value) {
+        MacroValues* values = (m_shared && macro <= LAST_PROJECT_MACRO) ? m_shared : &m_local;
+        if ( !values->m_evaluated[macro] ) {
+            values->m_available[macro] = DoGetValue(macro, values->m_values[macro]);
+            values->m_evaluated[macro] = true;
+        }
+        value = values->m_values[macro];
+        return values->m_available[macro];
+    }
+};
+
+bool MacroContext::DoGetValue(int macro, wxString& value)
+{
+    wxFileName fn;
+
+    switch ( macro ) {
+    case kWorkspaceName:
+        if ( !m_workspace ) {
+            return false;
+        }
+        value = m_workspace->GetName();
+        return true;
+
+    case kProjectOutputFile:
+        LoadProject();
+        if ( !m_bldConf ) {
+            return false;
+        }
+        value = m_bldConf->GetOutputFileName();
+        return true;
+
+    case kProjectWorkingDirectory:
+        LoadProject();
+        if ( !m_proj ) {
+            return false;
+        }
+        // When custom build project, use the working directory set in the
+        // custom build tab, otherwise use the project file's path
+        if ( m_bldConf ) {
+            value = m_bldConf->IsCustomBuild() ? m_bldConf->GetCustomBuildWorkingDir() : m_proj->GetFileName().GetPath();
+        }
+        return true;
+
+    case kProjectRunWorkingDirectory:
+        LoadProject();
+        if ( !m_proj ) {
+            return false;
+        }
+        if ( m_bldConf ) {
+            value = m_bldConf->GetWorkingDirectory();
+        }
+        return true;
+
+    case kProjectPath:
+        LoadProject();
+        if ( !m_proj ) {
+            return false;
+        }
+        value = m_proj->GetFileName().GetPath(wxPATH_GET_VOLUME|wxPATH_GET_SEPARATOR);
+        return true;
+
+    case kWorkspacePath:
+        LoadProject();
+        if ( !m_proj ) {
+            return false;
+        }
+        value = m_workspace->GetWorkspaceFileName().GetPath(wxPATH_GET_VOLUME|wxPATH_GET_SEPARATOR);
+        return true;
+
+    case kProjectName:
+        LoadProject();
+        if ( !m_proj ) {
+            return false;
+        }
+        //make sure that the project name does not contain any spaces
+        value = m_proj->GetName();
+        value.Replace(wxT(" "), wxT("_"));
+        return true;
+
+    case kIntermediateDirectory:
+    case kOutDir:
+        LoadProject();
+        if ( !m_proj || !m_bldConf ) {
+            return false;
+        }
+        value = m_bldConf->GetIntermediateDirectory();
+        if ( m_mode == kModeWorkspace ) {
+            // the IntermediateDirectory variable is special, since it can contains
+            // other variables in it.
+            wxString projectName, projectPath, workspacePath;
+            GetValue(kProjectPath,   projectPath);
+            GetValue(kWorkspacePath, workspacePath);
+            GetValue(kProjectName,   projectName);
+            value.Replace(wxT("$(ProjectPath)"),       projectPath);
+            value.Replace(wxT("$(WorkspacePath)"),     workspacePath);
+            value.Replace(wxT("$(ProjectName)"),       projectName);
+            value.Replace(wxT("$(ConfigurationName)"), m_bldConf->GetName());
+        }
+        return true;
+
+    case kConfigurationName:
+        LoadProject();
+        if ( !m_proj || !m_bldConf ) {
+            return false;
+        }
+        value = m_bldConf->GetName();
+        return true;
+
+    case kProjectFiles:
+    case kProjectFilesAbs:
+        LoadProject();
+        if ( !m_proj ) {
+            return false;
+        }
+        value = m_proj->GetFiles(macro == kProjectFilesAbs);
+        return true;
+
+    case kCurrentFileName:
+        if ( !GetCurrentFile(fn) ) {
+            return false;
+        }
+        value = fn.GetName();
+        return true;
+
+    case kCurrentFilePath:
+        if ( !GetCurrentFile(fn) ) {
+            return false;
+        }
+        value = fn.GetPath();
+        value.Replace(wxT("\\"), wxT("/"));
+        return true;
+
+    case kCurrentFileExt:
+        if ( !GetCurrentFile(fn) ) {
+            return false;
+        }
+        value = fn.GetExt();
+        return true;
+
+    case kCurrentFileFullPath:
+        if ( !GetCurrentFile(fn) ) {
+            return false;
+        }
+        value = fn.GetFullPath();
+        value.Replace(wxT("\\"), wxT("/"));
+        return true;
+
+    case kCurrentSelection:
+        if ( !GetEditor() ) {
+            return false;
+        }
+        value = GetEditor()->GetSelection();
+        return true;
+
+    case kCurrentSelectionRange:
+        if ( !GetEditor() ) {
+            return false;
+        }
+        value = wxString::Format(wxT("%i:%i"), GetEditor()->GetSelectionStart(), GetEditor()->GetSelectionEnd());
+        return true;
+
+    case kUser:
+        value = wxGetUserName();
+        return true;
+
+    case kDate:
+        value = wxDateTime::Now().FormatDate();
+        return true;
+
+    case kCodeLitePath:
+        if ( m_mode == kModeExpand ) {
+            if ( !m_manager ) {
+                return false;
+            }
+            value = m_manager->GetInstallDirectory();
+
+        } else {
+            if ( !m_workspace ) {
+                return false;
+            }
+            value = m_workspace->GetStartupDir();
+        }
+        return true;
+
+    default:
+        return false;
+    }
+}
 
 MacroManager::MacroManager()
+    : m_cacheDepth(0)
 {
+    for(int i=0; i<kMacroCount; ++i) {
+        m_macroNames[s_macroNames[i]] = i;
+    }
 }
 
 MacroManager::~MacroManager()
 {
+    MacroCache_t::iterator iter = m_cache.begin();
+    for(; iter != m_cache.end(); ++iter) {
+        delete iter->second;
+    }
+    m_cache.clear();
 }
 
 MacroManager* MacroManager::Instance()
@@ -20,98 +419,109 @@ MacroManager* MacroManager::Instance()
     return &ms_instance;
 }
 
-wxString MacroManager::Expand(const wxString& expression, IManager* manager, const wxString& project, const wxString &confToBuild)
+void MacroManager::BeginCache()
 {
-    wxString   errMsg;
-    wxString   expandedString(expression);
-    Workspace *workspace = WorkspaceST::Get();
-    
-    DollarEscaper de(expandedString);
-    
-    if ( workspace ) {
-        expandedString.Replace(wxT("$(WorkspaceName)"), workspace->GetName());
-        ProjectPtr proj = workspace->FindProjectByName(project, errMsg);
-        if (proj) {
-            wxString prjBuildWd;
-            wxString prjRunWd;
-
-            wxString project_name(proj->GetName());
-
-            //make sure that the project name does not contain any spaces
-            project_name.Replace(wxT(" "), wxT("_"));
-
-            BuildConfigPtr bldConf = workspace->GetProjBuildConf(proj->GetName(), confToBuild);
-            if (bldConf) {
-                bool isCustom = bldConf->IsCustomBuild();
-                expandedString.Replace(wxT("$(ProjectOutputFile)"), bldConf->GetOutputFileName());
-
-                // When custom build project, use the working directory set in the
-                // custom build tab, otherwise use the project file's path
-                prjBuildWd = isCustom ? bldConf->GetCustomBuildWorkingDir() : proj->GetFileName().GetPath();
-                prjRunWd   = bldConf->GetWorkingDirectory();
-            }
-
-            expandedString.Replace(wxT("$(ProjectWorkingDirectory)"),    prjBuildWd);
-            expandedString.Replace(wxT("$(ProjectRunWorkingDirectory)"), prjRunWd);
-            expandedString.Replace(wxT("$(ProjectPath)"), proj->GetFileName().GetPath(wxPATH_GET_VOLUME|wxPATH_GET_SEPARATOR));
-            expandedString.Replace(wxT("$(WorkspacePath)"), workspace->GetWorkspaceFileName().GetPath(wxPATH_GET_VOLUME|wxPATH_GET_SEPARATOR));
-            expandedString.Replace(wxT("$(ProjectName)"), project_name);
+    if ( wxThread::IsMain() ) {
+        ++m_cacheDepth;
+    }
+}
 
-            if (bldConf) {
-                expandedString.Replace(wxT("$(IntermediateDirectory)"), bldConf->GetIntermediateDirectory());
-                expandedString.Replace(wxT("$(ConfigurationName)"), bldConf->GetName());
-                expandedString.Replace(wxT("$(OutDir)"), bldConf->GetIntermediateDirectory());
-            }
+void MacroManager::EndCache()
+{
+    if ( !wxThread::IsMain() || m_cacheDepth == 0 || --m_cacheDepth > 0 ) {
+        return;
+    }
 
-            if(expandedString.Find(wxT("$(ProjectFiles)")) != wxNOT_FOUND)
-                expandedString.Replace(wxT("$(ProjectFiles)"),   proj->GetFiles());
+    MacroCache_t::iterator iter = m_cache.begin();
+    for(; iter != m_cache.end(); ++iter) {
+        delete iter->second;
+    }
+    m_cache.clear();
+}
 
-            if(expandedString.Find(wxT("$(ProjectFilesAbs)")) != wxNOT_FOUND)
-                expandedString.Replace(wxT("$(ProjectFilesAbs)"),proj->GetFiles(true));
+MacroValues* MacroManager::GetCacheEntry(const MacroContext& ctx)
+{
+    if ( m_cacheDepth == 0 || !wxThread::IsMain() ) {
+        return NULL;
+    }
 
+    wxString key;
+    key << ctx.m_mode << wxT("|") << (ctx.m_workspace ? 1 : 0) << wxT("|") << ctx.m_project << wxT("|") << ctx.m_conf;
 
-        }
+    MacroValues*& values = m_cache[key];
+    if ( !values ) {
+        values = new MacroValues();
     }
-    
-    if ( manager ) {
-        IEditor *editor = manager->GetActiveEditor();
-        if (editor) {
-            wxFileName fn(editor->GetFileName());
+    return values;
+}
 
-            expandedString.Replace(wxT("$(CurrentFileName)"), fn.GetName());
+wxString MacroManager::DoExpand(const wxString& expression, MacroContext& ctx, int minRank)
+{
+    size_t pos = expression.find(wxT("$("));
+    if ( pos == wxString::npos ) {
+        // the common case
+        return expression;
+    }
 
-            wxString fpath(fn.GetPath());
-            fpath.Replace(wxT("\\"), wxT("/"));
-            expandedString.Replace(wxT("$(CurrentFilePath)"), fpath);
-            expandedString.Replace(wxT("$(CurrentFileExt)"), fn.GetExt());
+    wxString result;
+    result.reserve(expression.length());
 
-            wxString ffullpath(fn.GetFullPath());
-            ffullpath.Replace(wxT("\\"), wxT("/"));
-            expandedString.Replace(wxT("$(CurrentFileFullPath)"), ffullpath);
-            expandedString.Replace(wxT("$(CurrentSelection)"), editor->GetSelection());
-            if(expandedString.Find(wxT("$(CurrentSelectionRange)")) != wxNOT_FOUND) {
-                int start=editor->GetSelectionStart(),
-                    end  =editor->GetSelectionEnd();
+    size_t copied = 0; // the text before this position was already added to 'result'
+    while ( pos != wxString::npos ) {
+        size_t nameStart = pos + 2;
+        size_t nameEnd   = nameStart;
+        while ( nameEnd < expression.length() && IsMacroNameChar(expression.GetChar(nameEnd)) ) {
+            ++nameEnd;
+        }
 
-                wxString output=wxString::Format(wxT("%i:%i"),start,end);
-                expandedString.Replace(wxT("$(CurrentSelectionRange)"), output);
+        if ( nameEnd > nameStart && nameEnd < expression.length() && expression.GetChar(nameEnd) == wxT(')') ) {
+            MacroNameMap_t::const_iterator iter = m_macroNames.find(expression.substr(nameStart, nameEnd - nameStart));
+            if ( iter != m_macroNames.end() ) {
+                int rank = GetMacroRank(ctx.m_mode, iter->second);
+                wxString value;
+                if ( rank != wxNOT_FOUND && rank >= minRank && ctx.GetValue(iter->second, value) ) {
+                    result.append(expression, copied, pos - copied);
+                    result << DoExpand(value, ctx, rank + 1);
+                    copied = nameEnd + 1;
+                    pos    = expression.find(wxT("$("), copied);
+                    continue;
+                }
             }
         }
-        
+
+        // not a macro we know (e.g. "$(shell ... $(ProjectName))"): keep it as is,
+        // but do look for macros within it
+        pos = expression.find(wxT("$("), pos + 2);
     }
 
-    //exapand common macros
-    wxDateTime now = wxDateTime::Now();
-    expandedString.Replace(wxT("$(User)"), wxGetUserName());
-    expandedString.Replace(wxT("$(Date)"), now.FormatDate());
+    result.append(expression, copied, wxString::npos);
+    return result;
+}
+
+wxString MacroManager::Expand(const wxString& expression, IManager* manager, const wxString& project, const wxString &confToBuild)
+{
+    wxString expandedString(expression);
+    DollarEscaper de(expandedString);
+
+    MacroContext ctx(kModeExpand, WorkspaceST::Get(), project, confToBuild);
+    ctx.m_manager = manager;
+    ctx.m_shared  = GetCacheEntry(ctx);
+    expandedString = DoExpand(expandedString, ctx, 0);
 
     if (manager) {
-        expandedString.Replace(wxT("$(CodeLitePath)"), manager->GetInstallDirectory());
         expandedString = manager->GetEnv()->ExpandVariables(expandedString, true);
     }
     return expandedString;
 }
 
+wxString MacroManager::ExpandWorkspaceMacros(const wxString& expression, Workspace* workspace, const wxString& project, const wxString& confToBuild, const wxString& fileName)
+{
+    MacroContext ctx(kModeWorkspace, workspace, project, confToBuild);
+    ctx.m_fileName = fileName;
+    ctx.m_shared   = GetCacheEntry(ctx);
+    return DoExpand(expression, ctx, 0);
+}
+
 wxString MacroManager::Replace(const wxString& inString, const wxString& variableName, const wxString& replaceWith, bool bIgnoreCase)
 {
     size_t flags = wxRE_DEFAULT;
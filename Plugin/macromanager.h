@@ -28,10 +28,24 @@
 
 #include <wx/string.h>
 #include "codelite_exports.h"
+#include <map>
 
 class IManager;
+class Workspace;
+class MacroContext;
+struct MacroValues;
+
 class WXDLLIMPEXP_SDK MacroManager
 {
+	friend class MacroCacheScope;
+
+	typedef std::map<wxString, int>          MacroNameMap_t;
+	typedef std::map<wxString, MacroValues*> MacroCache_t;
+
+	MacroNameMap_t m_macroNames;
+	MacroCache_t   m_cache;
+	int            m_cacheDepth;
+
 public:
 	static MacroManager* Instance();
 
@@ -39,6 +53,16 @@ private:
 	MacroManager();
 	virtual ~MacroManager();
 
+	void BeginCache();
+	void EndCache();
+	MacroValues* GetCacheEntry(const MacroContext &ctx);
+
+	/**
+	 * @brief expand the macros of 'expression' in a single pass. Only the macros
+	 * that come at or after 'minRank' in the expansion order of 'ctx' are expanded
+	 */
+	wxString DoExpand(const wxString &expression, MacroContext &ctx, int minRank);
+
 public:
 	/*
 	 * The following macro will be expanded into their real values:
@@ -62,6 +86,12 @@ public:
 	 * $(ProjectOutputFile)
 	 */
 	wxString Expand(const wxString &expression, IManager *manager, const wxString &project, const wxString &confToBuild = wxEmptyString);
+
+	/**
+	 * @brief expand the macros known to ExpandAllVariables() (the current file macros
+	 * refer to 'fileName' instead of the active editor). Environment variables are not expanded
+	 */
+	wxString ExpandWorkspaceMacros(const wxString &expression, Workspace *workspace, const wxString &project, const wxString &confToBuild, const wxString &fileName);
 	
 	
 	/**
@@ -83,4 +113,24 @@ public:
 	bool FindVariable(const wxString &inString, wxString &name, wxString &fullname);
 };
 
+/**
+ * @class MacroCacheScope
+ * @brief while an instance of this class exists, the workspace and project values
+ * the macros expand to ($(ProjectFiles), $(IntermediateDirectory)...) are computed once
+ * per project and configuration instead of once per expansion. Create one around code
+ * that expands many expressions, e.g. the makefile generation.
+ * The cache is used by the main thread only
+ */
+class WXDLLIMPEXP_SDK MacroCacheScope
+{
+public:
+	MacroCacheScope() {
+		MacroManager::Instance()->BeginCache();
+	}
+
+	~MacroCacheScope() {
+		MacroManager::Instance()->EndCache();
+	}
+};
+
 #endif // MACROMANAGER_H
@@ -0,0 +1,128 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : memory_mapped_file.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "memory_mapped_file.h"
+
+#ifdef __WXMSW__
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+clMemoryMappedFile::clMemoryMappedFile()
+    : m_data(NULL)
+    , m_length(0)
+{
+}
+
+clMemoryMappedFile::~clMemoryMappedFile()
+{
+    Close();
+}
+
+bool clMemoryMappedFile::Open(const wxString& fileName)
+{
+    Close();
+
+#ifdef __WXMSW__
+    HANDLE file = ::CreateFileW(fileName.wc_str(), GENERIC_READ, FILE_SHARE_READ|FILE_SHARE_WRITE|FILE_SHARE_DELETE,
+                                NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if ( file == INVALID_HANDLE_VALUE ) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if ( !::GetFileSizeEx(file, &size) || size.QuadPart <= 0 || (ULONGLONG)size.QuadPart > (ULONGLONG)(size_t)-1 ) {
+        ::CloseHandle(file);
+        return false;
+    }
+
+    // The view keeps a reference to the mapping and the mapping to the file,
+    // both handles can be closed right away
+    HANDLE mapping = ::CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    ::CloseHandle(file);
+    if ( mapping == NULL ) {
+        return false;
+    }
+
+    void* data = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    ::CloseHandle(mapping);
+    if ( data == NULL ) {
+        return false;
+    }
+
+    m_data   = (const char*)data;
+    m_length = (size_t)size.QuadPart;
+
+#else
+    int fd = ::open(fileName.fn_str(), O_RDONLY);
+    if ( fd < 0 ) {
+        return false;
+    }
+
+    struct stat buff;
+    if ( ::fstat(fd, &buff) < 0 || !S_ISREG(buff.st_mode) || buff.st_size <= 0 ||
+         (unsigned long long)buff.st_size > (unsigned long long)(size_t)-1 ) {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void* data = ::mmap(NULL, (size_t)buff.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if ( data == MAP_FAILED ) {
+        return false;
+    }
+
+#ifdef MADV_SEQUENTIAL
+    // The callers read the content from start to end
+    ::madvise(data, (size_t)buff.st_size, MADV_SEQUENTIAL);
+#endif
+
+    m_data   = (const char*)data;
+    m_length = (size_t)buff.st_size;
+#endif
+    return true;
+}
+
+void clMemoryMappedFile::Close()
+{
+    if ( !m_data ) {
+        return;
+    }
+
+#ifdef __WXMSW__
+    ::UnmapViewOfFile(m_data);
+#else
+    ::munmap((void*)m_data, m_length);
+#endif
+
+    m_data   = NULL;
+    m_length = 0;
+}
@@ -0,0 +1,80 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : memory_mapped_file.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef MEMORYMAPPEDFILE_H
+#define MEMORYMAPPEDFILE_H
+
+#include "codelite_exports.h"
+#include <wx/string.h>
+
+/**
+ * @class clMemoryMappedFile
+ * @brief a read-only view of a file's content, mapped into memory. The content
+ * is paged in by the OS when it is accessed, nothing is copied.
+ * Reading the content of a file that was truncated after it was mapped raises SIGBUS:
+ * only map files that are read right away (the editor load), never from worker threads
+ */
+class WXDLLIMPEXP_SDK clMemoryMappedFile
+{
+    const char* m_data;
+    size_t      m_length;
+
+private:
+    clMemoryMappedFile(const clMemoryMappedFile&);
+    clMemoryMappedFile& operator=(const clMemoryMappedFile&);
+
+public:
+    clMemoryMappedFile();
+    virtual ~clMemoryMappedFile();
+
+    /**
+     * @brief map 'fileName' into memory
+     * @return false if the file could not be mapped. Empty files and files that are
+     * not regular files (devices, pipes) are never mapped
+     */
+    bool Open(const wxString &fileName);
+
+    /**
+     * @brief unmap the file. The pointer returned by GetData() is no longer valid
+     */
+    void Close();
+
+    bool IsOpened() const {
+        return m_data != NULL;
+    }
+
+    /**
+     * @brief return the file content. The content is not NULL terminated
+     */
+    const char* GetData() const {
+        return m_data;
+    }
+
+    size_t GetLength() const {
+        return m_length;
+    }
+};
+
+#endif // MEMORYMAPPEDFILE_H
@@ -40,6 +40,7 @@
 #include "event_notifier.h"
 #include <wx/sstream.h>
 #include <wx/ffile.h>
+#include "workspace_snapshot.h"
 
 const wxString Project::STATIC_LIBRARY = wxT("Static Library");
 const wxString Project::DYNAMIC_LIBRARY = wxT("Dynamic Library");
@@ -165,14 +166,30 @@ bool Project::Load(const wxString &path)
     GetAllPluginsData(pluginsData);
     SetAllPluginsData(pluginsData, false);
 
+    DoLoadCompleted(path);
+    return true;
+}
+
+bool Project::LoadFromSnapshot(const wxString& path, const WorkspaceSnapshot& snapshot)
+{
+    // The snapshot keeps the document as Load() left it, there is
+    // nothing to convert
+    if ( !snapshot.GetDocument(path, m_doc) ) {
+        return false;
+    }
+
+    DoLoadCompleted(path);
+    return true;
+}
+
+void Project::DoLoadCompleted(const wxString& path)
+{
     m_vdCache.clear();
 
     m_fileName = path;
     m_fileName.MakeAbsolute();
     SetModified(true);
     SetProjectLastModifiedTime(GetFileLastModifiedTime());
-
-    return true;
 }
 
 wxXmlNode *Project::GetVirtualDir(const wxString &vdFullPath)
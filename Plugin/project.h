@@ -142,6 +142,7 @@ typedef TreeNode<wxString, ProjectItem> ProjectTreeNode;
 
 class Project;
 class Workspace;
+class WorkspaceSnapshot;
 
 typedef SmartPtr<Project>       ProjectPtr;
 typedef std::set<wxFileName>    FileNameSet_t;
@@ -295,6 +296,13 @@ public:
      * \return
      */
     bool Load(const wxString &path);
+
+    /**
+     * @brief load the project from the workspace snapshot instead of parsing its file
+     * @param path the project file full path
+     * @return false if the snapshot has no up-to-date copy of the project. Call Load() in that case
+     */
+    bool LoadFromSnapshot(const wxString &path, const WorkspaceSnapshot &snapshot);
     /**
      * \brief Create new project
      * \param name project name
@@ -646,6 +654,11 @@ private:
      */
     void ConvertToUnixFormat(wxXmlNode *parent);
 
+    /**
+     * @brief complete the loading of the project once m_doc holds its document
+     */
+    void DoLoadCompleted(const wxString &path);
+
     bool SaveXmlFile();
 };
 
@@ -0,0 +1,251 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : replace_in_files_engine.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "replace_in_files_engine.h"
+#include "globals.h"
+#include <wx/ffile.h>
+#include <wx/filefn.h>
+#include <wx/strconv.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef __WXMSW__
+#include <unistd.h>
+#endif
+
+#define REPLACE_IN_FILES_MAX_THREADS 8
+
+//------------------------------------------------------------------------------
+// ReplaceInFilesThread
+//------------------------------------------------------------------------------
+
+class ReplaceInFilesThread : public wxThread
+{
+    ReplaceInFilesEngine* m_engine;
+
+public:
+    ReplaceInFilesThread(ReplaceInFilesEngine* engine)
+        : wxThread(wxTHREAD_JOINABLE)
+        , m_engine(engine)
+    {}
+
+protected:
+    virtual void* Entry() {
+        m_engine->DoProcessFiles();
+        return NULL;
+    }
+};
+
+//------------------------------------------------------------------------------
+// ReplaceInFilesEngine
+//------------------------------------------------------------------------------
+
+ReplaceInFilesEngine::ReplaceInFilesEngine(const wxString& replaceWith, wxFontEncoding encoding)
+    : m_replaceWith(replaceWith.c_str())
+    , m_encoding(encoding == wxFONTENCODING_DEFAULT ? wxFONTENCODING_SYSTEM : encoding)
+    , m_files(NULL)
+    , m_next(0)
+{
+}
+
+ReplaceInFilesEngine::~ReplaceInFilesEngine()
+{
+}
+
+void ReplaceInFilesEngine::Run(std::vector<File>& files)
+{
+    m_files = &files;
+    m_next  = 0;
+
+    int cpus = wxThread::GetCPUCount();
+    size_t threadsCount = cpus > 1 ? (size_t)cpus : 1;
+    threadsCount = wxMin(threadsCount, (size_t)REPLACE_IN_FILES_MAX_THREADS);
+    threadsCount = wxMin(threadsCount, files.size());
+
+    // The calling thread processes files as well
+    std::vector<ReplaceInFilesThread*> threads;
+    for(size_t i=1; i<threadsCount; i++) {
+        ReplaceInFilesThread* thread = new ReplaceInFilesThread(this);
+        if ( thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR ) {
+            delete thread;
+            break;
+        }
+        threads.push_back(thread);
+    }
+
+    DoProcessFiles();
+
+    for(size_t i=0; i<threads.size(); i++) {
+        threads.at(i)->Wait();
+        delete threads.at(i);
+    }
+    m_files = NULL;
+}
+
+ReplaceInFilesEngine::File* ReplaceInFilesEngine::DoGetNextFile()
+{
+    wxCriticalSectionLocker locker(m_cs);
+    if ( m_next >= m_files->size() ) {
+        return NULL;
+    }
+    return &m_files->at(m_next++);
+}
+
+void ReplaceInFilesEngine::DoProcessFiles()
+{
+    File* file = NULL;
+    while ( (file = DoGetNextFile()) != NULL ) {
+        DoReplace(*file);
+    }
+}
+
+void ReplaceInFilesEngine::DoReplace(File& file)
+{
+    wxString content;
+    if ( !ReadFileWithConversion(file.m_fileName, content, m_encoding) ) {
+        file.m_error = wxT("Failed to read file");
+        return;
+    }
+
+    // Offsets of the lines, split the same way the search thread does
+    std::vector<size_t> lines;
+    lines.push_back(0);
+    for(size_t i=0; i<content.length(); i++) {
+        if ( content.GetChar(i) == wxT('\n') ) {
+            lines.push_back(i + 1);
+        }
+    }
+
+    wxString output;
+    output.reserve(content.length());
+
+    size_t last = 0;
+    bool   modified = false;
+    for(size_t i=0; i<file.m_edits.size(); i++) {
+        Edit& edit = file.m_edits.at(i);
+        if ( edit.m_line < 1 || (size_t)edit.m_line > lines.size() || edit.m_column < 0 || edit.m_len < 0 ) {
+            continue;
+        }
+
+        size_t lineStart = lines.at(edit.m_line - 1);
+        size_t lineEnd   = (size_t)edit.m_line < lines.size() ? lines.at(edit.m_line) - 1 : content.length();
+
+        // The line must be exactly the one found by the search, otherwise
+        // the file was modified since and the edit is not safe
+        if ( lineEnd - lineStart != edit.m_pattern.length() || content.compare(lineStart, lineEnd - lineStart, edit.m_pattern) != 0 ) {
+            continue;
+        }
+
+        size_t pos = lineStart + edit.m_column;
+        if ( pos < last || pos + edit.m_len > lineEnd ) {
+            // overlaps the previous edit or outside of the line
+            continue;
+        }
+
+        output.append(content, last, pos - last);
+        output.append(m_replaceWith);
+        last = pos + edit.m_len;
+        edit.m_replaced = true;
+        modified = true;
+    }
+
+    if ( !modified ) {
+        return;
+    }
+    output.append(content, last, content.length() - last);
+
+    if ( !DoWriteFile(file.m_fileName, output, file.m_error) ) {
+        for(size_t i=0; i<file.m_edits.size(); i++) {
+            file.m_edits.at(i).m_replaced = false;
+        }
+        return;
+    }
+    file.m_saved = true;
+}
+
+bool ReplaceInFilesEngine::DoWriteFile(const wxString& fileName, const wxString& content, wxString& error)
+{
+    // Convert first: a content that can not be represented in the file encoding
+    // must not leave anything behind
+    wxCSConv fontEncConv(m_encoding);
+    const wxCharBuffer buffer = content.mb_str(fontEncConv);
+    if ( !buffer.data() || (!content.IsEmpty() && !buffer.data()[0]) ) {
+        error = wxT("Failed to write file (the content can not be represented in the file encoding?)");
+        return false;
+    }
+    size_t len = strlen(buffer.data());
+
+    bool inPlace = false;
+#ifndef __WXMSW__
+    // Renaming a new file over the original would replace a symbolic link by a
+    // regular file, break hard links and lose an ownership (or ACLs) we can not
+    // restore: those files are rewritten in place
+    struct stat buff;
+    bool hasStat = lstat(fileName.mb_str(wxConvUTF8).data(), &buff) == 0;
+    if ( hasStat ) {
+        inPlace = S_ISLNK(buff.st_mode) || buff.st_nlink > 1 || buff.st_uid != geteuid() || buff.st_gid != getegid();
+    }
+#endif
+
+    if ( inPlace ) {
+        wxFFile file(fileName, wxT("wb"));
+        if ( !file.IsOpened() || file.Write(buffer.data(), len) != len || !file.Close() ) {
+            error = wxT("Failed to write file ") + fileName;
+            return false;
+        }
+        return true;
+    }
+
+    // Write to a temporary file next to the original and rename it over the
+    // original: the file is never left half written
+    wxString tmpfile = fileName + wxT(".cltmp");
+    {
+        wxFFile file(tmpfile, wxT("wb"));
+        if ( !file.IsOpened() ) {
+            error = wxT("Failed to create temporary file ") + tmpfile;
+            return false;
+        }
+
+        if ( file.Write(buffer.data(), len) != len || !file.Close() ) {
+            file.Close();
+            ::wxRemoveFile(tmpfile);
+            error = wxT("Failed to write temporary file ") + tmpfile;
+            return false;
+        }
+    }
+
+#ifndef __WXMSW__
+    // Keep the permissions of the original file
+    if ( hasStat ) {
+        chmod(tmpfile.mb_str(wxConvUTF8).data(), buff.st_mode & 07777);
+    }
+#endif
+
+    if ( !::wxRenameFile(tmpfile, fileName, true) ) {
+        ::wxRemoveFile(tmpfile);
+        error = wxT("Failed to replace file");
+        return false;
+    }
+    return true;
+}
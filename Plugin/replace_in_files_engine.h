@@ -0,0 +1,100 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : replace_in_files_engine.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef REPLACEINFILESENGINE_H
+#define REPLACEINFILESENGINE_H
+
+#include "codelite_exports.h"
+#include <wx/string.h>
+#include <wx/thread.h>
+#include <wx/fontenc.h>
+#include <vector>
+
+/**
+ * @class ReplaceInFilesEngine
+ * @brief apply the replacements of a "Replace in Files" search to files which are not
+ * opened in an editor. The files are processed on several threads: each file is read,
+ * every edit is verified against the line found by the search, the new content is built
+ * in memory and written back atomically (a temporary file renamed over the original).
+ * No GUI object is used, so the caller only has to update the editors and the result pane
+ */
+class WXDLLIMPEXP_SDK ReplaceInFilesEngine
+{
+public:
+    struct Edit {
+        int      m_line;     // 1 based line number, as reported by the search
+        int      m_column;   // in characters
+        int      m_len;      // in characters
+        wxString m_pattern;  // the line as it was when searched
+        bool     m_replaced; // output
+
+        Edit(int line, int column, int len, const wxString& pattern)
+            : m_line(line)
+            , m_column(column)
+            , m_len(len)
+            , m_pattern(pattern)
+            , m_replaced(false)
+        {}
+    };
+
+    struct File {
+        wxString          m_fileName;
+        std::vector<Edit> m_edits; // ordered by line and column
+        bool              m_saved; // output: the file was written
+        wxString          m_error; // output
+
+        File(const wxString& fileName)
+            : m_fileName(fileName)
+            , m_saved(false)
+        {}
+    };
+
+protected:
+    wxString           m_replaceWith;
+    wxFontEncoding     m_encoding;
+    std::vector<File>* m_files;
+    size_t             m_next;
+    wxCriticalSection  m_cs;
+
+    friend class ReplaceInFilesThread;
+
+protected:
+    File* DoGetNextFile();
+    void  DoProcessFiles();
+    void  DoReplace(File& file);
+    bool  DoWriteFile(const wxString& fileName, const wxString& content, wxString& error);
+
+public:
+    ReplaceInFilesEngine(const wxString& replaceWith, wxFontEncoding encoding);
+    virtual ~ReplaceInFilesEngine();
+
+    /**
+     * @brief process 'files'. Returns when all of them are done. The results are
+     * reported in the File and Edit objects
+     */
+    void Run(std::vector<File>& files);
+};
+
+#endif // REPLACEINFILESENGINE_H
@@ -52,6 +52,11 @@ const wxEventType wxEVT_SEARCH_THREAD_SEARCHSTARTED = wxNewEventType();
     }\
     wxThread::Sleep(1);
 
+// Matches are posted to the UI in batches: a batch is sent once it holds
+// SEARCH_BATCH_MATCHES matches or SEARCH_BATCH_INTERVAL ms after the previous
+// one, whichever comes first
+#define SEARCH_BATCH_MATCHES  5000
+#define SEARCH_BATCH_INTERVAL 250
 
 //----------------------------------------------------------------
 // SearchData
@@ -69,6 +74,7 @@ const wxString& SearchData::GetExtensions() const
 SearchThread::SearchThread()
     : WorkerThread()
     , m_wordChars(wxT("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_"))
+    , m_batchStart(0)
     , m_reExpr(wxT(""))
 {
     IndexWordChars();
@@ -113,7 +119,9 @@ wxRegEx& SearchThread::GetRegex(const wxString &expr, bool matchCase)
 
 void SearchThread::PerformSearch(const SearchData &data)
 {
-    Add( new SearchData(data) );
+    SearchData *req = new SearchData(data);
+    req->SetPriority(ThreadRequest::kPriorityHigh);
+    Add( req );
 }
 
 void SearchThread::ProcessRequest(ThreadRequest *req)
@@ -184,6 +192,8 @@ void SearchThread::DoSearchFiles(ThreadRequest *req)
     GetFiles(data, fileList);
 
     wxStopWatch sw;
+    m_batchTimer.Start();
+    m_batchStart = 0;
 
     // Send startup message to main thread
     if ( m_notifiedWindow || data->GetOwner() ) {
@@ -508,30 +518,32 @@ void SearchThread::SendEvent(wxEventType type, wxEvtHandler *owner)
     if ( !m_notifiedWindow && !owner)
         return;
 
-    static int counter(0);
-
     wxCommandEvent event(type, GetId());
 
-    if (type == wxEVT_SEARCH_THREAD_MATCHFOUND && counter == 10) {
-        // match found and we scanned 10 files
-        counter = 0;
-        event.SetClientData( new SearchResultList(m_results) );
-        m_results.clear();
-        SEND_ST_EVENT();
+    if (type == wxEVT_SEARCH_THREAD_MATCHFOUND) {
+        // keep buffering the matches until the batch is big or old enough
+        // (std::list::size() is not constant time, count the matches found since the last batch)
+        int batchSize = m_summary.GetNumMatchesFound() - m_batchStart;
+        if ( batchSize < SEARCH_BATCH_MATCHES && m_batchTimer.Time() < SEARCH_BATCH_INTERVAL ) {
+            return;
+        }
 
-    } else if(type == wxEVT_SEARCH_THREAD_MATCHFOUND) {
-        // a match event, but we did not meet the minimum number of files
-        counter++;
-        wxThread::Sleep(10);
+        // hand over the list instead of copying it
+        SearchResultList *results = new SearchResultList();
+        results->swap(m_results);
+        m_batchTimer.Start();
+        m_batchStart = m_summary.GetNumMatchesFound();
+        event.SetClientData( results );
+        SEND_ST_EVENT();
 
     } else if (type == wxEVT_SEARCH_THREAD_SEARCHEND) {
         // search eneded, if we got any matches "buffed" send them before the
         // the summary event
         if(m_results.empty() == false) {
             wxCommandEvent evt(wxEVT_SEARCH_THREAD_MATCHFOUND, GetId());
-            evt.SetClientData( new SearchResultList(m_results) );
-            m_results.clear();
-            counter = 0;
+            SearchResultList *results = new SearchResultList();
+            results->swap(m_results);
+            evt.SetClientData( results );
 
             if (owner) {
                 wxPostEvent(owner, evt);
@@ -549,7 +561,6 @@ void SearchThread::SendEvent(wxEventType type, wxEvtHandler *owner)
         // been reported yet
         event.SetClientData(new wxString(wxT("Search cancelled by user")));
         m_results.clear();
-        counter = 0;
 
         SEND_ST_EVENT();
     }
@@ -34,6 +34,7 @@
 #include "wx/filename.h"
 #include "cppwordscanner.h"
 #include <wx/regex.h>
+#include <wx/stopwatch.h>
 #include "worker_thread.h"
 #include "stringsearcher.h"
 #include "codelite_exports.h"
@@ -450,6 +451,8 @@ class WXDLLIMPEXP_SDK SearchThread : public WorkerThread
     SearchResultList m_results;
     bool m_stopSearch;
     SearchSummary m_summary;
+    wxStopWatch m_batchTimer; //< Time since the last batch of matches was sent
+    int m_batchStart;         //< Number of matches found when the last batch was sent
     wxString m_reExpr;
     wxRegEx m_regex;
     bool m_matchCase;
@@ -40,6 +40,96 @@
 #include "wx_xml_compatibility.h"
 #include "plugin.h"
 #include "event_notifier.h"
+#include "workspace_snapshot.h"
+#include <wx/thread.h>
+
+// Never use more threads than this for loading the projects
+#define WORKSPACE_MAX_LOADER_THREADS 8
+
+struct WorkspaceProjectLoad {
+    Project* project;
+    wxString path;
+    bool     loaded;
+    bool     fromSnapshot;
+
+    WorkspaceProjectLoad(const wxString &projectPath)
+        : project(new Project())
+        , path(projectPath)
+        , loaded(false)
+        , fromSnapshot(false)
+    {}
+};
+
+// Load every 'step'-th project, starting with 'first'
+static void WorkspaceLoadProjects(std::vector<WorkspaceProjectLoad>& loads, const WorkspaceSnapshot& snapshot, size_t first, size_t step)
+{
+    for(size_t i=first; i<loads.size(); i+=step) {
+        WorkspaceProjectLoad& load = loads.at(i);
+        load.fromSnapshot = load.project->LoadFromSnapshot(load.path, snapshot);
+        load.loaded = load.fromSnapshot || load.project->Load(load.path);
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// A helper thread that loads every N-th project of the workspace. Each project
+// is loaded by a single thread and the snapshot is only read, so the threads
+// do not share any state
+//--------------------------------------------------------------------------------------
+class WorkspaceLoaderThread : public wxThread
+{
+    std::vector<WorkspaceProjectLoad>& m_loads;
+    const WorkspaceSnapshot&           m_snapshot;
+    size_t                             m_first;
+    size_t                             m_step;
+
+public:
+    WorkspaceLoaderThread(std::vector<WorkspaceProjectLoad>& loads, const WorkspaceSnapshot& snapshot, size_t first, size_t step)
+        : wxThread(wxTHREAD_JOINABLE)
+        , m_loads(loads)
+        , m_snapshot(snapshot)
+        , m_first(first)
+        , m_step(step)
+    {}
+
+protected:
+    virtual void* Entry() {
+        WorkspaceLoadProjects(m_loads, m_snapshot, m_first, m_step);
+        return NULL;
+    }
+};
+
+// Load the projects on several threads. Projects found in the snapshot are
+// restored from it, the others are parsed
+static void WorkspaceLoadProjects(std::vector<WorkspaceProjectLoad>& loads, const WorkspaceSnapshot& snapshot)
+{
+    int cpus = wxThread::GetCPUCount();
+    size_t threadsCount = cpus > 1 ? (size_t)cpus : 1;
+    threadsCount = wxMin(threadsCount, (size_t)WORKSPACE_MAX_LOADER_THREADS);
+    threadsCount = wxMin(threadsCount, loads.size());
+    if ( threadsCount == 0 ) {
+        return;
+    }
+
+    // The calling thread loads its share as well
+    std::vector<WorkspaceLoaderThread*> threads;
+    for(size_t i=1; i<threadsCount; i++) {
+        WorkspaceLoaderThread* thread = new WorkspaceLoaderThread(loads, snapshot, i, threadsCount);
+        if ( thread->Create() != wxTHREAD_NO_ERROR || thread->Run() != wxTHREAD_NO_ERROR ) {
+            // Could not start it, load its share here
+            delete thread;
+            WorkspaceLoadProjects(loads, snapshot, i, threadsCount);
+            continue;
+        }
+        threads.push_back(thread);
+    }
+
+    WorkspaceLoadProjects(loads, snapshot, 0, threadsCount);
+
+    for(size_t i=0; i<threads.size(); i++) {
+        threads.at(i)->Wait();
+        delete threads.at(i);
+    }
+}
 
 Workspace::Workspace()
 {
@@ -85,7 +175,21 @@ bool Workspace::OpenWorkspace(const wxString &fileName, wxString &errMsg)
     }
     
     m_fileName = workSpaceFile;
-    m_doc.Load(m_fileName.GetFullPath());
+    m_fileName.MakeAbsolute();
+
+    // Documents that did not change since the workspace was last opened
+    // are restored from the snapshot instead of being parsed
+    WorkspaceSnapshot snapshot;
+    snapshot.Load( GetSnapshotFileName() );
+
+    wxString workspacePath = m_fileName.GetFullPath();
+    if ( !snapshot.GetDocument(workspacePath, m_doc) ) {
+        m_doc.Load(workspacePath);
+        if ( m_doc.IsOk() ) {
+            snapshot.SetDocument(workspacePath, m_doc);
+        }
+    }
+
     if ( !m_doc.IsOk() ) {
         errMsg = wxT("Corrupted workspace file");
         return false;
@@ -104,20 +208,45 @@ bool Workspace::OpenWorkspace(const wxString &fileName, wxString &errMsg)
 
     // Load all projects
     wxXmlNode *child = m_doc.GetRoot()->GetChildren();
-    std::vector<wxXmlNode*> removedChildren;
-    wxString tmperr;
+    std::vector<wxXmlNode*> projectNodes;
+    std::vector<WorkspaceProjectLoad> loads;
     while (child) {
         if (child->GetName() == wxT("Project")) {
-            wxString projectPath = child->GetPropVal(wxT("Path"), wxEmptyString);
+            wxFileName projectFile(child->GetPropVal(wxT("Path"), wxEmptyString));
+            projectFile.MakeAbsolute();
 
-            if ( !DoAddProject(projectPath, errMsg) ) {
-                tmperr << wxString::Format(wxT("Error occured while loading project: \"%s\"\nCodeLite has removed the faulty project from the workspace\n"), projectPath.c_str());
-                removedChildren.push_back(child);
-            }
+            projectNodes.push_back(child);
+            loads.push_back( WorkspaceProjectLoad(projectFile.GetFullPath()) );
         }
         child = child->GetNext();
     }
 
+    WorkspaceLoadProjects(loads, snapshot);
+
+    std::vector<wxXmlNode*> removedChildren;
+    wxArrayString snapshotFiles;
+    snapshotFiles.Add(workspacePath);
+    wxString tmperr;
+    for(size_t i=0; i<loads.size(); i++) {
+        WorkspaceProjectLoad& load = loads.at(i);
+        if ( !load.loaded ) {
+            wxString projectPath = projectNodes.at(i)->GetPropVal(wxT("Path"), wxEmptyString);
+            tmperr << wxString::Format(wxT("Error occured while loading project: \"%s\"\nCodeLite has removed the faulty project from the workspace\n"), projectPath.c_str());
+            removedChildren.push_back(projectNodes.at(i));
+            delete load.project;
+            continue;
+        }
+
+        if ( !load.fromSnapshot ) {
+            snapshot.SetDocument(load.path, load.project->m_doc);
+        }
+        snapshotFiles.Add(load.path);
+
+        // Add an entry to the projects map
+        ProjectPtr proj(load.project);
+        m_projects[proj->GetName()] = proj;
+    }
+
     // Delete the faulty projects
     for(size_t i=0; i<removedChildren.size(); i++) {
         wxXmlNode *ch = removedChildren.at(i);
@@ -125,6 +254,10 @@ bool Workspace::OpenWorkspace(const wxString &fileName, wxString &errMsg)
         delete ch;
     }
 
+    // Keep the snapshot in sync with the files we just loaded
+    snapshot.Prune(snapshotFiles);
+    snapshot.Save( GetSnapshotFileName() );
+
     errMsg.Clear();
     TagsManager *mgr = TagsManagerST::Get();
     mgr->CloseDatabase();
@@ -437,20 +570,6 @@ ProjectPtr Workspace::DoAddProject(ProjectPtr proj)
     return proj;
 }
 
-ProjectPtr Workspace::DoAddProject(const wxString &path, wxString &errMsg)
-{
-    // Add the project
-    ProjectPtr proj(new Project());
-    if ( !proj->Load(path) ) {
-        errMsg = wxT("Corrupted project file '");
-        errMsg << path << wxT("'");
-        return NULL;
-    }
-    // Add an entry to the projects map
-    m_projects[proj->GetName()] = proj;
-    return proj;
-}
-
 bool Workspace::RemoveProject(const wxString &name, wxString &errMsg)
 {
     ProjectPtr proj = FindProjectByName(name, errMsg);
@@ -831,3 +950,10 @@ wxFileName Workspace::GetTagsFileName() const
     fn_tags.SetExt("tags");
     return fn_tags;
 }
+
+wxFileName Workspace::GetSnapshotFileName() const
+{
+    wxFileName fn_snapshot(GetPrivateFolder(), GetWorkspaceFileName().GetFullName());
+    fn_snapshot.SetExt("snapshot");
+    return fn_snapshot;
+}
@@ -318,14 +318,16 @@ public:
      * @brief return the tags database full path
      */
     wxFileName GetTagsFileName() const;
+
+    /**
+     * @brief return the full path of the binary snapshot of the workspace and its projects
+     */
+    wxFileName GetSnapshotFileName() const;
     
 private:
     /**
      * Do the actual add project
-     * \param path project file path
-     * \param errMsg [output] incase an error, report the error to the caller
      */
-    ProjectPtr DoAddProject(const wxString &path, wxString &errMsg);
     ProjectPtr DoAddProject(ProjectPtr proj);
 
     void RemoveProjectFromBuildMatrix(ProjectPtr prj);
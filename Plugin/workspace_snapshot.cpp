@@ -0,0 +1,405 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : workspace_snapshot.cpp
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#include "workspace_snapshot.h"
+#include "wx_xml_compatibility.h"
+#include <wx/ffile.h>
+#include <wx/log.h>
+#include <wx/arrstr.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <string.h>
+
+// Bump this whenever the layout of the snapshot file changes
+#define WORKSPACE_SNAPSHOT_MAGIC   0x53574C43 // "CLWS"
+#define WORKSPACE_SNAPSHOT_VERSION 1
+
+// Documents deeper than this are not restored (protects the recursion
+// against corrupted snapshots)
+#define WORKSPACE_SNAPSHOT_MAX_DEPTH 256
+
+//------------------------------------------------------------------------------
+// Encoding
+//------------------------------------------------------------------------------
+
+static void SnapshotWriteUInt32(wxMemoryBuffer &buffer, wxUint32 value)
+{
+    buffer.AppendData(&value, sizeof(value));
+}
+
+static void SnapshotWriteUInt64(wxMemoryBuffer &buffer, wxUint64 value)
+{
+    buffer.AppendData(&value, sizeof(value));
+}
+
+static void SnapshotWriteString(wxMemoryBuffer &buffer, const wxString &str)
+{
+    const wxCharBuffer utf8 = str.mb_str(wxConvUTF8);
+    const char* data = utf8.data();
+    wxUint32 len = data ? strlen(data) : 0;
+    SnapshotWriteUInt32(buffer, len);
+    if ( len ) {
+        buffer.AppendData(data, len);
+    }
+}
+
+static void SnapshotWriteNode(wxMemoryBuffer &buffer, const wxXmlNode *node)
+{
+    SnapshotWriteUInt32(buffer, node->GetType());
+    SnapshotWriteString(buffer, node->GetName());
+    SnapshotWriteString(buffer, node->GetContent());
+
+    wxUint32 count = 0;
+    for(wxXmlProperty* prop = node->GetProperties(); prop; prop = prop->GetNext()) {
+        ++count;
+    }
+    SnapshotWriteUInt32(buffer, count);
+    for(wxXmlProperty* prop = node->GetProperties(); prop; prop = prop->GetNext()) {
+        SnapshotWriteString(buffer, prop->GetName());
+        SnapshotWriteString(buffer, prop->GetValue());
+    }
+
+    count = 0;
+    for(wxXmlNode* child = node->GetChildren(); child; child = child->GetNext()) {
+        ++count;
+    }
+    SnapshotWriteUInt32(buffer, count);
+    for(wxXmlNode* child = node->GetChildren(); child; child = child->GetNext()) {
+        SnapshotWriteNode(buffer, child);
+    }
+}
+
+//------------------------------------------------------------------------------
+// Decoding. Every read is bounds checked: a truncated or corrupted snapshot
+// must never be trusted
+//------------------------------------------------------------------------------
+
+class SnapshotReader
+{
+    const char* m_data;
+    size_t      m_len;
+    size_t      m_pos;
+
+public:
+    SnapshotReader(const void* data, size_t len)
+        : m_data((const char*)data)
+        , m_len(len)
+        , m_pos(0)
+    {}
+
+    bool AtEnd() const {
+        return m_pos == m_len;
+    }
+
+    bool ReadBytes(void* dest, size_t len) {
+        if ( len > m_len - m_pos ) {
+            return false;
+        }
+        memcpy(dest, m_data + m_pos, len);
+        m_pos += len;
+        return true;
+    }
+
+    bool ReadUInt32(wxUint32 &value) {
+        return ReadBytes(&value, sizeof(value));
+    }
+
+    bool ReadUInt64(wxUint64 &value) {
+        return ReadBytes(&value, sizeof(value));
+    }
+
+    bool ReadString(wxString &str) {
+        wxUint32 len = 0;
+        if ( !ReadUInt32(len) || len > m_len - m_pos ) {
+            return false;
+        }
+        str = len ? wxString(m_data + m_pos, wxConvUTF8, len) : wxString();
+        m_pos += len;
+        return true;
+    }
+
+    bool ReadBuffer(wxMemoryBuffer &buffer) {
+        wxUint32 len = 0;
+        if ( !ReadUInt32(len) || len > m_len - m_pos ) {
+            return false;
+        }
+        buffer.SetDataLen(0);
+        buffer.AppendData(m_data + m_pos, len);
+        m_pos += len;
+        return true;
+    }
+
+    // Return the node read or NULL on error
+    wxXmlNode* ReadNode(size_t depth) {
+        if ( depth > WORKSPACE_SNAPSHOT_MAX_DEPTH ) {
+            return NULL;
+        }
+
+        wxUint32 type = 0;
+        wxString name, content;
+        if ( !ReadUInt32(type) || !ReadString(name) || !ReadString(content) ) {
+            return NULL;
+        }
+
+        wxXmlNode* node = new wxXmlNode((wxXmlNodeType)type, name, content);
+
+        wxUint32 count = 0;
+        if ( !ReadUInt32(count) ) {
+            delete node;
+            return NULL;
+        }
+        for(wxUint32 i=0; i<count; ++i) {
+            wxString propName, propValue;
+            if ( !ReadString(propName) || !ReadString(propValue) ) {
+                delete node;
+                return NULL;
+            }
+            node->AddProperty(propName, propValue);
+        }
+
+        if ( !ReadUInt32(count) ) {
+            delete node;
+            return NULL;
+        }
+
+        // Link the children directly: AddChild() walks the list of children
+        // on every call
+        wxXmlNode* last = NULL;
+        for(wxUint32 i=0; i<count; ++i) {
+            wxXmlNode* child = ReadNode(depth + 1);
+            if ( !child ) {
+                delete node;
+                return NULL;
+            }
+            child->SetParent(node);
+            if ( last ) {
+                last->SetNext(child);
+            } else {
+                node->SetChildren(child);
+            }
+            last = child;
+        }
+        return node;
+    }
+};
+
+//------------------------------------------------------------------------------
+// WorkspaceSnapshot
+//------------------------------------------------------------------------------
+
+WorkspaceSnapshot::WorkspaceSnapshot()
+    : m_modified(false)
+{
+}
+
+WorkspaceSnapshot::~WorkspaceSnapshot()
+{
+}
+
+bool WorkspaceSnapshot::GetFileStat(const wxString& file, time_t& modified, wxULongLong& size)
+{
+    struct stat buff;
+    const wxCharBuffer cname = file.mb_str(wxConvUTF8);
+    if ( stat(cname.data(), &buff) < 0 ) {
+        return false;
+    }
+    modified = buff.st_mtime;
+    size     = (wxULongLong_t)buff.st_size;
+    return true;
+}
+
+void WorkspaceSnapshot::Load(const wxFileName& fn)
+{
+    Clear();
+
+    wxMemoryBuffer content;
+    {
+        wxLogNull nolog;
+        wxFFile file(fn.GetFullPath(), wxT("rb"));
+        if ( !file.IsOpened() ) {
+            return;
+        }
+
+        wxFileOffset len = file.Length();
+        if ( len <= 0 ) {
+            return;
+        }
+
+        void* data = content.GetWriteBuf(len);
+        if ( file.Read(data, len) != (size_t)len ) {
+            return;
+        }
+        content.UngetWriteBuf(len);
+    }
+
+    SnapshotReader reader(content.GetData(), content.GetDataLen());
+    wxUint32 magic = 0, version = 0, count = 0;
+    if ( !reader.ReadUInt32(magic) || magic != WORKSPACE_SNAPSHOT_MAGIC ) {
+        return;
+    }
+    if ( !reader.ReadUInt32(version) || version != WORKSPACE_SNAPSHOT_VERSION ) {
+        return;
+    }
+    if ( !reader.ReadUInt32(count) ) {
+        return;
+    }
+
+    EntryMap_t entries;
+    for(wxUint32 i=0; i<count; ++i) {
+        wxString file;
+        wxUint64 modified = 0, size = 0;
+        if ( !reader.ReadString(file) || !reader.ReadUInt64(modified) || !reader.ReadUInt64(size) ) {
+            return;
+        }
+
+        Entry& entry = entries[file];
+        entry.m_modified = (time_t)modified;
+        entry.m_size     = size;
+        if ( !reader.ReadBuffer(entry.m_data) ) {
+            return;
+        }
+    }
+
+    if ( reader.AtEnd() ) {
+        m_entries.swap(entries);
+    }
+}
+
+bool WorkspaceSnapshot::Save(const wxFileName& fn)
+{
+    if ( !m_modified ) {
+        return true;
+    }
+
+    wxMemoryBuffer content;
+    SnapshotWriteUInt32(content, WORKSPACE_SNAPSHOT_MAGIC);
+    SnapshotWriteUInt32(content, WORKSPACE_SNAPSHOT_VERSION);
+    SnapshotWriteUInt32(content, m_entries.size());
+
+    EntryMap_t::const_iterator iter = m_entries.begin();
+    for(; iter != m_entries.end(); ++iter) {
+        const Entry& entry = iter->second;
+        SnapshotWriteString(content, iter->first);
+        SnapshotWriteUInt64(content, (wxUint64)entry.m_modified);
+        SnapshotWriteUInt64(content, entry.m_size.GetValue());
+        SnapshotWriteUInt32(content, entry.m_data.GetDataLen());
+        content.AppendData(entry.m_data.GetData(), entry.m_data.GetDataLen());
+    }
+
+    // Write to a temporary file first: a crash while writing must not leave
+    // a truncated snapshot behind
+    wxString tmpfile = fn.GetFullPath() + wxT(".tmp");
+    {
+        wxLogNull nolog;
+        wxFFile file(tmpfile, wxT("w+b"));
+        if ( !file.IsOpened() ) {
+            return false;
+        }
+
+        if ( file.Write(content.GetData(), content.GetDataLen()) != content.GetDataLen() ) {
+            file.Close();
+            ::wxRemoveFile(tmpfile);
+            return false;
+        }
+        file.Close();
+
+        if ( !::wxRenameFile(tmpfile, fn.GetFullPath(), true) ) {
+            ::wxRemoveFile(tmpfile);
+            return false;
+        }
+    }
+
+    m_modified = false;
+    return true;
+}
+
+bool WorkspaceSnapshot::GetDocument(const wxString& file, wxXmlDocument& doc) const
+{
+    EntryMap_t::const_iterator iter = m_entries.find(file);
+    if ( iter == m_entries.end() ) {
+        return false;
+    }
+
+    const Entry& entry = iter->second;
+    time_t modified;
+    wxULongLong size;
+    if ( !GetFileStat(file, modified, size) || modified != entry.m_modified || size != entry.m_size ) {
+        return false;
+    }
+
+    SnapshotReader reader(entry.m_data.GetData(), entry.m_data.GetDataLen());
+    wxString version, encoding;
+    if ( !reader.ReadString(version) || !reader.ReadString(encoding) ) {
+        return false;
+    }
+
+    wxXmlNode* root = reader.ReadNode(0);
+    if ( !root ) {
+        return false;
+    }
+
+    if ( !reader.AtEnd() ) {
+        delete root;
+        return false;
+    }
+
+    doc.SetVersion(version);
+    doc.SetFileEncoding(encoding);
+    doc.SetRoot(root);
+    return true;
+}
+
+void WorkspaceSnapshot::SetDocument(const wxString& file, const wxXmlDocument& doc)
+{
+    if ( !doc.IsOk() ) {
+        return;
+    }
+
+    Entry entry;
+    if ( !GetFileStat(file, entry.m_modified, entry.m_size) ) {
+        return;
+    }
+
+    SnapshotWriteString(entry.m_data, doc.GetVersion());
+    SnapshotWriteString(entry.m_data, doc.GetFileEncoding());
+    SnapshotWriteNode(entry.m_data, doc.GetRoot());
+
+    m_entries[file] = entry;
+    m_modified = true;
+}
+
+void WorkspaceSnapshot::Prune(const wxArrayString& files)
+{
+    EntryMap_t::iterator iter = m_entries.begin();
+    while ( iter != m_entries.end() ) {
+        if ( files.Index(iter->first) == wxNOT_FOUND ) {
+            m_entries.erase(iter++);
+            m_modified = true;
+
+        } else {
+            ++iter;
+        }
+    }
+}
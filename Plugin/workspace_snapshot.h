@@ -0,0 +1,97 @@
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+//
+// copyright            : (C) 2013 by Eran Ifrah
+// file name            : workspace_snapshot.h
+//
+// -------------------------------------------------------------------------
+// A
+//              _____           _      _     _ _
+//             /  __ \         | |    | |   (_) |
+//             | /  \/ ___   __| | ___| |    _| |_ ___
+//             | |    / _ \ / _  |/ _ \ |   | | __/ _ )
+//             | \__/\ (_) | (_| |  __/ |___| | ||  __/
+//              \____/\___/ \__,_|\___\_____/_|\__\___|
+//
+//                                                  F i l e
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef WORKSPACESNAPSHOT_H
+#define WORKSPACESNAPSHOT_H
+
+#include "codelite_exports.h"
+#include <wx/string.h>
+#include <wx/filename.h>
+#include <wx/buffer.h>
+#include <wx/xml/xml.h>
+#include <map>
+
+/**
+ * @class WorkspaceSnapshot
+ * @brief a binary cache of the parsed workspace and project files, kept in the
+ * workspace private folder. Restoring a document from the snapshot is much cheaper
+ * than parsing its XML file. An entry is used only if the file it was created from
+ * still has the same size and modification time
+ */
+class WXDLLIMPEXP_SDK WorkspaceSnapshot
+{
+    struct Entry {
+        time_t         m_modified;
+        wxULongLong    m_size;
+        wxMemoryBuffer m_data;
+    };
+    typedef std::map<wxString, Entry> EntryMap_t;
+
+    EntryMap_t m_entries;
+    bool       m_modified;
+
+protected:
+    static bool GetFileStat(const wxString &file, time_t &modified, wxULongLong &size);
+
+public:
+    WorkspaceSnapshot();
+    virtual ~WorkspaceSnapshot();
+
+    /**
+     * @brief load the snapshot from 'fn'. A missing, corrupted or outdated snapshot file
+     * leaves the snapshot empty
+     */
+    void Load(const wxFileName &fn);
+
+    /**
+     * @brief write the snapshot to 'fn' if it was modified since it was loaded
+     */
+    bool Save(const wxFileName &fn);
+
+    /**
+     * @brief restore the document parsed from 'file' (a full path) into 'doc'
+     * @return false if the snapshot has no up-to-date entry for 'file'. 'doc' is
+     * not modified in that case
+     * @note this method is const and can be called from several threads at the same time
+     */
+    bool GetDocument(const wxString &file, wxXmlDocument &doc) const;
+
+    /**
+     * @brief store the document just parsed from 'file' (a full path)
+     */
+    void SetDocument(const wxString &file, const wxXmlDocument &doc);
+
+    /**
+     * @brief remove the entries of files that are not part of 'files' (full paths)
+     */
+    void Prune(const wxArrayString &files);
+
+    void Clear() {
+        m_entries.clear();
+        m_modified = false;
+    }
+};
+
+#endif // WORKSPACESNAPSHOT_H
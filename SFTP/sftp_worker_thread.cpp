@@ -84,8 +84,8 @@ void SFTPWorkerThread::ProcessRequest(ThreadRequest* request)
             DoReportStatusBarMessage(msg);
             m_sftp.reset(NULL);
 
-            // Requeue our request
-            if ( req->GetRetryCounter() == 0 ) {
+            // Requeue our request, unless a newer upload of the same file is already queued
+            if ( req->GetRetryCounter() == 0 && !req->IsCancelled() ) {
                 msg.Clear();
                 msg << "Retrying to upload file: " << req->GetRemoteFile();
                 DoReportMessage(req->GetAccount().GetAccountName(), msg, SFTPThreadMessage::STATUS_NONE);
@@ -162,6 +162,8 @@ SFTPThreadRequet::SFTPThreadRequet(const SSHAccountInfo& accountInfo, const wxSt
     , m_uploadSuccess(false)
     , m_direction(kUpload)
 {
+    // Only the latest content of a file needs to be uploaded
+    SetCoalescingKey(wxString() << "upload:" << accountInfo.GetAccountName() << ":" << remoteFile);
 }
 
 SFTPThreadRequet::SFTPThreadRequet(const RemoteFileInfo& remoteFile)
@@ -183,6 +185,7 @@ SFTPThreadRequet::SFTPThreadRequet(const SFTPThreadRequet& other)
 
 SFTPThreadRequet& SFTPThreadRequet::operator=(const SFTPThreadRequet& other)
 {
+    ThreadRequest::operator=(other);
     m_account       = other.m_account;
     m_remoteFile    = other.m_remoteFile;
     m_localFile     = other.m_localFile;
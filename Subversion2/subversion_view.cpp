@@ -24,6 +24,8 @@
 #include "fileextmanager.h"
 #include "svnsettingsdata.h"
 #include "svnstatushandler.h"
+#include "svnstatusjob.h"
+#include "jobqueue.h"
 #include <wx/wupdlock.h>
 #include "subversion_strings.h"
 #include "subversion_view.h"
@@ -84,12 +86,42 @@ static int PROJECT_IMG_ID     = wxNOT_FOUND;
 static int WORKSPACE_IMG_ID   = wxNOT_FOUND;
 static int LOCKED_IMG_ID      = wxNOT_FOUND;
 
+// The status bit that places a file under each of the tree top level nodes
+struct SvnStatusCategory {
+    size_t                   flag;
+    SvnTreeData::SvnNodeType nodeType;
+};
+
+static const SvnStatusCategory SVN_STATUS_CATEGORIES[] = {
+    { SvnFileStatusModified,    SvnTreeData::SvnNodeTypeModifiedRoot    },
+    { SvnFileStatusNew,         SvnTreeData::SvnNodeTypeAddedRoot       },
+    { SvnFileStatusDeleted,     SvnTreeData::SvnNodeTypeDeletedRoot     },
+    { SvnFileStatusConflicted,  SvnTreeData::SvnNodeTypeConflictRoot    },
+    { SvnFileStatusLocked,      SvnTreeData::SvnNodeTypeLockedRoot      },
+    { SvnFileStatusUnversioned, SvnTreeData::SvnNodeTypeUnversionedRoot },
+};
+
+static const size_t SVN_STATUS_CATEGORIES_COUNT = sizeof(SVN_STATUS_CATEGORIES) / sizeof(SVN_STATUS_CATEGORIES[0]);
+
+static wxArrayString DoGetFilesByStatus(const SvnStatusMap_t& status, size_t flag)
+{
+    wxArrayString files;
+    SvnStatusMap_t::const_iterator iter = status.begin();
+    for(; iter != status.end(); ++iter) {
+        if ( iter->second & flag ) {
+            files.Add(iter->first);
+        }
+    }
+    return files;
+}
+
 SubversionView::SubversionView( wxWindow* parent, Subversion2 *plugin )
     : SubversionPageBase( parent )
     , m_plugin          ( plugin )
     , m_simpleCommand   ( plugin )
     , m_diffCommand     ( plugin )
     , m_fileExplorerLastBaseImgIdx (-1)
+    , m_statusJobId     (0)
 {
     CreatGUIControls();
     m_themeHelper = new ThemeHandlerHelper(this);
@@ -99,10 +131,13 @@ SubversionView::SubversionView( wxWindow* parent, Subversion2 *plugin )
     EventNotifier::Get()->Connect(wxEVT_PROJ_FILE_ADDED,             clCommandEventHandler(SubversionView::OnFileAdded  ),               NULL, this);
     EventNotifier::Get()->Connect(wxEVT_FILE_RENAMED,                wxCommandEventHandler(SubversionView::OnFileRenamed),               NULL, this);
     EventNotifier::Get()->Connect(wxEVT_ACTIVE_EDITOR_CHANGED,       wxCommandEventHandler(SubversionView::OnActiveEditorChanged),       NULL, this);
+    Connect(wxEVT_CMD_JOB_STATUS_VOID_PTR, wxCommandEventHandler(SubversionView::OnStatusJobDone), NULL, this);
 }
 
 SubversionView::~SubversionView()
 {
+    // A status job still running would post its result to this view
+    m_plugin->GetManager()->GetJobQueue()->Cancel(SVN_STATUS_JOB_KEY);
     wxDELETE(m_themeHelper);
     DisconnectEvents();
 }
@@ -278,40 +313,60 @@ void SubversionView::OnWorkspaceClosed(wxCommandEvent& event)
 void SubversionView::ClearAll()
 {
     m_treeCtrl->DeleteAllItems();
+    m_status.clear();
+    m_statusRootDir.Clear();
 }
 
-void SubversionView::UpdateTree(const wxArrayString& modifiedFiles, const wxArrayString& conflictedFiles, const wxArrayString& unversionedFiles, const wxArrayString& newFiles, const wxArrayString& deletedFiles, const wxArrayString& lockedFiles, const wxArrayString& ignoreFiles, bool fileExplorerOnly, const wxString& sRootDir)
+void SubversionView::OnStatusJobDone(wxCommandEvent& event)
+{
+    SvnStatusJobResult* result = reinterpret_cast<SvnStatusJobResult*>(event.GetClientData());
+    if ( !result )
+        return;
+
+    // Results of an outdated 'svn status' are discarded
+    if ( result->m_id == m_statusJobId ) {
+        UpdateTree(result->m_status, result->m_fileExplorerOnly, result->m_rootDir);
+    }
+    delete result;
+}
+
+void SubversionView::UpdateTree(const SvnStatusMap_t& status, bool fileExplorerOnly, const wxString& sRootDir)
 {
     wxString rootDir = sRootDir;
     if(rootDir.IsEmpty())
         rootDir = DoGetCurRepoPath();
 
-    if( !fileExplorerOnly ) {
+    bool unchanged = m_treeCtrl->GetRootItem().IsOk() && rootDir == m_statusRootDir && status == m_status;
+    if( !fileExplorerOnly && !unchanged ) {
 
 #ifdef __WXMSW__
         wxWindowUpdateLocker locker(m_treeCtrl);
 #else
         clWindowUpdateLocker locker( m_treeCtrl );
 #endif
-        ClearAll();
+        if ( !DoUpdateTreeIncremental(status, rootDir) ) {
+            ClearAll();
 
-        // Add root node
-        wxTreeItemId root = m_treeCtrl->AddRoot(rootDir, FOLDER_IMG_ID, FOLDER_IMG_ID, new SvnTreeData(SvnTreeData::SvnNodeTypeRoot, rootDir));
+            // Add root node
+            wxTreeItemId root = m_treeCtrl->AddRoot(rootDir, FOLDER_IMG_ID, FOLDER_IMG_ID, new SvnTreeData(SvnTreeData::SvnNodeTypeRoot, rootDir));
 
-        if(root.IsOk() == false)
-            return;
+            if(root.IsOk() == false)
+                return;
 
-        DoAddNode(svnMODIFIED_FILES,    MODIFIED_IMG_ID,    SvnTreeData::SvnNodeTypeModifiedRoot,    modifiedFiles);
-        DoAddNode(svnADDED_FILES,       NEW_IMG_ID,         SvnTreeData::SvnNodeTypeAddedRoot,       newFiles);
-        DoAddNode(svnDELETED_FILES,     DELETED_IMG_ID,     SvnTreeData::SvnNodeTypeDeletedRoot,     deletedFiles);
-        DoAddNode(svnCONFLICTED_FILES,  CONFLICT_IMG_ID,    SvnTreeData::SvnNodeTypeConflictRoot,    conflictedFiles);
-        DoAddNode(svnLOCKED_FILES,      LOCKED_IMG_ID,      SvnTreeData::SvnNodeTypeLockedRoot,      lockedFiles);
-        DoAddNode(svnUNVERSIONED_FILES, UNVERSIONED_IMG_ID, SvnTreeData::SvnNodeTypeUnversionedRoot, unversionedFiles);
+            DoAddNode(svnMODIFIED_FILES,    MODIFIED_IMG_ID,    SvnTreeData::SvnNodeTypeModifiedRoot,    DoGetFilesByStatus(status, SvnFileStatusModified));
+            DoAddNode(svnADDED_FILES,       NEW_IMG_ID,         SvnTreeData::SvnNodeTypeAddedRoot,       DoGetFilesByStatus(status, SvnFileStatusNew));
+            DoAddNode(svnDELETED_FILES,     DELETED_IMG_ID,     SvnTreeData::SvnNodeTypeDeletedRoot,     DoGetFilesByStatus(status, SvnFileStatusDeleted));
+            DoAddNode(svnCONFLICTED_FILES,  CONFLICT_IMG_ID,    SvnTreeData::SvnNodeTypeConflictRoot,    DoGetFilesByStatus(status, SvnFileStatusConflicted));
+            DoAddNode(svnLOCKED_FILES,      LOCKED_IMG_ID,      SvnTreeData::SvnNodeTypeLockedRoot,      DoGetFilesByStatus(status, SvnFileStatusLocked));
+            DoAddNode(svnUNVERSIONED_FILES, UNVERSIONED_IMG_ID, SvnTreeData::SvnNodeTypeUnversionedRoot, DoGetFilesByStatus(status, SvnFileStatusUnversioned));
 
-        if (m_treeCtrl->ItemHasChildren(root)) {
-            m_treeCtrl->Expand(root);
+            if (m_treeCtrl->ItemHasChildren(root)) {
+                m_treeCtrl->Expand(root);
+            }
         }
 
+        m_status        = status;
+        m_statusRootDir = rootDir;
         DoLinkEditor();
     }
 
@@ -370,13 +425,7 @@ void SubversionView::DoAddNode(const wxString& title, int imgId, SvnTreeData::Sv
 
         // Add all children items
         for (size_t i=0; i<files.GetCount(); i++) {
-            wxFileName filename(files.Item(i));
-            wxTreeItemId folderParent = DoGetParentNode(files.Item(i), parent);
-            m_treeCtrl->AppendItem(folderParent,
-                                   filename.GetFullName(),
-                                   DoGetIconIndex(filename.GetFullName()),
-                                   DoGetIconIndex(filename.GetFullName()),
-                                   new SvnTreeData(SvnTreeData::SvnNodeTypeFile, files.Item(i)));
+            DoAddFileNode(parent, files.Item(i));
         }
 
         if ( nodeType != SvnTreeData::SvnNodeTypeUnversionedRoot) {
@@ -396,6 +445,130 @@ void SubversionView::DoAddNode(const wxString& title, int imgId, SvnTreeData::Sv
     }
 }
 
+void SubversionView::DoAddFileNode(const wxTreeItemId& parent, const wxString& filepath)
+{
+    wxFileName filename(filepath);
+    wxTreeItemId folderParent = DoGetParentNode(filepath, parent);
+    DoInsertSorted(folderParent,
+                   filename.GetFullName(),
+                   DoGetIconIndex(filename.GetFullName()),
+                   new SvnTreeData(SvnTreeData::SvnNodeTypeFile, filepath));
+}
+
+wxString SubversionView::DoGetSortKey(const wxTreeItemId& item)
+{
+    // Folders sort like the paths of the files they contain ("dir/")
+    wxString key = m_treeCtrl->GetItemText(item);
+    SvnTreeData* data = (SvnTreeData*)m_treeCtrl->GetItemData(item);
+    if ( data && data->GetType() == SvnTreeData::SvnNodeTypeFolder ) {
+        key << wxT("/");
+    }
+    return key;
+}
+
+wxTreeItemId SubversionView::DoInsertSorted(const wxTreeItemId& parent, const wxString& text, int imgId, SvnTreeData* data)
+{
+    // Keep the children in the order of the status map (sorted by path), the order the
+    // tree has when it is built from scratch. The files are then added in order: check
+    // the last child first so building the whole tree does not scan the children
+    wxString key = text;
+    if ( data->GetType() == SvnTreeData::SvnNodeTypeFolder ) {
+        key << wxT("/");
+    }
+
+    wxTreeItemId last = m_treeCtrl->GetLastChild(parent);
+    if ( !last.IsOk() || DoGetSortKey(last) < key ) {
+        return m_treeCtrl->AppendItem(parent, text, imgId, imgId, data);
+    }
+
+    size_t pos = 0;
+    wxTreeItemIdValue cookie;
+    wxTreeItemId child = m_treeCtrl->GetFirstChild(parent, cookie);
+    while ( child.IsOk() && DoGetSortKey(child) < key ) {
+        ++pos;
+        child = m_treeCtrl->GetNextChild(parent, cookie);
+    }
+    return m_treeCtrl->InsertItem(parent, pos, text, imgId, imgId, data);
+}
+
+void SubversionView::DoDeleteFileNode(const wxTreeItemId& categoryRoot, const wxTreeItemId& item)
+{
+    wxTreeItemId parent = m_treeCtrl->GetItemParent(item);
+    m_treeCtrl->Delete(item);
+
+    // Remove the folder nodes that were left empty
+    while ( parent.IsOk() && parent != categoryRoot && m_treeCtrl->GetChildrenCount(parent, false) == 0 ) {
+        wxTreeItemId grandParent = m_treeCtrl->GetItemParent(parent);
+        m_treeCtrl->Delete(parent);
+        parent = grandParent;
+    }
+}
+
+bool SubversionView::DoUpdateTreeIncremental(const SvnStatusMap_t& status, const wxString& rootDir)
+{
+    if ( !m_treeCtrl->GetRootItem().IsOk() || rootDir != m_statusRootDir )
+        return false;
+
+    size_t allFlags = 0;
+    SvnStatusMap_t::const_iterator iter = status.begin();
+    for(; iter != status.end(); ++iter) {
+        allFlags |= iter->second;
+    }
+
+    // A top level node that appears or disappears changes the tree layout: let the caller rebuild it
+    wxTreeItemId categoryRoots[SVN_STATUS_CATEGORIES_COUNT];
+    for(size_t i=0; i<SVN_STATUS_CATEGORIES_COUNT; ++i) {
+        categoryRoots[i] = DoFindCategoryRoot(SVN_STATUS_CATEGORIES[i].nodeType);
+        bool hasFiles = (allFlags & SVN_STATUS_CATEGORIES[i].flag) != 0;
+        if ( categoryRoots[i].IsOk() != hasFiles )
+            return false;
+    }
+
+    // Both maps are sorted by path: walk them side by side and only touch the files whose status changed
+    SvnStatusMap_t::const_iterator oldIter = m_status.begin();
+    SvnStatusMap_t::const_iterator newIter = status.begin();
+    while ( oldIter != m_status.end() || newIter != status.end() ) {
+        wxString filepath;
+        size_t   oldFlags = 0;
+        size_t   newFlags = 0;
+        if ( newIter == status.end() || (oldIter != m_status.end() && oldIter->first < newIter->first) ) {
+            filepath = oldIter->first;
+            oldFlags = oldIter->second;
+            ++oldIter;
+
+        } else if ( oldIter == m_status.end() || newIter->first < oldIter->first ) {
+            filepath = newIter->first;
+            newFlags = newIter->second;
+            ++newIter;
+
+        } else {
+            filepath = newIter->first;
+            oldFlags = oldIter->second;
+            newFlags = newIter->second;
+            ++oldIter;
+            ++newIter;
+        }
+
+        if ( oldFlags == newFlags )
+            continue;
+
+        for(size_t i=0; i<SVN_STATUS_CATEGORIES_COUNT; ++i) {
+            bool had = (oldFlags & SVN_STATUS_CATEGORIES[i].flag) != 0;
+            bool has = (newFlags & SVN_STATUS_CATEGORIES[i].flag) != 0;
+            if ( had && !has ) {
+                wxTreeItemId item = DoFindFileNode(categoryRoots[i], filepath);
+                if ( item.IsOk() ) {
+                    DoDeleteFileNode(categoryRoots[i], item);
+                }
+
+            } else if ( !had && has ) {
+                DoAddFileNode(categoryRoots[i], filepath);
+            }
+        }
+    }
+    return true;
+}
+
 int SubversionView::DoGetIconIndex(const wxString& filename)
 {
     FileExtManager::Init();
@@ -1121,6 +1294,7 @@ void SubversionView::DisconnectEvents()
     EventNotifier::Get()->Disconnect(wxEVT_PROJ_FILE_ADDED,  clCommandEventHandler(SubversionView::OnFileAdded),                NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_FILE_RENAMED,     wxCommandEventHandler(SubversionView::OnFileRenamed),              NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_ACTIVE_EDITOR_CHANGED, wxCommandEventHandler(SubversionView::OnActiveEditorChanged), NULL, this);
+    Disconnect(wxEVT_CMD_JOB_STATUS_VOID_PTR, wxCommandEventHandler(SubversionView::OnStatusJobDone), NULL, this);
 }
 
 void SubversionView::OnOpenFile(wxCommandEvent& event)
@@ -1258,11 +1432,10 @@ wxTreeItemId SubversionView::DoFindChild(const wxTreeItemId& parent, const wxStr
         child = m_treeCtrl->GetNextChild(parent, cookie);
     }
     // if we reached here, we did not find a tree node for this name
-    return m_treeCtrl->AppendItem(parent, // parent node
-                                  name,   // text
-                                  FOLDER_IMG_ID,      // folder icon
-                                  FOLDER_IMG_ID,
-                                  new SvnTreeData(SvnTreeData::SvnNodeTypeFolder, curpath));
+    return DoInsertSorted(parent, // parent node
+                          name,   // text
+                          FOLDER_IMG_ID, // folder icon
+                          new SvnTreeData(SvnTreeData::SvnNodeTypeFolder, curpath));
 }
 
 void SubversionView::OnRename(wxCommandEvent& event)
@@ -1284,6 +1457,52 @@ wxString SubversionView::DoGetCurRepoPath() const
     return m_curpath;
 }
 
+wxTreeItemId SubversionView::DoFindExistingChild(const wxTreeItemId& parent, const wxString& name)
+{
+    wxTreeItemIdValue cookie;
+    wxTreeItemId child = m_treeCtrl->GetFirstChild(parent, cookie);
+    while( child.IsOk() ) {
+        if(m_treeCtrl->GetItemText(child) == name) {
+            return child;
+        }
+        child = m_treeCtrl->GetNextChild(parent, cookie);
+    }
+    return wxTreeItemId();
+}
+
+wxTreeItemId SubversionView::DoFindFileNode(const wxTreeItemId& categoryRoot, const wxString& filepath)
+{
+    // Follow the path components instead of scanning the whole category
+    wxFileName fn(filepath);
+    wxArrayString dirs = fn.GetDirs();
+    wxTreeItemId node = categoryRoot;
+    for(size_t i=0; i<dirs.GetCount() && node.IsOk(); i++) {
+        node = DoFindExistingChild(node, dirs.Item(i));
+    }
+
+    if ( !node.IsOk() )
+        return node;
+    return DoFindExistingChild(node, fn.GetFullName());
+}
+
+wxTreeItemId SubversionView::DoFindCategoryRoot(SvnTreeData::SvnNodeType nodeType)
+{
+    wxTreeItemId root = m_treeCtrl->GetRootItem();
+    if ( !root.IsOk() )
+        return wxTreeItemId();
+
+    wxTreeItemIdValue cookie;
+    wxTreeItemId child = m_treeCtrl->GetFirstChild(root, cookie);
+    while( child.IsOk() ) {
+        SvnTreeData* data = static_cast<SvnTreeData*>(m_treeCtrl->GetItemData(child));
+        if ( data && data->GetType() == nodeType ) {
+            return child;
+        }
+        child = m_treeCtrl->GetNextChild(root, cookie);
+    }
+    return wxTreeItemId();
+}
+
 wxTreeItemId SubversionView::DoFindFile(const wxTreeItemId& parent, const wxString &basepath, const wxString& fullpath)
 {
     if(parent.IsOk() == false) {
@@ -35,6 +35,7 @@ Subclass of SubversionPageBase, which is generated by wxFormBuilder.
 #include "svninfo.h"
 #include "svncommand.h"
 #include "svntreedata.h"
+#include "svnxml.h"
 #include "svn_console.h"
 #include "theme_handler_helper.h"
 #include "cl_command_event.h"
@@ -72,6 +73,9 @@ class SubversionView : public SubversionPageBase
     int                  m_fileExplorerLastBaseImgIdx;
     ThemeHandlerHelper*  m_themeHelper;
     wxFileName           m_workspaceFile;
+    SvnStatusMap_t       m_status;
+    wxString             m_statusRootDir;
+    int                  m_statusJobId;
     
 public:
     enum {
@@ -84,6 +88,11 @@ protected:
     void                     CreatGUIControls();
     void                     ClearAll();
     void                     DoAddNode(const wxString &title, int imgId, SvnTreeData::SvnNodeType nodeType, const wxArrayString &files);
+    void                     DoAddFileNode(const wxTreeItemId& parent, const wxString &filepath);
+    wxTreeItemId             DoInsertSorted(const wxTreeItemId& parent, const wxString &text, int imgId, SvnTreeData* data);
+    wxString                 DoGetSortKey(const wxTreeItemId& item);
+    void                     DoDeleteFileNode(const wxTreeItemId& categoryRoot, const wxTreeItemId& item);
+    bool                     DoUpdateTreeIncremental(const SvnStatusMap_t& status, const wxString &rootDir);
     int                      DoGetIconIndex(const wxString &filename);
     SvnTreeData::SvnNodeType DoGetSelectionType(const wxArrayTreeItemIds &items);
     void                     DoGetPaths(const wxTreeItemId &parent, wxArrayString &paths);
@@ -101,6 +110,9 @@ protected:
     wxTreeItemId DoGetParentNode     (const wxString &filename, const wxTreeItemId& parent);
     wxTreeItemId DoFindChild         (const wxTreeItemId& parent, const wxString &name, const wxString &curpath);
     wxTreeItemId DoFindFile          (const wxTreeItemId& parent, const wxString &basepath, const wxString& fullpath);
+    wxTreeItemId DoFindExistingChild (const wxTreeItemId& parent, const wxString &name);
+    wxTreeItemId DoFindFileNode      (const wxTreeItemId& categoryRoot, const wxString &filepath);
+    wxTreeItemId DoFindCategoryRoot  (SvnTreeData::SvnNodeType nodeType);
 
 protected:
     // Handlers for SubversionPageBase events.
@@ -118,6 +130,7 @@ protected:
     void OnSettings           (wxCommandEvent &event);
     void OnActiveEditorChanged(wxCommandEvent &event);
     void OnOpenFile           (wxCommandEvent &event);
+    void OnStatusJobDone      (wxCommandEvent &event);
 
     // Svn events
     void OnCommit             (wxCommandEvent &event);
@@ -160,15 +173,17 @@ public:
         return m_subversionConsole;
     }
     void     DisconnectEvents();
-    void     UpdateTree(const wxArrayString& modifiedFiles,
-                        const wxArrayString &conflictedFiles,
-                        const wxArrayString &unversionedFiles,
-                        const wxArrayString& newFiles,
-                        const wxArrayString& deletedFiles,
-                        const wxArrayString& lockedFiles,
-                        const wxArrayString& ignoreFiles,
+    void     UpdateTree(const SvnStatusMap_t& status,
                         bool fileExplorerOnly,
                         const wxString &rootDir);
+
+    /**
+     * @brief return a new id for a 'svn status' parsing job. Only the result
+     * of the most recent job is applied to the tree
+     */
+    int      NewStatusJobId() {
+        return ++m_statusJobId;
+    }
     void     BuildTree();
     void     BuildTree(const wxString &root);
     void     BuildExplorerTree(const wxString &root);
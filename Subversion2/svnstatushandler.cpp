@@ -2,7 +2,9 @@
 #include "svn_console.h"
 #include "subversion_view.h"
 #include "subversion2.h"
-#include "svnxml.h"
+#include "svnstatusjob.h"
+#include "jobqueue.h"
+#include "imanager.h"
 
 SvnStatusHandler::SvnStatusHandler(Subversion2 *plugin, int commandId, wxEvtHandler *owner, bool fileExplorerOnly, const wxString &rootDir)
 	: SvnCommandHandler(plugin, commandId, owner)
@@ -17,15 +19,8 @@ SvnStatusHandler::~SvnStatusHandler()
 
 void SvnStatusHandler::Process(const wxString& output)
 {
-	wxArrayString modFiles, conflictedFiles, unversionedFiles, newFiles, deletedFiles, lockedFiles, ignoredFiles;
-	SvnXML::GetFiles(output, modFiles, conflictedFiles, unversionedFiles, newFiles, deletedFiles, lockedFiles, ignoredFiles);
-
-	modFiles.Sort();
-	conflictedFiles.Sort();
-	unversionedFiles.Sort();
-	newFiles.Sort();
-	deletedFiles.Sort();
-	lockedFiles.Sort();
-	ignoredFiles.Sort();
-	GetPlugin()->GetSvnView()->UpdateTree(modFiles, conflictedFiles, unversionedFiles, newFiles, deletedFiles, lockedFiles, ignoredFiles, m_fileExplorerOnly, m_rootDir);
+	// The output can be tens of MBs for large working copies, parse it in the background.
+	// The view is notified once the status map is ready
+	SubversionView* view = GetPlugin()->GetSvnView();
+	GetPlugin()->GetManager()->GetJobQueue()->PushJob(new SvnStatusJob(view, view->NewStatusJobId(), output, m_fileExplorerOnly, m_rootDir));
 }
@@ -0,0 +1,38 @@
+#include "svnstatusjob.h"
+
+SvnStatusJob::SvnStatusJob(wxEvtHandler* parent, int id, const wxString& output, bool fileExplorerOnly, const wxString& rootDir)
+    : Job(parent)
+    , m_id(id)
+    , m_output(output.c_str()) // make sure we don't share the string buffer with the main thread
+    , m_fileExplorerOnly(fileExplorerOnly)
+    , m_rootDir(rootDir.c_str())
+{
+    SetCoalescingKey(SVN_STATUS_JOB_KEY);
+}
+
+SvnStatusJob::~SvnStatusJob()
+{
+}
+
+void SvnStatusJob::Process(wxThread* thread)
+{
+    wxUnusedVar(thread);
+
+    SvnStatusJobResult* result = new SvnStatusJobResult();
+    result->m_id               = m_id;
+    result->m_fileExplorerOnly = m_fileExplorerOnly;
+    result->m_rootDir          = m_rootDir;
+    SvnXML::GetFilesStatus(m_output, result->m_status);
+
+    // the output can be large, release it as soon as possible
+    m_output.Clear();
+
+    // Cancel() takes the same lock: once it returned (e.g. the view is being
+    // destroyed), nothing is posted to the parent anymore
+    wxCriticalSectionLocker locker(m_cancelledLock);
+    if ( m_cancelled ) {
+        delete result;
+        return;
+    }
+    Post(result);
+}
@@ -0,0 +1,44 @@
+#ifndef SVNSTATUSJOB_H
+#define SVNSTATUSJOB_H
+
+#include "job.h" // Base class: Job
+#include "svnxml.h"
+
+// The coalescing key of the status jobs: a newer 'svn status' supersedes the
+// one being parsed, and the view cancels them before it is destroyed
+#define SVN_STATUS_JOB_KEY wxT("svn_status")
+
+/**
+ * @brief the result of a SvnStatusJob, posted to the parent as the client data
+ * of a wxEVT_CMD_JOB_STATUS_VOID_PTR event. The receiver must delete it
+ */
+struct SvnStatusJobResult
+{
+    int            m_id;
+    bool           m_fileExplorerOnly;
+    wxString       m_rootDir;
+    SvnStatusMap_t m_status;
+
+    SvnStatusJobResult() : m_id(wxNOT_FOUND), m_fileExplorerOnly(false) {}
+};
+
+/**
+ * @class SvnStatusJob
+ * @brief parse the output of 'svn status' on a worker thread
+ */
+class SvnStatusJob : public Job
+{
+    int      m_id;
+    wxString m_output;
+    bool     m_fileExplorerOnly;
+    wxString m_rootDir;
+
+public:
+    SvnStatusJob(wxEvtHandler* parent, int id, const wxString& output, bool fileExplorerOnly, const wxString& rootDir);
+    virtual ~SvnStatusJob();
+
+public:
+    virtual void Process(wxThread* thread);
+};
+
+#endif // SVNSTATUSJOB_H
@@ -39,14 +39,7 @@ SvnXML::~SvnXML()
 {
 }
 
-void SvnXML::GetFiles(const wxString &input,
-					  wxArrayString  &modifiedFiles,
-					  wxArrayString  &conflictedFiles,
-					  wxArrayString  &unversionedFiles,
-					  wxArrayString  &newFiles,
-					  wxArrayString  &deletedFiles,
-					  wxArrayString  &lockedFiles,
-					  wxArrayString  &ignoredFiles)
+void SvnXML::GetFilesStatus(const wxString& input, SvnStatusMap_t& status)
 {
 	// First column information:
 	//
@@ -73,51 +66,85 @@ void SvnXML::GetFiles(const wxString &input,
     //  'T' locked in repository, lock token present but sTolen
     //  'B' not locked in repository, lock token present but Broken
 	//
-	wxArrayString lines = wxStringTokenize(input, wxT("\n\r"), wxTOKEN_STRTOK);
-	for(size_t i=0; i<lines.GetCount(); i++) {
-		wxString statusLine = lines.Item(i).Trim();
-		if(statusLine.Len() < 7) {
-			continue;
+	size_t start = 0;
+	size_t len   = input.length();
+	while ( start < len ) {
+		size_t end = input.find_first_of(wxT("\r\n"), start);
+		if ( end == wxString::npos ) {
+			end = len;
 		}
-		
-		wxString filename = statusLine.Mid(7);
-		filename.Trim().Trim(false);
 
-		wxChar ch1 = statusLine.GetChar(0);
-		wxChar ch6 = statusLine.GetChar(5);
-		switch(ch1) {
-		case 'I':
-			ignoredFiles.Add(filename);
-			break;
-		case 'A':
-			newFiles.Add(filename);
-			break;
-		case 'M':
-			modifiedFiles.Add(filename);
-			break;
-		case 'D':
-			deletedFiles.Add(filename);
-			break;
-		case '?':
-			unversionedFiles.Add(filename);
-			break;
-		case 'C':
-			conflictedFiles.Add(filename);
-			break;
-		default:
-			break;
-		}
+		// The file name starts at the eighth column
+		if ( end - start > 7 ) {
+			size_t flags = 0;
+			switch(input.GetChar(start)) {
+			case 'I':
+				flags |= SvnFileStatusIgnored;
+				break;
+			case 'A':
+				flags |= SvnFileStatusNew;
+				break;
+			case 'M':
+				flags |= SvnFileStatusModified;
+				break;
+			case 'D':
+				flags |= SvnFileStatusDeleted;
+				break;
+			case '?':
+				flags |= SvnFileStatusUnversioned;
+				break;
+			case 'C':
+				flags |= SvnFileStatusConflicted;
+				break;
+			default:
+				break;
+			}
 
-		switch(ch6) {
-		case 'K':
-			lockedFiles.Add(filename);
-			break;
-		case 'O':
-			lockedFiles.Add(filename);
-			break;
-		default:
-			break;
+			switch(input.GetChar(start + 5)) {
+			case 'K':
+			case 'O':
+				flags |= SvnFileStatusLocked;
+				break;
+			default:
+				break;
+			}
+
+			if ( flags ) {
+				wxString filename = input.Mid(start + 7, end - start - 7);
+				filename.Trim().Trim(false);
+				if ( !filename.IsEmpty() ) {
+					status[filename] |= flags;
+				}
+			}
 		}
+		start = end + 1;
+	}
+}
+
+void SvnXML::GetFiles(const wxString &input,
+					  wxArrayString  &modifiedFiles,
+					  wxArrayString  &conflictedFiles,
+					  wxArrayString  &unversionedFiles,
+					  wxArrayString  &newFiles,
+					  wxArrayString  &deletedFiles,
+					  wxArrayString  &lockedFiles,
+					  wxArrayString  &ignoredFiles)
+{
+	SvnStatusMap_t status;
+	GetFilesStatus(input, status);
+
+	// The map is sorted, so are the output arrays
+	SvnStatusMap_t::const_iterator iter = status.begin();
+	for(; iter != status.end(); ++iter) {
+		const wxString& filename = iter->first;
+		size_t flags = iter->second;
+		if ( flags & SvnFileStatusIgnored     ) ignoredFiles.Add(filename);
+		if ( flags & SvnFileStatusNew         ) newFiles.Add(filename);
+		if ( flags & SvnFileStatusModified    ) modifiedFiles.Add(filename);
+		if ( flags & SvnFileStatusDeleted     ) deletedFiles.Add(filename);
+		if ( flags & SvnFileStatusUnversioned ) unversionedFiles.Add(filename);
+		if ( flags & SvnFileStatusConflicted  ) conflictedFiles.Add(filename);
+		if ( flags & SvnFileStatusLocked      ) lockedFiles.Add(filename);
 	}
 }
 
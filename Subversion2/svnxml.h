@@ -28,6 +28,21 @@
 #include "wx/string.h"
 #include "wx/arrstr.h"
 #include "svninfo.h"
+#include <map>
+
+/// Status bits of a single working copy entry, as reported by 'svn status'
+enum SvnFileStatus {
+	SvnFileStatusModified    = 0x00000001,
+	SvnFileStatusConflicted  = 0x00000002,
+	SvnFileStatusUnversioned = 0x00000004,
+	SvnFileStatusNew         = 0x00000008,
+	SvnFileStatusDeleted     = 0x00000010,
+	SvnFileStatusLocked      = 0x00000020,
+	SvnFileStatusIgnored     = 0x00000040
+};
+
+/// path (as reported by svn) -> combination of SvnFileStatus bits
+typedef std::map<wxString, size_t> SvnStatusMap_t;
 
 class SvnXML
 {
@@ -35,6 +50,13 @@ public:
 	SvnXML();
 	~SvnXML();
 
+	/**
+	 * @brief parse the output of 'svn status' into a compact status map.
+	 * The input is scanned line by line in place, no intermediate array is built
+	 * so it is safe (and cheap) to call this from a worker thread
+	 */
+	static void GetFilesStatus(const wxString& input, SvnStatusMap_t& status);
+
 	static void GetFiles(const wxString& input, wxArrayString& modifiedFiles, wxArrayString& conflictedFiles, wxArrayString& unversionedFiles, wxArrayString& newFiles, wxArrayString& deletedFiles, wxArrayString& lockedFiles, wxArrayString& ignoredFiles);
 
 	static void GetSvnInfo(const wxString& input, SvnInfo &svnInfo);
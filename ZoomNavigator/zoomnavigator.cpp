@@ -65,7 +65,6 @@ ZoomNavigator::ZoomNavigator(IManager *manager)
     
     m_topWindow->Connect(wxEVT_IDLE, wxIdleEventHandler(ZoomNavigator::OnIdle), NULL, this);
     EventNotifier::Get()->Connect(wxEVT_INIT_DONE, wxCommandEventHandler(ZoomNavigator::OnInitDone), NULL, this);
-    EventNotifier::Get()->Connect(wxEVT_FILE_SAVED, wxCommandEventHandler(ZoomNavigator::OnFileSaved), NULL, this);
     EventNotifier::Get()->Connect(wxEVT_ZN_SETTINGS_UPDATED, wxCommandEventHandler(ZoomNavigator::OnSettingsChanged), NULL, this);
     m_topWindow->Connect(XRCID("zn_settings"), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler(ZoomNavigator::OnSettings), NULL, this);
     DoInitialize();
@@ -79,7 +78,6 @@ void ZoomNavigator::UnPlug()
 {
     EventNotifier::Get()->Disconnect(wxEVT_INIT_DONE, wxCommandEventHandler(ZoomNavigator::OnInitDone), NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_ZN_SETTINGS_UPDATED, wxCommandEventHandler(ZoomNavigator::OnSettingsChanged), NULL, this);
-    EventNotifier::Get()->Disconnect(wxEVT_FILE_SAVED, wxCommandEventHandler(ZoomNavigator::OnFileSaved), NULL, this);
     
     m_topWindow->Disconnect(wxEVT_IDLE, wxIdleEventHandler(ZoomNavigator::OnIdle), NULL, this);
     m_topWindow->Disconnect(XRCID("zn_settings"), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler(ZoomNavigator::OnSettings), NULL, this);
@@ -169,7 +167,9 @@ void ZoomNavigator::DoUpdate()
     wxStyledTextCtrl* stc = curEditor->GetSTC();
     CHECK_CONDITION( stc );
     
-    if ( curEditor->GetFileName().GetFullPath() != m_curfile ) {
+    // Compare the documents and not the file names: a file that was closed
+    // and re-opened is a new document
+    if ( curEditor->GetFileName().GetFullPath() != m_curfile || !m_text->IsAttachedTo( curEditor ) ) {
         SetEditorText( curEditor );
     }
     
@@ -206,7 +206,6 @@ void ZoomNavigator::SetZoomTextScrollPosToMiddle( wxStyledTextCtrl* stc )
         first = 0;
 
     m_text->SetFirstVisibleLine( first );
-    m_text->ClearSelections();
 }
 
 void ZoomNavigator::PatchUpHighlights( const int first, const int last )
@@ -287,17 +286,6 @@ void ZoomNavigator::OnSettingsChanged(wxCommandEvent& e)
     }
 }
 
-void ZoomNavigator::OnFileSaved(wxCommandEvent& e)
-{
-    e.Skip();
-   
-    if ( e.GetString() == m_curfile ) {
-        // Update the file content
-        m_curfile.Clear();
-        DoUpdate();
-    }
-}
-
 void ZoomNavigator::OnWorkspaceClosed(wxCommandEvent& e)
 {
     e.Skip();
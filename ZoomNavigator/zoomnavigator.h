@@ -59,7 +59,6 @@ public:
     void OnPreviewClicked(wxMouseEvent &e);
     void OnSettings(wxCommandEvent &e);
     void OnSettingsChanged(wxCommandEvent &e);
-    void OnFileSaved(wxCommandEvent& e);
     void OnWorkspaceClosed(wxCommandEvent &e);
     void OnEnablePlugin(wxCommandEvent &e);
     void OnInitDone(wxCommandEvent &e);
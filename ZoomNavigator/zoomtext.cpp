@@ -20,7 +20,10 @@
 ZoomText::ZoomText(wxWindow *parent, wxWindowID id, const wxPoint& pos, const wxSize& size, long style, const wxString& name)
     : wxStyledTextCtrl( parent, id, pos, size, style |wxNO_BORDER, name )
 {
-    SetEditable( false );
+    // The zoom view shares the document with the active editor.
+    // The read-only flag belongs to the document, so instead of setting it
+    // we swallow any keyboard input, middle-click paste and drop
+    UsePopUp( false );
     SetUseHorizontalScrollBar( false );
     SetUseVerticalScrollBar( true );
     HideSelection( true );
@@ -35,27 +38,38 @@ ZoomText::ZoomText(wxWindow *parent, wxWindowID id, const wxPoint& pos, const wx
     
     m_zoomFactor = data.GetZoomFactor();
     m_colour = data.GetHighlightColour();
-    MarkerSetBackground(1, m_colour);
     SetZoom( m_zoomFactor );
     EventNotifier::Get()->Connect(wxEVT_ZN_SETTINGS_UPDATED, wxCommandEventHandler(ZoomText::OnSettingsChanged), NULL, this);
     EventNotifier::Get()->Connect(wxEVT_CL_THEME_CHANGED, wxCommandEventHandler(ZoomText::OnThemeChanged), NULL, this);
-    MarkerDefine(1, wxSTC_MARK_BACKGROUND, m_colour, m_colour );
+    Connect(wxEVT_KEY_DOWN, wxKeyEventHandler(ZoomText::OnKeyDown), NULL, this);
+    Connect(wxEVT_CHAR, wxKeyEventHandler(ZoomText::OnKeyDown), NULL, this);
+    Connect(wxEVT_MIDDLE_DOWN, wxMouseEventHandler(ZoomText::OnMiddleClick), NULL, this);
+    Connect(wxEVT_MIDDLE_UP, wxMouseEventHandler(ZoomText::OnMiddleClick), NULL, this);
+    Connect(wxEVT_STC_DRAG_OVER, wxStyledTextEventHandler(ZoomText::OnDrop), NULL, this);
+    Connect(wxEVT_STC_DO_DROP, wxStyledTextEventHandler(ZoomText::OnDrop), NULL, this);
+
+    // Markers are stored in the document, which is shared with the editor.
+    // Use the view's selection to highlight the visible lines instead
+    DoSetHighlightColour();
 
 #ifndef __WXMSW__    
     SetTwoPhaseDraw(false);
     SetBufferedDraw(false);
-    SetLayoutCache(wxSTC_CACHE_DOCUMENT);
 #endif
-
-#ifdef __WXMSW__    
-    MarkerSetAlpha(1, 50);
-#endif    
+    // Only cache the visible page, the document can be very large
+    SetLayoutCache(wxSTC_CACHE_PAGE);
 }
 
 ZoomText::~ZoomText()
 {
     EventNotifier::Get()->Disconnect(wxEVT_ZN_SETTINGS_UPDATED, wxCommandEventHandler(ZoomText::OnSettingsChanged), NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_CL_THEME_CHANGED, wxCommandEventHandler(ZoomText::OnThemeChanged), NULL, this);
+    Disconnect(wxEVT_KEY_DOWN, wxKeyEventHandler(ZoomText::OnKeyDown), NULL, this);
+    Disconnect(wxEVT_CHAR, wxKeyEventHandler(ZoomText::OnKeyDown), NULL, this);
+    Disconnect(wxEVT_MIDDLE_DOWN, wxMouseEventHandler(ZoomText::OnMiddleClick), NULL, this);
+    Disconnect(wxEVT_MIDDLE_UP, wxMouseEventHandler(ZoomText::OnMiddleClick), NULL, this);
+    Disconnect(wxEVT_STC_DRAG_OVER, wxStyledTextEventHandler(ZoomText::OnDrop), NULL, this);
+    Disconnect(wxEVT_STC_DO_DROP, wxStyledTextEventHandler(ZoomText::OnDrop), NULL, this);
 }
 
 void ZoomText::UpdateLexer(const wxString& filename)
@@ -65,14 +79,14 @@ void ZoomText::UpdateLexer(const wxString& filename)
     if ( !lexer ) {
         lexer = EditorConfigST::Get()->GetLexer("Text");
     }
-    lexer->Apply( this );
+    // Apply the styles only: the keywords are owned by the (shared) document
+    // and were already set by the editor
+    lexer->Apply( this, false );
     
     SetZoom( m_zoomFactor );
-    SetEditable( false );
     SetUseHorizontalScrollBar( false );
     SetUseVerticalScrollBar( true );
-    HideSelection( true );
-    MarkerSetBackground(1, m_colour);
+    DoSetHighlightColour();
 }
 
 void ZoomText::OnSettingsChanged(wxCommandEvent &e)
@@ -83,27 +97,35 @@ void ZoomText::OnSettingsChanged(wxCommandEvent &e)
     if ( conf.ReadItem( &data ) ) {
         m_zoomFactor = data.GetZoomFactor();
         m_colour = data.GetHighlightColour();
-        MarkerSetBackground(1, m_colour);
+        DoSetHighlightColour();
         SetZoom(m_zoomFactor);
-        Colourise(0, wxSTC_INVALID_POSITION);
     }
 }
 
 void ZoomText::UpdateText(IEditor* editor)
 {
-    if ( !editor ) {
-        SetReadOnly( false );
-        SetText( "" );
-        SetReadOnly( true );
+    if ( !editor || !editor->GetSTC() ) {
+        // Release our reference to the previous document and
+        // switch to a new, empty one
+        SetDocPointer( NULL );
 
     } else {
-        SetReadOnly( false );
-        SetText( editor->GetEditorText() );
-        SetReadOnly( true );
+        // Attach to the editor's document. Scintilla reference counts the
+        // document, so there is no copy and any change made in the editor
+        // is reflected here immediately
+        void* docPointer = editor->GetSTC()->GetDocPointer();
+        if ( GetDocPointer() != docPointer ) {
+            SetDocPointer( docPointer );
+        }
         SetCurrentPos( editor->GetCurrentPosition() );
     }
 }
 
+bool ZoomText::IsAttachedTo(IEditor* editor)
+{
+    return editor && editor->GetSTC() && editor->GetSTC()->GetDocPointer() == GetDocPointer();
+}
+
 void ZoomText::HighlightLines(int start, int end)
 {
     int nLineCount = end - start;
@@ -115,10 +137,38 @@ void ZoomText::HighlightLines(int start, int end)
             start = 0;
     }
         
-    MarkerDeleteAll(1);
-    for(int i=start; i<=end; ++i) {
-        MarkerAdd(i, 1);
-    }
+    // Setting the selection scrolls the caret into view, keep the current scroll position
+    int firstVisibleLine = GetFirstVisibleLine();
+    SetSelection(PositionFromLine(start), GetLineEndPosition(end));
+    SetFirstVisibleLine(firstVisibleLine);
+}
+
+void ZoomText::DoSetHighlightColour()
+{
+    SetSelBackground(true, m_colour);
+    SetSelEOLFilled(true);
+    HideSelection(false);
+#ifdef __WXMSW__    
+    SetSelAlpha(50);
+#endif    
+}
+
+void ZoomText::OnKeyDown(wxKeyEvent& e)
+{
+    // The document is shared with the editor: don't allow editing it from here
+    wxUnusedVar(e);
+}
+
+void ZoomText::OnMiddleClick(wxMouseEvent& e)
+{
+    // Don't skip: on GTK a middle click pastes the primary selection
+    wxUnusedVar(e);
+}
+
+void ZoomText::OnDrop(wxStyledTextEvent& e)
+{
+    // Refuse any text dropped on the view
+    e.SetDragResult(wxDragNone);
 }
 
 void ZoomText::OnThemeChanged(wxCommandEvent& e)
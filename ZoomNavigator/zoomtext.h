@@ -19,6 +19,10 @@ class ZoomText : public wxStyledTextCtrl
     
 protected:
     void OnThemeChanged(wxCommandEvent &e);
+    void OnKeyDown(wxKeyEvent &e);
+    void OnMiddleClick(wxMouseEvent &e);
+    void OnDrop(wxStyledTextEvent &e);
+    void DoSetHighlightColour();
     
 public:
     ZoomText(wxWindow *parent, wxWindowID id=wxID_ANY,
@@ -29,6 +33,7 @@ public:
     void UpdateLexer(const wxString &filename);
     void OnSettingsChanged(wxCommandEvent &e);
     void UpdateText(IEditor* editort);
+    bool IsAttachedTo(IEditor* editor);
     void HighlightLines(int start, int end);
 };
 
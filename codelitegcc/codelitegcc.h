@@ -0,0 +1,15 @@
+#ifndef CODELITEGCC_H
+#define CODELITEGCC_H
+
+// Compilation records up to this size are appended to the shared log file with a single write.
+// Larger records are written to a log file of their own, named after the process id
+#define CL_MAX_SHARED_RECORD_SIZE 32768
+
+// The cost of a single compilation, recorded when CL_BUILD_STATS is set
+struct CompileStats {
+    long wallMs;    // elapsed time
+    long cpuMs;     // user + system time of the compiler and the processes it started
+    long peakRssKb; // peak resident set size of the largest of these processes
+};
+
+#endif // CODELITEGCC_H
@@ -8,6 +8,7 @@
 #include <unistd.h>
 #include <limits.h>
 #include <sstream>
+#include "codelitegcc.h"
 
 typedef std::vector<std::string> StringVec_t;
 
@@ -15,11 +16,12 @@ std::vector<std::string> extract_file_name( const std::string& line );
 char * normalize_path(const char * src, size_t src_len);
 bool is_source_file(const std::string& filename, std::string &fixed_file_name);
 void * Memrchr(const void *buf, int c, size_t num);
-
+
 #ifdef _WIN32
-extern int ExecuteProcessWIN(const std::string& commandline);
+extern int ExecuteProcessWIN(const std::string& commandline, CompileStats* stats);
+extern void AppendRecord( const std::string& logfile, const std::string& record );
 #endif
-
+
 #ifndef _WIN32
 
 #include <unistd.h>
@@ -33,21 +35,27 @@ extern int ExecuteProcessWIN(const std::string& commandline);
 #include <sys/file.h>
 #include <sys/stat.h>
 #include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
 
-void WriteContent( const std::string& logfile, const std::string& filename, const std::string& flags )
+static void AppendRecord( const std::string& logfile, const std::string& record )
 {
-    // Open the file
-    int fd = ::open(logfile.c_str(), O_CREAT|O_APPEND, 0660);
-    ::chmod(logfile.c_str(), 0660);
-
-    // Lock it
+    int fd = ::open(logfile.c_str(), O_WRONLY|O_CREAT|O_APPEND, 0660);
     if ( fd < 0 )
         return;
 
-    if(::flock(fd, LOCK_EX) < 0) {
-        return;
+    // A single write() to a file opened with O_APPEND: the kernel moves to the end of
+    // the file and writes the record in one step, so no lock is needed between the
+    // compilers running in parallel
+    ssize_t written = ::write(fd, record.c_str(), record.length());
+    if ( written != (ssize_t)record.length() ) {
+        perror("write");
     }
+    ::close(fd);
+}
 
+void WriteContent( const std::string& logfile, const std::string& filename, const std::string& flags )
+{
     char cwd[1024];
     memset(cwd, 0, sizeof(cwd));
     char* pcwd = ::getcwd(cwd, sizeof(cwd));
@@ -55,24 +63,76 @@ void WriteContent( const std::string& logfile, const std::string& filename, cons
 
     std::string line = filename + "|" + cwd + "|" + flags + "\n";
 
-    FILE* fp = fopen(logfile.c_str(), "a+b");
-    if ( !fp ) {
-        perror("fopen");
+    if ( line.length() <= CL_MAX_SHARED_RECORD_SIZE ) {
+        AppendRecord(logfile, line);
+
+    } else {
+        // Oversized record: write it to a log file private to this process (LOGFILE.PID)
+        std::stringstream ss;
+        ss << logfile << "." << ::getpid();
+        AppendRecord(ss.str(), line);
     }
-
-    // Write the content
-    ::fprintf(fp, "%s", line.c_str());
-    ::fflush(fp);
-    ::fclose(fp);
-
-    // Release the lock
-    ::flock(fd, LOCK_UN);
-
-    // close the fd
-    ::close(fd);
 }
 
+// Run the compiler as a child process and measure it
+static int ExecuteProcessWithStats(char **argv, CompileStats& stats)
+{
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    pid_t pid = fork();
+    if ( pid < 0 ) {
+        // Can't measure it, simply run it
+        return execvp(argv[0], argv);
+
+    } else if ( pid == 0 ) {
+        execvp(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+
+    int status = 0;
+    while ( waitpid(pid, &status, 0) < 0 ) {
+        if ( errno != EINTR ) {
+            return 1;
+        }
+    }
+    gettimeofday(&end, NULL);
+
+    // The compiler is our only child: RUSAGE_CHILDREN covers it and the processes
+    // it waited for (cc1plus, as, ...)
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    getrusage(RUSAGE_CHILDREN, &usage);
+
+    stats.wallMs    = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_usec - start.tv_usec) / 1000;
+    stats.cpuMs     = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000 +
+                      (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000;
+#ifdef __APPLE__
+    stats.peakRssKb = usage.ru_maxrss / 1024; // bytes
+#else
+    stats.peakRssKb = usage.ru_maxrss;        // kilobytes
 #endif
+
+    if ( WIFEXITED(status) ) {
+        return WEXITSTATUS(status);
+    }
+    return WIFSIGNALED(status) ? 128 + WTERMSIG(status) : 1;
+}
+
+#endif
+
+void WriteStats( const std::string& logfile, const std::string& filename, const std::string& object, const CompileStats& stats, int exitCode )
+{
+    char cwd[1024];
+    memset(cwd, 0, sizeof(cwd));
+    char* pcwd = ::getcwd(cwd, sizeof(cwd));
+    (void) pcwd;
+
+    std::stringstream ss;
+    ss << filename << "|" << cwd << "|" << object << "|" << stats.wallMs << "|" << stats.cpuMs << "|" << stats.peakRssKb << "|" << exitCode << "\n";
+    AppendRecord(logfile, ss.str());
+}
 extern void WriteContent( const std::string& logfile, const std::string& filename, const std::string& flags );
 
 // A thin wrapper around gcc
@@ -87,7 +147,10 @@ int main(int argc, char **argv)
     
     StringVec_t file_names;
     const char *pdb = getenv("CL_COMPILATION_DB");
+    const char *pstats = getenv("CL_BUILD_STATS");
     std::string commandline;
+    std::string object_name;
+    bool compile_only = false;
     for ( int i=1; i<argc; ++i ) {
         // Wrap all arguments with spaces with double quotes
         std::string arg = argv[i];
@@ -95,6 +158,16 @@ int main(int argc, char **argv)
         
         if ( is_source_file( arg, file_name ) ) {
             file_names.push_back( file_name );
+        }
+
+        if ( arg == "-c" ) {
+            compile_only = true;
+
+        } else if ( arg == "-o" && i + 1 < argc ) {
+            object_name = argv[i + 1];
+
+        } else if ( arg.length() > 2 && arg.compare(0, 2, "-o") == 0 ) {
+            object_name = arg.substr(2);
         }
         
         // re-escape double quotes if needed
@@ -125,9 +198,25 @@ int main(int argc, char **argv)
         }
     }
 
+    // Only compilations are measured: not the dependencies generation, the preprocessing
+    // or the link
+    if ( pstats && compile_only && file_names.size() == 1 ) {
+        CompileStats stats;
+        memset(&stats, 0, sizeof(stats));
+#ifdef _WIN32
+        int exitCode = ::ExecuteProcessWIN(commandline, &stats);
+#else
+        int exitCode = ExecuteProcessWithStats(argv+1, stats);
+#endif
+        std::string logfile = pstats;
+        logfile += ".txt";
+        WriteStats(logfile, file_names.at(0), object_name, stats, exitCode);
+        return exitCode;
+    }
+
     int exitCode = 0;
 #ifdef _WIN32
-    exitCode = ::ExecuteProcessWIN(commandline);
+    exitCode = ::ExecuteProcessWIN(commandline, NULL);
     return exitCode;
 #else
     return execvp(argv[1], argv+1);
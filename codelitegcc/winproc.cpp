@@ -4,8 +4,10 @@
 #include <conio.h>
 #include <limits.h>
 #include <io.h>
+#include <stdio.h>
+#include "codelitegcc.h"
 
-int ExecuteProcessWIN(const std::string& commandline)
+int ExecuteProcessWIN(const std::string& commandline, CompileStats* stats)
 {
     STARTUPINFO si;
     PROCESS_INFORMATION pi;
@@ -14,65 +16,107 @@ int ExecuteProcessWIN(const std::string& commandline)
     si.cb = sizeof(si);
     ZeroMemory( &pi, sizeof(pi) );
 
+    // When measuring, run the compiler in a job: the job accounts for the compiler
+    // and every process it starts (cc1plus, as, ...). The process is started suspended
+    // so it can't start any process before it is part of the job
+    HANDLE hJob = stats ? ::CreateJobObject(NULL, NULL) : NULL;
+    DWORD tickStart = ::GetTickCount();
+
     // Start the child process.
     char* cmdline = strdup(commandline.c_str());
-    CreateProcess( NULL, TEXT(cmdline), NULL, NULL, FALSE, 0,
+    CreateProcess( NULL, TEXT(cmdline), NULL, NULL, FALSE, hJob ? CREATE_SUSPENDED : 0,
                    NULL, NULL, &si, &pi );
 
+    bool inJob = false;
+    if ( hJob ) {
+        inJob = ::AssignProcessToJobObject(hJob, pi.hProcess) ? true : false;
+        ::ResumeThread(pi.hThread);
+    }
+
     // Wait until child process exits.
     WaitForSingleObject( pi.hProcess, INFINITE );
     DWORD ret;
     GetExitCodeProcess( pi.hProcess, &ret );
+
+    if ( stats ) {
+        stats->wallMs = ::GetTickCount() - tickStart;
+
+        JOBOBJECT_EXTENDED_LIMIT_INFORMATION info;
+        ZeroMemory( &info, sizeof(info) );
+        if ( inJob && ::QueryInformationJobObject(hJob, JobObjectExtendedLimitInformation, &info, sizeof(info), NULL) ) {
+            // the peak commit charge of the job: the closest to the peak RSS we get
+            // without psapi
+            stats->peakRssKb = (long)(info.PeakProcessMemoryUsed / 1024);
+        }
+
+        JOBOBJECT_BASIC_ACCOUNTING_INFORMATION accounting;
+        ZeroMemory( &accounting, sizeof(accounting) );
+        if ( inJob && ::QueryInformationJobObject(hJob, JobObjectBasicAccountingInformation, &accounting, sizeof(accounting), NULL) ) {
+            // times are in 100 nanoseconds units
+            stats->cpuMs = (long)((accounting.TotalUserTime.QuadPart + accounting.TotalKernelTime.QuadPart) / 10000);
+
+        } else {
+            // Not in a job (e.g. codelite itself runs in a job that does not allow nested jobs):
+            // only the compiler driver can be measured
+            FILETIME creationTime, exitTime, kernelTime, userTime;
+            if ( ::GetProcessTimes(pi.hProcess, &creationTime, &exitTime, &kernelTime, &userTime) ) {
+                ULARGE_INTEGER kernel, user;
+                kernel.LowPart = kernelTime.dwLowDateTime;
+                kernel.HighPart = kernelTime.dwHighDateTime;
+                user.LowPart = userTime.dwLowDateTime;
+                user.HighPart = userTime.dwHighDateTime;
+                stats->cpuMs = (long)((kernel.QuadPart + user.QuadPart) / 10000);
+            }
+        }
+    }
+
     CloseHandle( pi.hProcess );
     CloseHandle( pi.hThread );
+    if ( hJob ) {
+        CloseHandle( hJob );
+    }
+    free( cmdline );
     return ret;
 }
 
-void WriteContent( const std::string& logfile, const std::string& filename, const std::string& flags )
+void AppendRecord( const std::string& logfile, const std::string& record )
 {
-    // Open the file
+    // Open the file for append only: every WriteFile() is then performed
+    // at the end of the file in one step, so no lock is needed between the
+    // compilers running in parallel. FILE_SHARE_DELETE allows codelite to
+    // rename the log while we are writing to it
     HANDLE hFile = ::CreateFile(logfile.c_str(),
-                                GENERIC_WRITE,
-                                FILE_SHARE_WRITE,
+                                FILE_APPEND_DATA,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
                                 NULL,
                                 OPEN_ALWAYS,
                                 FILE_ATTRIBUTE_NORMAL,
                                 NULL);
-    if( !hFile )
+    if( hFile == INVALID_HANDLE_VALUE )
         return;
 
-    OVERLAPPED ov;
-    memset(&ov, 0, sizeof(ov));
-    ov.hEvent = 0x0;
-    ov.Offset = UINT_MAX;
-    // Obtain the lock over the file
-    BOOL res = ::LockFileEx(hFile,
-                            LOCKFILE_EXCLUSIVE_LOCK,
-                            0,                       // must be 0
-                            UINT_MAX,                // number of bytes to lock
-                            0,                       // crap, set it 0
-                            &ov);
-    //int error = GetLastError();
-    if ( !res ) {
-        ::CloseHandle(hFile);
-        return;
-    }
-
-    // Move the write pointer to the end
-    ::SetFilePointer(hFile, 0, NULL, FILE_END);
+    DWORD dwBytesWritten = 0;
+    ::WriteFile(hFile, record.c_str(), record.length(), &dwBytesWritten, NULL);
+    ::CloseHandle(hFile);
+}
 
+void WriteContent( const std::string& logfile, const std::string& filename, const std::string& flags )
+{
     char cwd[1024];
     memset(cwd, 0, sizeof(cwd));
     ::getcwd(cwd, sizeof(cwd));
 
     std::string line = filename + "|" + cwd + "|" + flags + "\n";
 
-    DWORD dwBytesWritten = 0;
-    ::WriteFile(hFile, line.c_str(), line.length(), &dwBytesWritten, NULL);
+    if ( line.length() <= CL_MAX_SHARED_RECORD_SIZE ) {
+        AppendRecord(logfile, line);
 
-    // Unlock the entire file
-    ::UnlockFile(hFile, 0, 0, UINT_MAX, 0);
-    ::CloseHandle(hFile);
+    } else {
+        // Oversized record: write it to a log file private to this process (LOGFILE.PID)
+        char suffix[32];
+        sprintf(suffix, ".%lu", (unsigned long)::GetCurrentProcessId());
+        AppendRecord(logfile + suffix, line);
+    }
 }
 
 #endif
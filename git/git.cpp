@@ -99,6 +99,7 @@ GitPlugin::GitPlugin(IManager *manager)
     , m_pluginToolbar(NULL)
     , m_pluginMenu(NULL)
     , m_commitListDlg(NULL)
+    , m_treeItemsIndexDirty(true)
 {
     m_longName = wxT("GIT plugin");
     m_shortName = wxT("git");
@@ -111,6 +112,14 @@ GitPlugin::GitPlugin(IManager *manager)
     EventNotifier::Get()->Connect( wxEVT_PROJ_FILE_ADDED, clCommandEventHandler(GitPlugin::OnFilesAddedToProject), NULL, this);
     EventNotifier::Get()->Connect( wxEVT_PROJ_FILE_REMOVED, wxCommandEventHandler(GitPlugin::OnFilesRemovedFromProject), NULL, this);
     EventNotifier::Get()->Connect(wxEVT_WORKSPACE_CONFIG_CHANGED, wxCommandEventHandler(GitPlugin::OnWorkspaceConfigurationChanged), NULL, this);
+    EventNotifier::Get()->Connect( wxEVT_FILE_VIEW_REFRESHED, wxCommandEventHandler(GitPlugin::OnFileViewRefreshed), NULL, this);
+
+    // Any item removed from the File View invalidates our path->item index
+    wxTreeCtrl* tree = m_mgr->GetTree(TreeFileView);
+    if ( tree ) {
+        tree->Connect(wxEVT_COMMAND_TREE_DELETE_ITEM, wxTreeEventHandler(GitPlugin::OnFileViewItemDeleted), NULL, this);
+    }
+
     // Add the console
     m_console = new GitConsole(m_mgr->GetOutputPaneNotebook(), this);
     m_mgr->GetOutputPaneNotebook()->AddPage(m_console, wxT("git"), false, m_images.Bitmap("git"));
@@ -309,6 +318,12 @@ void GitPlugin::UnPlug()
     EventNotifier::Get()->Disconnect( wxEVT_WORKSPACE_LOADED, wxCommandEventHandler(GitPlugin::OnWorkspaceLoaded), NULL, this);
     EventNotifier::Get()->Disconnect( wxEVT_PROJ_FILE_ADDED, clCommandEventHandler(GitPlugin::OnFilesAddedToProject), NULL, this);
     EventNotifier::Get()->Disconnect(wxEVT_WORKSPACE_CONFIG_CHANGED, wxCommandEventHandler(GitPlugin::OnWorkspaceConfigurationChanged), NULL, this);
+    EventNotifier::Get()->Disconnect( wxEVT_FILE_VIEW_REFRESHED, wxCommandEventHandler(GitPlugin::OnFileViewRefreshed), NULL, this);
+
+    wxTreeCtrl* tree = m_mgr->GetTree(TreeFileView);
+    if ( tree ) {
+        tree->Disconnect(wxEVT_COMMAND_TREE_DELETE_ITEM, wxTreeEventHandler(GitPlugin::OnFileViewItemDeleted), NULL, this);
+    }
 
     /*Context Menu*/
     m_eventHandler->Disconnect( XRCID("git_add_file"), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( GitPlugin::OnFileAddSelected), NULL, this );
@@ -377,6 +392,7 @@ void GitPlugin::OnSetGitRepoPath(wxCommandEvent& e)
 /*******************************************************************************/
 void GitPlugin::OnSettings(wxCommandEvent &e)
 {
+    bool wasColouring = IsTreeColouringEnabled();
     GitSettingsDlg dlg(m_topWindow, m_repositoryDirectory);
     if ( dlg.ShowModal() == wxID_OK ) {
 
@@ -390,6 +406,19 @@ void GitPlugin::OnSettings(wxCommandEvent &e)
 
         GIT_MESSAGE("git executable is now set to: %s", m_pathGITExecutable.c_str());
         GIT_MESSAGE("gitk executable is now set to: %s", m_pathGITKExecutable.c_str());
+
+        // Only the changes are coloured as the statuses arrive: apply (or remove)
+        // the colours of the files already known
+        bool colouring = (data.GetFlags() & GitEntry::Git_Colour_Tree_View) != 0;
+        if ( colouring && !wasColouring ) {
+            DoColourFiles(m_trackedFiles, OverlayTool::Bmp_OK);
+            DoColourFiles(m_modifiedFiles, OverlayTool::Bmp_Modified);
+
+        } else if ( !colouring && wasColouring ) {
+            DoColourFiles(m_trackedFiles, OverlayTool::Bmp_NoChange);
+            DoColourFiles(m_modifiedFiles, OverlayTool::Bmp_NoChange);
+        }
+
         AddDefaultActions();
         ProcessGitActionQueue();
     }
@@ -665,15 +694,10 @@ void GitPlugin::OnListModified(wxCommandEvent& e)
 {
     wxUnusedVar(e);
     wxArrayString choices;
-    std::map<wxString, wxTreeItemId>::const_iterator it;
-
-    // First get a map of the filepaths/treeitemids of modified files
-    std::map<wxString, wxTreeItemId> modifiedIDs;
-    CreateFilesTreeIDsMap(modifiedIDs, true);
-
-    for (it = modifiedIDs.begin(); it != modifiedIDs.end(); ++it) {
-        if (it->second.IsOk())
-            choices.Add(it->first);
+    wxStringSet_t::const_iterator it = m_modifiedFiles.begin();
+    for (; it != m_modifiedFiles.end(); ++it) {
+        if (DoFindTreeItem(*it).IsOk())
+            choices.Add(*it);
     }
 
     if(choices.GetCount() == 0)
@@ -745,22 +769,18 @@ void GitPlugin::OnBisectReset(wxCommandEvent& e)
 void GitPlugin::OnFileSaved(wxCommandEvent& e)
 {
     e.Skip();
-    wxUnusedVar(e);
-    std::map<wxString, wxTreeItemId>::const_iterator it;
 
-    // First get an up to date map of the filepaths/treeitemids of modified files
-    // (Trying to cache these results in segfaults when the tree has been modified)
-    std::map<wxString, wxTreeItemId> modifiedIDs;
-    CreateFilesTreeIDsMap(modifiedIDs, true);
-
-    for (it = modifiedIDs.begin(); it != modifiedIDs.end(); ++it) {
-        if (!it->second.IsOk()) {
-            GIT_MESSAGE(wxT("Stored item not found in tree, rebuilding item IDs"));
-            gitAction ga(gitListAll,wxT(""));
-            m_gitActionQueue.push(ga);
-            break;
+    // Optimistically mark the saved file as modified, the status
+    // query below will correct it if the content matches the index
+    wxString filename = e.GetString();
+    if ( !filename.IsEmpty() && m_trackedFiles.count(filename) && !m_modifiedFiles.count(filename) ) {
+        m_modifiedFiles.insert(filename);
+        if ( IsTreeColouringEnabled() ) {
+            wxTreeItemId item = DoFindTreeItem(filename);
+            if ( item.IsOk() ) {
+                DoSetTreeItemImage(m_mgr->GetTree(TreeFileView), item, OverlayTool::Bmp_Modified);
+            }
         }
-        DoSetTreeItemImage(m_mgr->GetTree(TreeFileView), it->second, OverlayTool::Bmp_Modified);
     }
 
     gitAction ga(gitListModified,wxT(""));
@@ -770,12 +790,34 @@ void GitPlugin::OnFileSaved(wxCommandEvent& e)
     RefreshFileListView();
 }
 
+/*******************************************************************************/
+void GitPlugin::OnFileViewRefreshed(wxCommandEvent& e)
+{
+    e.Skip();
+
+    // The File View was rebuilt: all items (and their overlays) are new
+    m_treeItemsIndexDirty = true;
+    if ( m_repositoryDirectory.IsEmpty() || !IsTreeColouringEnabled() )
+        return;
+
+    DoColourFiles(m_trackedFiles, OverlayTool::Bmp_OK);
+    DoColourFiles(m_modifiedFiles, OverlayTool::Bmp_Modified);
+}
+
+/*******************************************************************************/
+void GitPlugin::OnFileViewItemDeleted(wxTreeEvent& e)
+{
+    e.Skip();
+    m_treeItemsIndexDirty = true;
+}
+
 /*******************************************************************************/
 void GitPlugin::OnFilesAddedToProject(clCommandEvent& e)
 {
     e.Skip();
 
     const wxArrayString &files = e.GetStrings();
+    m_treeItemsIndexDirty = true;
     if( !files.IsEmpty() && !m_repositoryDirectory.IsEmpty() ) {
         GIT_MESSAGE(wxT("Files added to project, updating file list"));
         DoAddFiles( files );
@@ -910,7 +952,9 @@ void GitPlugin::ProcessGitActionQueue(const wxString& commandString /*= ""*/)
 
     case gitListModified:
         GIT_MESSAGE1(wxT("Listing modified files in git repository"));
-        command << wxT(" --no-pager ls-files -m");
+        // Porcelain output is stable across git versions and locales. We can't use '-z'
+        // since the process output is collected into a NUL terminated string
+        command << wxT(" -c core.quotepath=off --no-pager status --porcelain --untracked-files=no");
         GIT_MESSAGE1(wxT("%s. Repo path: %s"), command.c_str(), m_repositoryDirectory.c_str());
         break;
 
@@ -1111,55 +1155,56 @@ void GitPlugin::ProcessGitActionQueue(const wxString& commandString /*= ""*/)
 /*******************************************************************************/
 void GitPlugin::FinishGitListAction(const gitAction& ga)
 {
-    clConfig conf("git.conf");
-    GitEntry data;
-    conf.ReadItem(&data);
-
-    if ( !(data.GetFlags() & GitEntry::Git_Colour_Tree_View) )
-        return;
+    wxStringSet_t gitFileSet;
+    if (ga.action == gitListModified) {
+        DoParseStatusPorcelain(m_commandOutput, gitFileSet);
 
-    wxArrayString tmpArray = wxStringTokenize(m_commandOutput, wxT("\n"), wxTOKEN_STRTOK);
+    } else {
+        wxArrayString tmpArray = wxStringTokenize(m_commandOutput, wxT("\n"), wxTOKEN_STRTOK);
 
-    // Convert path to absolute
-    for (unsigned i=0; i < tmpArray.GetCount(); ++i) {
-        wxFileName fname(tmpArray[i]);
-        fname.MakeAbsolute(m_repositoryDirectory);
-        tmpArray[i] = fname.GetFullPath();
+        // Convert path to absolute
+        for (unsigned i=0; i < tmpArray.GetCount(); ++i) {
+            wxFileName fname(tmpArray[i]);
+            fname.MakeAbsolute(m_repositoryDirectory);
+            gitFileSet.insert(fname.GetFullPath());
+        }
     }
 
-    // convert the array to set for performance
-    wxStringSet_t gitFileSet;
-    gitFileSet.insert(tmpArray.begin(), tmpArray.end());
+    bool colourTree = IsTreeColouringEnabled();
 
+    // Only touch the items whose status actually changed since the last query
     if (ga.action == gitListAll) {
-        m_mgr->SetStatusMessage(_("Colouring tracked git files..."), 0);
-        ColourFileTree(m_mgr->GetTree(TreeFileView), gitFileSet, OverlayTool::Bmp_OK);
+        if ( colourTree ) {
+            m_mgr->SetStatusMessage(_("Colouring tracked git files..."), 0);
+            wxStringSet_t newlyTracked;
+            wxStringSet_t::const_iterator iter = gitFileSet.begin();
+            for (; iter != gitFileSet.end(); ++iter) {
+                if ( !m_trackedFiles.count(*iter) && !m_modifiedFiles.count(*iter) ) {
+                    newlyTracked.insert(*iter);
+                }
+            }
+            DoColourFiles(newlyTracked, OverlayTool::Bmp_OK);
+        }
         m_trackedFiles.swap(gitFileSet);
 
     } else if (ga.action == gitListModified) {
-        m_mgr->SetStatusMessage(_("Colouring modifed git files..."), 0);
-        //Reset modified files
-        ColourFileTree(m_mgr->GetTree(TreeFileView), m_modifiedFiles, OverlayTool::Bmp_OK);
-        // First get an up to date map of the filepaths/treeitemids
-        // (Trying to cache these results in segfaults when the tree has been modified)
-        std::map<wxString, wxTreeItemId> IDs;
-        CreateFilesTreeIDsMap(IDs);
-
-        // Now filter using the list of modified files, gitFileList, to find which IDs to colour differently
-        wxStringSet_t toColour;
-        wxStringSet_t::const_iterator iter = gitFileSet.begin();
-        for (; iter != gitFileSet.end(); ++iter) {
-            wxTreeItemId id = IDs[ (*iter) ];
-            if (id.IsOk()) {
-                DoSetTreeItemImage(m_mgr->GetTree(TreeFileView), id, OverlayTool::Bmp_Modified);
-
-            } else {
-                toColour.insert( *iter );
+        if ( colourTree ) {
+            m_mgr->SetStatusMessage(_("Colouring modifed git files..."), 0);
+            wxStringSet_t newlyModified, noLongerModified;
+            wxStringSet_t::const_iterator iter = gitFileSet.begin();
+            for (; iter != gitFileSet.end(); ++iter) {
+                if ( !m_modifiedFiles.count(*iter) ) {
+                    newlyModified.insert(*iter);
+                }
             }
-        }
 
-        if ( !toColour.empty() ) {
-            ColourFileTree(m_mgr->GetTree(TreeFileView), toColour, OverlayTool::Bmp_Modified);
+            for (iter = m_modifiedFiles.begin(); iter != m_modifiedFiles.end(); ++iter) {
+                if ( !gitFileSet.count(*iter) ) {
+                    noLongerModified.insert(*iter);
+                }
+            }
+            DoColourFiles(noLongerModified, OverlayTool::Bmp_OK);
+            DoColourFiles(newlyModified, OverlayTool::Bmp_Modified);
         }
 
         // Finally, cache the modified-files list: it's used in other functions
@@ -1168,6 +1213,43 @@ void GitPlugin::FinishGitListAction(const gitAction& ga)
     m_mgr->SetStatusMessage("", 0);
 }
 
+/*******************************************************************************/
+void GitPlugin::DoParseStatusPorcelain(const wxString& output, wxStringSet_t& files) const
+{
+    // Each line is formatted as "XY PATH" or "XY ORIG_PATH -> PATH" (renames)
+    wxArrayString lines = wxStringTokenize(output, wxT("\n"), wxTOKEN_STRTOK);
+    for (size_t i=0; i<lines.GetCount(); ++i) {
+        const wxString& line = lines.Item(i);
+        if ( line.length() < 4 || line.GetChar(2) != wxT(' ') )
+            continue;
+
+        wxChar x = line.GetChar(0);
+        wxChar y = line.GetChar(1);
+        if ( x == wxT('?') || x == wxT('!') )
+            continue;
+
+        if ( x == wxT(' ') && y == wxT(' ') )
+            continue;
+
+        wxString path = line.Mid(3);
+        int where = path.Find(wxT(" -> "));
+        if ( where != wxNOT_FOUND ) {
+            path = path.Mid(where + 4);
+        }
+
+        // Paths with special characters are quoted C-style
+        if ( path.length() > 1 && path.StartsWith(wxT("\"")) && path.EndsWith(wxT("\"")) ) {
+            path = path.Mid(1, path.length() - 2);
+            path.Replace(wxT("\\\""), wxT("\""));
+            path.Replace(wxT("\\\\"), wxT("\\"));
+        }
+
+        wxFileName fname(path);
+        fname.MakeAbsolute(m_repositoryDirectory);
+        files.insert(fname.GetFullPath());
+    }
+}
+
 /*******************************************************************************/
 void GitPlugin::ListBranchAction(const gitAction& ga)
 {
@@ -1659,41 +1741,6 @@ void GitPlugin::AddDefaultActions()
     m_gitActionQueue.push(ga);
 }
 
-/*******************************************************************************/
-void GitPlugin::ColourFileTree(wxTreeCtrl* tree, const wxStringSet_t& files, OverlayTool::BmpType bmpType) const
-{
-    clConfig conf("git.conf");
-    GitEntry data;
-    conf.ReadItem(&data);
-
-    if ( !(data.GetFlags() & GitEntry::Git_Colour_Tree_View) )
-        return;
-
-    std::stack<wxTreeItemId> items;
-    if (tree->GetRootItem().IsOk())
-        items.push(tree->GetRootItem());
-
-    while (!items.empty()) {
-        wxTreeItemId next = items.top();
-        items.pop();
-
-        if (next != tree->GetRootItem()) {
-            FilewViewTreeItemData *data = static_cast<FilewViewTreeItemData*>( tree->GetItemData( next ) );
-            const wxString& path = data->GetData().GetFile();
-            if (!path.IsEmpty() && files.count(path)) {
-                DoSetTreeItemImage(tree, next, bmpType);
-            }
-        }
-
-        wxTreeItemIdValue cookie;
-        wxTreeItemId nextChild = tree->GetFirstChild(next, cookie);
-        while (nextChild.IsOk()) {
-            items.push(nextChild);
-            nextChild = tree->GetNextSibling(nextChild);
-        }
-    }
-}
-
 /*******************************************************************************/
 
 void GitPlugin::CreateFilesTreeIDsMap(std::map<wxString, wxTreeItemId>& IDs, bool ifmodified /*=false*/) const
@@ -1733,6 +1780,53 @@ void GitPlugin::CreateFilesTreeIDsMap(std::map<wxString, wxTreeItemId>& IDs, boo
     }
 }
 
+/*******************************************************************************/
+bool GitPlugin::IsTreeColouringEnabled() const
+{
+    clConfig conf("git.conf");
+    GitEntry data;
+    conf.ReadItem(&data);
+    return data.GetFlags() & GitEntry::Git_Colour_Tree_View;
+}
+
+/*******************************************************************************/
+void GitPlugin::DoUpdateTreeItemsIndex()
+{
+    // The index is invalidated whenever an item is deleted from the tree or
+    // the tree is rebuilt, so a full walk is only needed after such a change
+    if ( !m_treeItemsIndexDirty )
+        return;
+
+    CreateFilesTreeIDsMap(m_treeItemsIndex);
+    m_treeItemsIndexDirty = false;
+}
+
+/*******************************************************************************/
+wxTreeItemId GitPlugin::DoFindTreeItem(const wxString& path)
+{
+    DoUpdateTreeItemsIndex();
+    std::map<wxString, wxTreeItemId>::const_iterator iter = m_treeItemsIndex.find(path);
+    if ( iter == m_treeItemsIndex.end() )
+        return wxTreeItemId();
+    return iter->second;
+}
+
+/*******************************************************************************/
+void GitPlugin::DoColourFiles(const wxStringSet_t& files, OverlayTool::BmpType bmpType)
+{
+    wxTreeCtrl* tree = m_mgr->GetTree(TreeFileView);
+    if ( !tree || files.empty() )
+        return;
+
+    wxStringSet_t::const_iterator iter = files.begin();
+    for (; iter != files.end(); ++iter) {
+        wxTreeItemId item = DoFindTreeItem(*iter);
+        if ( item.IsOk() ) {
+            DoSetTreeItemImage(tree, item, bmpType);
+        }
+    }
+}
+
 /*******************************************************************************/
 void GitPlugin::OnProgressTimer(wxTimerEvent& Event)
 {
@@ -1800,6 +1894,8 @@ void GitPlugin::DoCleanup()
     m_remoteBranchList.Clear();
     m_trackedFiles.clear();
     m_modifiedFiles.clear();
+    m_treeItemsIndex.clear();
+    m_treeItemsIndexDirty = true;
     m_addedFiles = false;
     m_progressMessage.Clear();
     m_commandOutput.Clear();
@@ -1840,12 +1936,8 @@ void GitPlugin::DoCreateTreeImages()
 
 void GitPlugin::DoSetTreeItemImage(wxTreeCtrl* ctrl, const wxTreeItemId& item, OverlayTool::BmpType bmpType) const
 {
-    clConfig conf("git.conf");
-    GitEntry data;
-    conf.ReadItem(&data);
-
-    if ( !(data.GetFlags() & GitEntry::Git_Colour_Tree_View) )
-        return;
+    // the caller is responsible for checking the Git_Colour_Tree_View flag
+    // Bmp_NoChange restores the image without any overlay
 
     // get the base image first
     int curImgIdx = ctrl->GetItemImage(item);
@@ -1854,7 +1946,7 @@ void GitPlugin::DoSetTreeItemImage(wxTreeCtrl* ctrl, const wxTreeItemId& item, O
 
         // now get the new image index based on the following:
         // baseCount + (imgIdx * bitmapCount) + BmpType
-        int newImg = m_baseImageCount + (baseImg * 2) + bmpType;
+        int newImg = bmpType == OverlayTool::Bmp_NoChange ? baseImg : m_baseImageCount + (baseImg * 2) + bmpType;
 
         // the below condition should never met, but I am paranoid..
         if ( ctrl->GetImageList()->GetImageCount() > newImg ) {
@@ -103,6 +103,8 @@ class GitPlugin : public IPlugin
     GitConsole *            m_console;
     wxFileName              m_workspaceFilename;
     GitCommitListDlg *      m_commitListDlg;
+    std::map<wxString, wxTreeItemId> m_treeItemsIndex;
+    bool                    m_treeItemsIndexDirty;
     
 private:
     void DoCreateTreeImages();
@@ -113,8 +115,14 @@ private:
     void AddDefaultActions();
     void LoadDefaultGitCommands(GitEntry& data, bool overwrite = false);
     void ProcessGitActionQueue(const wxString& commandString = "");
-    void ColourFileTree(wxTreeCtrl *tree, const wxStringSet_t& files, OverlayTool::BmpType bmpType) const;
     void CreateFilesTreeIDsMap(std::map<wxString, wxTreeItemId>& IDs, bool ifmodified = false) const;
+
+    /// Persistent path -> tree item index of the File View
+    bool IsTreeColouringEnabled() const;
+    void DoUpdateTreeItemsIndex();
+    wxTreeItemId DoFindTreeItem(const wxString& path);
+    void DoColourFiles(const wxStringSet_t& files, OverlayTool::BmpType bmpType);
+    void DoParseStatusPorcelain(const wxString& output, wxStringSet_t& files) const;
     
     /// Workspace management
     bool IsWorkspaceOpened() const;
@@ -143,6 +151,8 @@ private:
     void OnProcessOutput(wxCommandEvent &event);
 
     void OnFileSaved(wxCommandEvent& e);
+    void OnFileViewRefreshed(wxCommandEvent& e);
+    void OnFileViewItemDeleted(wxTreeEvent& e);
     void OnFilesAddedToProject(clCommandEvent& e);
     void OnFilesRemovedFromProject(wxCommandEvent& e);
     void OnWorkspaceLoaded(wxCommandEvent& e);